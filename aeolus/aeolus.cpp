@@ -186,6 +186,22 @@ void Aeolus::allNotesOff(int)
             _keymap[i] = 0x80;
       }
 
+//---------------------------------------------------------
+//   clear
+//    silence the pipes and the reverb at once; the stops
+//    stay as they are
+//---------------------------------------------------------
+
+void Aeolus::clear()
+      {
+      memset(_keymap, 0, sizeof(_keymap));
+      for (int i = 0; i < _ndivis; i++)
+            _divisp[i]->clear();
+      for (int i = 0; i < _nasect; i++)
+            _asectp[i]->clear();
+      nout = 0;
+      }
+
 //---------------------------------------------------------
 //   getPatchInfo
 //---------------------------------------------------------
@@ -123,6 +123,7 @@ class Aeolus : public Synthesizer {
 
       virtual void allSoundsOff(int channel) { allNotesOff(channel); }
       virtual void allNotesOff(int /*channel*/);
+      virtual void clear();
 
       virtual SynthesizerGui* gui();
 
@@ -35,6 +35,13 @@ void Diffuser::init (int size, float c)
 }
 
 
+void Diffuser::clear (void)
+{
+    memset (_data, 0, _size * sizeof (float));
+    _i = 0;
+}
+
+
 void Diffuser::fini (void)
 {
     delete[] _data;
@@ -95,6 +102,21 @@ void Asection::set_size (float time)
 }
 
 
+//---------------------------------------------------------
+//   clear
+//    silence the reverb
+//---------------------------------------------------------
+
+void Asection::clear ()
+      {
+      memset (_base, 0, NCHANN * N * sizeof (float));
+      _sw = _sx = _sy = 0.0f;
+      _dif0.clear ();
+      _dif1.clear ();
+      _dif2.clear ();
+      _dif3.clear ();
+      }
+
 //---------------------------------------------------------
 //   process
 //---------------------------------------------------------
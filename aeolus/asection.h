@@ -41,6 +41,7 @@ class Diffuser {
 
    public:
       void init(int size, float c);
+      void clear();
       void fini();
       int  size() { return _size; }
       float process(float x) {
@@ -80,6 +81,7 @@ class Asection {
       float *get_wptr () { return _base + _offs0; }
       SyntiParameter *get_apar () { return _apar; }
       void set_size (float size);
+      void clear ();
       void process (float vol, float *W, float *X, float *Y, float *R);
 
       static float _refl [16];
@@ -93,6 +93,21 @@ void Division::process()
       _gain = g;
       }
 
+//---------------------------------------------------------
+//   clear
+//    silence all pipes at once, the stops stay
+//---------------------------------------------------------
+
+void Division::clear()
+      {
+      for (int i = 0; i < _nrank; i++)
+            _ranks [i]->clear ();
+      memset (_buff, 0, NCHANN * PERIOD * sizeof (float));
+      _gain = 0.1f;
+      _c    = 1.0f;
+      _s    = 0.0f;
+      }
+
 void Division::set_rank (int ind, Rankwave *W, int pan, int del)
 {
     Rankwave *C;
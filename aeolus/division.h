@@ -58,6 +58,7 @@ class Division
       void trem_on()                { _trem = 1; }
       void trem_off()               { _trem = 2; }
 
+      void clear();
       void process();
       void update(int note, int mask);
       void update(unsigned char *keys);
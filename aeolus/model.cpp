@@ -156,58 +156,101 @@ void Model::init_iface()
       set_mconf (0, _chconf[0]._bits);
       }
 
+//---------------------------------------------------------
+//   init_ranks
+//---------------------------------------------------------
+
 void Model::init_ranks (int comm)
       {
       _count++;
       _ready = false;
 //WS      send_event (TO_IFACE, new M_ifc_retune (_fbase, _itemp));
 
+      std::vector<RankJob> jobs;
       for (int g = 0; g < _ngroup; g++) {
             Group* G = _group + g;
-            for (int i = 0; i < G->_nifelm; i++)
-                  proc_rank (g, i, comm);
+            for (int i = 0; i < G->_nifelm; i++) {
+                  if (comm == MT_SAVE_RANK)
+                        proc_rank (g, i, comm);
+                  else
+                        add_rank (g, i, &jobs);
+                  }
             }
+      calc_ranks (jobs);
       _ready = true;
       }
 
+//---------------------------------------------------------
+//   proc_rank
+//---------------------------------------------------------
 
 void Model::proc_rank (int g, int i, int comm)
+      {
+      if (comm == MT_SAVE_RANK) {
+            Rank* R = find_rank (g, i);
+            if (R && R->_wave->modif ()) {
+                  R->_wave->save(_waves, R->_sdef, _aeolus->_fsamp,
+                     _fbase, scales[_itemp]._data);
+                  }
+            }
+      else {
+            std::vector<RankJob> jobs;
+            add_rank (g, i, &jobs);
+            calc_ranks (jobs);
+            }
+      }
+
+//---------------------------------------------------------
+//   add_rank
+//    queue the rank of interface element i in group g,
+//    if it was not computed for the current _count yet
+//---------------------------------------------------------
+
+void Model::add_rank (int g, int i, std::vector<RankJob>* jobs)
       {
       Ifelm* I = _group [g]._ifelms + i;
       if ((I->_type == Ifelm::DIVRANK) || (I->_type == Ifelm::KBDRANK)) {
             int d = (I->_action0 >> 16) & 255;
             int r = (I->_action0 >>  8) & 255;
             Rank* R = _divis [d]._ranks + r;
-            if (comm == MT_SAVE_RANK) {
-                  if (R->_wave->modif ()) {
-                        R->_wave->save(_waves, R->_sdef, _aeolus->_fsamp,
-                           _fbase, scales[_itemp]._data);
-                        }
-                  }
-            else if (R->_count != _count) {
+            if (R->_count != _count) {
                   R->_count = _count;
-                  M_def_rank M(comm);
-                  M._divis = d;
-                  M._rank  = r;
-                  M._group = g;
-                  M._ifelm = i;
-                  M._fsamp = _aeolus->_fsamp;
-                  M._fbase = _fbase;
-                  M._scale = scales [_itemp]._data;
-                  M._sdef  = R->_sdef;
-                  M._wave  = R->_wave;
-                  M._path  = _waves;
-
-//WS                  send_event(TO_IFACE, new M_ifc_ifelm (MT_IFC_ELATT, M._group, M._ifelm));
-
-                  M._wave = new Rankwave (M._sdef->_n0, M._sdef->_n1);
-                  if (M._wave->load (M._path, M._sdef, M._fsamp, M._fbase, M._scale))
-                        M._wave->gen_waves (M._sdef, M._fsamp, M._fbase, M._scale);
-
-                  _aeolus->_divisp [M._divis]->set_rank (M._rank, M._wave,  M._sdef->_pan, M._sdef->_del);
-                  _divis [M._divis]._ranks [M._rank]._wave = M._wave;
+//WS                  send_event(TO_IFACE, new M_ifc_ifelm (MT_IFC_ELATT, g, i));
+                  jobs->push_back({ d, r, R->_sdef, 0 });
+                  }
+            }
+      }
+
+//---------------------------------------------------------
+//   calc_ranks
+//    Load the waves of all jobs from the cache or generate
+//    them on the thread pool. Generated waves are saved
+//    right away, so the next start with the same sample
+//    rate and tuning only has to load them. Waves not
+//    used for a while are removed from the cache.
+//---------------------------------------------------------
+
+void Model::calc_ranks (std::vector<RankJob>& jobs)
+      {
+      const char* path = _waves;
+      float fsamp      = _aeolus->_fsamp;
+      float fbase      = _fbase;
+      float* scale     = scales [_itemp]._data;
+
+      QtConcurrent::blockingMap(jobs, [path, fsamp, fbase, scale](RankJob& j) {
+            j._wave = new Rankwave (j._sdef->_n0, j._sdef->_n1);
+            if (j._wave->load (path, j._sdef, fsamp, fbase, scale)) {
+                  j._wave->gen_waves (j._sdef, fsamp, fbase, scale);
+                  j._wave->save (path, j._sdef, fsamp, fbase, scale);
                   }
+            });
+
+      for (const RankJob& j : jobs) {
+            _aeolus->_divisp [j._divis]->set_rank (j._rank, j._wave,  j._sdef->_pan, j._sdef->_del);
+            _divis [j._divis]._ranks [j._rank]._wave = j._wave;
             }
+      if (!jobs.empty())
+            Rankwave::clean_cache (path);
       }
 
 //---------------------------------------------------------
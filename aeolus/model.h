@@ -47,6 +47,19 @@ public:
     Rankwave   *_wave;
 };
 
+//---------------------------------------------------------
+//   RankJob
+//    a rank to be loaded or generated
+//---------------------------------------------------------
+
+struct RankJob
+      {
+      int         _divis;
+      int         _rank;
+      Addsynth*   _sdef;
+      Rankwave*   _wave;
+      };
+
 
 class Divis
       {
@@ -170,6 +183,8 @@ class Model
       void init_iface();
       void init_ranks(int comm);
       void proc_rank(int g, int i, int comm);
+      void add_rank(int g, int i, std::vector<RankJob>* jobs);
+      void calc_ranks(std::vector<RankJob>& jobs);
       void set_mconf(int i, uint16_t *d);
       void get_state(uint32_t *bits);
       void set_state(int bank, int pres);
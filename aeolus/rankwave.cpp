@@ -16,6 +16,11 @@
     Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 */
 
+#ifdef _MSC_VER
+#include <sys/utime.h>
+#else
+#include <utime.h>
+#endif
 #include "rankwave.h"
 
 #define DEBUG
@@ -24,18 +29,6 @@ extern float exp2ap (float);
 
 
 Rngen   Pipewave::_rgen;
-float  *Pipewave::_arg = 0;
-float  *Pipewave::_att = 0;
-
-void Pipewave::initstatic(float fsamp)
-      {
-      if (_arg)
-            return;
-      int k = (int)(fsamp);
-      _arg  = new float [k];
-      k     = (int)(0.5f * fsamp);
-      _att  = new float [k];
-      }
 
 //---------------------------------------------------------
 //   play
@@ -183,7 +176,7 @@ void Pipewave::play()
 }
 
 
-void Pipewave::genwave (Addsynth *D, int n, float fsamp, float fpipe)
+void Pipewave::genwave (Addsynth *D, int n, float fsamp, float fpipe, Rngen& rgen, float *arg, float *att)
 {
     int    h, i, k, nc;
     float  f0, f1, f, m, t, v, v0;
@@ -197,7 +190,7 @@ void Pipewave::genwave (Addsynth *D, int n, float fsamp, float fpipe)
     _l0 = (int)(fsamp * m + 0.5);
     _l0 = (_l0 + PERIOD - 1) & ~(PERIOD - 1);
 
-    f1 = (fpipe + D->_n_off.vi (n) + D->_n_ran.vi (n) * (2 * _rgen.urand () - 1)) / fsamp;
+    f1 = (fpipe + D->_n_off.vi (n) + D->_n_ran.vi (n) * (2 * rgen.urand () - 1)) / fsamp;
     f0 = f1 * exp2ap (D->_n_atd.vi (n) / 1200.0f);
 
     for (h = N_HARM - 1; h >= 0; h--)
@@ -234,14 +227,14 @@ void Pipewave::genwave (Addsynth *D, int n, float fsamp, float fpipe)
     k = (int)(fsamp * D->_n_att.vi (n) + 0.5);
     for (i = 0; i <= _l0; i++)
     {
-        _arg [i] = t - floorf (t + 0.5);
+        arg [i] = t - floorf (t + 0.5);
 	t += (i < k) ? (((k - i) * f0 + i * f1) / k) : f1;
     }
 
     for (i = 1; i < _l1; i++)
     {
-	t = _arg [_l0]+ (float) i * nc / _l1;
-        _arg [i + _l0] = t - floorf (t + 0.5);
+	t = arg [_l0]+ (float) i * nc / _l1;
+        arg [i + _l0] = t - floorf (t + 0.5);
     }
 
     v0 = exp2ap (0.1661 * D->_n_vol.vi (n));
@@ -251,16 +244,16 @@ void Pipewave::genwave (Addsynth *D, int n, float fsamp, float fpipe)
         v = D->_h_lev.vi (h, n);
         if (v < -80.0) continue;
 
-        v = v0 * exp2ap (0.1661 * (v + D->_h_ran.vi (h, n) * (2 * _rgen.urand () - 1)));
+        v = v0 * exp2ap (0.1661 * (v + D->_h_ran.vi (h, n) * (2 * rgen.urand () - 1)));
         k = (int)(fsamp * D->_h_att.vi (h, n) + 0.5);
-        attgain (k, D->_h_atp.vi (h, n));
+        attgain (att, k, D->_h_atp.vi (h, n));
 
         for (i = 0; i < _l0 + _l1; i++)
         {
-	    t = _arg [i] * (h + 1);
+	    t = arg [i] * (h + 1);
             t -= floorf (t);
             m = v * sinf (2 * M_PI * t);
-            if (i < k) m *= _att [i];
+            if (i < k) m *= att [i];
             _p0 [i] += m;
         }
     }
@@ -311,7 +304,7 @@ void Pipewave::looplen (float f, float fsamp, int lmax, int *aa, int *bb)
 }
 
 
-void Pipewave::attgain (int n, float p)
+void Pipewave::attgain (float *att, int n, float p)
 {
     int    i, j, k;
     float  d, m, w, x, y, z;
@@ -331,7 +324,7 @@ void Pipewave::attgain (int n, float p)
         while (j < k)
 	{
             m = (double) j / n;
-            _att [j++] = (1.0 - m) * z + m;
+            att [j++] = (1.0 - m) * z + m;
             z += d;
 	}
     }
@@ -402,19 +395,74 @@ Rankwave::~Rankwave (void)
 }
 
 
+//---------------------------------------------------------
+//   seed
+//    The random generator of a rank is seeded from the
+//    stop definition, its file and the note range, so
+//    that generating the same rank again, after the cache
+//    was removed or on another machine, gives the same
+//    waves.
+//---------------------------------------------------------
+
+uint32_t Rankwave::seed (Addsynth *D) const
+{
+    QCryptographicHash h (QCryptographicHash::Sha1);
+    h.addData (D->_filename, strlen (D->_filename));
+    h.addData ((const char *) &D->_n0, (const char *)(&D->_h_atp + 1) - (const char *) &D->_n0);
+    h.addData ((const char *) &_n0, sizeof (int));
+    h.addData ((const char *) &_n1, sizeof (int));
+    return qFromLittleEndian<quint32> ((const uchar *) h.result ().constData ());
+}
+
+
+//---------------------------------------------------------
+//   gen_waves
+//    ranks are generated concurrently, so each call has
+//    its own work buffers and random generator
+//---------------------------------------------------------
+
 void Rankwave::gen_waves (Addsynth *D, float fsamp, float fbase, float *scale)
 {
-    Pipewave::initstatic (fsamp);
+    float *arg = new float [(int)(fsamp)];
+    float *att = new float [(int)(0.5f * fsamp)];
+    Rngen  rgen;
+    rgen.init (seed (D));
 
     fbase *=  D->_fn / (D->_fd * scale [9]);
     for (int i = _n0; i <= _n1; i++)
     {
-	_pipes [i - _n0].genwave (D, i - _n0, fsamp, ldexpf (fbase * scale [i % 12], i / 12 - 5));
+	_pipes [i - _n0].genwave (D, i - _n0, fsamp, ldexpf (fbase * scale [i % 12], i / 12 - 5), rgen, arg, att);
     }
+    delete[] arg;
+    delete[] att;
     _modif = true;
 }
 
 
+//---------------------------------------------------------
+//   cachename
+//    The waves of a rank depend on the stop definition,
+//    the sample rate, the tuning and the temperament.
+//    Each combination is kept in its own file.
+//---------------------------------------------------------
+
+static void cachename (char *name, const char *path, Addsynth *D, float fsamp, float fbase, float *scale)
+{
+    char  base [64];
+    char *p;
+
+    QCryptographicHash h (QCryptographicHash::Sha1);
+    h.addData ((const char *) &D->_n0, (const char *)(&D->_h_atp + 1) - (const char *) &D->_n0);
+    h.addData ((const char *) &fsamp, sizeof (float));
+    h.addData ((const char *) &fbase, sizeof (float));
+    h.addData ((const char *) scale, 12 * sizeof (float));
+
+    strcpy (base, D->_filename);
+    if ((p = strrchr (base, '.'))) *p = 0;
+    sprintf (name, "%s/%s-%s.ae1", path, base, h.result ().toHex ().left (16).constData ());
+}
+
+
 void Rankwave::set_param (float *out, int del, int pan)
 {
     int         n, a, b;
@@ -456,17 +504,18 @@ int Rankwave::save (const char *path, Addsynth *D, float fsamp, float fbase, flo
     Pipewave  *P;
     int        i;
     char       name [1024];
+    char       temp [1100];
     char       data [64];
-    char      *p;
 
-    sprintf (name, "%s/%s", path, D->_filename);
-    if ((p = strrchr (name, '.'))) strcpy (p, ".ae1");
-    else strcat (name, ".ae1");
+    // written under a temporary name, other ranks or
+    // instances may be reading or writing the same file
+    cachename (name, path, D, fsamp, fbase, scale);
+    sprintf (temp, "%s.%p.tmp", name, (void *) this);
 
-    F = fopen (name, "wb");
+    F = fopen (temp, "wb");
     if (F == NULL)
     {
-	fprintf (stderr, "Can't open waveform file '%s' for writing\n", name);
+	fprintf (stderr, "Can't open waveform file '%s' for writing\n", temp);
         return 1;
     }
 
@@ -492,6 +541,8 @@ int Rankwave::save (const char *path, Addsynth *D, float fsamp, float fbase, flo
     for (i = _n0, P = _pipes; i <= _n1; i++, P++) P->save (F);
 
     fclose (F);
+    remove (name);
+    if (rename (temp, name)) remove (temp);
 
     _modif = false;
     return 0;
@@ -505,12 +556,9 @@ int Rankwave::load (const char *path, Addsynth *D, float fsamp, float fbase, flo
     int        i;
     char       name [1024];
     char       data [64];
-    char      *p;
     float      f;
 
-    sprintf (name, "%s/%s", path, D->_filename);
-    if ((p = strrchr (name, '.'))) strcpy (p, ".ae1");
-    else strcat (name, ".ae1");
+    cachename (name, path, D, fsamp, fbase, scale);
 
     F = fopen (name, "rb");
     if (F == NULL)
@@ -586,7 +634,38 @@ int Rankwave::load (const char *path, Addsynth *D, float fsamp, float fbase, flo
     for (i = _n0, P = _pipes; i <= _n1; i++, P++) P->load (F);
 
     fclose (F);
+    utime (name, 0);    // the modification time marks the last use for clean_cache
 
     _modif = false;
     return 0;
 }
+
+
+//---------------------------------------------------------
+//   clean_cache
+//    Remove the wave files of the naming without a key,
+//    temporary files left by an interrupted save and,
+//    per stop, all but the MAX_CACHED most recently used
+//    wave files.
+//---------------------------------------------------------
+
+void Rankwave::clean_cache (const char *path)
+{
+    QDir dir (QString::fromLocal8Bit (path));
+    QRegExp keyed ("(.*)-[0-9a-f]{16}\\.ae1");
+    QDateTime stale = QDateTime::currentDateTime ().addSecs (-3600);
+    QHash<QString, int> count;
+
+    // newest first
+    for (const QFileInfo& fi : dir.entryInfoList (QStringList () << "*.ae1" << "*.ae1.*.tmp", QDir::Files, QDir::Time))
+    {
+        QString n = fi.fileName ();
+        if (n.endsWith (".tmp"))
+        {
+            // may still be written by another instance
+            if (fi.lastModified () < stale) dir.remove (n);
+        }
+        else if (!keyed.exactMatch (n) || ++count [keyed.cap (1)] > MAX_CACHED)
+            dir.remove (n);
+    }
+}
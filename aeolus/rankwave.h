@@ -42,13 +42,13 @@ private:
 
     friend class Rankwave;
 
-    void genwave (Addsynth *D, int n, float fsamp, float fpipe);
+    void genwave (Addsynth *D, int n, float fsamp, float fpipe, Rngen& rgen, float *arg, float *att);
     void save (FILE *F);
     void load (FILE *F);
     void play (void);
 
     static void looplen (float f, float fsamp, int lmax, int *aa, int *bb);
-    static void attgain (int n, float p);
+    static void attgain (float *att, int n, float p);
 
     float     *_p0;    // attack start
     float     *_p1;    // loop start
@@ -73,12 +73,7 @@ private:
     float      _g_r;   // release gain
     int16_t    _i_r;   // release count
 
-
-    static void initstatic (float fsamp);
-
     static   Rngen   _rgen;
-    static   float  *_arg;
-    static   float  *_att;
 };
 
 //---------------------------------------------------------
@@ -97,6 +92,8 @@ class Rankwave
       Pipewave   *_pipes;
       bool        _modif;
 
+      uint32_t seed (Addsynth *D) const;
+
 public:
 
       Rankwave (int n0, int n1);
@@ -130,6 +127,19 @@ public:
         for (P = _list; P; P = P->_link) P->_sbit = 0;
     }
 
+    void clear (void)
+    {
+        Pipewave *P;
+        for (P = _list; P; P = P->_link)
+        {
+            P->_sbit = 0;
+            P->_sdel = 0;
+            P->_p_p = 0;
+            P->_p_r = 0;
+        }
+        _list = 0;
+    }
+
     int  n0 (void) const { return _n0; }
     int  n1 (void) const { return _n1; }
     void play (int shift);
@@ -139,6 +149,9 @@ public:
     int  load (const char *path, Addsynth *D, float fsamp, float fbase, float *scale);
     bool modif (void) const { return _modif; }
 
+    static const int MAX_CACHED = 4;    // wave files kept per stop
+    static void clean_cache (const char *path);
+
     int  _cmask;  // used by division logic
     int  _nmask;  // used by division logic
 
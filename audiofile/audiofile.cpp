@@ -44,13 +44,15 @@ AudioFile::AudioFile()
       {
       memset(&info, 0, sizeof(info));
       memset(&inst, 0, sizeof(inst));
-      sf = 0;
+      sf   = 0;
+      file = 0;
       }
 
 AudioFile::~AudioFile()
       {
       if (sf)
             sf_close(sf);
+      delete file;
       }
 
 //---------------------------------------------------------
@@ -67,6 +69,33 @@ bool AudioFile::open(const QByteArray& b)
       return sf != 0;
       }
 
+//---------------------------------------------------------
+//   open
+//    read from the file instead of a memory copy; only
+//    the parts actually read are loaded
+//---------------------------------------------------------
+
+bool AudioFile::open(const QString& path)
+      {
+      file = new QFile(path);
+      if (!file->open(QIODevice::ReadOnly))
+            return false;
+      idx = 0;
+      sf  = sf_open_virtual(&sfio, SFM_READ, &info, this);
+      hasInstrument = sf_command(sf, SFC_GET_INSTRUMENT, &inst, sizeof(inst)) == SF_TRUE;
+
+      return sf != 0;
+      }
+
+//---------------------------------------------------------
+//   seekFrame
+//---------------------------------------------------------
+
+bool AudioFile::seekFrame(sf_count_t frame)
+      {
+      return sf_seek(sf, frame, SEEK_SET) == frame;
+      }
+
 //---------------------------------------------------------
 //   read
 //---------------------------------------------------------
@@ -90,9 +119,11 @@ sf_count_t AudioFile::seek(sf_count_t offset, int whence)
                   idx += offset;
                   break;
             case SEEK_END:
-                  idx = buf.size() + offset;
+                  idx = getFileLen() + offset;
                   break;
             }
+      if (file)
+            file->seek(idx);
       return idx;
       }
 
@@ -102,8 +133,15 @@ sf_count_t AudioFile::seek(sf_count_t offset, int whence)
 
 sf_count_t AudioFile::read(void* ptr, sf_count_t count)
       {
-      count = qMin(count, (sf_count_t)(buf.size() - idx));
-      memcpy(ptr, buf.data() + idx, count);
+      if (file) {
+            count = file->read((char*)ptr, count);
+            if (count < 0)
+                  return 0;
+            }
+      else {
+            count = qMin(count, (sf_count_t)(buf.size() - idx));
+            memcpy(ptr, buf.data() + idx, count);
+            }
       idx += count;
       return count;
       }
@@ -25,13 +25,16 @@ class AudioFile {
       SF_INSTRUMENT inst;
       bool hasInstrument;
       QByteArray buf;  // used during read of Sample
-      int idx;
+      QFile* file;     // used instead of buf when streaming from disk
+      qint64 idx;
 
    public:
       AudioFile();
       ~AudioFile();
 
       bool open(const QByteArray&);
+      bool open(const QString& path);
+      bool seekFrame(sf_count_t frame);
       const char* error() const     { return sf_strerror(sf); }
       int read(short*, int);
 
@@ -39,7 +42,7 @@ class AudioFile {
       int frames() const     { return info.frames; }
       int samplerate() const { return info.samplerate; }
 
-      sf_count_t getFileLen() const { return buf.size(); }
+      sf_count_t getFileLen() const { return file ? file->size() : buf.size(); }
       sf_count_t tell() const       { return idx; }
       sf_count_t read(void* ptr, sf_count_t count);
       sf_count_t write(const void* ptr, sf_count_t count);
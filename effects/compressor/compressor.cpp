@@ -191,20 +191,30 @@ void db_init()
 void Compressor::init(float sr)
       {
       sampleRate = sr;
-      sum        = 0.0f;
-      amp        = 0.0f;
-      gain       = 0.0f;
-      gain_t     = 0.0f;
-      env        = 0.0f;
-      env_rms    = 0.0f;
-      env_peak   = 0.0f;
-      count      = 0;
+      clear();
       as[0]      = 1.0f;
       for (int i = 0; i < A_TBL; ++i)
             as[i] = expf(-1.0f / (sampleRate * (float)i / (float)A_TBL));
       db_init();
       }
 
+//---------------------------------------------------------
+//   Compressor::clear
+//---------------------------------------------------------
+
+void Compressor::clear()
+      {
+      rms.reset();
+      sum      = 0.0f;
+      amp      = 0.0f;
+      gain     = 0.0f;
+      gain_t   = 0.0f;
+      env      = 0.0f;
+      env_rms  = 0.0f;
+      env_peak = 0.0f;
+      count    = 0;
+      }
+
 //---------------------------------------------------------
 //   Compressor::process
 //---------------------------------------------------------
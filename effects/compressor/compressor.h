@@ -30,7 +30,8 @@ class RmsEnv {
       float        sum;
 
    public:
-      RmsEnv() {
+      RmsEnv() { reset(); }
+      void reset() {
             for (int i=0; i<RMS_BUF_SIZE; i++)
                   buffer[i] = 0.0f;
             pos = 0;
@@ -131,6 +132,7 @@ class Compressor : public Effect
 
    public:
       virtual void init(float fsamp);
+      virtual void clear();
       virtual void process(int n, float* inp, float* out);
       virtual const char* name() const { return "SC4"; }
       virtual EffectGui* gui();
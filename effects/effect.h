@@ -55,6 +55,7 @@ class Effect : public QObject {
       virtual void process(int frames, float*, float*) = 0;
       virtual const char* name() const = 0;
       virtual void init(float /*sampleRate*/) {}
+      virtual void clear() {}       // forget the signal, keep the parameters
       virtual const std::vector<ParDescr>& parDescr() const = 0;
 
       Q_INVOKABLE qreal value(const QString& name) const;
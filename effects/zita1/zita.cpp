@@ -226,6 +226,12 @@ void Diff1::init (int size, float c)
       _c = c;
       }
 
+void Diff1::clear ()
+      {
+      memset (_line, 0, _size * sizeof (float));
+      _i = 0;
+      }
+
 void Diff1::fini()
       {
       delete[] _line;
@@ -251,6 +257,12 @@ void Delay::init (int size)
       _i = 0;
       }
 
+void Delay::clear ()
+      {
+      memset (_line, 0, _size * sizeof (float));
+      _i = 0;
+      }
+
 void Delay::fini ()
       {
       delete[] _line;
@@ -277,6 +289,13 @@ void Vdelay::init (int size)
       _iw = 0;
       }
 
+void Vdelay::clear ()
+      {
+      memset (_line, 0, _size * sizeof (float));
+      _ir = 0;
+      _iw = 0;
+      }
+
 void Vdelay::fini ()
       {
       delete[] _line;
@@ -366,6 +385,32 @@ void ZitaReverb::init(float fsamp)
       _nsamp = 0;
       }
 
+//---------------------------------------------------------
+//   clear
+//    silence the reverb tail as after init(); the delay
+//    and the output mix are set up again with the next
+//    fragment
+//---------------------------------------------------------
+
+void ZitaReverb::clear()
+      {
+      _vdelay0.clear ();
+      _vdelay1.clear ();
+      for (int i = 0; i < 8; i++) {
+            _diff1 [i].clear ();
+            _filt1 [i]._slo = 0;
+            _filt1 [i]._shi = 0;
+            _delay [i].clear ();
+            }
+      _pareq1.reset ();
+      _pareq2.reset ();
+
+      _g0 = _d0 = 0;
+      _g1 = _d1 = 0;
+      _cntA2 = _cntA1 - 1;
+      _cntC2 = _cntC1 - 1;
+      _nsamp = 0;
+      }
 
 void ZitaReverb::fini ()
       {
@@ -95,6 +95,7 @@ class Diff1
       Diff1() {}
       ~Diff1();
       void  init(int size, float c);
+      void  clear();
       void  fini();
 
       float process(float x) {
@@ -146,6 +147,7 @@ class Delay
       ~Delay();
 
       void  init (int size);
+      void  clear ();
       void  fini ();
 
       float read () { return _line [_i]; }
@@ -172,6 +174,7 @@ class Vdelay
       ~Vdelay();
 
       void  init (int size);
+      void  clear ();
       void  fini ();
       void  set_delay (int del);
 
@@ -243,6 +246,7 @@ class ZitaReverb : public Effect
       ~ZitaReverb();
 
       virtual void init(float fsamp);
+      virtual void clear();
       void fini();
 
       virtual void process(int n, float* inp, float* out);
@@ -221,7 +221,9 @@ void Channel::setPreset(Preset* p)
       {
       if (_preset != p) {
             if (p)
-                  p->loadSamples();
+                  p->loadSamples(synth->backgroundLoading());
+            if (_preset)
+                  _preset->releaseSamples();
             _preset = p;
             }
       }
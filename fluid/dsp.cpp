@@ -21,6 +21,7 @@
 #include "fluid.h"
 #include "voice.h"
 #include "sfont.h"
+#include "kernels.h"
 
 namespace FluidS {
 
@@ -72,6 +73,37 @@ inline bool Voice::updateAmpInc(unsigned int &nextNewAmpInc, std::map<int, qreal
       }
 
 
+//---------------------------------------------------------
+//   blockLength
+//    Number of output samples from dsp_i on, which can be
+//    rendered by a block kernel: the amplitude increment
+//    does not change, the voice is not turned off and the
+//    phase index stays <= end_index.
+//    Returns 0 if the next sample needs updateAmpInc().
+//---------------------------------------------------------
+
+unsigned Voice::blockLength(unsigned dsp_i, unsigned n, Phase dsp_phase, Phase dsp_phase_incr, unsigned end_index,
+   unsigned nextNewAmpInc, qreal dsp_amp_incr) const
+      {
+      if (dsp_i >= n || dsp_i >= nextNewAmpInc || (amp == 0.0 && dsp_amp_incr == 0.0))
+            return 0;
+      unsigned len = qMin(n, nextNewAmpInc) - dsp_i;
+      if (positionToTurnOff > 0) {
+            if (dsp_i >= unsigned(positionToTurnOff))
+                  return 0;
+            len = qMin(len, unsigned(positionToTurnOff) - dsp_i);
+            }
+      if (dsp_phase_incr.data > 0) {
+            qint64 limit = ((qint64(end_index) + 1) << 32) - 1;
+            if (dsp_phase.data > limit)
+                  return 0;
+            qint64 steps = (limit - dsp_phase.data) / dsp_phase_incr.data + 1;
+            if (steps < qint64(len))
+                  len = unsigned(steps);
+            }
+      return len;
+      }
+
 /* Interpolation (find a value between two samples of the original waveform) */
 
 /* Linear interpolation table (2 coefficients centered on 1st) */
@@ -221,6 +253,7 @@ int Voice::dsp_float_interpolate_linear(unsigned n)
       unsigned int end_index;
       short int point;
       float *coeffs;
+      const DspKernels* kernels = DspKernels::instance();
       int looping;
 
       /* Convert playback "speed" floating point value to phase index/fract */
@@ -244,7 +277,17 @@ int Voice::dsp_float_interpolate_linear(unsigned n)
             dsp_phase_index = dsp_phase.index();
 
             /* interpolate the sequence of sample points */
-            for ( ; dsp_i < n && dsp_phase_index <= end_index; dsp_i++) {
+            while (dsp_i < n && dsp_phase_index <= end_index) {
+                  unsigned len = kernels->interpolateLinear ? blockLength(dsp_i, n, dsp_phase, dsp_phase_incr, end_index, nextNewAmpInc, dsp_amp_incr) : 0;
+                  if (len) {
+                        kernels->interpolateLinear(dsp_buf + dsp_i, dsp_data, dsp_phase.data, dsp_phase_incr.data,
+                           len, amp, dsp_amp_incr, interp_coeff_linear);
+                        dsp_phase.data += dsp_phase_incr.data * len;
+                        dsp_phase_index = dsp_phase.index();
+                        amp   += dsp_amp_incr * len;
+                        dsp_i += len;
+                        continue;
+                        }
                   coeffs = interp_coeff_linear[fluid_phase_fract_to_tablerow (dsp_phase)];
                   dsp_buf[dsp_i] = amp * (coeffs[0] * dsp_data[dsp_phase_index]
 				  + coeffs[1] * dsp_data[dsp_phase_index+1]);
@@ -255,6 +298,7 @@ int Voice::dsp_float_interpolate_linear(unsigned n)
                   if (!updateAmpInc(nextNewAmpInc, curSample2AmpInc, dsp_amp_incr, dsp_i))
                         return dsp_i;
                   amp += dsp_amp_incr;
+                  dsp_i++;
                   }
 
             /* break out if buffer filled */
@@ -315,6 +359,7 @@ int Voice::dsp_float_interpolate_4th_order(unsigned n)
       unsigned int start_index;
       short int start_point, end_point1, end_point2;
       float *coeffs;
+      const DspKernels* kernels = DspKernels::instance();
 
       /* Convert playback "speed" floating point value to phase index/fract */
       dsp_phase_incr.setFloat(phase_incr);
@@ -366,7 +411,17 @@ int Voice::dsp_float_interpolate_4th_order(unsigned n)
                   }
 
             /* interpolate the sequence of sample points */
-            for ( ; dsp_i < n && dsp_phase_index <= end_index; dsp_i++) {
+            while (dsp_i < n && dsp_phase_index <= end_index) {
+                  unsigned len = kernels->interpolate4 ? blockLength(dsp_i, n, phase, dsp_phase_incr, end_index, nextNewAmpInc, dsp_amp_incr) : 0;
+                  if (len) {
+                        kernels->interpolate4(dsp_buf + dsp_i, dsp_data, phase.data, dsp_phase_incr.data,
+                           len, amp, dsp_amp_incr, interp_coeff);
+                        phase.data += dsp_phase_incr.data * len;
+                        dsp_phase_index = phase.index();
+                        amp   += dsp_amp_incr * len;
+                        dsp_i += len;
+                        continue;
+                        }
                   coeffs = interp_coeff[fluid_phase_fract_to_tablerow (phase)];
                   dsp_buf[dsp_i] = amp * (coeffs[0] * dsp_data[dsp_phase_index-1]
 				  + coeffs[1] * dsp_data[dsp_phase_index]
@@ -379,6 +434,7 @@ int Voice::dsp_float_interpolate_4th_order(unsigned n)
                   if (!updateAmpInc(nextNewAmpInc, curSample2AmpInc, dsp_amp_incr, dsp_i))
                         return dsp_i;
                   amp += dsp_amp_incr;
+                  dsp_i++;
                   }
 
             /* break out if buffer filled */
@@ -465,6 +521,7 @@ int Voice::dsp_float_interpolate_7th_order(unsigned n)
       short int start_points[3];
       short int end_points[3];
       float *coeffs;
+      const DspKernels* kernels = DspKernels::instance();
       int looping;
 
       /* Convert playback "speed" floating point value to phase index/fract */
@@ -577,7 +634,17 @@ int Voice::dsp_float_interpolate_7th_order(unsigned n)
             start_index -= 2;	/* set back to original start index */
 
             /* interpolate the sequence of sample points */
-            for ( ; dsp_i < n && dsp_phase_index <= end_index; dsp_i++) {
+            while (dsp_i < n && dsp_phase_index <= end_index) {
+                  unsigned len = kernels->interpolate7 ? blockLength(dsp_i, n, dsp_phase, dsp_phase_incr, end_index, nextNewAmpInc, dsp_amp_incr) : 0;
+                  if (len) {
+                        kernels->interpolate7(dsp_buf + dsp_i, dsp_data, dsp_phase.data, dsp_phase_incr.data,
+                           len, amp, dsp_amp_incr, sinc_table7);
+                        dsp_phase.data += dsp_phase_incr.data * len;
+                        dsp_phase_index = dsp_phase.index();
+                        amp   += dsp_amp_incr * len;
+                        dsp_i += len;
+                        continue;
+                        }
                   coeffs = sinc_table7[fluid_phase_fract_to_tablerow (dsp_phase)];
 
                   dsp_buf[dsp_i] = amp * (coeffs[0] * (float)dsp_data[dsp_phase_index-3]
@@ -594,6 +661,7 @@ int Voice::dsp_float_interpolate_7th_order(unsigned n)
                   if (!updateAmpInc(nextNewAmpInc, curSample2AmpInc, dsp_amp_incr, dsp_i))
                         return dsp_i;
                   amp += dsp_amp_incr;
+                  dsp_i++;
                   }
 
             /* break out if buffer filled */
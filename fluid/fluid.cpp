@@ -120,8 +120,10 @@ Fluid::~Fluid()
 
 void Fluid::freeVoice(Voice* v)
       {
-      if (activeVoices.removeOne(v))
+      if (activeVoices.removeOne(v)) {
+            v->sample->removeVoice();
             freeVoices.append(v);
+            }
       }
 
 //---------------------------------------------------------
@@ -148,6 +150,8 @@ void Fluid::play(const PlayEvent& event)
                   //
                   // process note off
                   //
+                  if (removeDeferredNotes(ch, key))
+                        _droppedNotes.ref();
                   foreach (Voice* v, activeVoices) {
                         if (v->ON() && (v->chan == ch) && (v->key == key))
                               v->noteoff();
@@ -158,22 +162,10 @@ void Fluid::play(const PlayEvent& event)
                   qDebug("channel has no preset");
                   err = true;
                   }
-            else {
-                  /*
-                   * If the same note is hit twice on the same channel, then the older
-                   * voice process is advanced to the release stage.  Using a mechanical
-                   * MIDI controller, the only way this can happen is when the sustain
-                   * pedal is held.  In this case the behaviour implemented here is
-                   * natural for many instruments.  Note: One noteon event can trigger
-                   * several voice processes, for example a stereo sample.  Don't
-                   * release those...
-                   */
-                  foreach(Voice* v, activeVoices) {
-                        if (v->isPlaying() && (v->chan == ch) && (v->key == key) && (v->get_id() != noteid))
-                              v->noteoff();
-                        }
-                  err = !cp->preset()->noteon(this, noteid++, ch, key, vel, event.tuning());
-                  }
+            else if (!cp->preset()->samplesReady(key, vel))
+                  deferNote(ch, key, vel, event.tuning());
+            else
+                  err = !startNote(ch, key, vel, event.tuning());
             }
       else if (type == ME_CONTROLLER) {
             switch(event.dataA()) {
@@ -196,6 +188,90 @@ void Fluid::play(const PlayEvent& event)
                type, ch, qPrintable(error()));
       }
 
+//---------------------------------------------------------
+//   startNote
+//---------------------------------------------------------
+
+bool Fluid::startNote(int ch, int key, int vel, double tuning)
+      {
+      /*
+       * If the same note is hit twice on the same channel, then the older
+       * voice process is advanced to the release stage.  Using a mechanical
+       * MIDI controller, the only way this can happen is when the sustain
+       * pedal is held.  In this case the behaviour implemented here is
+       * natural for many instruments.  Note: One noteon event can trigger
+       * several voice processes, for example a stereo sample.  Don't
+       * release those...
+       */
+      foreach(Voice* v, activeVoices) {
+            if (v->isPlaying() && (v->chan == ch) && (v->key == key) && (v->get_id() != noteid))
+                  v->noteoff();
+            }
+      return channel[ch]->preset()->noteon(this, noteid++, ch, key, vel, tuning);
+      }
+
+//---------------------------------------------------------
+//   deferNote
+//    the samples of the note are loaded in the background;
+//    the note is started by process() when they are ready
+//---------------------------------------------------------
+
+void Fluid::deferNote(int ch, int key, int vel, double tuning)
+      {
+      removeDeferredNotes(ch, key);
+      if (_nDeferred == MAX_DEFERRED_NOTES) {
+            _droppedNotes.ref();
+            return;
+            }
+      _deferred[_nDeferred++] = { ch, key, vel, tuning, 0 };
+      }
+
+//---------------------------------------------------------
+//   startDeferredNotes
+//    start the deferred notes whose samples are ready now;
+//    notes which wait longer than a second are dropped
+//---------------------------------------------------------
+
+void Fluid::startDeferredNotes(unsigned frames)
+      {
+      int n = 0;
+      for (int i = 0; i < _nDeferred; ++i) {
+            DeferredNote d = _deferred[i];
+            Preset* p      = channel[d.chan]->preset();
+            if (p && p->samplesReady(d.key, d.vel)) {
+                  startNote(d.chan, d.key, d.vel, d.tuning);
+                  continue;
+                  }
+            d.frames += frames;
+            if (!p || d.frames > sample_rate) {
+                  _droppedNotes.ref();
+                  continue;
+                  }
+            _deferred[n++] = d;
+            }
+      _nDeferred = n;
+      }
+
+//---------------------------------------------------------
+//   removeDeferredNotes
+//    key -1 removes all notes of chan, chan -1 the notes
+//    of all channels; returns the number of removed notes
+//---------------------------------------------------------
+
+int Fluid::removeDeferredNotes(int chan, int key)
+      {
+      int n = 0;
+      for (int i = 0; i < _nDeferred; ++i) {
+            const DeferredNote& d = _deferred[i];
+            if ((chan == -1 || d.chan == chan) && (key == -1 || d.key == key))
+                  continue;
+            _deferred[n++] = d;
+            }
+      int removed = _nDeferred - n;
+      _nDeferred  = n;
+      return removed;
+      }
+
 //---------------------------------------------------------
 //   damp_voices
 //---------------------------------------------------------
@@ -214,6 +290,7 @@ void Fluid::damp_voices(int chan)
 
 void Fluid::allNotesOff(int chan)
       {
+      removeDeferredNotes(chan, -1);
       foreach(Voice* v, activeVoices) {
             if (chan == -1 || v->chan == chan)
                   v->noteoff();
@@ -228,12 +305,29 @@ void Fluid::allNotesOff(int chan)
 
 void Fluid::allSoundsOff(int chan)
       {
+      removeDeferredNotes(chan, -1);
       foreach(Voice* v, activeVoices) {
             if (chan == -1 || v->chan == chan)
                   v->off();
             }
       }
 
+//---------------------------------------------------------
+//   clear
+//    silence all voices and drop the channels, they are
+//    created again with their defaults by the next event
+//---------------------------------------------------------
+
+void Fluid::clear()
+      {
+      allSoundsOff(-1);
+      foreach(Channel* c, channel)
+            c->setPreset(0);
+      qDeleteAll(channel);
+      channel.clear();
+      noteid = 0;
+      }
+
 //---------------------------------------------------------
 //   system_reset
 //
@@ -393,6 +487,8 @@ void Fluid::update_presets()
 void Fluid::process(unsigned len, float* out, float* effect1, float* effect2)
       {
       if (mutex.tryLock()) {
+            if (_nDeferred)
+                  startDeferredNotes(len);
             foreach (Voice* v, activeVoices)
                   v->write(len, out, effect1, effect2);
             mutex.unlock();
@@ -492,6 +588,7 @@ Voice* Fluid::alloc_voice(unsigned id, Sample* sample, int chan, int key, int ve
             c = channel[chan];
 
       v->init(sample, c, key, vel, id, vt);
+      sample->addVoice();
 
       /* add the default modulators to the synthesis process. */
       for (unsigned i = 0; i < sizeof(defaultMod)/sizeof(*defaultMod); ++i)
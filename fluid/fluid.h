@@ -301,6 +301,7 @@ class Fluid : public Synthesizer {
       QList<Voice*> freeVoices;           // unused synthesis processes
       QList<Voice*> activeVoices;         // active synthesis processes
       QString _error;                     // last error message
+      bool _backgroundLoading { false };  // load samples in the loader thread, defer their notes
 
       static bool initialized;
 
@@ -311,6 +312,28 @@ class Fluid : public Synthesizer {
       QMutex mutex;
       void updatePatchList();
 
+      //---------------------------------------------------
+      //   DeferredNote
+      //    a note on whose samples are still being loaded
+      //---------------------------------------------------
+
+      struct DeferredNote {
+            int chan;
+            int key;
+            int vel;
+            double tuning;
+            unsigned frames;              // time waited
+            };
+      static const int MAX_DEFERRED_NOTES = 64;
+      DeferredNote _deferred[MAX_DEFERRED_NOTES];
+      int _nDeferred { 0 };
+      QAtomicInt _droppedNotes { 0 };     // deferred notes which were never played, counted on the audio thread
+
+      bool startNote(int chan, int key, int vel, double tuning);
+      void deferNote(int chan, int key, int vel, double tuning);
+      void startDeferredNotes(unsigned frames);
+      int removeDeferredNotes(int chan, int key);
+
    protected:
       int _state;                         // the synthesizer state
 
@@ -342,6 +365,7 @@ class Fluid : public Synthesizer {
 
       virtual void allSoundsOff(int);
       virtual void allNotesOff(int);
+      virtual void clear();
 
       Preset* get_preset(unsigned int sfontnum, unsigned int banknum, unsigned int prognum);
       Preset* find_preset(unsigned int banknum, unsigned int prognum);
@@ -399,6 +423,10 @@ class Fluid : public Synthesizer {
       virtual double masterTuning() const     { return _masterTuning; }
       virtual void setMasterTuning(double f)  { _masterTuning = f;    }
 
+      bool backgroundLoading() const          { return _backgroundLoading; }
+      int droppedNotes() const                { return _droppedNotes.load(); }
+      void setBackgroundLoading(bool val)     { _backgroundLoading = val;  }
+
       QString error() const { return _error; }
 
       virtual SynthesizerGui* gui();
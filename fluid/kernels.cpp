@@ -0,0 +1,492 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2017 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <atomic>
+
+#include "kernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define FLUID_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__)
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_SSE2
+#define TARGET_AVX2
+#endif
+
+namespace FluidS {
+
+//---------------------------------------------------------
+//   index / row
+//    integer sample position and interpolation table
+//    row of a fixed point phase
+//---------------------------------------------------------
+
+static inline int index(qint64 phase)
+      {
+      return int(phase >> 32);
+      }
+
+static inline int row(qint64 phase)
+      {
+      return int(quint32(phase) >> 24);
+      }
+
+//---------------------------------------------------------
+//   interpolateLinearScalar
+//---------------------------------------------------------
+
+static void interpolateLinearScalar(float* buf, const short* data, qint64 phase, qint64 incr,
+   unsigned count, float amp, float ampIncr, const float (*coeff)[2])
+      {
+      for (unsigned i = 0; i < count; ++i, phase += incr) {
+            const short* d = data + index(phase);
+            const float* c = coeff[row(phase)];
+            buf[i] = (amp + i * ampIncr) * (c[0] * d[0] + c[1] * d[1]);
+            }
+      }
+
+//---------------------------------------------------------
+//   interpolate4Scalar
+//---------------------------------------------------------
+
+static void interpolate4Scalar(float* buf, const short* data, qint64 phase, qint64 incr,
+   unsigned count, float amp, float ampIncr, const float (*coeff)[4])
+      {
+      for (unsigned i = 0; i < count; ++i, phase += incr) {
+            const short* d = data + index(phase) - 1;
+            const float* c = coeff[row(phase)];
+            buf[i] = (amp + i * ampIncr) * (c[0] * d[0] + c[1] * d[1] + c[2] * d[2] + c[3] * d[3]);
+            }
+      }
+
+//---------------------------------------------------------
+//   interpolate7Scalar
+//---------------------------------------------------------
+
+static void interpolate7Scalar(float* buf, const short* data, qint64 phase, qint64 incr,
+   unsigned count, float amp, float ampIncr, const float (*coeff)[7])
+      {
+      for (unsigned i = 0; i < count; ++i, phase += incr) {
+            const short* d = data + index(phase) - 3;
+            const float* c = coeff[row(phase)];
+            buf[i] = (amp + i * ampIncr) * (c[0] * d[0] + c[1] * d[1] + c[2] * d[2] + c[3] * d[3]
+               + c[4] * d[4] + c[5] * d[5] + c[6] * d[6]);
+            }
+      }
+
+//---------------------------------------------------------
+//   mixScalar
+//---------------------------------------------------------
+
+static void mixScalar(const float* buf, unsigned count, float left, float right,
+   float reverbLevel, float chorusLevel, float* out, float* reverb, float* chorus)
+      {
+      for (unsigned i = 0; i < count; ++i) {
+            float v    = buf[i];
+
+            float vv   = v  * left;
+            *out++    += vv;
+            *reverb++ += vv * reverbLevel;
+            *chorus++ += vv * chorusLevel;
+
+            vv         = v  * right;
+            *out++    += vv;
+            *reverb++ += vv * reverbLevel;
+            *chorus++ += vv * chorusLevel;
+            }
+      }
+
+#ifdef FLUID_X86
+
+//---------------------------------------------------------
+//   ampRamp
+//    amplitudes of the samples i..i+3
+//---------------------------------------------------------
+
+TARGET_SSE2 static inline __m128 ampRamp(float amp, float ampIncr, unsigned i)
+      {
+      __m128 steps = _mm_add_ps(_mm_set1_ps(float(i)), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f));
+      return _mm_add_ps(_mm_set1_ps(amp), _mm_mul_ps(steps, _mm_set1_ps(ampIncr)));
+      }
+
+//---------------------------------------------------------
+//   load4
+//    four samples converted to float
+//---------------------------------------------------------
+
+TARGET_SSE2 static inline __m128 load4(const short* p)
+      {
+      __m128i d = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+      return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(d, d), 16));
+      }
+
+//---------------------------------------------------------
+//   sum4
+//    horizontal sums of four vectors
+//---------------------------------------------------------
+
+TARGET_SSE2 static inline __m128 sum4(__m128 s0, __m128 s1, __m128 s2, __m128 s3)
+      {
+      _MM_TRANSPOSE4_PS(s0, s1, s2, s3);
+      return _mm_add_ps(_mm_add_ps(s0, s1), _mm_add_ps(s2, s3));
+      }
+
+//---------------------------------------------------------
+//   interpolateLinearSSE2
+//---------------------------------------------------------
+
+TARGET_SSE2 static void interpolateLinearSSE2(float* buf, const short* data, qint64 phase, qint64 incr,
+   unsigned count, float amp, float ampIncr, const float (*coeff)[2])
+      {
+      unsigned i = 0;
+      for (; i + 4 <= count; i += 4) {
+            float c0[4], c1[4], d0[4], d1[4];
+            for (int k = 0; k < 4; ++k, phase += incr) {
+                  const short* d = data + index(phase);
+                  const float* c = coeff[row(phase)];
+                  c0[k] = c[0];
+                  c1[k] = c[1];
+                  d0[k] = d[0];
+                  d1[k] = d[1];
+                  }
+            __m128 v = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(c0), _mm_loadu_ps(d0)),
+                                  _mm_mul_ps(_mm_loadu_ps(c1), _mm_loadu_ps(d1)));
+            _mm_storeu_ps(buf + i, _mm_mul_ps(v, ampRamp(amp, ampIncr, i)));
+            }
+      if (i < count)
+            interpolateLinearScalar(buf + i, data, phase, incr, count - i, amp + i * ampIncr, ampIncr, coeff);
+      }
+
+//---------------------------------------------------------
+//   interpolate4SSE2
+//---------------------------------------------------------
+
+TARGET_SSE2 static void interpolate4SSE2(float* buf, const short* data, qint64 phase, qint64 incr,
+   unsigned count, float amp, float ampIncr, const float (*coeff)[4])
+      {
+      unsigned i = 0;
+      for (; i + 4 <= count; i += 4) {
+            __m128 s[4];
+            for (int k = 0; k < 4; ++k, phase += incr)
+                  s[k] = _mm_mul_ps(_mm_loadu_ps(coeff[row(phase)]), load4(data + index(phase) - 1));
+            _mm_storeu_ps(buf + i, _mm_mul_ps(sum4(s[0], s[1], s[2], s[3]), ampRamp(amp, ampIncr, i)));
+            }
+      if (i < count)
+            interpolate4Scalar(buf + i, data, phase, incr, count - i, amp + i * ampIncr, ampIncr, coeff);
+      }
+
+//---------------------------------------------------------
+//   interpolate7SSE2
+//    the upper three points are loaded from idx..idx+3 and
+//    shifted down, so that no point after idx+3 is read
+//---------------------------------------------------------
+
+TARGET_SSE2 static void interpolate7SSE2(float* buf, const short* data, qint64 phase, qint64 incr,
+   unsigned count, float amp, float ampIncr, const float (*coeff)[7])
+      {
+      unsigned i = 0;
+      for (; i + 4 <= count; i += 4) {
+            __m128 s[4];
+            for (int k = 0; k < 4; ++k, phase += incr) {
+                  const short* d = data + index(phase);
+                  const float* c = coeff[row(phase)];
+                  __m128i hi  = _mm_srli_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(d)), 16);
+                  __m128 dhi  = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16));
+                  __m128 chi  = _mm_castsi128_ps(_mm_srli_si128(_mm_castps_si128(_mm_loadu_ps(c + 3)), 4));
+                  s[k] = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(c), load4(d - 3)), _mm_mul_ps(chi, dhi));
+                  }
+            _mm_storeu_ps(buf + i, _mm_mul_ps(sum4(s[0], s[1], s[2], s[3]), ampRamp(amp, ampIncr, i)));
+            }
+      if (i < count)
+            interpolate7Scalar(buf + i, data, phase, incr, count - i, amp + i * ampIncr, ampIncr, coeff);
+      }
+
+//---------------------------------------------------------
+//   mixSSE2
+//---------------------------------------------------------
+
+TARGET_SSE2 static void mixSSE2(const float* buf, unsigned count, float left, float right,
+   float reverbLevel, float chorusLevel, float* out, float* reverb, float* chorus)
+      {
+      const __m128 gain = _mm_setr_ps(left, right, left, right);
+      const __m128 rl   = _mm_set1_ps(reverbLevel);
+      const __m128 cl   = _mm_set1_ps(chorusLevel);
+      unsigned i = 0;
+      for (; i + 4 <= count; i += 4) {
+            __m128 v  = _mm_loadu_ps(buf + i);
+            __m128 v0 = _mm_mul_ps(_mm_unpacklo_ps(v, v), gain);
+            __m128 v1 = _mm_mul_ps(_mm_unpackhi_ps(v, v), gain);
+            float* o  = out + i * 2;
+            float* r  = reverb + i * 2;
+            float* c  = chorus + i * 2;
+            _mm_storeu_ps(o,     _mm_add_ps(_mm_loadu_ps(o),     v0));
+            _mm_storeu_ps(o + 4, _mm_add_ps(_mm_loadu_ps(o + 4), v1));
+            _mm_storeu_ps(r,     _mm_add_ps(_mm_loadu_ps(r),     _mm_mul_ps(v0, rl)));
+            _mm_storeu_ps(r + 4, _mm_add_ps(_mm_loadu_ps(r + 4), _mm_mul_ps(v1, rl)));
+            _mm_storeu_ps(c,     _mm_add_ps(_mm_loadu_ps(c),     _mm_mul_ps(v0, cl)));
+            _mm_storeu_ps(c + 4, _mm_add_ps(_mm_loadu_ps(c + 4), _mm_mul_ps(v1, cl)));
+            }
+      if (i < count)
+            mixScalar(buf + i, count - i, left, right, reverbLevel, chorusLevel, out + i * 2, reverb + i * 2, chorus + i * 2);
+      }
+
+//---------------------------------------------------------
+//   AVX2 helpers
+//    Each 256 bit register holds the terms of two output
+//    samples, i in the low and i + 4 in the high lane, so
+//    that the in-lane transpose of four registers yields
+//    the sums of eight consecutive samples.
+//---------------------------------------------------------
+
+TARGET_AVX2 static inline __m256 load4x2(const short* a, const short* b)
+      {
+      __m128i d = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(a)),
+                                     _mm_loadl_epi64(reinterpret_cast<const __m128i*>(b)));
+      return _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(d));
+      }
+
+TARGET_AVX2 static inline __m256 loadu2(const float* a, const float* b)
+      {
+      return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(a)), _mm_loadu_ps(b), 1);
+      }
+
+TARGET_AVX2 static inline __m256 sum8(__m256 s0, __m256 s1, __m256 s2, __m256 s3)
+      {
+      __m256 t0 = _mm256_unpacklo_ps(s0, s1);
+      __m256 t1 = _mm256_unpackhi_ps(s0, s1);
+      __m256 t2 = _mm256_unpacklo_ps(s2, s3);
+      __m256 t3 = _mm256_unpackhi_ps(s2, s3);
+      __m256 u0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+      __m256 u1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+      __m256 u2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+      __m256 u3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+      return _mm256_add_ps(_mm256_add_ps(u0, u1), _mm256_add_ps(u2, u3));
+      }
+
+TARGET_AVX2 static inline __m256 ampRamp8(float amp, float ampIncr, unsigned i)
+      {
+      const __m256 steps = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+      __m256 n = _mm256_add_ps(_mm256_set1_ps(float(i)), steps);
+      return _mm256_add_ps(_mm256_set1_ps(amp), _mm256_mul_ps(n, _mm256_set1_ps(ampIncr)));
+      }
+
+//---------------------------------------------------------
+//   interpolate4AVX2
+//---------------------------------------------------------
+
+TARGET_AVX2 static void interpolate4AVX2(float* buf, const short* data, qint64 phase, qint64 incr,
+   unsigned count, float amp, float ampIncr, const float (*coeff)[4])
+      {
+      unsigned i = 0;
+      for (; i + 8 <= count; i += 8) {
+            __m256 s[4];
+            qint64 p2 = phase + 4 * incr;
+            for (int k = 0; k < 4; ++k, phase += incr, p2 += incr) {
+                  s[k] = _mm256_mul_ps(loadu2(coeff[row(phase)], coeff[row(p2)]),
+                                       load4x2(data + index(phase) - 1, data + index(p2) - 1));
+                  }
+            phase = p2;
+            _mm256_storeu_ps(buf + i, _mm256_mul_ps(sum8(s[0], s[1], s[2], s[3]), ampRamp8(amp, ampIncr, i)));
+            }
+      if (i < count)
+            interpolate4SSE2(buf + i, data, phase, incr, count - i, amp + i * ampIncr, ampIncr, coeff);
+      }
+
+//---------------------------------------------------------
+//   interpolate7AVX2
+//    points idx+1..idx+3 are loaded from idx and shifted
+//    down, so that no point after idx+3 is read
+//---------------------------------------------------------
+
+TARGET_AVX2 static void interpolate7AVX2(float* buf, const short* data, qint64 phase, qint64 incr,
+   unsigned count, float amp, float ampIncr, const float (*coeff)[7])
+      {
+      unsigned i = 0;
+      for (; i + 8 <= count; i += 8) {
+            __m256 s[4];
+            qint64 p2 = phase + 4 * incr;
+            for (int k = 0; k < 4; ++k, phase += incr, p2 += incr) {
+                  const short* d1 = data + index(phase);
+                  const short* d2 = data + index(p2);
+                  const float* c1 = coeff[row(phase)];
+                  const float* c2 = coeff[row(p2)];
+                  __m256 hi  = _mm256_castsi256_ps(_mm256_srli_si256(_mm256_castps_si256(loadu2(c1 + 3, c2 + 3)), 4));
+                  __m256 dh  = _mm256_castsi256_ps(_mm256_srli_si256(_mm256_castps_si256(load4x2(d1, d2)), 4));
+                  s[k] = _mm256_add_ps(_mm256_mul_ps(loadu2(c1, c2), load4x2(d1 - 3, d2 - 3)), _mm256_mul_ps(hi, dh));
+                  }
+            phase = p2;
+            _mm256_storeu_ps(buf + i, _mm256_mul_ps(sum8(s[0], s[1], s[2], s[3]), ampRamp8(amp, ampIncr, i)));
+            }
+      if (i < count)
+            interpolate7SSE2(buf + i, data, phase, incr, count - i, amp + i * ampIncr, ampIncr, coeff);
+      }
+
+//---------------------------------------------------------
+//   mixAVX2
+//---------------------------------------------------------
+
+TARGET_AVX2 static void mixAVX2(const float* buf, unsigned count, float left, float right,
+   float reverbLevel, float chorusLevel, float* out, float* reverb, float* chorus)
+      {
+      const __m256 gain = _mm256_setr_ps(left, right, left, right, left, right, left, right);
+      const __m256 rl   = _mm256_set1_ps(reverbLevel);
+      const __m256 cl   = _mm256_set1_ps(chorusLevel);
+      unsigned i = 0;
+      for (; i + 8 <= count; i += 8) {
+            __m256 v  = _mm256_loadu_ps(buf + i);
+            __m256 lo = _mm256_unpacklo_ps(v, v);           // 0 0 1 1 | 4 4 5 5
+            __m256 hi = _mm256_unpackhi_ps(v, v);           // 2 2 3 3 | 6 6 7 7
+            __m256 v0 = _mm256_mul_ps(_mm256_permute2f128_ps(lo, hi, 0x20), gain);
+            __m256 v1 = _mm256_mul_ps(_mm256_permute2f128_ps(lo, hi, 0x31), gain);
+            float* o  = out + i * 2;
+            float* r  = reverb + i * 2;
+            float* c  = chorus + i * 2;
+            _mm256_storeu_ps(o,     _mm256_add_ps(_mm256_loadu_ps(o),     v0));
+            _mm256_storeu_ps(o + 8, _mm256_add_ps(_mm256_loadu_ps(o + 8), v1));
+            _mm256_storeu_ps(r,     _mm256_add_ps(_mm256_loadu_ps(r),     _mm256_mul_ps(v0, rl)));
+            _mm256_storeu_ps(r + 8, _mm256_add_ps(_mm256_loadu_ps(r + 8), _mm256_mul_ps(v1, rl)));
+            _mm256_storeu_ps(c,     _mm256_add_ps(_mm256_loadu_ps(c),     _mm256_mul_ps(v0, cl)));
+            _mm256_storeu_ps(c + 8, _mm256_add_ps(_mm256_loadu_ps(c + 8), _mm256_mul_ps(v1, cl)));
+            }
+      if (i < count)
+            mixSSE2(buf + i, count - i, left, right, reverbLevel, chorusLevel, out + i * 2, reverb + i * 2, chorus + i * 2);
+      }
+
+//---------------------------------------------------------
+//   cpuHasAVX2
+//---------------------------------------------------------
+
+static bool cpuHasAVX2()
+      {
+#if defined(_MSC_VER)
+      int info[4];
+      __cpuid(info, 0);
+      if (info[0] < 7)
+            return false;
+      __cpuid(info, 1);
+      bool osxsave = info[2] & (1 << 27);
+      bool avx     = info[2] & (1 << 28);
+      if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+            return false;
+      __cpuidex(info, 7, 0);
+      return info[1] & (1 << 5);
+#elif defined(__GNUC__)
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2");
+#else
+      return false;
+#endif
+      }
+
+//---------------------------------------------------------
+//   cpuHasSSE2
+//---------------------------------------------------------
+
+static bool cpuHasSSE2()
+      {
+#if defined(__x86_64__) || defined(_M_X64)
+      return true;
+#elif defined(_MSC_VER)
+      int info[4];
+      __cpuid(info, 1);
+      return info[3] & (1 << 26);
+#elif defined(__GNUC__)
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("sse2");
+#else
+      return false;
+#endif
+      }
+
+#endif // FLUID_X86
+
+static const DspKernels noneKernels {
+      0, 0, 0, mixScalar, DspKernels::Level::NONE
+      };
+static const DspKernels scalarKernels {
+      interpolateLinearScalar, interpolate4Scalar, interpolate7Scalar, mixScalar, DspKernels::Level::SCALAR
+      };
+#ifdef FLUID_X86
+static const DspKernels sse2Kernels {
+      interpolateLinearSSE2, interpolate4SSE2, interpolate7SSE2, mixSSE2, DspKernels::Level::SSE2
+      };
+static const DspKernels avx2Kernels {
+      interpolateLinearSSE2, interpolate4AVX2, interpolate7AVX2, mixAVX2, DspKernels::Level::AVX2
+      };
+#endif
+
+static std::atomic<const DspKernels*> kernels { 0 };
+
+//---------------------------------------------------------
+//   maxLevel
+//    best implementation supported by the cpu
+//---------------------------------------------------------
+
+DspKernels::Level DspKernels::maxLevel()
+      {
+#ifdef FLUID_X86
+      static const Level level = cpuHasAVX2() ? Level::AVX2 : (cpuHasSSE2() ? Level::SSE2 : Level::SCALAR);
+      return level;
+#else
+      return Level::SCALAR;
+#endif
+      }
+
+//---------------------------------------------------------
+//   setLevel
+//    select an implementation, limited to what the cpu
+//    supports; used by tests and benchmarks
+//---------------------------------------------------------
+
+void DspKernels::setLevel(Level l)
+      {
+      if (int(l) > int(maxLevel()))
+            l = maxLevel();
+      switch (l) {
+#ifdef FLUID_X86
+            case Level::AVX2:
+                  kernels = &avx2Kernels;
+                  break;
+            case Level::SSE2:
+                  kernels = &sse2Kernels;
+                  break;
+#endif
+            case Level::NONE:
+                  kernels = &noneKernels;
+                  break;
+            default:
+                  kernels = &scalarKernels;
+                  break;
+            }
+      }
+
+//---------------------------------------------------------
+//   instance
+//---------------------------------------------------------
+
+const DspKernels* DspKernels::instance()
+      {
+      if (!kernels)
+            setLevel(maxLevel());
+      return kernels;
+      }
+
+}     // namespace FluidS
+
@@ -0,0 +1,55 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2017 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __FLUID_KERNELS_H__
+#define __FLUID_KERNELS_H__
+
+namespace FluidS {
+
+//---------------------------------------------------------
+//   DspKernels
+//    Block versions of the inner voice loops. An
+//    interpolation kernel renders count samples starting
+//    at the fixed point (32.32) position phase, advancing
+//    by incr per sample, scaled by a linear amplitude ramp
+//    starting at amp. The caller makes sure that all
+//    sample points touched are inside the sample.
+//    The mix kernel adds a mono voice buffer to the
+//    interleaved stereo dry, reverb and chorus buses.
+//
+//    The implementation is selected at runtime from the
+//    instruction sets of the cpu. Level NONE has no
+//    interpolation kernels, the voice renders sample by
+//    sample as without kernels.
+//---------------------------------------------------------
+
+struct DspKernels {
+      enum class Level : char { NONE, SCALAR, SSE2, AVX2 };
+
+      void (*interpolateLinear)(float* buf, const short* data, qint64 phase, qint64 incr,
+         unsigned count, float amp, float ampIncr, const float (*coeff)[2]);
+      void (*interpolate4)(float* buf, const short* data, qint64 phase, qint64 incr,
+         unsigned count, float amp, float ampIncr, const float (*coeff)[4]);
+      void (*interpolate7)(float* buf, const short* data, qint64 phase, qint64 incr,
+         unsigned count, float amp, float ampIncr, const float (*coeff)[7]);
+      void (*mix)(const float* buf, unsigned count, float left, float right,
+         float reverbLevel, float chorusLevel, float* out, float* reverb, float* chorus);
+      Level level;
+
+      static const DspKernels* instance();
+      static Level maxLevel();
+      static void setLevel(Level);
+      };
+
+}     // namespace FluidS
+#endif
+
@@ -21,6 +21,8 @@
  * 02111-1307, USA
  */
 
+#include <algorithm>
+
 #include "sfont.h"
 #include "fluid.h"
 #include "voice.h"
@@ -53,6 +55,8 @@ SFont::SFont(Fluid* f)
       samplepos   = 0;
       samplesize  = 0;
       _bankOffset = 0;
+      _sampleMap  = 0;
+      _mapFailed  = false;
       }
 
 SFont::~SFont()
@@ -88,7 +92,9 @@ bool SFont::read(const QString& s)
       foreach(Preset* p, presets) {
             if (!p->importSfont())
                   return false;
+            p->collectSamples();
             }
+      SampleCache::instance();      // start the loader outside of the audio thread
       return true;
       }
 
@@ -129,31 +135,86 @@ Preset::~Preset()
             delete z;
       }
 
+//---------------------------------------------------------
+//   instrumentSamples
+//---------------------------------------------------------
+
+static void instrumentSamples(Instrument* i, QList<Sample*>* sl)
+      {
+      if (i->global_zone && i->global_zone->sample)
+            sl->append(i->global_zone->sample);
+      foreach(Zone* iz, i->zones)
+            sl->append(iz->sample);
+      }
+
+//---------------------------------------------------------
+//   collectSamples
+//    called once after import, so that loadSamples() and
+//    releaseSamples() do not build the list on the audio
+//    thread
+//---------------------------------------------------------
+
+void Preset::collectSamples()
+      {
+      _samples.clear();
+      if (_global_zone && _global_zone->instrument)
+            instrumentSamples(_global_zone->instrument, &_samples);
+      foreach(Zone* z, zones)
+            instrumentSamples(z->instrument, &_samples);
+      }
+
 //---------------------------------------------------------
 //   loadSamples
 //    this is called if the preset is associated with a
-//    channel
+//    channel; the samples stay loaded until the preset
+//    is released by releaseSamples().
+//    If background is set, the samples are loaded by the
+//    loader thread of the SampleCache and notes using them
+//    are deferred until they are ready, see samplesReady().
 //---------------------------------------------------------
 
-void Preset::loadSamples()
+void Preset::loadSamples(bool background)
       {
-//      sfont->synth->mutex.lock();
-      if (_global_zone && _global_zone->instrument) {
-            Instrument* i = _global_zone->instrument;
-            if (i->global_zone && i->global_zone->sample)
-                  i->global_zone->sample->load();
-            foreach(Zone* iz, i->zones)
-                  iz->sample->load();
-            }
+      foreach(Sample* s, _samples)
+            s->acquire(background);
+      }
+
+//---------------------------------------------------------
+//   releaseSamples
+//    the preset is no longer used by a channel
+//---------------------------------------------------------
+
+void Preset::releaseSamples()
+      {
+      foreach(Sample* s, _samples)
+            s->release();
+      }
+
+//---------------------------------------------------------
+//   samplesReady
+//    true if all samples that a note on with key and vel
+//    would play can be played; samples which are not ready
+//    are requested from the loader.
+//    Called from the audio thread.
+//---------------------------------------------------------
 
-      foreach(Zone* z, zones) {
-            Instrument* i = z->instrument;
-            if (i->global_zone && i->global_zone->sample)
-                  i->global_zone->sample->load();
-            foreach(Zone* iz, i->zones)
-                  iz->sample->load();
+bool Preset::samplesReady(int key, int vel)
+      {
+      bool ready = true;
+      foreach (Zone* preset_zone, zones) {
+            if (!preset_zone->inside_range(key, vel))
+                  continue;
+            foreach (Zone* inst_zone, preset_zone->get_inst()->get_zone()) {
+                  Sample* sample = inst_zone->get_sample();
+                  if (sample == 0 || !sample->valid() || sample->inRom() || sample->ready())
+                        continue;
+                  if (inst_zone->inside_range(key, vel)) {
+                        SampleCache::instance()->request(sample);
+                        ready = false;
+                        }
+                  }
             }
-//      sfont->synth->mutex.unlock();
+      return ready;
       }
 
 //---------------------------------------------------------
@@ -180,7 +241,7 @@ bool Preset::noteon(Fluid* synth, unsigned id, int chan, int key, int vel, doubl
                   foreach(Zone* inst_zone, inst->get_zone()) {
                         /* make sure this instrument zone has a valid sample */
                         Sample* sample = inst_zone->get_sample();
-                        if (sample == 0 || sample->inRom())
+                        if (sample == 0 || sample->inRom() || !sample->ready())
                               continue;
                         /* check if the note falls into the key and velocity range of this
                            instrument */
@@ -574,9 +635,16 @@ bool Zone::importZone()
 //---------------------------------------------------------
 
 Sample::Sample(SFont* s)
+   : _queued(false), _ready(false), _users(0), _voices(0), _lastUse(0)
       {
       sf          = s;
       _valid      = false;
+      _mapped     = false;
+      _pending    = false;
+      _nextRequest = 0;
+      _oggStart   = 0;
+      _oggSize    = 0;
+      _index      = -1;
       start       = 0;
       end         = 0;
       loopstart   = 0;
@@ -596,48 +664,84 @@ Sample::Sample(SFont* s)
 
 Sample::~Sample()
       {
-      delete[] data;
+      SampleCache::instance()->remove(this);
+      if (!_mapped)
+            delete[] data;
+      }
+
+//---------------------------------------------------------
+//   acquire
+//    the sample is used by a channel preset; with
+//    background set the call does not block and can be
+//    made from the audio thread
+//---------------------------------------------------------
+
+void Sample::acquire(bool background)
+      {
+      ++_users;
+      SampleCache* cache = SampleCache::instance();
+      if (ready())
+            cache->touch(this);
+      else if (_valid) {
+            if (background)
+                  cache->request(this);
+            else
+                  cache->load(this);
+            }
+      }
+
+//---------------------------------------------------------
+//   release
+//---------------------------------------------------------
+
+void Sample::release()
+      {
+      SampleCache::instance()->touch(this);
+      --_users;
+      }
+
+//---------------------------------------------------------
+//   removeVoice
+//---------------------------------------------------------
+
+void Sample::removeVoice()
+      {
+      SampleCache::instance()->touch(this);
+      --_voices;
       }
 
 //---------------------------------------------------------
 //   load
+//    make uncompressed sample data available; on little
+//    endian hosts the data is used in place from the memory
+//    mapped sample chunk of the soundfont.
+//    Called without the cache mutex held while the sample
+//    is pending.
 //---------------------------------------------------------
 
 void Sample::load()
       {
-      if (!_valid || data)
-            return;
-      QFile fd(sf->get_name());
-      if (!fd.open(QIODevice::ReadOnly))
-            return;
-      if (sampletype & FLUID_SAMPLETYPE_OGG_VORBIS) {
-            if (!fd.seek(sf->samplePos() + start))
-                  return;
-            }
-      else {
-            if (!fd.seek(sf->samplePos() + start * sizeof(short)))
-                  return;
-            }
       unsigned int size = end - start;
+      const uchar* map  = QSysInfo::ByteOrder == QSysInfo::LittleEndian ? sf->mappedSamples() : 0;
 
-      if (sampletype & FLUID_SAMPLETYPE_OGG_VORBIS) {
-#ifdef SOUNDFONT3
-            char* p = new char[size];
-            if (fd.read(p, size) != size) {
-                  printf("  read %d failed\n", size);
-                  delete[] p;
-                  return;
-                  }
-            decompressOggVorbis(p, size);
-            delete[] p;
-#endif
+      if (map && (start + size) * sizeof(short) <= sf->getSamplesize()) {
+            data    = (short*)(map + start * sizeof(short));
+            _mapped = true;
             }
       else {
+            QFile fd(sf->get_name());
+            if (!fd.open(QIODevice::ReadOnly))
+                  return;
+            if (!fd.seek(sf->samplePos() + start * sizeof(short)))
+                  return;
             data = new short[size];
             size *= sizeof(short);
 
-            if (fd.read((char*)data, size) != size)
+            if (fd.read((char*)data, size) != size) {
+                  delete[] data;
+                  data = 0;
                   return;
+                  }
 
             if (QSysInfo::ByteOrder == QSysInfo::BigEndian) {
                   unsigned char hi, lo;
@@ -651,14 +755,361 @@ void Sample::load()
                         data[i] = s;
                         }
                   }
-            end       -= (start + 1);       // marks last sample, contrary to SF spec.
-            loopstart -= start;
-            loopend   -= start;
-            start      = 0;
             }
+      end       -= (start + 1);       // marks last sample, contrary to SF spec.
+      loopstart -= start;
+      loopend   -= start;
+      start      = 0;
       optimize();
       }
 
+//---------------------------------------------------------
+//   decode
+//    decompress the sample data; called without the cache
+//    mutex held while the sample is pending
+//---------------------------------------------------------
+
+void Sample::decode()
+      {
+#ifdef SOUNDFONT3
+      if (_oggSize == 0) {
+            // start and end are replaced by the decoded positions
+            _oggStart = start;
+            _oggSize  = end - start;
+            }
+      SampleDiskCache* cache = SampleDiskCache::instance();
+      if (cache->read(this)) {
+            optimize();
+            return;
+            }
+      QFile fd(sf->get_name());
+      if (!fd.open(QIODevice::ReadOnly) || !fd.seek(sf->samplePos() + _oggStart))
+            return;
+      char* p = new char[_oggSize];
+      if (fd.read(p, _oggSize) != _oggSize) {
+            qDebug("Sample::decode: read %d failed", _oggSize);
+            delete[] p;
+            return;
+            }
+      decompressOggVorbis(p, _oggSize);
+      delete[] p;
+      if (data) {
+            optimize();
+            cache->write(this);
+            }
+#endif
+      }
+
+//---------------------------------------------------------
+//   SampleLoader
+//    loads the samples requested from the audio thread
+//---------------------------------------------------------
+
+class SampleLoader : public QThread {
+      SampleCache* _cache;
+
+   public:
+      SampleLoader(SampleCache* c) : _cache(c) {}
+      virtual void run() override { _cache->loadRequests(); }
+      };
+
+// the audio thread wakes the loader only if it gets the
+// mutex without waiting; otherwise the loader finds the
+// request at its next poll
+static const unsigned long REQUEST_POLL_MS = 10;
+
+//---------------------------------------------------------
+//   SampleCache
+//---------------------------------------------------------
+
+SampleCache::SampleCache()
+   : _requests(0), _clock(0)
+      {
+      _memory = 0;
+      _budget = 256 * 1024 * 1024;
+      _quit   = false;
+      _loader = new SampleLoader(this);
+      _loader->start(QThread::LowPriority);
+      }
+
+SampleCache::~SampleCache()
+      {
+      _mutex.lock();
+      _quit = true;
+      _requested.wakeAll();
+      _mutex.unlock();
+      _loader->wait();
+      delete _loader;
+      }
+
+//---------------------------------------------------------
+//   instance
+//---------------------------------------------------------
+
+SampleCache* SampleCache::instance()
+      {
+      static SampleCache cache;
+      return &cache;
+      }
+
+//---------------------------------------------------------
+//   request
+//    queue s for the loader; never blocks and does not
+//    allocate, so it can be called from the audio thread
+//---------------------------------------------------------
+
+void SampleCache::request(Sample* s)
+      {
+      if (s->_queued.exchange(true))
+            return;
+      Sample* head = _requests.load();
+      do {
+            s->_nextRequest = head;
+            } while (!_requests.compare_exchange_weak(head, s));
+      if (_mutex.tryLock()) {
+            _requested.wakeOne();
+            _mutex.unlock();
+            }
+      }
+
+//---------------------------------------------------------
+//   loadRequests
+//    the loader thread; compressed samples are decoded
+//    in parallel
+//---------------------------------------------------------
+
+void SampleCache::loadRequests()
+      {
+      QMutexLocker locker(&_mutex);
+      while (!_quit) {
+            // the loader is the only consumer, so taking the
+            // whole stack at once is safe from ABA
+            Sample* s = _requests.exchange(0);
+            if (!s) {
+                  _requested.wait(&_mutex, REQUEST_POLL_MS);
+                  continue;
+                  }
+            locker.unlock();
+            QList<Sample*> samples;
+            QList<QFuture<void>> futures;
+            for (; s; s = s->_nextRequest) {
+                  samples.append(s);
+                  if (s->compressed())
+                        futures.append(QtConcurrent::run(this, &SampleCache::load, s));
+                  else
+                        load(s);
+                  }
+            for (QFuture<void>& f : futures)
+                  f.waitForFinished();
+            locker.relock();
+            for (Sample* rs : samples)
+                  rs->_queued = false;
+            _loaded.wakeAll();
+            }
+      }
+
+//---------------------------------------------------------
+//   load
+//    make the data of s available; blocks until it is
+//    loaded or decoded
+//---------------------------------------------------------
+
+void SampleCache::load(Sample* s)
+      {
+      QMutexLocker locker(&_mutex);
+      while (s->_pending)
+            _loaded.wait(&_mutex);
+      if (s->ready()) {
+            touch(s);
+            return;
+            }
+      if (!s->valid())
+            return;
+      s->_pending = true;
+      locker.unlock();
+      if (s->compressed())
+            s->decode();
+      else
+            s->load();
+      locker.relock();
+      s->_pending = false;
+      if (s->data)
+            add(s);
+      _loaded.wakeAll();
+      }
+
+//---------------------------------------------------------
+//   insert
+//    account for a sample whose data has been decoded
+//    elsewhere
+//---------------------------------------------------------
+
+void SampleCache::insert(Sample* s)
+      {
+      QMutexLocker locker(&_mutex);
+      add(s);
+      }
+
+//---------------------------------------------------------
+//   add
+//    called with the mutex held
+//---------------------------------------------------------
+
+void SampleCache::add(Sample* s)
+      {
+      touch(s);
+      s->_ready = true;
+      if (s->compressed()) {
+            _resident.append(s);
+            _memory += s->memory();
+            shrink();
+            }
+      }
+
+//---------------------------------------------------------
+//   shrink
+//    release unused samples, least recently used first,
+//    until the cache fits into the budget; called with the
+//    mutex held.
+//    The audio thread pins a sample before it checks
+//    ready(), the cache clears ready before it checks the
+//    pins, so one of them sees the other.
+//---------------------------------------------------------
+
+void SampleCache::shrink()
+      {
+      if (_memory <= _budget)
+            return;
+      QList<Sample*> lru;
+      for (Sample* s : _resident) {
+            if (!s->inUse())
+                  lru.append(s);
+            }
+      std::sort(lru.begin(), lru.end(), [](const Sample* a, const Sample* b) {
+            return a->_lastUse < b->_lastUse;
+            });
+      for (Sample* s : lru) {
+            if (_memory <= _budget)
+                  break;
+            s->_ready = false;
+            if (s->inUse()) {
+                  s->_ready = true;
+                  continue;
+                  }
+            _memory -= s->memory();
+            delete[] s->data;
+            s->data = 0;
+            _resident.removeOne(s);
+            }
+      }
+
+//---------------------------------------------------------
+//   remove
+//    called when a sample is deleted
+//---------------------------------------------------------
+
+void SampleCache::remove(Sample* s)
+      {
+      QMutexLocker locker(&_mutex);
+      while (s->_pending || s->_queued)
+            _loaded.wait(&_mutex);
+      if (_resident.removeOne(s))
+            _memory -= s->memory();
+      }
+
+//---------------------------------------------------------
+//   memory
+//---------------------------------------------------------
+
+qint64 SampleCache::memory()
+      {
+      QMutexLocker locker(&_mutex);
+      return _memory;
+      }
+
+//---------------------------------------------------------
+//   budget
+//---------------------------------------------------------
+
+qint64 SampleCache::budget()
+      {
+      QMutexLocker locker(&_mutex);
+      return _budget;
+      }
+
+//---------------------------------------------------------
+//   setBudget
+//---------------------------------------------------------
+
+void SampleCache::setBudget(qint64 bytes)
+      {
+      QMutexLocker locker(&_mutex);
+      _budget = bytes;
+      shrink();
+      }
+
+//---------------------------------------------------------
+//   fileHash
+//    The content hash of the soundfont file, the key of
+//    the sample disk cache. It is computed once per path
+//    and shared by all soundfonts read from that path as
+//    long as size and modification time of the file stay
+//    the same. Empty if the file cannot be read.
+//---------------------------------------------------------
+
+QString SFont::fileHash() const
+      {
+      struct FileHash {
+            qint64 size;
+            QDateTime modified;
+            QString hash;
+            };
+      static QMutex mutex;
+      static QHash<QString, FileHash> hashes;
+
+      QFileInfo fi(f.fileName());
+      QString path = fi.canonicalFilePath();
+      if (path.isEmpty())
+            return QString();
+      QMutexLocker locker(&mutex);
+      auto i = hashes.constFind(path);
+      if (i != hashes.constEnd() && i->size == fi.size() && i->modified == fi.lastModified())
+            return i->hash;
+      QFile fd(path);
+      QCryptographicHash h(QCryptographicHash::Sha1);
+      if (!fd.open(QIODevice::ReadOnly) || !h.addData(&fd))
+            return QString();
+      QString hash = QString::fromLatin1(h.result().toHex());
+      hashes.insert(path, FileHash { fi.size(), fi.lastModified(), hash });
+      return hash;
+      }
+
+//---------------------------------------------------------
+//   mappedSamples
+//    map the sample chunk into memory on first use;
+//    returns 0 if the file cannot be mapped
+//---------------------------------------------------------
+
+const uchar* SFont::mappedSamples()
+      {
+      QMutexLocker locker(&_mapMutex);
+      if (!_sampleMap && !_mapFailed) {
+            _mapFile.setFileName(f.fileName());
+            if (_mapFile.open(QIODevice::ReadOnly))
+                  _sampleMap = _mapFile.map(samplepos, samplesize);
+            if (!_sampleMap || (quintptr(_sampleMap) & 1)) {
+                  // data must be aligned for use as short
+                  if (_sampleMap)
+                        _mapFile.unmap(const_cast<uchar*>(_sampleMap));
+                  _sampleMap = 0;
+                  _mapFailed = true;
+                  _mapFile.close();
+                  qDebug("fluid: cannot map sample data of <%s>", qPrintable(f.fileName()));
+                  }
+            }
+      return _sampleMap;
+      }
+
 //---------------------------------------------------------
 //   inRom
 //---------------------------------------------------------
@@ -1597,6 +2048,7 @@ void SFont::load_shdr (int size)
       /* load all sample headers */
       for (int i = 0; i < size; i++) {
             Sample* p = new Sample(this);
+            p->setIndex(i);
             sample.append(p);
             char buffer[21];
             READSTR (buffer);
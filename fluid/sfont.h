@@ -23,6 +23,8 @@
 #ifndef _FLUID_DEFSFONT_H
 #define _FLUID_DEFSFONT_H
 
+#include <atomic>
+
 #include "config.h"
 #include "fluid.h"
 
@@ -55,6 +57,11 @@ class SFont {
       unsigned samplepos;           // the position in the file at which the sample data starts
       unsigned samplesize;          // the size of the sample data
 
+      QMutex _mapMutex;
+      QFile _mapFile;               // keeps the memory mapped sample chunk
+      const uchar* _sampleMap;
+      bool _mapFailed;
+
       QList<Instrument*> instruments;
       QList<Preset*> presets;
       QList<Sample*> sample;
@@ -115,6 +122,8 @@ class SFont {
       void setSamplepos(unsigned v)             { samplepos = v; }
       void setSamplesize(unsigned v)            { samplesize = v; }
       unsigned getSamplesize() const            { return samplesize; }
+      const uchar* mappedSamples();
+      QString fileHash() const;
       const QList<Preset*> getPresets() const   { return presets; }
       SFVersion version() const                 { return _version; }
       int bankOffset() const                    { return _bankOffset; }
@@ -128,6 +137,20 @@ class SFont {
 
 class Sample {
       bool _valid;
+      bool _mapped;                 // data points into the mapped sample chunk
+      bool _pending;                // being loaded, guarded by the cache mutex
+      std::atomic<bool> _queued;    // in the request stack of the cache
+      Sample* _nextRequest;         // next sample in the request stack
+      std::atomic<bool> _ready;     // data can be played
+      std::atomic<int> _users;      // channel presets using this sample
+      std::atomic<int> _voices;     // active voices playing this sample
+      std::atomic<quint64> _lastUse;      // SampleCache clock at the last use
+      unsigned int _oggStart;       // position and size of the compressed data
+      unsigned int _oggSize;
+      int _index;                   // position in the sample header list
+
+      void load();
+      void decode();
 
    public:
       SFont* sf;
@@ -155,14 +178,110 @@ class Sample {
 
       bool inRom() const;
       void optimize();
-      void load();
       bool valid() const    { return _valid; }
       void setValid(bool v) { _valid = v; }
+      int index() const     { return _index; }
+      void setIndex(int v)  { _index = v;    }
+      bool compressed() const { return sampletype & FLUID_SAMPLETYPE_OGG_VORBIS; }
+      // sequentially consistent, see SampleCache::shrink()
+      bool ready() const    { return _ready; }
+      bool inUse() const    { return _users > 0 || _voices > 0; }
+      size_t memory() const { return data ? (end - start + 1) * sizeof(short) : 0; }
+
+      void acquire(bool background);
+      void release();
+      void addVoice()       { ++_voices; }
+      void removeVoice();
 #ifdef SOUNDFONT3
       bool decompressOggVorbis(char* p, int size);
 #endif
+      friend class SampleCache;
+      };
+
+//---------------------------------------------------------
+//   SampleCache
+//    Loads sample data and keeps the decoded SF3 samples of
+//    all soundfonts. Samples which are neither used by a
+//    channel preset nor played by a voice are released in
+//    least recently used order when the memory budget is
+//    exceeded.
+//    The audio thread never waits for the cache: it pushes
+//    samples which are not ready onto a lock-free request
+//    stack that a loader thread works off.
+//---------------------------------------------------------
+
+class SampleLoader;
+
+class SampleCache {
+      QMutex _mutex;
+      QWaitCondition _loaded;
+      QWaitCondition _requested;
+      std::atomic<Sample*> _requests;     // pushed by the audio thread, taken by the loader
+      std::atomic<quint64> _clock;        // counts sample uses, orders the lru list
+      QList<Sample*> _resident;           // decoded samples counted in _memory
+      qint64 _memory;
+      qint64 _budget;
+      bool _quit;
+      SampleLoader* _loader;
+
+      void add(Sample*);
+      void shrink();
+      void loadRequests();
+
+   public:
+      SampleCache();
+      ~SampleCache();
+      static SampleCache* instance();
+
+      void load(Sample*);
+      void request(Sample*);
+      void touch(Sample* s)         { s->_lastUse = ++_clock; }
+      void insert(Sample*);
+      void remove(Sample*);
+      qint64 memory();
+      qint64 budget();
+      void setBudget(qint64 bytes);
+      friend class SampleLoader;
       };
 
+#ifdef SOUNDFONT3
+//---------------------------------------------------------
+//   SampleDiskCache
+//    Decoded SF3 samples on disk, one directory per
+//    soundfont content hash and one file per sample index.
+//    A file is a PcmHeader followed by the raw 16 bit data
+//    in host byte order. When the size limit is exceeded,
+//    the soundfonts not used for the longest time are
+//    removed; soundfonts used in this session are kept.
+//---------------------------------------------------------
+
+class SampleDiskCache {
+      QMutex _mutex;
+      QString _path;
+      qint64 _limit;
+      qint64 _size;                 // -1: not scanned yet
+      QSet<QString> _active;        // soundfonts used in this session
+      QSet<QString> _writing;       // files being written
+
+      QString fontPath(const QString& hash);
+      void scan();
+      void evict(qint64 needed);
+
+   public:
+      SampleDiskCache();
+      static SampleDiskCache* instance();
+
+      bool read(Sample*);
+      void write(const Sample*);
+
+      qint64 size();
+      QString path();
+      void setPath(const QString&);
+      qint64 limit();
+      void setLimit(qint64 bytes);
+      };
+#endif
+
 //---------------------------------------------------------
 //   Zone
 //---------------------------------------------------------
@@ -222,6 +341,7 @@ class Preset {
 
       Zone* _global_zone;           // the global zone of the preset
       QList<Zone*> zones;
+      QList<Sample*> _samples;      // the samples of all zones, see collectSamples()
 
    public:
       Preset(SFont* sfont);
@@ -234,9 +354,12 @@ class Preset {
 
       void setGlobalZone(Zone* z)               { _global_zone = z;   }
       bool importSfont();
+      void collectSamples();
 
       Zone* global_zone()                       { return _global_zone; }
-      void loadSamples();
+      void loadSamples(bool background);
+      bool samplesReady(int key, int vel);
+      void releaseSamples();
       QList<Zone*> getZones()                   { return zones; }
       };
 
@@ -48,4 +48,266 @@ bool Sample::decompressOggVorbis(char* src, int size)
 
       return true;
       }
+
+//---------------------------------------------------------
+//   PcmHeader
+//    header of a sample file in the disk cache; the data
+//    following it starts 32 byte aligned
+//---------------------------------------------------------
+
+static const char PCM_MAGIC[4]    = { 'M', 'S', 'P', 'C' };
+static const quint32 PCM_VERSION  = 1;      // also detects a foreign byte order
+
+struct PcmHeader {
+      char magic[4];
+      quint32 version;
+      quint32 frames;
+      quint32 loopstart;
+      quint32 loopend;
+      quint32 valid;
+      quint32 reserved[2];
+      };
+
+//---------------------------------------------------------
+//   SampleDiskCache
+//---------------------------------------------------------
+
+SampleDiskCache::SampleDiskCache()
+      {
+      QString path = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+      _path  = path.isEmpty() ? QString("") : path + "/sf3/v1";
+      _limit = qint64(1024) * 1024 * 1024;
+      _size  = -1;
+      }
+
+//---------------------------------------------------------
+//   instance
+//---------------------------------------------------------
+
+SampleDiskCache* SampleDiskCache::instance()
+      {
+      static SampleDiskCache cache;
+      return &cache;
+      }
+
+//---------------------------------------------------------
+//   fontPath
+//    the first use of a soundfont in this session updates
+//    its time stamp; called with the mutex held
+//---------------------------------------------------------
+
+QString SampleDiskCache::fontPath(const QString& hash)
+      {
+      QString dir = _path + "/" + hash;
+      if (!_active.contains(hash)) {
+            _active.insert(hash);
+            QDir().mkpath(dir);
+            QFile stamp(dir + "/used");
+            if (stamp.open(QIODevice::WriteOnly | QIODevice::Truncate))
+                  stamp.write(QDateTime::currentDateTimeUtc().toString(Qt::ISODate).toLatin1());
+            }
+      return dir;
+      }
+
+//---------------------------------------------------------
+//   read
+//    return false if the sample is not in the cache
+//---------------------------------------------------------
+
+bool SampleDiskCache::read(Sample* s)
+      {
+      QString hash = s->sf->fileHash();
+      QString dir;
+      {
+      QMutexLocker locker(&_mutex);
+      if (_path.isEmpty() || hash.isEmpty())
+            return false;
+      dir = fontPath(hash);
+      }
+      QFile f(dir + QString("/%1.pcm").arg(s->index()));
+      if (!f.open(QIODevice::ReadOnly))
+            return false;
+      PcmHeader h;
+      if (f.read((char*)&h, sizeof(h)) != qint64(sizeof(h))
+         || memcmp(h.magic, PCM_MAGIC, sizeof(PCM_MAGIC))
+         || h.version != PCM_VERSION
+         || h.frames < 1
+         || f.size() != qint64(sizeof(h)) + qint64(h.frames) * qint64(sizeof(short))) {
+            qDebug("SampleDiskCache: invalid file <%s>", qPrintable(f.fileName()));
+            return false;
+            }
+      short* data = new short[h.frames];
+      qint64 n    = qint64(h.frames) * qint64(sizeof(short));
+      if (f.read((char*)data, n) != n) {
+            delete[] data;
+            return false;
+            }
+      s->data      = data;
+      s->start     = 0;
+      s->end       = h.frames - 1;
+      s->loopstart = h.loopstart;
+      s->loopend   = h.loopend;
+      s->setValid(h.valid);
+      return true;
+      }
+
+//---------------------------------------------------------
+//   write
+//    A file written again replaces the old one, only the
+//    difference in size counts; a file already being
+//    written by another thread is left to it.
+//---------------------------------------------------------
+
+void SampleDiskCache::write(const Sample* s)
+      {
+      QString hash = s->sf->fileHash();
+      qint64 n     = qint64(s->end + 1) * qint64(sizeof(short));
+      qint64 size  = qint64(sizeof(PcmHeader)) + n;
+      QString path;
+      qint64 added;
+      {
+      QMutexLocker locker(&_mutex);
+      if (_path.isEmpty() || hash.isEmpty() || _limit <= 0)
+            return;
+      path = fontPath(hash) + QString("/%1.pcm").arg(s->index());
+      if (_writing.contains(path))
+            return;
+      scan();
+      QFileInfo old(path);
+      added = size - (old.exists() ? old.size() : 0);
+      if (_size + added > _limit) {
+            evict(added);
+            if (_size + added > _limit)
+                  return;
+            }
+      _size += added;
+      _writing.insert(path);
+      }
+      PcmHeader h;
+      memset(&h, 0, sizeof(h));
+      memcpy(h.magic, PCM_MAGIC, sizeof(PCM_MAGIC));
+      h.version   = PCM_VERSION;
+      h.frames    = s->end + 1;
+      h.loopstart = s->loopstart;
+      h.loopend   = s->loopend;
+      h.valid     = s->valid();
+
+      QSaveFile f(path);
+      bool ok = f.open(QIODevice::WriteOnly)
+         && f.write((const char*)&h, sizeof(h)) == qint64(sizeof(h))
+         && f.write((const char*)s->data, n) == n
+         && f.commit();
+      if (!ok)
+            qDebug("SampleDiskCache: cannot write <%s>", qPrintable(path));
+      QMutexLocker locker(&_mutex);
+      _writing.remove(path);
+      if (!ok)
+            _size -= added;
+      }
+
+//---------------------------------------------------------
+//   scan
+//    sum up the cache size on first use; called with the
+//    mutex held
+//---------------------------------------------------------
+
+void SampleDiskCache::scan()
+      {
+      if (_size >= 0)
+            return;
+      _size = 0;
+      QDirIterator it(_path, QStringList("*.pcm"), QDir::Files, QDirIterator::Subdirectories);
+      while (it.hasNext()) {
+            it.next();
+            _size += it.fileInfo().size();
+            }
+      }
+
+//---------------------------------------------------------
+//   evict
+//    remove the least recently used soundfonts until needed
+//    bytes fit into the limit; called with the mutex held
+//---------------------------------------------------------
+
+void SampleDiskCache::evict(qint64 needed)
+      {
+      QFileInfoList fonts = QDir(_path).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+      std::sort(fonts.begin(), fonts.end(), [](const QFileInfo& a, const QFileInfo& b) {
+            return QFileInfo(a.filePath() + "/used").lastModified() < QFileInfo(b.filePath() + "/used").lastModified();
+            });
+      for (const QFileInfo& fi : fonts) {
+            if (_size + needed <= _limit)
+                  break;
+            if (_active.contains(fi.fileName()))
+                  continue;
+            qint64 size = 0;
+            for (const QFileInfo& pcm : QDir(fi.filePath()).entryInfoList(QStringList("*.pcm"), QDir::Files))
+                  size += pcm.size();
+            if (QDir(fi.filePath()).removeRecursively())
+                  _size -= size;
+            }
+      }
+
+//---------------------------------------------------------
+//   size
+//    bytes of all sample files in the cache
+//---------------------------------------------------------
+
+qint64 SampleDiskCache::size()
+      {
+      QMutexLocker locker(&_mutex);
+      if (_path.isEmpty())
+            return 0;
+      scan();
+      return _size;
+      }
+
+//---------------------------------------------------------
+//   path
+//---------------------------------------------------------
+
+QString SampleDiskCache::path()
+      {
+      QMutexLocker locker(&_mutex);
+      return _path;
+      }
+
+//---------------------------------------------------------
+//   setPath
+//    an empty path disables the cache
+//---------------------------------------------------------
+
+void SampleDiskCache::setPath(const QString& path)
+      {
+      QMutexLocker locker(&_mutex);
+      _path = path;
+      _size = -1;
+      _active.clear();
+      }
+
+//---------------------------------------------------------
+//   limit
+//---------------------------------------------------------
+
+qint64 SampleDiskCache::limit()
+      {
+      QMutexLocker locker(&_mutex);
+      return _limit;
+      }
+
+//---------------------------------------------------------
+//   setLimit
+//    a limit of 0 disables writing to the cache
+//---------------------------------------------------------
+
+void SampleDiskCache::setLimit(qint64 bytes)
+      {
+      QMutexLocker locker(&_mutex);
+      _limit = bytes;
+      if (_path.isEmpty())
+            return;
+      scan();
+      if (_size > _limit)
+            evict(0);
+      }
 } // namespace
@@ -236,6 +236,8 @@ class Voice
 
       static void dsp_float_config();
       bool updateAmpInc(unsigned int &nextNewAmpInc, std::map<int, qreal>::iterator &curSample2AmpInc, qreal &dsp_amp_incr, unsigned int &dsp_i);
+      unsigned blockLength(unsigned dsp_i, unsigned n, Phase dsp_phase, Phase dsp_phase_incr, unsigned end_index,
+         unsigned nextNewAmpInc, qreal dsp_amp_incr) const;
       int dsp_float_interpolate_none(unsigned);
       int dsp_float_interpolate_linear(unsigned);
       int dsp_float_interpolate_4th_order(unsigned);
@@ -469,7 +469,7 @@ void BarLine::draw(QPainter* painter) const
             if (s && s->isEndBarLineType() && m->isIrregular() && score()->markIrregularMeasures() && !m->isMMRest()) {
                   painter->setPen(MScore::layoutBreakColor);
                   QFont f("FreeSerif");
-                  f.setPointSizeF(12 * spatium() * MScore::pixelRatio / SPATIUM20);
+                  f.setPointSizeF(12 * spatium() * MScore::pixelRatio() / SPATIUM20);
                   f.setBold(true);
                   QString str = m->len() > m->timesig() ? "+" : "-";
                   QRectF r = QFontMetricsF(f, MScore::paintDevice()).boundingRect(str);
@@ -192,7 +192,7 @@ void Bend::draw(QPainter* painter) const
       painter->setBrush(QBrush(curColor()));
 
       qreal _spatium = spatium();
-      QFont f = font(_spatium * MScore::pixelRatio);
+      QFont f = font(_spatium * MScore::pixelRatio());
       painter->setFont(f);
 
       int n    = _points.size();
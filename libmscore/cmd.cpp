@@ -153,6 +153,7 @@ void Score::undoRedo(bool undo)
             undoStack()->undo();
       else
             undoStack()->redo();
+      setPlaylistDirty(cmdState().startTick(), cmdState().endTick());
       update();
       updateSelection();
       }
@@ -176,6 +177,10 @@ void Score::endCmd(bool rollback)
       if (rollback)
             undoStack()->current()->unwind();
 
+      // the layout range of the command is also the range of
+      // playback events to render again
+      int playStartTick = cmdState().startTick();
+      int playEndTick   = cmdState().endTick();
       update();
 
       if (MScore::debugMode)
@@ -184,7 +189,7 @@ void Score::endCmd(bool rollback)
       undoStack()->endMacro(noUndo);
 
       if (dirty()) {
-            masterScore()->_playlistDirty = true;  // TODO: flag individual operations
+            setPlaylistDirty(playStartTick, playEndTick);
             masterScore()->_autosaveDirty = true;
             }
       MuseScoreCore::mscoreCore->endCmd();
@@ -215,8 +220,13 @@ void Score::update()
       for (MasterScore* ms : *movements()) {
             CmdState& cs = ms->cmdState();
             if (cs.layoutRange()) {
-                  for (Score* s : ms->scoreList())
-                        s->doLayoutRange(cs.startTick(), cs.endTick());
+                  for (Score* s : ms->scoreList()) {
+                        // part scores without a view are laid out when they are shown or exported
+                        if (s != ms && s->viewer.isEmpty())
+                              s->deferLayoutRange(cs.startTick(), cs.endTick(), cs.layoutFlags);
+                        else
+                              s->doLayoutRange(cs.startTick(), cs.endTick());
+                        }
                   for (Score* s : scoreList()) {
                         for (MuseScoreView* v : s->viewer)
                               v->updateAll();
@@ -198,17 +198,19 @@ void Dynamic::doAutoplace()
       if (!(s && autoplace()))
             return;
 
+      System* system = s->measure()->system();
+      if (!system)
+            return;
       qreal minDistance = score()->styleP(StyleIdx::dynamicsMinDistance);
-      Shape s1          = s->measure()->staffShape(staffIdx());
-      Shape s2          = shape().translated(s->pos() + pos());
+      Shape s2          = shape().translated(s->measure()->pos() + s->pos() + pos());
 
       if (placeAbove()) {
-            qreal d = s2.minVerticalDistance(s1);
+            qreal d = system->topDistance(staffIdx(), s2);
             if (d > -minDistance)
                   rUserYoffset() = -d - minDistance;
             }
       else {
-            qreal d = s1.minVerticalDistance(s2);
+            qreal d = system->bottomDistance(staffIdx(), s2);
             if (d > -minDistance)
                   rUserYoffset() = d + minDistance;
             }
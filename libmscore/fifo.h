@@ -47,6 +47,45 @@ class FifoBase {
       bool isFull() const     { return maxCount == counter; }
       };
 
+//---------------------------------------------------------
+//   SpscQueue
+//    wait-free queue for one producer and one consumer
+//    thread
+//    - enqueue() fails instead of blocking if the queue
+//      is full
+//    - no memory allocation after construction, so both
+//      sides can be used in a realtime thread
+//    - N must be a power of two
+//---------------------------------------------------------
+
+template <class T, unsigned N>
+class SpscQueue {
+      static_assert((N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+
+      T buffer[N];
+      std::atomic<unsigned> head { 0 };   // written by the consumer
+      std::atomic<unsigned> tail { 0 };   // written by the producer
+
+   public:
+      bool enqueue(const T& v) {
+            unsigned t = tail.load(std::memory_order_relaxed);
+            if (t - head.load(std::memory_order_acquire) == N)
+                  return false;
+            buffer[t & (N - 1)] = v;
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+            }
+      bool dequeue(T* v) {
+            unsigned h = head.load(std::memory_order_relaxed);
+            if (h == tail.load(std::memory_order_acquire))
+                  return false;
+            *v = buffer[h & (N - 1)];
+            head.store(h + 1, std::memory_order_release);
+            return true;
+            }
+      int count() const  { return int(tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire)); }
+      bool empty() const { return count() == 0; }
+      };
 
 }     // namespace Ms
 #endif
@@ -288,7 +288,7 @@ void FretDiagram::draw(QPainter* painter) const
       QFont scaledFont(font);
       scaledFont.setPointSizeF(font.pointSize() * _userMag);
       QFontMetricsF fm(scaledFont, MScore::paintDevice());
-      scaledFont.setPointSizeF(scaledFont.pointSizeF() * MScore::pixelRatio);
+      scaledFont.setPointSizeF(scaledFont.pointSizeF() * MScore::pixelRatio());
 
       painter->setFont(scaledFont);
       qreal dotd = stringDist * .6;
@@ -328,7 +328,7 @@ void FretDiagram::draw(QPainter* painter) const
       if (_fretOffset > 0) {
             qreal fretNumMag = score()->styleD(StyleIdx::fretNumMag);
             QFont scaledFont(font);
-            scaledFont.setPointSizeF(font.pointSize() * fretNumMag * _userMag * MScore::pixelRatio);
+            scaledFont.setPointSizeF(font.pointSize() * fretNumMag * _userMag * MScore::pixelRatio());
             painter->setFont(scaledFont);
             if (score()->styleI(StyleIdx::fretNumPos) == 0)
                   painter->drawText(QRectF(-stringDist *.4, .0, .0, fretDist),
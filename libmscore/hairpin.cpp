@@ -77,6 +77,8 @@ static void moveDynamic(Dynamic* d, qreal y)
             d->rUserYoffset() = y;
             ss.add(d->shape());
             ms.add(d->shape().translated(spos));
+            if (d->measure()->system())
+                  d->measure()->system()->staff(staffIdx)->addToSkyline(d->shape().translated(d->measure()->pos() + spos));
             }
       }
 
@@ -264,21 +264,32 @@ void Image::draw(QPainter* painter) const
                   if (score()->printing()) {
                         // use original image size for printing
                         painter->scale(s.width() / rasterDoc->width(), s.height() / rasterDoc->height());
-                        painter->drawPixmap(QPointF(0, 0), QPixmap::fromImage(*rasterDoc));
+                        painter->drawImage(QPointF(0, 0), *rasterDoc);
                         }
                   else {
                         QTransform t = painter->transform();
                         QSize ss = QSizeF(s.width() * t.m11(), s.height() * t.m22()).toSize();
                         t.setMatrix(1.0, t.m12(), t.m13(), t.m21(), 1.0, t.m23(), t.m31(), t.m32(), t.m33());
                         painter->setWorldTransform(t);
-                        if ((buffer.size() != ss || _dirty) && rasterDoc && !rasterDoc->isNull()) {
-                              buffer = QPixmap::fromImage(rasterDoc->scaled(ss, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
-                              _dirty = false;
+                        if (QThread::currentThread() != QCoreApplication::instance()->thread()) {
+                              // pages are rendered in parallel by savePng(); QPixmap
+                              // must not be used outside of the gui thread, so the
+                              // image is scaled for every draw without the cache
+                              if (rasterDoc->isNull() || ss.isEmpty())
+                                    emptyImage = true;
+                              else
+                                    painter->drawImage(QPointF(0.0, 0.0), rasterDoc->scaled(ss, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+                              }
+                        else {
+                              if ((buffer.size() != ss || _dirty) && rasterDoc && !rasterDoc->isNull()) {
+                                    buffer = QPixmap::fromImage(rasterDoc->scaled(ss, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+                                    _dirty = false;
+                                    }
+                              if (buffer.isNull())
+                                    emptyImage = true;
+                              else
+                                    painter->drawPixmap(QPointF(0.0, 0.0), buffer);
                               }
-                        if (buffer.isNull())
-                              emptyImage = true;
-                        else
-                              painter->drawPixmap(QPointF(0.0, 0.0), buffer);
                         }
                   painter->restore();
                   }
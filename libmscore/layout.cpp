@@ -59,6 +59,7 @@
 #include "hairpin.h"
 #include "stafflines.h"
 #include "articulation.h"
+#include "layouttrace.h"
 
 namespace Ms {
 
@@ -88,6 +89,7 @@ void Score::rebuildBspTree()
 
 void Score::layoutChords1(Segment* segment, int staffIdx)
       {
+      LAYOUT_TRACE_SCOPE(LAYOUT_CHORDS1);
       Staff* staff = Score::staff(staffIdx);
 
       if (staff->isTabStaff(segment->tick()))
@@ -753,6 +755,7 @@ static qreal layoutAccidental(AcEl* me, AcEl* above, AcEl* below, qreal colOffse
 
 void Score::layoutChords3(std::vector<Note*>& notes, Staff* staff, Segment* segment)
       {
+      LAYOUT_TRACE_SCOPE(LAYOUT_CHORDS3);
       //---------------------------------------------------
       //    layout accidentals
       //    find column for dots
@@ -1177,6 +1180,7 @@ void Score::beamGraceNotes(Chord* mainNote, bool after)
 
 void Score::layoutSpanner()
       {
+      LAYOUT_TRACE_SCOPE(LAYOUT_SPANNER);
       int tracks = ntracks();
       for (int track = 0; track < tracks; ++track) {
             for (Segment* segment = firstSegment(); segment; segment = segment->next1()) {
@@ -1208,6 +1212,7 @@ void Score::layoutSpanner()
 
 void Score::hideEmptyStaves(System* system, bool isFirstSystem)
       {
+      LAYOUT_TRACE_SCOPE(HIDE_EMPTY_STAVES);
       int staves   = _staves.size();
       int staffIdx = 0;
       bool systemIsEmpty = true;
@@ -1534,6 +1539,7 @@ static qreal sff2(qreal width, qreal xMin, const SpringMap& springs)
 
 void Score::respace(std::vector<ChordRest*>* elements)
       {
+      LAYOUT_TRACE_SCOPE(RESPACE);
       ChordRest* cr1 = elements->front();
       ChordRest* cr2 = elements->back();
       int n          = elements->size();
@@ -2062,6 +2068,7 @@ int LayoutContext::adjustMeasureNo(MeasureBase* m)
 
 void Score::createBeams(Measure* measure)
       {
+      LAYOUT_TRACE_SCOPE(CREATE_BEAMS);
       bool crossMeasure = styleB(StyleIdx::crossMeasureValues);
 
       for (int track = 0; track < ntracks(); ++track) {
@@ -2227,6 +2234,7 @@ void Score::createBeams(Measure* measure)
 
 void Score::getNextMeasure(LayoutContext& lc)
       {
+      LAYOUT_TRACE_SCOPE(GET_NEXT_MEASURE);
       lc.prevMeasure = lc.curMeasure;
       lc.curMeasure  = lc.nextMeasure;
       if (!lc.curMeasure)
@@ -2714,6 +2722,7 @@ static void restoreBeams(Measure* m)
 
 System* Score::collectSystem(LayoutContext& lc)
       {
+      LAYOUT_TRACE_SCOPE(COLLECT_SYSTEM);
       if (!lc.curMeasure)
             return 0;
       System* system = getNextSystem(lc);
@@ -2968,10 +2977,14 @@ System* Score::collectSystem(LayoutContext& lc)
             system->setWidth(pos.x());
 
       //
-      // compute shape of measures
+      // compute shape of measures and the skylines of the system;
+      // shapes added to a measure shape below are also added
+      // to the skyline
       //
 
       for (int si = 0; si < score()->nstaves(); ++si) {
+            SysStaff* ss = system->staff(si);
+            ss->clearSkyline();
             for (MeasureBase* mb : system->measures()) {
                   if (!mb->isMeasure())
                         continue;
@@ -2980,6 +2993,7 @@ System* Score::collectSystem(LayoutContext& lc)
                   for (Segment& s : m->segments())
                         m->staffShape(si).add(s.staffShape(si).translated(s.pos()));
                   m->staffShape(si).add(m->staffLines(si)->bbox());
+                  ss->addToSkyline(m->staffShape(si).translated(m->pos()));
                   }
             }
 
@@ -3023,6 +3037,7 @@ System* Score::collectSystem(LayoutContext& lc)
                                     int si = tt->staffIdx();
                                     s->staffShape(si).add(tt->shape().translated(e->pos()));
                                     m->staffShape(si).add(tt->shape().translated(s->pos() + e->pos()));
+                                    system->staff(si)->addToSkyline(tt->shape().translated(m->pos() + s->pos() + e->pos()));
                                     }
                               }
                         else if (e->visible() && (e->isRehearsalMark() || e->isStaffText())) {
@@ -3030,6 +3045,7 @@ System* Score::collectSystem(LayoutContext& lc)
                               int si = e->staffIdx();
                               s->staffShape(si).add(e->shape().translated(e->pos()));
                               m->staffShape(si).add(e->shape().translated(s->pos() + e->pos()));
+                              system->staff(si)->addToSkyline(e->shape().translated(m->pos() + s->pos() + e->pos()));
                               }
                         else if (e->visible() && e->isDynamic()) {
                               Dynamic* d = toDynamic(e);
@@ -3058,6 +3074,7 @@ System* Score::collectSystem(LayoutContext& lc)
                                           int si = d->staffIdx();
                                           s->staffShape(si).add(d->shape().translated(e->pos()));
                                           m->staffShape(si).add(d->shape().translated(s->pos() + d->pos()));
+                                          system->staff(si)->addToSkyline(d->shape().translated(m->pos() + s->pos() + d->pos()));
                                           }
                                     }
                               }
@@ -3157,6 +3174,11 @@ System* Score::collectSystem(LayoutContext& lc)
             // add SpannerSegment shapes to staff shapes
             //
 
+            for (SpannerSegment* ss : system->spannerSegments()) {
+                  Spanner* sp = ss->spanner();
+                  if (sp->tick() < etick && sp->tick2() > stick)
+                        system->staff(sp->staffIdx())->addToSkyline(ss->isLyricsLineSegment() ? ss->shape() : ss->shape().translated(ss->pos()));
+                  }
             for (MeasureBase* mb : system->measures()) {
                   if (!mb->isMeasure())
                         continue;
@@ -3191,6 +3213,7 @@ System* Score::collectSystem(LayoutContext& lc)
 
 void LayoutContext::collectPage()
       {
+      LAYOUT_TRACE_SCOPE(COLLECT_PAGE);
       const qreal slb = score->styleP(StyleIdx::staffLowerBorder);
       bool breakPages = score->layoutMode() != LayoutMode::SYSTEM;
       qreal y         = prevSystem ? prevSystem->y() + prevSystem->height() : page->tm();
@@ -3367,15 +3390,63 @@ void LayoutContext::collectPage()
 
 void Score::doLayout()
       {
+      _deferredStartTick   = -1;
+      _deferredEndTick     = -1;
+      _deferredLayoutFlags = LayoutFlag::NO_FLAGS;
       doLayoutRange(0, -1);
       }
 
+//---------------------------------------------------------
+//   deferLayoutRange
+//    collect the layout range of a part score without a
+//    view; doDeferredLayout() lays it out before the score
+//    is shown or exported
+//---------------------------------------------------------
+
+void Score::deferLayoutRange(int stick, int etick, LayoutFlags flags)
+      {
+      stick = qMax(stick, 0);
+      if (_deferredStartTick == -1) {
+            _deferredStartTick = stick;
+            _deferredEndTick   = etick;
+            }
+      else {
+            _deferredStartTick = qMin(_deferredStartTick, stick);
+            if (etick < 0 || _deferredEndTick < 0)
+                  _deferredEndTick = -1;
+            else
+                  _deferredEndTick = qMax(_deferredEndTick, etick);
+            }
+      _deferredLayoutFlags |= flags;
+      }
+
+//---------------------------------------------------------
+//   doDeferredLayout
+//---------------------------------------------------------
+
+void Score::doDeferredLayout()
+      {
+      if (_deferredStartTick == -1)
+            return;
+      int stick = _deferredStartTick;
+      int etick = _deferredEndTick;
+      _deferredStartTick = -1;
+      _deferredEndTick   = -1;
+      if (_deferredLayoutFlags & LayoutFlag::FIX_PITCH_VELO)
+            updateVelo();
+      if (_deferredLayoutFlags & LayoutFlag::PLAY_EVENTS)
+            createPlayEvents();
+      _deferredLayoutFlags = LayoutFlag::NO_FLAGS;
+      doLayoutRange(stick, etick);
+      }
+
 //---------------------------------------------------------
 //   doLayoutRange
 //---------------------------------------------------------
 
 void Score::doLayoutRange(int stick, int etick)
       {
+      LAYOUT_TRACE_SCOPE(DO_LAYOUT_RANGE);
 qDebug("%p %d-%d", this, stick, etick);
       if (stick < 0)
             stick = 0;
@@ -0,0 +1,207 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2017 Werner Schweer and others
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENSE.GPL
+//=============================================================================
+
+#include "layouttrace.h"
+
+#ifdef LAYOUT_TRACE
+
+#include <chrono>
+
+namespace Ms {
+
+std::atomic<bool> LayoutTrace::_enabled { false };
+QString LayoutTrace::_path;
+QMutex LayoutTrace::_mutex;
+std::vector<LayoutTrace::Event> LayoutTrace::_events;
+LayoutTrace::Counter LayoutTrace::_counters[int(LayoutPhase::PHASES)];
+qint64 LayoutTrace::_droppedEvents = 0;
+
+static const char* phaseNames[] = {
+      "doLayoutRange", "getNextMeasure", "collectSystem", "createBeams",
+      "layoutChords1", "layoutChords3", "respace", "hideEmptyStaves",
+      "layoutSpanner", "collectPage", "rebuildBspTree"
+      };
+
+static_assert(sizeof(phaseNames) / sizeof(*phaseNames) == int(LayoutPhase::PHASES), "phase name missing");
+
+//---------------------------------------------------------
+//   now
+//    nanoseconds of a monotonic clock
+//---------------------------------------------------------
+
+qint64 LayoutTrace::now()
+      {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+      }
+
+//---------------------------------------------------------
+//   name
+//---------------------------------------------------------
+
+const char* LayoutTrace::name(LayoutPhase p)
+      {
+      return phaseNames[int(p)];
+      }
+
+//---------------------------------------------------------
+//   add
+//    record phase p started at startNs and ending now
+//---------------------------------------------------------
+
+void LayoutTrace::add(LayoutPhase p, qint64 startNs)
+      {
+      qint64 duration = now() - startNs;
+      QMutexLocker locker(&_mutex);
+      Counter& c = _counters[int(p)];
+      ++c.calls;
+      c.totalNs += duration;
+      c.maxNs    = qMax(c.maxNs, duration);
+      if (_events.size() < size_t(MAX_EVENTS)) {
+            static QThreadStorage<int> threadIndex;
+            static int threads = 0;
+            if (!threadIndex.hasLocalData())
+                  threadIndex.setLocalData(++threads);
+            _events.push_back({ startNs, duration, p, threadIndex.localData() });
+            }
+      else
+            ++_droppedEvents;
+      }
+
+//---------------------------------------------------------
+//   start
+//    trace from now on; stop() writes the result to path
+//---------------------------------------------------------
+
+void LayoutTrace::start(const QString& path)
+      {
+      reset();
+      _path    = path;
+      _enabled = true;
+      }
+
+//---------------------------------------------------------
+//   reset
+//---------------------------------------------------------
+
+void LayoutTrace::reset()
+      {
+      QMutexLocker locker(&_mutex);
+      _events.clear();
+      for (Counter& c : _counters)
+            c = { 0, 0, 0 };
+      _droppedEvents = 0;
+      }
+
+//---------------------------------------------------------
+//   stop
+//---------------------------------------------------------
+
+bool LayoutTrace::stop()
+      {
+      if (!_enabled.exchange(false))
+            return true;
+      if (_path.isEmpty())
+            return true;
+      QFile f(_path);
+      if (!f.open(QIODevice::WriteOnly)) {
+            qDebug("LayoutTrace: cannot write <%s>", qPrintable(_path));
+            return false;
+            }
+      QMutexLocker locker(&_mutex);
+      if (_path.endsWith(".json"))
+            return writeChromeTrace(&f);
+      return writeCounters(&f);
+      }
+
+//---------------------------------------------------------
+//   counter
+//---------------------------------------------------------
+
+LayoutTrace::Counter LayoutTrace::counter(LayoutPhase p)
+      {
+      QMutexLocker locker(&_mutex);
+      return _counters[int(p)];
+      }
+
+//---------------------------------------------------------
+//   events
+//---------------------------------------------------------
+
+int LayoutTrace::events()
+      {
+      QMutexLocker locker(&_mutex);
+      return int(_events.size());
+      }
+
+//---------------------------------------------------------
+//   writeChromeTrace
+//    trace event format, complete events in microseconds;
+//    the counters go to otherData
+//---------------------------------------------------------
+
+bool LayoutTrace::writeChromeTrace(QIODevice* f)
+      {
+      qint64 origin = _events.empty() ? 0 : _events.front().startNs;
+      for (const Event& e : _events)
+            origin = qMin(origin, e.startNs);
+
+      // written by hand, a QJsonArray of a million events is slow
+      f->write("{\"traceEvents\":[\n");
+      bool first = true;
+      for (const Event& e : _events) {
+            if (!first)
+                  f->write(",\n");
+            first = false;
+            f->write(QString("{\"name\":\"%1\",\"cat\":\"layout\",\"ph\":\"X\",\"pid\":1,\"tid\":%2,\"ts\":%3,\"dur\":%4}")
+               .arg(name(e.phase))
+               .arg(e.thread)
+               .arg((e.startNs - origin) / 1000.0, 0, 'f', 3)
+               .arg(e.durationNs / 1000.0, 0, 'f', 3).toLatin1());
+            }
+      f->write("\n],\n\"displayTimeUnit\":\"ms\",\n\"otherData\":{");
+      for (int i = 0; i < int(LayoutPhase::PHASES); ++i) {
+            const Counter& c = _counters[i];
+            f->write(QString("\"%1\":{\"calls\":%2,\"totalMs\":%3,\"maxMs\":%4},")
+               .arg(phaseNames[i])
+               .arg(c.calls)
+               .arg(c.totalNs / 1e6, 0, 'f', 3)
+               .arg(c.maxNs / 1e6, 0, 'f', 3).toLatin1());
+            }
+      f->write(QString("\"droppedEvents\":%1}}\n").arg(_droppedEvents).toLatin1());
+      return true;
+      }
+
+//---------------------------------------------------------
+//   writeCounters
+//    one line per phase: calls, total, mean and maximum
+//    time; phases include the phases they call
+//---------------------------------------------------------
+
+bool LayoutTrace::writeCounters(QIODevice* f)
+      {
+      f->write(QString("%1 %2 %3 %4 %5\n")
+         .arg("phase", -16).arg("calls", 10).arg("total ms", 12).arg("mean us", 12).arg("max us", 12).toLatin1());
+      for (int i = 0; i < int(LayoutPhase::PHASES); ++i) {
+            const Counter& c = _counters[i];
+            f->write(QString("%1 %2 %3 %4 %5\n")
+               .arg(phaseNames[i], -16)
+               .arg(c.calls, 10)
+               .arg(c.totalNs / 1e6, 12, 'f', 3)
+               .arg(c.calls ? c.totalNs / 1e3 / c.calls : 0.0, 12, 'f', 3)
+               .arg(c.maxNs / 1e3, 12, 'f', 3).toLatin1());
+            }
+      return true;
+      }
+
+}     // namespace Ms
+
+#endif
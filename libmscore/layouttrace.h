@@ -0,0 +1,119 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2017 Werner Schweer and others
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENSE.GPL
+//=============================================================================
+
+#ifndef __LAYOUTTRACE_H__
+#define __LAYOUTTRACE_H__
+
+#include "config.h"
+#include <atomic>
+
+namespace Ms {
+
+#ifdef LAYOUT_TRACE
+
+//---------------------------------------------------------
+//   LayoutPhase
+//---------------------------------------------------------
+
+enum class LayoutPhase : char {
+      DO_LAYOUT_RANGE,
+      GET_NEXT_MEASURE,
+      COLLECT_SYSTEM,
+      CREATE_BEAMS,
+      LAYOUT_CHORDS1,
+      LAYOUT_CHORDS3,
+      RESPACE,
+      HIDE_EMPTY_STAVES,
+      LAYOUT_SPANNER,
+      COLLECT_PAGE,
+      REBUILD_BSP_TREE,
+      PHASES
+      };
+
+//---------------------------------------------------------
+//   LayoutTrace
+//    Timing of the layout phases. While tracing, every
+//    LAYOUT_TRACE_SCOPE adds its duration to the counters
+//    of its phase and records an event. stop() writes a
+//    Chrome trace (file name ending in .json, open it in
+//    chrome://tracing) or a table of the counters.
+//---------------------------------------------------------
+
+class LayoutTrace {
+   public:
+      struct Counter {
+            qint64 calls;
+            qint64 totalNs;
+            qint64 maxNs;
+            };
+
+      static const int MAX_EVENTS = 1000000;    // later events are only counted
+
+   private:
+      struct Event {
+            qint64 startNs;
+            qint64 durationNs;
+            LayoutPhase phase;
+            int thread;
+            };
+
+      static std::atomic<bool> _enabled;
+      static QString _path;
+      static QMutex _mutex;
+      static std::vector<Event> _events;
+      static Counter _counters[int(LayoutPhase::PHASES)];
+      static qint64 _droppedEvents;
+
+      static bool writeChromeTrace(QIODevice*);
+      static bool writeCounters(QIODevice*);
+
+   public:
+      static bool enabled()         { return _enabled; }
+      static qint64 now();
+      static void add(LayoutPhase, qint64 startNs);
+
+      static void start(const QString& path);
+      static bool stop();
+      static void reset();
+
+      static const char* name(LayoutPhase);
+      static Counter counter(LayoutPhase p);
+      static int events();
+      };
+
+//---------------------------------------------------------
+//   LayoutTraceScope
+//    times the enclosing block
+//---------------------------------------------------------
+
+class LayoutTraceScope {
+      LayoutPhase _phase;
+      qint64 _start;
+
+   public:
+      LayoutTraceScope(LayoutPhase p) : _phase(p), _start(LayoutTrace::enabled() ? LayoutTrace::now() : -1) {}
+      ~LayoutTraceScope() {
+            if (_start >= 0)
+                  LayoutTrace::add(_phase, _start);
+            }
+      };
+
+#define LAYOUT_TRACE_SCOPE(phase) LayoutTraceScope _layoutTraceScope(LayoutPhase::phase)
+
+#else
+
+#define LAYOUT_TRACE_SCOPE(phase)
+
+#endif
+
+}     // namespace Ms
+#endif
@@ -3756,6 +3756,51 @@ void Measure::setStretchedWidth(qreal w)
       setWidth(w);
       }
 
+//---------------------------------------------------------
+//   SpacingGroup
+//    The right edges of segments with the same spacing
+//    rules, see Segment::spacing(). The edges only move to
+//    the right, so a moved segment is added again.
+//---------------------------------------------------------
+
+struct SpacingGroup {
+      const Segment* segment;             // any segment of the group
+      bool gap;
+      std::vector<Skyline> skylines;      // the shapes, one per staff
+      Skyline::Edge x;                    // the rightmost segment
+      Skyline::Edge right;                // x + minRight()
+
+      void add(const Segment* s) {
+            for (unsigned staffIdx = 0; staffIdx < skylines.size(); ++staffIdx)
+                  skylines[staffIdx].add(s->staffShape(staffIdx), s->x(), s);
+            x.raise(s->x(), s);
+            right.raise(s->x() + s->minRight(), s);
+            }
+
+      //---------------------------------------------------------
+      //   minPosition
+      //    the minimum x position of ns after all segments of
+      //    the group, like Segment::minHorizontalDistance()
+      //---------------------------------------------------------
+
+      Skyline::Edge minPosition(Segment* ns) const {
+            SegmentSpacing sp = segment->spacing(ns, false);
+            Skyline::Edge e;
+            if (sp.shape > -1000000.0) {
+                  for (unsigned staffIdx = 0; staffIdx < skylines.size(); ++staffIdx) {
+                        Skyline::Edge se = skylines[staffIdx].minPosition(ns->staffShape(staffIdx));
+                        e.raise(se.x + sp.shape, se.segment);
+                        }
+                  e.raise(x.x + sp.shape, x.segment);     // the shape distance is at least 0
+                  }
+            if (sp.right > -1000000.0)
+                  e.raise(right.x + sp.right, right.segment);
+            e.raise(x.x + qMax(sp.min, 0.0), x.segment);
+            e.x += sp.extra;
+            return e;
+            }
+      };
+
 //---------------------------------------------------------
 //   computeMinWidth
 //    sets the minimum stretched width of segment list s
@@ -3767,6 +3812,22 @@ void Measure::computeMinWidth(Segment* s, qreal x, bool isSystemHeader)
       Segment* fs = s;
       bool first = system()->firstMeasure() == this;
       const Shape ls(first ? QRectF(0.0, -1000000.0, 0.0, 2000000.0) : QRectF(0.0, 0.0, 0.0, spatium() * 4));
+
+      // the segments placed so far (without fs, which is checked
+      // against ls, and s) grouped by their spacing rules
+      std::vector<SpacingGroup> groups;
+      auto addToGroups = [this, &groups](const Segment* ps) {
+            bool gap = ps->isChordRestType() && ps->isGap();
+            for (SpacingGroup& g : groups) {
+                  if (g.segment->segmentType() == ps->segmentType() && g.gap == gap) {
+                        g.add(ps);
+                        return;
+                        }
+                  }
+            groups.push_back({ ps, gap, std::vector<Skyline>(score()->nstaves()), Skyline::Edge(), Skyline::Edge() });
+            groups.back().add(ps);
+            };
+
       while (s) {
             s->rxpos() = x;
             if (!s->enabled()) {
@@ -3786,20 +3847,17 @@ void Measure::computeMinWidth(Segment* s, qreal x, bool isSystemHeader)
                         w = s->minHorizontalDistance(ns, false);
                         }
 // printf("  min %f <%s>(%d) <%s>(%d)\n", s->x(), s->subTypeName(), s->enabled(), ns->subTypeName(), ns->enabled());
-#if 1
-                  // look back for collisions with previous segments
-                  // this is time consuming (ca. +5%) and probably requires more optimization
-
-                  int n = 1;
-                  for (Segment* ps = s; ps != fs;) {
-                        qreal ww;
-                        ps = ps->prevEnabled();
-                        if (ps == fs)
-                              ww = ns->minLeft(ls) - s->x();
-                        else {
-                              if (ps->isChordRestType())
-                                    ++n;
-                              ww = ps->minHorizontalDistance(ns, false) - (s->x() - ps->x());
+                  // look back for collisions with previous segments:
+                  // find the segment which needs the most space to ns
+                  if (s != fs) {
+                        Segment* ps = fs;
+                        qreal ww    = ns->minLeft(ls) - s->x();
+                        for (const SpacingGroup& g : groups) {
+                              Skyline::Edge e = g.minPosition(ns);
+                              if (e.segment && e.x - s->x() > ww) {
+                                    ww = e.x - s->x();
+                                    ps = const_cast<Segment*>(e.segment);
+                                    }
                               }
                         if (ww > w) {
                               // overlap !
@@ -3807,6 +3865,11 @@ void Measure::computeMinWidth(Segment* s, qreal x, bool isSystemHeader)
                               // only ChordRest segments get more space
                               // TODO: is there a special case n == 0 ?
 
+                              int n = 1;
+                              for (Segment* ss = ps; ss != s; ss = ss->nextEnabled()) {
+                                    if (ss != fs && ss->isChordRestType())
+                                          ++n;
+                                    }
                               qreal d = (ww - w) / n;
                               qreal xx = ps->x();
                               for (Segment* ss = ps; ss != s;) {
@@ -3822,10 +3885,14 @@ void Measure::computeMinWidth(Segment* s, qreal x, bool isSystemHeader)
                                     }
                               w += d;
                               x = xx;
-                              break;
+
+                              // the segments after ps have moved to the right,
+                              // their new edges replace the old ones
+                              for (Segment* ss = ps->nextEnabled(); ss != s; ss = ss->nextEnabled())
+                                    addToGroups(ss);
                               }
+                        addToGroups(s);
                         }
-#endif
                   }
             else
                   w = s->minRight();
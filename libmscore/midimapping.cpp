@@ -23,10 +23,20 @@ namespace Ms {
 
 void MasterScore::rebuildMidiMapping()
       {
+      std::vector<Channel*> channels;
+      for (const MidiMapping& mm : _midiMapping)
+            channels.push_back(mm.articulation);
       removeDeletedMidiMapping();
       int maxport = updateMidiMapping();
       reorderMidiMapping();
       masterScore()->setMidiPortCount(maxport);
+
+      // rendered events carry the index of their channel
+      bool changed = int(channels.size()) != _midiMapping.size();
+      for (int i = 0; !changed && i < _midiMapping.size(); ++i)
+            changed = channels[i] != _midiMapping[i].articulation;
+      if (changed)
+            setPlaylistDirty(-1, -1);
       }
 
 //---------------------------------------------------------
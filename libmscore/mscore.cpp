@@ -108,8 +108,9 @@ int     MScore::mtcType;
 
 bool    MScore::noExcerpts = false;
 bool    MScore::noImages = false;
-bool    MScore::pdfPrinting = false;
-double  MScore::pixelRatio  = 0.8;        // DPI / logicalDPI
+RenderContext MScore::defaultRenderContext { 0.8, false, false };    // pixelRatio: DPI / logicalDPI
+
+static thread_local const RenderContext* currentRenderContext = 0;
 
 MPaintDevice* MScore::_paintDevice;
 
@@ -464,6 +465,34 @@ QQmlEngine* MScore::qml()
       return _qml;
       }
 
+//---------------------------------------------------------
+//   renderContext
+//    the render context of the calling thread
+//---------------------------------------------------------
+
+const RenderContext& MScore::renderContext()
+      {
+      return currentRenderContext ? *currentRenderContext : defaultRenderContext;
+      }
+
+//---------------------------------------------------------
+//   RenderScope
+//---------------------------------------------------------
+
+RenderScope::RenderScope(double pixelRatio, bool printing, bool pdfPrinting)
+      {
+      _context.pixelRatio  = pixelRatio;
+      _context.printing    = printing;
+      _context.pdfPrinting = pdfPrinting;
+      _previous            = currentRenderContext;
+      currentRenderContext = &_context;
+      }
+
+RenderScope::~RenderScope()
+      {
+      currentRenderContext = _previous;
+      }
+
 //---------------------------------------------------------
 //   paintDevice
 //---------------------------------------------------------
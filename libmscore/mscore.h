@@ -376,6 +376,35 @@ class MPaintDevice : public QPaintDevice {
       virtual ~MPaintDevice() {}
       };
 
+//---------------------------------------------------------
+//   RenderContext
+//    settings elements read while drawing; see RenderScope
+//---------------------------------------------------------
+
+struct RenderContext {
+      double pixelRatio;            // DPI / logicalDPI of the paint device
+      bool printing;                // do not draw unprintable elements, selection etc.
+      bool pdfPrinting;             // draw symbols as text (vector output)
+      };
+
+//---------------------------------------------------------
+//   RenderScope
+//    make a render context current for the calling thread
+//    until the scope ends, so that several renderings can
+//    run at the same time
+//---------------------------------------------------------
+
+class RenderScope {
+      RenderContext _context;
+      const RenderContext* _previous;
+
+   public:
+      RenderScope(double pixelRatio, bool printing, bool pdfPrinting = false);
+      ~RenderScope();
+      RenderScope(const RenderScope&) = delete;
+      RenderScope& operator=(const RenderScope&) = delete;
+      };
+
 //---------------------------------------------------------
 //   MScore
 //    MuseScore application object
@@ -467,8 +496,11 @@ class MScore : public QObject {
       static bool noExcerpts;
       static bool noImages;
 
-      static bool pdfPrinting;
-      static double pixelRatio;
+      static RenderContext defaultRenderContext;   // used outside of a RenderScope
+      static const RenderContext& renderContext();
+      static bool pdfPrinting()           { return renderContext().pdfPrinting; }
+      static double pixelRatio()          { return renderContext().pixelRatio;  }
+      static void setPixelRatio(double v) { defaultRenderContext.pixelRatio = v; }
 
       static qreal verticalPageGap;
       static qreal horizontalPageGapEven;
@@ -633,7 +633,7 @@ void Note::setPitch(int val)
       Q_ASSERT(val >= 0 && val <= 127);
       if (_pitch != val) {
             _pitch = val;
-            score()->setPlaylistDirty();
+            score()->setPlaylistDirty(tick(), tick());
             }
       }
 
@@ -1105,7 +1105,7 @@ void Note::draw(QPainter* painter) const
                         }
                   }
             QFont f(tab->fretFont());
-            f.setPointSizeF(f.pointSizeF() * spatium() * MScore::pixelRatio / SPATIUM20);
+            f.setPointSizeF(f.pointSizeF() * spatium() * MScore::pixelRatio() / SPATIUM20);
             painter->setFont(f);
             painter->setPen(c);
             painter->drawText(QPointF(bbox().x(), tab->fretFontYOffset()), s);
@@ -2444,7 +2444,7 @@ bool Note::setProperty(P_ID propertyId, const QVariant& v)
       switch(propertyId) {
             case P_ID::PITCH:
                   setPitch(v.toInt());
-                  score()->setPlaylistDirty();
+                  score()->setPlaylistDirty(tick(), tick());
                   break;
             case P_ID::TPC1:
                   _tpc[0] = v.toInt();
@@ -2470,11 +2470,11 @@ bool Note::setProperty(P_ID propertyId, const QVariant& v)
                   break;
             case P_ID::VELO_OFFSET:
                   setVeloOffset(v.toInt());
-                  score()->setPlaylistDirty();
+                  score()->setPlaylistDirty(tick(), tick());
                   break;
             case P_ID::TUNING:
                   setTuning(v.toDouble());
-                  score()->setPlaylistDirty();
+                  score()->setPlaylistDirty(tick(), tick());
                   break;
             case P_ID::FRET:
                   setFret(v.toInt());
@@ -2490,7 +2490,7 @@ bool Note::setProperty(P_ID propertyId, const QVariant& v)
                   break;
             case P_ID::VELO_TYPE:
                   setVeloType(ValueType(v.toInt()));
-                  score()->setPlaylistDirty();
+                  score()->setPlaylistDirty(tick(), tick());
                   break;
             case P_ID::VISIBLE: {                     // P_ID::VISIBLE requires reflecting property on dots
                   setVisible(v.toBool());
@@ -2505,7 +2505,7 @@ bool Note::setProperty(P_ID propertyId, const QVariant& v)
                   }
             case P_ID::PLAY:
                   setPlay(v.toBool());
-                  score()->setPlaylistDirty();
+                  score()->setPlaylistDirty(tick(), tick());
                   break;
             case P_ID::FIXED:
                   setFixed(v.toBool());
@@ -29,6 +29,7 @@
 #include "system.h"
 #include "mscore.h"
 #include "segment.h"
+#include "layouttrace.h"
 
 namespace Ms {
 
@@ -222,6 +223,7 @@ static void countElements(void* data, Element* /*e*/)
 
 void Page::doRebuildBspTree()
       {
+      LAYOUT_TRACE_SCOPE(REBUILD_BSP_TREE);
       int n = 0;
       scanElements(&n, countElements, false);
 
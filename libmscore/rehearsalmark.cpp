@@ -13,6 +13,7 @@
 #include "score.h"
 #include "rehearsalmark.h"
 #include "measure.h"
+#include "system.h"
 
 namespace Ms {
 
@@ -59,17 +60,17 @@ void RehearsalMark::layout()
                         rxpos() += qMin(leftX, barlineX) + width();
                         }
                   }
-            if (autoplace()) {
+            System* system = s->measure()->system();
+            if (autoplace() && system) {
                   qreal minDistance = score()->styleP(StyleIdx::rehearsalMarkMinDistance);
-                  Shape s1 = s->measure()->staffShape(staffIdx());
-                  Shape s2 = shape().translated(s->pos() + pos());
+                  Shape s2 = shape().translated(s->measure()->pos() + s->pos() + pos());
                   if (placeAbove()) {
-                        qreal d = s2.minVerticalDistance(s1);
+                        qreal d = system->topDistance(staffIdx(), s2);
                         if (d > -minDistance)
                               rUserYoffset() = -d - minDistance;
                         }
                   else {
-                        qreal d = s1.minVerticalDistance(s2);
+                        qreal d = system->bottomDistance(staffIdx(), s2);
                         if (d > -minDistance)
                               rUserYoffset() = d + minDistance;
                         }
@@ -50,6 +50,7 @@
 #include "undo.h"
 #include "utils.h"
 #include "sym.h"
+#include "rendermidi.h"
 
 namespace Ms {
 
@@ -72,19 +73,45 @@ namespace Ms {
 
 bool graceNotesMerged(Chord *chord);
 
+//---------------------------------------------------------
+//   removeRange
+//    remove the entries from stick to etick, etick == -1
+//    is the end of the score
+//---------------------------------------------------------
+
+template <class T>
+static void removeRange(QMap<int, T>& map, int stick, int etick)
+      {
+      auto i = map.lowerBound(stick);
+      while (i != map.end() && (etick == -1 || i.key() < etick))
+            i = map.erase(i);
+      }
+
+//---------------------------------------------------------
+//   firstSegment
+//    the first segment of type st from stick on
+//---------------------------------------------------------
+
+static Segment* firstSegment(Score* score, int stick, Segment::Type st)
+      {
+      Measure* m = stick > 0 ? score->tick2measure(stick) : score->firstMeasure();
+      Segment* s = m ? m->first(st) : 0;
+      while (s && s->tick() < stick)
+            s = s->next1(st);
+      return s;
+      }
+
 //---------------------------------------------------------
 //   updateSwing
+//    read the swing texts from stick to etick
 //---------------------------------------------------------
 
-void Score::updateSwing()
+void Score::updateSwing(int stick, int etick)
       {
-      for (Staff* s : _staves) {
-            s->swingList()->clear();
-            }
-      Measure* fm = firstMeasure();
-      if (!fm)
-            return;
-      for (Segment* s = fm->first(Segment::Type::ChordRest); s; s = s->next1(Segment::Type::ChordRest)) {
+      for (Staff* s : _staves)
+            removeRange(*s->swingList(), stick, etick);
+      const Segment::Type sst = Segment::Type::ChordRest;
+      for (Segment* s = firstSegment(this, stick, sst); s && (etick == -1 || s->tick() < etick); s = s->next1(sst)) {
             for (const Element* e : s->annotations()) {
                   if (!e->isStaffText())
                         continue;
@@ -110,18 +137,17 @@ void Score::updateSwing()
 
 //---------------------------------------------------------
 //   updateChannel
+//    read the channel switches from stick to etick
 //---------------------------------------------------------
 
-void MasterScore::updateChannel()
+void MasterScore::updateChannel(int stick, int etick)
       {
       for (Staff* s : staves()) {
             for (int i = 0; i < VOICES; ++i)
-                  s->channelList(i)->clear();
+                  removeRange(*s->channelList(i), stick, etick);
             }
-      Measure* fm = firstMeasure();
-      if (!fm)
-            return;
-      for (Segment* s = fm->first(Segment::Type::ChordRest); s; s = s->next1(Segment::Type::ChordRest)) {
+      const Segment::Type sst = Segment::Type::ChordRest;
+      for (Segment* s = firstSegment(this, stick, sst); s && (etick == -1 || s->tick() < etick); s = s->next1(sst)) {
             for (const Element* e : s->annotations()) {
                   if (e->isInstrumentChange()) {
                         Staff* staff = Score::staff(e->staffIdx());
@@ -143,8 +169,18 @@ void MasterScore::updateChannel()
                         }
                   }
             }
+      setNoteChannels(stick, etick);
+      }
+
+//---------------------------------------------------------
+//   setNoteChannels
+//    set the channel of the notes from stick to etick
+//---------------------------------------------------------
 
-      for (Segment* s = fm->first(Segment::Type::ChordRest); s; s = s->next1(Segment::Type::ChordRest)) {
+void MasterScore::setNoteChannels(int stick, int etick)
+      {
+      const Segment::Type sst = Segment::Type::ChordRest;
+      for (Segment* s = firstSegment(this, stick, sst); s && (etick == -1 || s->tick() < etick); s = s->next1(sst)) {
             for (Staff* st : staves()) {
                   int strack = st->idx() * VOICES;
                   int etrack = strack + VOICES;
@@ -467,7 +503,7 @@ void Score::updateRepeatList(bool expandRepeats)
             repeatList()->unwind();
       if (MScore::debugMode)
             repeatList()->dump();
-      setPlaylistDirty();
+      _playlistDirty = true;        // PlaybackCache::update() places the chunks at the new repeats
       }
 
 //---------------------------------------------------------
@@ -558,70 +594,91 @@ void Score::removeHairpin(Hairpin* h)
       }
 
 //---------------------------------------------------------
-//   updateVelo
-//    calculate velocity for all notes
+//   collectDynamics
+//    read the dynamics from stick to etick into the lists
+//    of their staves
 //---------------------------------------------------------
 
-void Score::updateVelo()
+static void collectDynamics(Score* score, StaffDynamics* dynamics, int stick, int etick)
       {
-      //
-      //    collect Dynamics
-      //
-      if (!firstMeasure())
-            return;
+      for (std::multimap<int, const Dynamic*>& dl : *dynamics)
+            dl.erase(dl.lower_bound(stick), etick == -1 ? dl.end() : dl.lower_bound(etick));
+      for (Segment* s = firstSegment(score, stick, Segment::Type::All); s; s = s->next1()) {
+            int tick = s->tick();
+            if (etick != -1 && tick >= etick)
+                  break;
+            for (const Element* e : s->annotations()) {
+                  if (e->isDynamic())
+                        (*dynamics)[e->staffIdx()].insert(std::make_pair(tick, toDynamic(e)));
+                  }
+            }
+      }
+
+//---------------------------------------------------------
+//   setVelocities
+//    compute the velocity lists of the staves from the
+//    dynamics and the hairpins
+//---------------------------------------------------------
 
-      for (Staff* st : _staves) {
+static void setVelocities(Score* score, const StaffDynamics& dynamics)
+      {
+      int nstaves = score->nstaves();
+      for (Staff* st : score->staves()) {
             VeloList& velo = st->velocities();
             velo.clear();
             velo.setVelo(0, 80);
             }
-      for (int staffIdx = 0; staffIdx < nstaves(); ++staffIdx) {
-            Staff* st      = staff(staffIdx);
+      std::vector<std::vector<Hairpin*>> hairpins(nstaves);
+      for (const auto& sp : score->spannerMap().map()) {
+            if (sp.second->isHairpin())
+                  hairpins[sp.second->staffIdx()].push_back(toHairpin(sp.second));
+            }
+      for (int staffIdx = 0; staffIdx < nstaves; ++staffIdx) {
+            Staff* st      = score->staff(staffIdx);
             VeloList& velo = st->velocities();
             Part* prt      = st->part();
             int partStaves = prt->nstaves();
-            int partStaff  = Score::staffIdx(prt);
+            int partStaff  = score->staffIdx(prt);
 
-            for (Segment* s = firstMeasure()->first(); s; s = s->next1()) {
-                  int tick = s->tick();
-                  for (const Element* e : s->annotations()) {
-                        if (e->staffIdx() != staffIdx)
-                              continue;
-                        if (e->type() != ElementType::DYNAMIC)
-                              continue;
-                        const Dynamic* d = static_cast<const Dynamic*>(e);
-                        int v            = d->velocity();
-                        if (v < 1)     //  illegal value
-                              continue;
-                        int dStaffIdx = d->staffIdx();
-                        switch(d->dynRange()) {
-                              case Dynamic::Range::STAFF:
-                                    if (dStaffIdx == staffIdx)
-                                          velo.setVelo(tick, v);
-                                    break;
-                              case Dynamic::Range::PART:
-                                    if (dStaffIdx >= partStaff && dStaffIdx < partStaff+partStaves) {
-                                          for (int i = partStaff; i < partStaff+partStaves; ++i)
-                                                staff(i)->velocities().setVelo(tick, v);
-                                          }
-                                    break;
-                              case Dynamic::Range::SYSTEM:
-                                    for (int i = 0; i < nstaves(); ++i)
-                                          staff(i)->velocities().setVelo(tick, v);
-                                    break;
-                              }
-                        }
-                  }
-            for (const auto& sp : _spanner.map()) {
-                  Spanner* s = sp.second;
-                  if (s->type() != ElementType::HAIRPIN || sp.second->staffIdx() != staffIdx)
+            for (const auto& i : dynamics[staffIdx]) {
+                  int tick         = i.first;
+                  const Dynamic* d = i.second;
+                  int v            = d->velocity();
+                  if (v < 1)     //  illegal value
                         continue;
-                  Hairpin* h = static_cast<Hairpin*>(s);
-                  updateHairpin(h);
+                  switch(d->dynRange()) {
+                        case Dynamic::Range::STAFF:
+                              velo.setVelo(tick, v);
+                              break;
+                        case Dynamic::Range::PART:
+                              for (int k = partStaff; k < partStaff+partStaves; ++k)
+                                    score->staff(k)->velocities().setVelo(tick, v);
+                              break;
+                        case Dynamic::Range::SYSTEM:
+                              for (int k = 0; k < nstaves; ++k)
+                                    score->staff(k)->velocities().setVelo(tick, v);
+                              break;
+                        }
                   }
+            for (Hairpin* h : hairpins[staffIdx])
+                  score->updateHairpin(h);
             }
       }
 
+//---------------------------------------------------------
+//   updateVelo
+//    calculate velocity for all notes
+//---------------------------------------------------------
+
+void Score::updateVelo()
+      {
+      if (!firstMeasure())
+            return;
+      StaffDynamics dynamics(nstaves());
+      collectDynamics(this, &dynamics, 0, -1);
+      setVelocities(this, dynamics);
+      }
+
 //---------------------------------------------------------
 //   renderStaff
 //---------------------------------------------------------
@@ -1729,5 +1786,458 @@ void Score::renderMidi(EventMap* events)
                         break;
                   }
             }
+      events->finalize();
+      }
+
+//---------------------------------------------------------
+//   renderMidiIncremental
+//    like renderMidi(), but only measures changed since
+//    the last call are rendered again; events must be the
+//    map passed the last time
+//---------------------------------------------------------
+
+void Score::renderMidiIncremental(EventMap* events)
+      {
+      if (!_playbackCache)
+            _playbackCache = new PlaybackCache(this);
+      updateRepeatList(MScore::playRepeats);
+      _foundPlayPosAfterRepeats = false;
+      _playbackCache->update(events);
+      }
+
+//---------------------------------------------------------
+//   setPlaylistDirty
+//    mark the playback events of a tick range as outdated,
+//    startTick == -1 marks the whole score
+//---------------------------------------------------------
+
+void Score::setPlaylistDirty()
+      {
+      setPlaylistDirty(-1, -1);
+      }
+
+void Score::setPlaylistDirty(int startTick, int endTick)
+      {
+      MasterScore* ms = masterScore();
+      _playlistDirty     = true;
+      ms->_playlistDirty = true;
+      for (Score* s : ms->scoreList()) {
+            if (!s->_playbackCache)
+                  continue;
+            if (startTick == -1)
+                  s->_playbackCache->setAllDirty();
+            else
+                  s->_playbackCache->setDirty(startTick, endTick);
+            }
+      }
+
+//---------------------------------------------------------
+//   startsWithTie
+//    true if a chord of the measure is tied to the
+//    previous measure
+//---------------------------------------------------------
+
+static bool startsWithTie(Measure* m)
+      {
+      const Segment::Type st = Segment::Type::ChordRest;
+      for (int track = 0; track < m->score()->ntracks(); ++track) {
+            for (Segment* s = m->first(st); s; s = s->next(st)) {
+                  Element* e = s->element(track);
+                  if (!e)
+                        continue;
+                  if (e->isChord()) {
+                        for (Note* n : toChord(e)->notes()) {
+                              if (n->tieBack())
+                                    return true;
+                              }
+                        }
+                  break;
+                  }
+            }
+      return false;
+      }
+
+//---------------------------------------------------------
+//   firstDifference
+//    return the first tick where lookups in the two maps
+//    can differ or -1 if they are equal; velocity ramps
+//    interpolate towards the next entry, so the previous
+//    entry is returned
+//---------------------------------------------------------
+
+template <class T, class Equal>
+static int firstDifference(const QMap<int, T>& a, const QMap<int, T>& b, Equal equal)
+      {
+      int tick = 0;
+      auto ia = a.cbegin();
+      auto ib = b.cbegin();
+      for (; ia != a.cend() && ib != b.cend(); ++ia, ++ib) {
+            if (ia.key() != ib.key() || !equal(ia.value(), ib.value()))
+                  return tick;
+            tick = ia.key();
+            }
+      return (ia != a.cend() || ib != b.cend()) ? tick : -1;
+      }
+
+//---------------------------------------------------------
+//   PlaybackCache::setDirty
+//---------------------------------------------------------
+
+void PlaybackCache::setDirty(int startTick, int endTick)
+      {
+      if (_startTick == -1 || startTick < _startTick)
+            _startTick = startTick;
+      if (_endTick == -1 || endTick > _endTick)
+            _endTick = endTick;
+      }
+
+//---------------------------------------------------------
+//   staffDirtyTick
+//    compare velocities, swing and channel switches of
+//    the staff with the last update; return the tick from
+//    which the staff must be rendered again or -1;
+//    channelTick is lowered to the first changed channel
+//    switch
+//---------------------------------------------------------
+
+int PlaybackCache::staffDirtyTick(int staffIdx, int* channelTick)
+      {
+      Staff* st = _score->staff(staffIdx);
+      int tick  = -1;
+      auto merge = [](int* tick, int t) {
+            if (t != -1 && (*tick == -1 || t < *tick))
+                  *tick = t;
+            };
+      merge(&tick, firstDifference(st->velocities(), _velocities[staffIdx],
+         [](const VeloEvent& a, const VeloEvent& b) { return a.type == b.type && a.val == b.val; }));
+      merge(&tick, firstDifference(*st->swingList(), _swing[staffIdx],
+         [](const SwingParameters& a, const SwingParameters& b) {
+            return a.swingUnit == b.swingUnit && a.swingRatio == b.swingRatio; }));
+      for (int voice = 0; voice < VOICES; ++voice) {
+            int t = firstDifference(*st->channelList(voice), _channels[staffIdx * VOICES + voice],
+               [](int a, int b) { return a == b; });
+            merge(&tick, t);
+            merge(channelTick, t);
+            _channels[staffIdx * VOICES + voice] = *st->channelList(voice);
+            }
+      _velocities[staffIdx] = st->velocities();
+      _swing[staffIdx]      = *st->swingList();
+      return tick;
+      }
+
+//---------------------------------------------------------
+//   place
+//    insert the events of a chunk from fromTick to toTick
+//---------------------------------------------------------
+
+void PlaybackCache::place(EventMap* events, const EventMap& src, int fromTick, int toTick) const
+      {
+      if (src.empty() || (src.cend() - 1)->first < fromTick || src.cbegin()->first > toTick)
+            return;
+      for (auto i = src.lower_bound(fromTick); i != src.cend() && i->first <= toTick; ++i)
+            events->insert(*i);
+      }
+
+//---------------------------------------------------------
+//   placeAll
+//    insert the events from fromTick to toTick in the same
+//    order as renderMidi(): staves, pedals, metronome;
+//    the metronome placements start at index metronome
+//---------------------------------------------------------
+
+void PlaybackCache::placeAll(EventMap* events, size_t metronome, int fromTick, int toTick) const
+      {
+      for (size_t i = 0; i < metronome; ++i)
+            place(events, _chunks.at(_placements[i]).events, fromTick, toTick);
+      place(events, _pedals, fromTick, toTick);
+      for (size_t i = metronome; i < _placements.size(); ++i)
+            place(events, _chunks.at(_placements[i]).events, fromTick, toTick);
+      events->finalize();
+      }
+
+//---------------------------------------------------------
+//   update
+//    The dirty tick range is widened by a measure on both
+//    sides and over chains of tied notes, as a tied note is
+//    rendered with the length of the whole chain.
+//    Swing, channel switches and dynamics are read again
+//    only in that range. Chunks are rendered at the tick
+//    offset of their repeat, so a changed repeat list
+//    renders the chunks at the new offsets.
+//---------------------------------------------------------
+
+void PlaybackCache::update(EventMap* events)
+      {
+      Score* score    = _score;
+      MasterScore* ms = score->masterScore();
+
+      std::vector<Measure*> measures;
+      for (Measure* m = score->firstMeasure(); m; m = m->nextMeasure())
+            measures.push_back(m);
+      std::vector<const Staff*> staves(score->staves().begin(), score->staves().end());
+      if (measures != _measures || staves != _staves) {
+            _allDirty = true;
+            _measures.swap(measures);
+            _staves.swap(staves);
+            }
+      std::vector<int> repeats;
+      for (const RepeatSegment* rs : *score->repeatList()) {
+            repeats.push_back(rs->tick);
+            repeats.push_back(rs->len);
+            repeats.push_back(rs->utick);
+            }
+      bool repeatsChanged = repeats != _repeats;
+      _repeats.swap(repeats);
+      std::vector<std::pair<int, const Instrument*>> instruments;
+      for (const Part* p : ms->parts()) {
+            for (const auto& i : *p->instruments())
+                  instruments.push_back(std::make_pair(i.first, i.second));
+            }
+      bool instrumentsChanged = instruments != _instruments;
+      _instruments.swap(instruments);
+
+      int nstaves = score->nstaves();
+      int n       = int(_measures.size());
+
+      if (_allDirty)
+            _chunks.clear();
+      _velocities.resize(nstaves);
+      _swing.resize(nstaves);
+      _channels.resize(nstaves * VOICES);
+
+      int idx1 = n;
+      int idx2 = -1;
+      if (_startTick != -1) {
+            for (int i = 0; i < n; ++i) {
+                  if (_measures[i]->endTick() > _startTick && _measures[i]->tick() <= _endTick) {
+                        idx1 = qMin(idx1, i);
+                        idx2 = i;
+                        }
+                  }
+            if (idx2 != -1) {
+                  idx1 = qMax(idx1 - 1, 0);
+                  idx2 = qMin(idx2 + 1, n - 1);
+                  while (idx1 > 0 && startsWithTie(_measures[idx1]))
+                        --idx1;
+                  }
+            }
+      int stick = idx2 != -1 ? _measures[idx1]->tick() : -1;
+      int etick = idx2 != -1 ? _measures[idx2]->endTick() : -1;
+
+      //
+      // read the annotations of the dirty range; the channel
+      // switches of an excerpt are read from the master score,
+      // which has its own dirty range
+      //
+      bool allChannels = _allDirty || instrumentsChanged || !score->isMaster();
+      if (_allDirty) {
+            score->updateSwing();
+            _dynamics.assign(nstaves, std::multimap<int, const Dynamic*>());
+            collectDynamics(score, &_dynamics, 0, -1);
+            }
+      else if (stick != -1) {
+            score->updateSwing(stick, etick);
+            collectDynamics(score, &_dynamics, stick, etick);
+            }
+      if (allChannels)
+            ms->updateChannel();
+      else if (stick != -1)
+            ms->updateChannel(stick, etick);
+      setVelocities(score, _dynamics);
+
+      int channelTick = -1;
+      std::vector<int> staffDirty(nstaves);
+      for (int staffIdx = 0; staffIdx < nstaves; ++staffIdx)
+            staffDirty[staffIdx] = staffDirtyTick(staffIdx, &channelTick);
+      // a changed channel switch holds up to the next one
+      if (channelTick != -1 && !allChannels)
+            ms->setNoteChannels(channelTick, -1);
+
+      //
+      // pedals are rendered for the whole score and depend on
+      // the repeats and on the channels
+      //
+      std::vector<std::tuple<int, int, int>> pedalSpans;
+      for (const auto& sp : score->spannerMap().map()) {
+            if (sp.second->isPedal())
+                  pedalSpans.push_back(std::make_tuple(sp.second->tick(), sp.second->tick2(), sp.second->staffIdx()));
+            }
+      bool pedalsDirty = _allDirty || repeatsChanged || instrumentsChanged || channelTick != -1
+         || pedalSpans != _pedalSpans;
+      _pedalSpans.swap(pedalSpans);
+      EventMap pedals;
+      if (pedalsDirty) {
+            score->renderSpanners(&pedals, -1);
+            pedals.finalize();
+            }
+
+      //
+      // the chunks in the order renderMidi() inserts the
+      // events: staves, then metronome
+      //
+      std::vector<ChunkKey> plan;
+      for (int staffIdx = 0; staffIdx < nstaves; ++staffIdx) {
+            Staff* staff = score->staff(staffIdx);
+            Measure* lastMeasure = 0;
+            for (const RepeatSegment* rs : *score->repeatList()) {
+                  int endTick    = rs->tick + rs->len;
+                  int tickOffset = rs->utick - rs->tick;
+                  for (Measure* m = score->tick2measure(rs->tick); m; m = m->nextMeasure()) {
+                        if (lastMeasure && m->isRepeatMeasure(staff))
+                              plan.push_back(ChunkKey { lastMeasure, staffIdx, tickOffset + m->tick() - lastMeasure->tick() });
+                        else {
+                              lastMeasure = m;
+                              plan.push_back(ChunkKey { m, staffIdx, tickOffset });
+                              }
+                        if (m->tick() + m->ticks() >= endTick)
+                              break;
+                        }
+                  }
+            }
+      size_t metronome = plan.size();
+      for (const RepeatSegment* rs : *score->repeatList()) {
+            int endTick    = rs->tick + rs->len;
+            int tickOffset = rs->utick - rs->tick;
+            for (Measure* m = score->tick2measure(rs->tick); m; m = m->nextMeasure()) {
+                  plan.push_back(ChunkKey { m, -1, tickOffset });
+                  if (m->tick() + m->ticks() >= endTick)
+                        break;
+                  }
+            }
+
+      //
+      // find the chunks to render
+      //
+      std::set<ChunkKey> dirty;
+      for (const ChunkKey& key : plan) {
+            Measure* m  = key.measure;
+            qreal tempo = score->tempomap()->tempo(m->tick());
+            auto ic     = _chunks.find(key);
+            bool render = (stick != -1 && m->tick() >= stick && m->tick() < etick)
+               || ic == _chunks.end()
+               || ic->second.tick != m->tick()
+               || ic->second.ticks != m->ticks();
+            if (key.staffIdx == -1)
+                  render = render || ic->second.tempo != tempo;
+            else if (staffDirty[key.staffIdx] != -1)
+                  render = render || m->endTick() > staffDirty[key.staffIdx];
+            if (render)
+                  dirty.insert(key);
+            }
+
+      // play events of tied notes are read by the first note of
+      // the chain, so create all of them before collecting
+      const Segment::Type st = Segment::Type::ChordRest;
+      std::set<std::pair<Measure*, int>> created;
+      for (const ChunkKey& key : dirty) {
+            if (key.staffIdx == -1 || !score->staff(key.staffIdx)->primaryStaff())
+                  continue;
+            if (!created.insert(std::make_pair(key.measure, key.staffIdx)).second)
+                  continue;
+            int strack = key.staffIdx * VOICES;
+            for (int track = strack; track < strack + VOICES; ++track) {
+                  for (Segment* seg = key.measure->first(st); seg; seg = seg->next(st)) {
+                        Element* e = seg->element(track);
+                        if (e && e->isChord())
+                              score->createPlayEvents(toChord(e));
+                        }
+                  }
+            }
+      // keep the replaced events, they are removed from the event map
+      std::map<ChunkKey, EventMap> replaced;
+      for (const ChunkKey& key : dirty) {
+            Measure* m = key.measure;
+            Chunk& c   = _chunks[key];
+            if (c.tick != -1)
+                  replaced[key].swap(c.events);
+            c.tick     = m->tick();
+            c.ticks    = m->ticks();
+            c.events.clear();
+            if (key.staffIdx == -1) {
+                  c.tempo = score->tempomap()->tempo(m->tick());
+                  score->renderMetronome(&c.events, m, key.tickOffset);
+                  }
+            else
+                  collectMeasureEvents(&c.events, m, score->staff(key.staffIdx), key.tickOffset);
+            c.events.finalize();
+            }
+      _renderedChunks = int(dirty.size());
+
+      if (_allDirty || events != _events || events->size() != _eventCount || plan.size() != _placements.size()) {
+            _placements.swap(plan);
+            if (pedalsDirty)
+                  _pedals.swap(pedals);
+            events->clear();
+            placeAll(events, metronome, INT_MIN, INT_MAX);
+            }
+      else {
+            // the tick range of all changed events; it is placed
+            // again as a whole, so events with equal ticks are
+            // in the order of a full render
+            int fromTick = INT_MAX;
+            int toTick   = INT_MIN;
+            auto extend = [&fromTick, &toTick](const EventMap& src) {
+                  if (!src.empty()) {
+                        fromTick = qMin(fromTick, src.cbegin()->first);
+                        toTick   = qMax(toTick, (src.cend() - 1)->first);
+                        }
+                  };
+            for (size_t i = 0; i < plan.size(); ++i) {
+                  const ChunkKey& key = _placements[i];
+                  auto ir = replaced.find(key);
+                  if (key == plan[i] && ir == replaced.end())
+                        continue;
+                  auto ic = _chunks.find(key);
+                  if (ir != replaced.end())
+                        extend(ir->second);
+                  else if (ic != _chunks.end())
+                        extend(ic->second.events);
+                  extend(_chunks.at(plan[i]).events);
+                  }
+            if (pedalsDirty) {
+                  // pedal events which differ
+                  auto p1 = _pedals.cbegin();
+                  auto p2 = pedals.cbegin();
+                  auto e1 = _pedals.cend();
+                  auto e2 = pedals.cend();
+                  auto same = [](const EventMap::value_type& a, const EventMap::value_type& b) {
+                        return a.first == b.first && a.second == b.second;
+                        };
+                  for (; p1 != e1 && p2 != e2 && same(*p1, *p2); ++p1, ++p2)
+                        ;
+                  for (; e1 != p1 && e2 != p2 && same(*(e1 - 1), *(e2 - 1)); --e1, --e2)
+                        ;
+                  for (; p1 != e1; ++p1) {
+                        fromTick = qMin(fromTick, p1->first);
+                        toTick   = qMax(toTick, p1->first);
+                        }
+                  for (; p2 != e2; ++p2) {
+                        fromTick = qMin(fromTick, p2->first);
+                        toTick   = qMax(toTick, p2->first);
+                        }
+                  _pedals.swap(pedals);
+                  }
+            _placements.swap(plan);
+            if (fromTick <= toTick) {
+                  EventMap range;
+                  placeAll(&range, metronome, fromTick, toTick);
+                  events->replaceRange(fromTick, toTick, range);
+                  }
+            }
+
+      // drop the chunks which are no longer placed
+      std::set<ChunkKey> placed(_placements.begin(), _placements.end());
+      for (auto i = _chunks.begin(); i != _chunks.end();) {
+            if (placed.count(i->first))
+                  ++i;
+            else
+                  i = _chunks.erase(i);
+            }
+
+      _events     = events;
+      _eventCount = events->size();
+      _allDirty   = false;
+      _startTick  = -1;
+      _endTick    = -1;
       }
 }
@@ -0,0 +1,97 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2017 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __RENDERMIDI_H__
+#define __RENDERMIDI_H__
+
+#include <tuple>
+#include "synthesizer/event.h"
+#include "staff.h"
+#include "velo.h"
+
+namespace Ms {
+
+class Score;
+class Measure;
+class Dynamic;
+class Instrument;
+
+// the dynamics of each staff by tick, in score order
+typedef std::vector<std::multimap<int, const Dynamic*>> StaffDynamics;
+
+//---------------------------------------------------------
+//   PlaybackCache
+//    Persistent store of the playback events of a score.
+//    Events are rendered in chunks per measure and staff
+//    and spliced into the event map of the sequencer;
+//    update() re-renders only the chunks touched since
+//    the last call.
+//---------------------------------------------------------
+
+class PlaybackCache {
+      struct ChunkKey {
+            Measure* measure;             // source of the events
+            int staffIdx;                 // -1: metronome
+            int tickOffset;               // repeat offset the events are rendered with
+            bool operator<(const ChunkKey& k) const {
+                  return std::tie(measure, staffIdx, tickOffset) < std::tie(k.measure, k.staffIdx, k.tickOffset);
+                  }
+            bool operator==(const ChunkKey& k) const {
+                  return measure == k.measure && staffIdx == k.staffIdx && tickOffset == k.tickOffset;
+                  }
+            };
+      struct Chunk {
+            int tick    { -1 };           // measure position the chunk was rendered for
+            int ticks   { 0 };
+            qreal tempo { 0.0 };          // metronome chunks depend on the tempo
+            EventMap events;              // unrolled ticks, at the offset of the key
+            };
+
+      Score* _score;
+      std::map<ChunkKey, Chunk> _chunks;
+      std::vector<ChunkKey> _placements;
+      EventMap _pedals;
+      std::vector<std::tuple<int, int, int>> _pedalSpans;  // tick, tick2 and staff of the pedals rendered
+      const EventMap* _events { 0 };      // event map the chunks were placed into
+      size_t _eventCount      { 0 };
+
+      // score state of the last update, used to detect changes
+      // which are not reported as a dirty tick range
+      std::vector<Measure*> _measures;
+      std::vector<const Staff*> _staves;
+      std::vector<int> _repeats;          // tick, len and utick of each repeat segment
+      std::vector<std::pair<int, const Instrument*>> _instruments;
+      std::vector<VeloList> _velocities;
+      std::vector<QMap<int,SwingParameters>> _swing;
+      std::vector<QMap<int,int>> _channels;     // VOICES entries per staff
+      StaffDynamics _dynamics;
+
+      bool _allDirty  { true };
+      int _startTick  { -1 };
+      int _endTick    { -1 };
+      int _renderedChunks { 0 };
+
+      int staffDirtyTick(int staffIdx, int* channelTick);
+      void place(EventMap* events, const EventMap& src, int fromTick, int toTick) const;
+      void placeAll(EventMap* events, size_t metronome, int fromTick, int toTick) const;
+
+   public:
+      PlaybackCache(Score* s) : _score(s) {}
+      void setDirty(int startTick, int endTick);
+      void setAllDirty()            { _allDirty = true; }
+      void update(EventMap* events);
+      int renderedChunks() const    { return _renderedChunks; }
+      };
+
+}     // namespace Ms
+#endif
+
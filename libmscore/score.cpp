@@ -70,6 +70,7 @@
 #include "rehearsalmark.h"
 #include "breath.h"
 #include "instrchange.h"
+#include "rendermidi.h"
 
 namespace Ms {
 
@@ -100,6 +101,7 @@ MeasureBaseList::MeasureBaseList()
 void MeasureBaseList::push_back(MeasureBase* e)
       {
       ++_size;
+      _tickIndexValid = false;
       if (_last) {
             _last->setNext(e);
             e->setPrev(_last);
@@ -120,6 +122,7 @@ void MeasureBaseList::push_back(MeasureBase* e)
 void MeasureBaseList::push_front(MeasureBase* e)
       {
       ++_size;
+      _tickIndexValid = false;
       if (_first) {
             _first->setPrev(e);
             e->setNext(_first);
@@ -150,6 +153,7 @@ void MeasureBaseList::add(MeasureBase* e)
             return;
             }
       ++_size;
+      _tickIndexValid = false;
       e->setPrev(el->prev());
       el->prev()->setNext(e);
       el->setPrev(e);
@@ -162,6 +166,7 @@ void MeasureBaseList::add(MeasureBase* e)
 void MeasureBaseList::remove(MeasureBase* el)
       {
       --_size;
+      _tickIndexValid = false;
       if (el->prev())
             el->prev()->setNext(el->next());
       else
@@ -179,6 +184,7 @@ void MeasureBaseList::remove(MeasureBase* el)
 void MeasureBaseList::insert(MeasureBase* fm, MeasureBase* lm)
       {
       ++_size;
+      _tickIndexValid = false;
       for (MeasureBase* m = fm; m != lm; m = m->next())
             ++_size;
       MeasureBase* pm = fm->prev();
@@ -201,6 +207,7 @@ void MeasureBaseList::remove(MeasureBase* fm, MeasureBase* lm)
       {
       printf("remove measures %p %p\n", fm, lm);
       --_size;
+      _tickIndexValid = false;
       for (MeasureBase* m = fm; m != lm; m = m->next())
             --_size;
       MeasureBase* pm = fm->prev();
@@ -221,6 +228,7 @@ void MeasureBaseList::remove(MeasureBase* fm, MeasureBase* lm)
 
 void MeasureBaseList::change(MeasureBase* ob, MeasureBase* nb)
       {
+      _tickIndexValid = false;
       nb->setPrev(ob->prev());
       nb->setNext(ob->next());
       if (ob->prev())
@@ -238,6 +246,49 @@ void MeasureBaseList::change(MeasureBase* ob, MeasureBase* nb)
             e->setParent(nb);
       }
 
+//---------------------------------------------------------
+//   rebuildTickIndex
+//---------------------------------------------------------
+
+void MeasureBaseList::rebuildTickIndex() const
+      {
+      _tickIndex.clear();
+      _tickIndex.reserve(_size);
+      for (MeasureBase* mb = _first; mb; mb = mb->next()) {
+            if (mb->isMeasure())
+                  _tickIndex.push_back(toMeasure(mb));
+            }
+      _tickIndexValid = true;
+      }
+
+//---------------------------------------------------------
+//   tick2measure
+//    binary search in the tick index; returns the last
+//    measure starting at or before tick.
+//    The index holds measure pointers only and compares
+//    against their current tick, so moving measures in
+//    time does not invalidate it as long as the list
+//    order is unchanged.
+//---------------------------------------------------------
+
+Measure* MeasureBaseList::tick2measure(int tick) const
+      {
+      if (!_tickIndexValid)
+            rebuildTickIndex();
+      auto i = std::upper_bound(_tickIndex.begin(), _tickIndex.end(), tick,
+         [](int t, const Measure* m) { return t < m->tick(); });
+      if (i == _tickIndex.begin())
+            return 0;
+      Measure* lm = *(i - 1);
+      if (i != _tickIndex.end())
+            return lm;
+      // check last measure
+      if ((tick >= lm->tick()) && (tick <= lm->endTick()))
+            return lm;
+      qDebug("tick2measure %d (max %d) not found", tick, lm->tick());
+      return 0;
+      }
+
 //---------------------------------------------------------
 //   Score
 //---------------------------------------------------------
@@ -324,6 +375,7 @@ Score::~Score()
       qDeleteAll(_staves);
       qDeleteAll(_systems);
 //      qDeleteAll(_pages);
+      delete _playbackCache;
       _masterScore = 0;
       }
 
@@ -64,6 +64,7 @@ class Omr;
 class Page;
 class Parameter;
 class Part;
+class PlaybackCache;
 class RepeatList;
 class Rest;
 class Revisions;
@@ -142,14 +143,22 @@ class MeasureBaseList {
       MeasureBase* _first;
       MeasureBase* _last;
 
+      // all measures of the list in list (and therefore tick) order;
+      // rebuilt on demand after the list structure changed
+      mutable std::vector<Measure*> _tickIndex;
+      mutable bool _tickIndexValid { false };
+
       void push_back(MeasureBase* e);
       void push_front(MeasureBase* e);
+      void rebuildTickIndex() const;
 
    public:
       MeasureBaseList();
       MeasureBase* first() const { return _first; }
       MeasureBase* last()  const { return _last; }
-      void clear()               { _first = _last = 0; _size = 0; }
+      void clear()               { _first = _last = 0; _size = 0; invalidateTickIndex(); }
+      void invalidateTickIndex() { _tickIndexValid = false; }
+      Measure* tick2measure(int tick) const;
       void add(MeasureBase*);
       void remove(MeasureBase*);
       void insert(MeasureBase*, MeasureBase*);
@@ -221,6 +230,24 @@ struct Layer {
       uint tags;
       };
 
+//---------------------------------------------------------
+//   SaveSnapshot
+//    Contents of a compressed score file, collected on the
+//    main thread by Score::createSnapshot(). Compression,
+//    image encoding and i/o are done by
+//    Score::writeCompressedFile(), which does not access the
+//    score and can run in a worker thread.
+//---------------------------------------------------------
+
+struct SaveSnapshot {
+      struct File {
+            QString path;                 // path in the zip archive
+            QByteArray data;
+            QImage image;                 // if set, stored as png instead of data
+            };
+      QList<File> files;
+      };
+
 //---------------------------------------------------------
 //   UpdateMode
 //    There is an implied order from least invasive update
@@ -382,6 +409,9 @@ class Score : public ScoreElement {
       MasterScore* _masterScore;
       QList<MuseScoreView*> viewer;
       Excerpt* _excerpt  { 0 };
+      int _deferredStartTick { -1 };        ///< layout range of a part score without view,
+      int _deferredEndTick   { -1 };        ///< done when the score is shown or exported
+      LayoutFlags _deferredLayoutFlags;
 
       QString _mscoreVersion;
       int _mscoreRevision;
@@ -423,7 +453,6 @@ class Score : public ScoreElement {
       bool _markIrregularMeasures { true  };
       bool _showInstrumentNames   { true  };
       bool _showVBox              { true  };
-      bool _printing              { false };      ///< True if we are drawing to a printer
       bool _playlistDirty         { true  };
       bool _autosaveDirty         { true  };
       bool _saved                 { false };    ///< True if project was already saved; only on first
@@ -436,6 +465,7 @@ class Score : public ScoreElement {
       bool _foundPlayPosAfterRepeats; ///< Temporary used during playback rendering
                                       ///< indicating if playPos after expanded repeats
                                       ///< has been calculated.
+      PlaybackCache* _playbackCache { 0 };  ///< rendered playback events, created on demand
 
       int _mscVersion { MSCVERSION };   ///< version of current loading *.msc file
 
@@ -736,6 +766,8 @@ class Score : public ScoreElement {
       bool saveFile(QIODevice* f, bool msczFormat, bool onlySelection = false);
       bool saveCompressedFile(QFileInfo&, bool onlySelection);
       bool saveCompressedFile(QIODevice*, QFileInfo&, bool onlySelection);
+      void createSnapshot(SaveSnapshot*, const QFileInfo&, bool onlySelection, bool relayoutThumbnail = true);
+      static bool writeCompressedFile(QIODevice*, const SaveSnapshot&, QString* error = 0);
       bool exportFile();
 
       void print(QPainter* printer, int page);
@@ -779,12 +811,12 @@ class Score : public ScoreElement {
       bool created() const           { return _created;       }
       bool saved() const             { return _saved;         }
       void setSaved(bool v)          { _saved = v;            }
-      bool printing() const          { return _printing;      }
-      void setPrinting(bool val)     { _printing = val;      }
+      bool printing() const          { return MScore::renderContext().printing; }   ///< True if we are drawing to a printer
       void setAutosaveDirty(bool v)  { _autosaveDirty = v;    }
       bool autosaveDirty() const     { return _autosaveDirty; }
       bool playlistDirty()           { return _playlistDirty; }
-      void setPlaylistDirty()        { _playlistDirty = true; }
+      void setPlaylistDirty();
+      void setPlaylistDirty(int startTick, int endTick);
 
       void spell();
       void spell(int startStaff, int endStaff, Segment* startSegment, Segment* endSegment);
@@ -799,12 +831,12 @@ class Score : public ScoreElement {
       bool saveStyle(const QString&);
 
       QVariant styleV(StyleIdx idx) const  { return style().value(idx);   }
-      Spatium  styleS(StyleIdx idx) const  { Q_ASSERT(!strcmp(MStyle::valueType(idx),"Ms::Spatium")); return style().value(idx).value<Spatium>();  }
-      qreal    styleP(StyleIdx idx) const  { Q_ASSERT(!strcmp(MStyle::valueType(idx),"Ms::Spatium")); return style().pvalue(idx); }
-      QString  styleSt(StyleIdx idx) const { Q_ASSERT(!strcmp(MStyle::valueType(idx),"QString"));     return style().value(idx).toString(); }
-      bool     styleB(StyleIdx idx) const  { Q_ASSERT(!strcmp(MStyle::valueType(idx),"bool"));        return style().value(idx).toBool();  }
-      qreal    styleD(StyleIdx idx) const  { Q_ASSERT(!strcmp(MStyle::valueType(idx),"double"));      return style().value(idx).toDouble();  }
-      int      styleI(StyleIdx idx) const  { Q_ASSERT(!strcmp(MStyle::valueType(idx),"int"));         return style().value(idx).toInt();  }
+      Spatium  styleS(StyleIdx idx) const  { Q_ASSERT(MStyle::valueTypeId(idx) == qMetaTypeId<Spatium>()); return Spatium(style().dvalue(idx));  }
+      qreal    styleP(StyleIdx idx) const  { Q_ASSERT(MStyle::valueTypeId(idx) == qMetaTypeId<Spatium>()); return style().pvalue(idx); }
+      QString  styleSt(StyleIdx idx) const { Q_ASSERT(MStyle::valueTypeId(idx) == QMetaType::QString);     return style().value(idx).toString(); }
+      bool     styleB(StyleIdx idx) const  { Q_ASSERT(MStyle::valueTypeId(idx) == QMetaType::Bool);        return style().ivalue(idx);  }
+      qreal    styleD(StyleIdx idx) const  { Q_ASSERT(MStyle::valueTypeId(idx) == QMetaType::Double);      return style().dvalue(idx);  }
+      int      styleI(StyleIdx idx) const  { Q_ASSERT(MStyle::valueTypeId(idx) == QMetaType::Int);         return style().ivalue(idx);  }
 
       qreal spatium() const                    { return styleD(StyleIdx::spatium);    }
       void setSpatium(qreal v)                 { style().set(StyleIdx::spatium, v);  }
@@ -842,6 +874,8 @@ class Score : public ScoreElement {
       bool pasteStaff(XmlReader&, Segment* dst, int staffIdx);
       void pasteSymbols(XmlReader& e, ChordRest* dst);
       void renderMidi(EventMap* events);
+      void renderMidiIncremental(EventMap* events);
+      const PlaybackCache* playbackCache() const { return _playbackCache; }
       void renderStaff(EventMap* events, Staff*);
       void renderSpanners(EventMap* events, int staffIdx);
       void renderMetronome(EventMap* events, Measure* m, int tickOffset);
@@ -853,7 +887,7 @@ class Score : public ScoreElement {
 
       void addLyrics(int tick, int staffIdx, const QString&);
 
-      void updateSwing();
+      void updateSwing(int stick = 0, int etick = -1);
       void createPlayEvents();
 
       void cmdConcertPitchChanged(bool, bool /*useSharpsFlats*/);
@@ -954,6 +988,9 @@ class Score : public ScoreElement {
 
       void doLayout();
       void doLayoutRange(int, int);
+      void deferLayoutRange(int, int, LayoutFlags);
+      void doDeferredLayout();
+      bool layoutDeferred() const { return _deferredStartTick != -1; }
       void layoutLinear(LayoutContext& lc);
 
       void layoutSystemsUndoRedo();
@@ -1003,7 +1040,7 @@ class Score : public ScoreElement {
       const QList<Layer>& layer() const     { return _layer;       }
       bool tagIsValid(uint tag) const       { return tag & _layer[_currentLayer].tags; }
 
-      void addViewer(MuseScoreView* v)      { viewer.append(v);    }
+      void addViewer(MuseScoreView* v)      { doDeferredLayout(); viewer.append(v); }
       void removeViewer(MuseScoreView* v)   { viewer.removeAll(v); }
       const QList<MuseScoreView*>& getViewer() const { return viewer;       }
 
@@ -1135,6 +1172,7 @@ class Score : public ScoreElement {
 
       friend class ChangeSynthesizerState;
       friend class Chord;
+      friend class PlaybackCache;
       };
 
 //---------------------------------------------------------
@@ -1246,7 +1284,8 @@ class MasterScore : public Score {
       int getNextFreeMidiMapping(int p = -1, int ch = -1);
       int getNextFreeDrumMidiMapping();
       void enqueueMidiEvent(MidiInputEvent ev) { _midiInputQueue.enqueue(ev); }
-      void updateChannel();
+      void updateChannel(int stick = 0, int etick = -1);
+      void setNoteChannels(int stick, int etick);
       void setSoloMute();
 
       void addExcerpt(Excerpt*);
@@ -488,17 +488,15 @@ QImage Score::createThumbnail()
       pm.setDotsPerMeterY(dpm);
       pm.fill(0xffffffff);
 
-      double pr = MScore::pixelRatio;
-      MScore::pixelRatio = 1.0;
-
+      {
+      RenderScope rs(1.0, true);
       QPainter p(&pm);
       p.setRenderHint(QPainter::Antialiasing, true);
       p.setRenderHint(QPainter::TextAntialiasing, true);
       p.scale(mag, mag);
       print(&p, 0);
       p.end();
-
-      MScore::pixelRatio = pr;
+      }
 
       if (layoutMode() != mode) {
             setLayoutMode(mode);
@@ -514,7 +512,22 @@ QImage Score::createThumbnail()
 
 bool Score::saveCompressedFile(QIODevice* f, QFileInfo& info, bool onlySelection)
       {
-      MQZipWriter uz(f);
+      SaveSnapshot snapshot;
+      createSnapshot(&snapshot, info, onlySelection);
+      return writeCompressedFile(f, snapshot, &MScore::lastError);
+      }
+
+//---------------------------------------------------------
+//   createSnapshot
+//    Collect the contents of a compressed score file.
+//    If relayoutThumbnail is false and the score is not in
+//    page mode, no thumbnail is created, as that would need
+//    a complete page layout.
+//---------------------------------------------------------
+
+void Score::createSnapshot(SaveSnapshot* snapshot, const QFileInfo& info, bool onlySelection, bool relayoutThumbnail)
+      {
+      QList<SaveSnapshot::File>& files = snapshot->files;
 
       QString fn = info.completeBaseName() + ".mscx";
       QBuffer cbuf;
@@ -534,29 +547,19 @@ bool Score::saveCompressedFile(QIODevice* f, QFileInfo& info, bool onlySelection
 
       xml.etag();
       xml.etag();
-      cbuf.seek(0);
-      //uz.addDirectory("META-INF");
-      uz.addFile("META-INF/container.xml", cbuf.data());
+      files.append({ "META-INF/container.xml", cbuf.data(), QImage() });
 
       // save images
-      //uz.addDirectory("Pictures");
       foreach (ImageStoreItem* ip, imageStore) {
             if (!ip->isUsed(this))
                   continue;
             QString path = QString("Pictures/") + ip->hashName();
-            uz.addFile(path, ip->buffer());
+            files.append({ path, ip->buffer(), QImage() });
             }
 
       // create thumbnail
-      QImage pm = createThumbnail();
-
-      QByteArray ba;
-      QBuffer b(&ba);
-      if (!b.open(QIODevice::WriteOnly))
-            qDebug("open buffer failed");
-      if (!pm.save(&b, "PNG"))
-            qDebug("save failed");
-      uz.addFile("Thumbnails/thumbnail.png", ba);
+      if (relayoutThumbnail || layoutMode() == LayoutMode::PAGE)
+            files.append({ "Thumbnails/thumbnail.png", QByteArray(), createThumbnail() });
 
 #ifdef OMR
       //
@@ -566,15 +569,8 @@ bool Score::saveCompressedFile(QIODevice* f, QFileInfo& info, bool onlySelection
             int n = masterScore()->omr()->numPages();
             for (int i = 0; i < n; ++i) {
                   QString path = QString("OmrPages/page%1.png").arg(i+1);
-                  QBuffer cbuf;
                   OmrPage* page = masterScore()->omr()->page(i);
-                  const QImage& image = page->image();
-                  if (!image.save(&cbuf, "PNG")) {
-                        MScore::lastError = tr("save file: cannot save image (%1x%2)").arg(image.width()).arg(image.height());
-                        return false;
-                        }
-                  uz.addFile(path, cbuf.data());
-                  cbuf.close();
+                  files.append({ path, QByteArray(), page->image() });
                   }
             }
 #endif
@@ -582,15 +578,42 @@ bool Score::saveCompressedFile(QIODevice* f, QFileInfo& info, bool onlySelection
       // save audio
       //
       if (_audio)
-            uz.addFile("audio.ogg", _audio->data());
+            files.append({ "audio.ogg", _audio->data(), QImage() });
 
       QBuffer dbuf;
       dbuf.open(QIODevice::ReadWrite);
       saveFile(&dbuf, true, onlySelection);
-      dbuf.seek(0);
-      uz.addFile(fn, dbuf.data());
+      files.append({ fn, dbuf.data(), QImage() });
+      }
+
+//---------------------------------------------------------
+//   writeCompressedFile
+//    file is already opened
+//    This does not access any score and is safe to call
+//    from a worker thread.
+//---------------------------------------------------------
+
+bool Score::writeCompressedFile(QIODevice* f, const SaveSnapshot& snapshot, QString* error)
+      {
+      MQZipWriter uz(f);
+
+      for (const SaveSnapshot::File& file : snapshot.files) {
+            if (file.image.isNull()) {
+                  uz.addFile(file.path, file.data);
+                  continue;
+                  }
+            QByteArray ba;
+            QBuffer b(&ba);
+            b.open(QIODevice::WriteOnly);
+            if (!file.image.save(&b, "PNG")) {
+                  if (error)
+                        *error = tr("save file: cannot save image (%1x%2)").arg(file.image.width()).arg(file.image.height());
+                  return false;
+                  }
+            uz.addFile(file.path, ba);
+            }
       uz.close();
-      return true;
+      return uz.status() == MQZipWriter::NoError;
       }
 
 //---------------------------------------------------------
@@ -934,8 +957,7 @@ Score::FileError MasterScore::read1(XmlReader& e, bool ignoreVersionError)
 
 void Score::print(QPainter* painter, int pageNo)
       {
-      _printing  = true;
-      MScore::pdfPrinting = true;
+      RenderScope rs(MScore::pixelRatio(), true, true);
       Page* page = pages().at(pageNo);
       QRectF fr  = page->abbox();
 
@@ -949,8 +971,6 @@ void Score::print(QPainter* painter, int pageNo)
             e->draw(painter);
             painter->restore();
             }
-      MScore::pdfPrinting = false;
-      _printing = false;
       }
 
 //---------------------------------------------------------
@@ -1316,40 +1316,49 @@ qreal Segment::minLeft() const
       }
 
 //---------------------------------------------------------
-//   minHorizontalDistance
+//   isGap
+//    all elements are gap rests
 //---------------------------------------------------------
 
-qreal Segment::minHorizontalDistance(Segment* ns, bool systemHeaderGap) const
+bool Segment::isGap() const
+      {
+      bool gap = false;
+      for (int i = 0; i < score()->nstaves() * VOICES; i++) {
+            Element* el = element(i);
+            if (el && el->isRest() && toRest(el)->isGap())
+                  gap = true;
+            else if (el)
+                  return false;
+            }
+      return gap;
+      }
+
+//---------------------------------------------------------
+//   spacing
+//    the rules for the distance to ns; they depend on the
+//    type of this segment and ns, and on gap rests
+//---------------------------------------------------------
+
+SegmentSpacing Segment::spacing(Segment* ns, bool systemHeaderGap) const
       {
       Segment::Type st  = segmentType();
       Segment::Type nst = ns ? ns->segmentType() : Segment::Type::Invalid;
 
-      qreal w = 0.0;
-      for (unsigned staffIdx = 0; staffIdx < _shapes.size(); ++staffIdx) {
-            qreal d = staffShape(staffIdx).minHorizontalDistance(ns->staffShape(staffIdx));
-            w = qMax(w, d);
-            }
-
+      SegmentSpacing sp;
+      sp.shape = 0.0;
       if (isChordRestType()) {
             if (nst == Segment::Type::EndBarLine)
-                  w += score()->styleP(StyleIdx::noteBarDistance);
+                  sp.shape = score()->styleP(StyleIdx::noteBarDistance);
             else if (nst == Segment::Type::Clef)
-                  w = qMax(w, score()->styleP(StyleIdx::clefLeftMargin));
+                  sp.min = score()->styleP(StyleIdx::clefLeftMargin);
             else {
-                  bool isGap = false;
-                  for (int i = 0; i < score()->nstaves() * VOICES; i++) {
-                        Element* el = element(i);
-                        if (el && el->isRest() && toRest(el)->isGap())
-                              isGap = true;
-                        else if (el) {
-                              isGap = false;
-                              break;
-                              }
+                  if (isGap()) {
+                        sp.shape = -1000000.0;
+                        sp.min   = 0.0;
+                        return sp;
                         }
-                  if (isGap)
-                        return 0.0;
-
-                  w = qMax(w, score()->noteHeadWidth()) + score()->styleP(StyleIdx::minNoteDistance);
+                  sp.shape = score()->styleP(StyleIdx::minNoteDistance);
+                  sp.min   = score()->noteHeadWidth() + sp.shape;
                   }
             }
       else if (nst == Segment::Type::ChordRest) {
@@ -1362,8 +1371,9 @@ qreal Segment::minHorizontalDistance(Segment* ns, bool systemHeaderGap) const
                   }
             else
                   d = score()->styleP(StyleIdx::barNoteDistance);
-            qreal dd = minRight() + ns->minLeft() + spatium();
-            w = qMax(d, dd);
+            sp.shape = -1000000.0;
+            sp.right = ns->minLeft() + spatium();
+            sp.min   = d;
             // d -= ns->minLeft() * .7;      // hack
             // d = qMax(d, ns->minLeft());
             // d = qMax(d, spatium());       // minimum distance is one spatium
@@ -1371,42 +1381,62 @@ qreal Segment::minHorizontalDistance(Segment* ns, bool systemHeaderGap) const
             }
       else if (st & (Segment::Type::Clef | Segment::Type::HeaderClef)) {
             if (nst == Segment::Type::KeySig)
-                  w += score()->styleP(StyleIdx::clefKeyDistance);
+                  sp.shape = score()->styleP(StyleIdx::clefKeyDistance);
             else if (nst == Segment::Type::TimeSig)
-                  w += score()->styleP(StyleIdx::clefTimesigDistance);
+                  sp.shape = score()->styleP(StyleIdx::clefTimesigDistance);
             else if (nst & (Segment::Type::EndBarLine | Segment::Type::StartRepeatBarLine))
-                  w += score()->styleP(StyleIdx::clefBarlineDistance);
+                  sp.shape = score()->styleP(StyleIdx::clefBarlineDistance);
             else if (nst == Segment::Type::Ambitus)
-                  w += score()->styleP(StyleIdx::ambitusMargin);
+                  sp.shape = score()->styleP(StyleIdx::ambitusMargin);
             }
       else if ((st & (Segment::Type::KeySig | Segment::Type::KeySigAnnounce))
          && (nst & (Segment::Type::TimeSig | Segment::Type::TimeSigAnnounce))) {
-            w += score()->styleP(StyleIdx::keyTimesigDistance);
+            sp.shape = score()->styleP(StyleIdx::keyTimesigDistance);
             }
       else if (st == Segment::Type::KeySig && nst == Segment::Type::StartRepeatBarLine)
-            w += score()->styleP(StyleIdx::keyBarlineDistance);
+            sp.shape = score()->styleP(StyleIdx::keyBarlineDistance);
       else if (st == Segment::Type::StartRepeatBarLine)
-            w += score()->styleP(StyleIdx::noteBarDistance);
+            sp.shape = score()->styleP(StyleIdx::noteBarDistance);
       else if (st == Segment::Type::BeginBarLine && (nst & (Segment::Type::HeaderClef | Segment::Type::Clef)))
-            w += score()->styleP(StyleIdx::clefLeftMargin);
+            sp.shape = score()->styleP(StyleIdx::clefLeftMargin);
       else if (st == Segment::Type::EndBarLine) {
             if (nst == Segment::Type::KeySigAnnounce)
-                  w += score()->styleP(StyleIdx::keysigLeftMargin);
+                  sp.shape = score()->styleP(StyleIdx::keysigLeftMargin);
             else if (nst == Segment::Type::TimeSigAnnounce)
-                  w += score()->styleP(StyleIdx::timesigLeftMargin);
+                  sp.shape = score()->styleP(StyleIdx::timesigLeftMargin);
             }
       else if (st == Segment::Type::TimeSig && nst == Segment::Type::StartRepeatBarLine)
-            w += score()->styleP(StyleIdx::timesigBarlineDistance);
+            sp.shape = score()->styleP(StyleIdx::timesigBarlineDistance);
       else if (st == Segment::Type::Breath)
-            w += spatium() * 1.5;
+            sp.shape = spatium() * 1.5;
       else if (st == Segment::Type::Ambitus)
-            w += score()->styleP(StyleIdx::ambitusMargin);
+            sp.shape = score()->styleP(StyleIdx::ambitusMargin);
+
+      if (ns)
+            sp.extra = ns->extraLeadingSpace().val() * spatium();
+      return sp;
+      }
+
+//---------------------------------------------------------
+//   minHorizontalDistance
+//---------------------------------------------------------
 
+qreal Segment::minHorizontalDistance(Segment* ns, bool systemHeaderGap) const
+      {
+      SegmentSpacing sp = spacing(ns, systemHeaderGap);
+
+      qreal w = sp.min;
+      if (sp.shape > -1000000.0) {
+            qreal d = 0.0;
+            for (unsigned staffIdx = 0; staffIdx < _shapes.size(); ++staffIdx)
+                  d = qMax(d, staffShape(staffIdx).minHorizontalDistance(ns->staffShape(staffIdx)));
+            w = qMax(w, d + sp.shape);
+            }
+      if (sp.right > -1000000.0)
+            w = qMax(w, minRight() + sp.right);
       if (w < 0.0)
             w = 0.0;
-      if (ns)
-            w += ns->extraLeadingSpace().val() * spatium();
-      return w;
+      return w + sp.extra;
       }
 
 }           // namespace Ms
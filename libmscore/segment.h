@@ -30,6 +30,21 @@ class ChordRest;
 class Spanner;
 class System;
 
+//---------------------------------------------------------
+//   SegmentSpacing
+//    The distance of a segment to the next one is
+//       max(shape distance + shape, minRight() + right, min)
+//    but at least 0, plus extra. The shape distance is at
+//    least 0. Terms which do not apply are -1000000.
+//---------------------------------------------------------
+
+struct SegmentSpacing {
+      qreal shape { -1000000.0 };
+      qreal right { -1000000.0 };
+      qreal min   { -1000000.0 };
+      qreal extra { 0.0 };
+      };
+
 //------------------------------------------------------------------------
 //   @@ Segment
 ///    A segment holds all vertical aligned staff elements.
@@ -240,7 +255,9 @@ class Segment : public Element {
       qreal minRight() const;
       qreal minLeft(const Shape&) const;
       qreal minLeft() const;
+      SegmentSpacing spacing(Segment*, bool isSystemGap) const;
       qreal minHorizontalDistance(Segment*, bool isSystemGap) const;
+      bool isGap() const;
 
       // some helper function
       ChordRest* cr(int track) const        { return toChordRest(_elist[track]); }
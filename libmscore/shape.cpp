@@ -76,6 +76,202 @@ qreal Shape::minHorizontalDistance(const Shape& a) const
       return dist;
       }
 
+//---------------------------------------------------------
+//   Skyline::clear
+//---------------------------------------------------------
+
+void Skyline::clear()
+      {
+      _pieces.clear();
+      _lines.clear();
+      _full = Edge();
+      _all  = Edge();
+      }
+
+//---------------------------------------------------------
+//   Skyline::split
+//    make y the start of a piece
+//---------------------------------------------------------
+
+void Skyline::split(qreal y)
+      {
+      auto i = _pieces.upper_bound(y);
+      if (i == _pieces.begin())
+            _pieces.insert(i, std::make_pair(y, Edge()));
+      else {
+            --i;
+            if (i->first != y)
+                  _pieces.insert(std::next(i), std::make_pair(y, i->second));
+            }
+      }
+
+//---------------------------------------------------------
+//   Skyline::add
+//    add shape s placed at x, the right edges are owned
+//    by segment
+//---------------------------------------------------------
+
+void Skyline::add(const Shape& s, qreal x, const Segment* segment)
+      {
+      for (const QRectF& r : s) {
+            qreal right = r.right() + x;
+            _all.raise(right, segment);
+            if (r.width() == 0.0)
+                  _full.raise(right, segment);
+            else if (r.height() == 0.0)
+                  _lines[r.top()].raise(right, segment);
+            else {
+                  split(r.top());
+                  split(r.bottom());
+                  for (auto i = _pieces.find(r.top()); i->first < r.bottom(); ++i)
+                        i->second.raise(right, segment);
+                  }
+            }
+      }
+
+//---------------------------------------------------------
+//   Skyline::minPosition
+//    return the minimum x position of shape s so that it
+//    does not collide with the skyline, and the segment
+//    which determines it
+//---------------------------------------------------------
+
+Skyline::Edge Skyline::minPosition(const Shape& s) const
+      {
+      Edge e;
+      for (const QRectF& r : s) {
+            qreal left = r.left();
+            if (r.width() == 0.0) {
+                  e.raise(_all.x - left, _all.segment);
+                  continue;
+                  }
+            e.raise(_full.x - left, _full.segment);
+            if (r.height() == 0.0) {
+                  auto i = _lines.find(r.top());
+                  if (i != _lines.end())
+                        e.raise(i->second.x - left, i->second.segment);
+                  continue;
+                  }
+            auto i = _pieces.upper_bound(r.top());
+            if (i != _pieces.begin())
+                  --i;
+            for (; i != _pieces.end() && i->first < r.bottom(); ++i)
+                  e.raise(i->second.x - left, i->second.segment);
+            }
+      return e;
+      }
+
+//---------------------------------------------------------
+//   SkylineLine::split
+//    make x the start of a piece
+//---------------------------------------------------------
+
+void SkylineLine::split(qreal x)
+      {
+      auto i = _pieces.upper_bound(x);
+      if (i == _pieces.begin())
+            _pieces.insert(i, std::make_pair(x, emptyValue()));
+      else {
+            --i;
+            if (i->first != x)
+                  _pieces.insert(std::next(i), std::make_pair(x, i->second));
+            }
+      }
+
+//---------------------------------------------------------
+//   SkylineLine::add
+//---------------------------------------------------------
+
+void SkylineLine::add(const QRectF& r)
+      {
+      if (r.width() == 0.0)
+            return;
+      split(r.left());
+      split(r.right());
+      for (auto i = _pieces.find(r.left()); i->first < r.right(); ++i) {
+            if (_north)
+                  i->second = qMin(i->second, r.top());
+            else
+                  i->second = qMax(i->second, r.bottom());
+            }
+      }
+
+void SkylineLine::add(const Shape& s)
+      {
+      for (const QRectF& r : s)
+            add(r);
+      }
+
+//---------------------------------------------------------
+//   SkylineLine::minDistance
+//    this is a south line, sl the north line of shapes
+//    located below. Calculates the minimum vertical
+//    distance like Shape::minVerticalDistance(), only
+//    between x1 and x2.
+//---------------------------------------------------------
+
+qreal SkylineLine::minDistance(const SkylineLine& sl, qreal x1, qreal x2) const
+      {
+      Q_ASSERT(!_north && sl._north);
+      qreal dist   = -1000000.0;      // min real
+      qreal bottom = emptyValue();
+      qreal top    = sl.emptyValue();
+      auto i = _pieces.upper_bound(x1);
+      if (i != _pieces.begin())
+            --i;
+      auto k = sl._pieces.upper_bound(x1);
+      if (k != sl._pieces.begin())
+            --k;
+      while (i != _pieces.end() && k != sl._pieces.end()) {
+            qreal x;
+            if (i->first <= k->first) {
+                  x = i->first;
+                  if (i->first == k->first)
+                        top = (k++)->second;
+                  bottom = (i++)->second;
+                  }
+            else {
+                  x = k->first;
+                  top = (k++)->second;
+                  }
+            if (x >= x2)
+                  break;
+            // the piece starting at x ends at the next key of either line
+            qreal next = 1000000.0;
+            if (i != _pieces.end())
+                  next = i->first;
+            if (k != sl._pieces.end())
+                  next = qMin(next, k->first);
+            if (next > x1 && bottom != emptyValue() && top != sl.emptyValue())
+                  dist = qMax(dist, bottom - top);
+            }
+      return dist;
+      }
+
+//---------------------------------------------------------
+//   SkylineLine::minDistance
+//    s is located above a north line or below a south
+//    line
+//---------------------------------------------------------
+
+qreal SkylineLine::minDistance(const Shape& s) const
+      {
+      qreal dist = -1000000.0;      // min real
+      for (const QRectF& r : s) {
+            if (r.width() == 0.0)
+                  continue;
+            auto i = _pieces.upper_bound(r.left());
+            if (i != _pieces.begin())
+                  --i;
+            for (; i != _pieces.end() && i->first < r.right(); ++i) {
+                  if (i->second == emptyValue())
+                        continue;
+                  dist = qMax(dist, _north ? r.bottom() - i->second : i->second - r.top());
+                  }
+            }
+      return dist;
+      }
+
 //-------------------------------------------------------------------
 //   minVerticalDistance
 //    a is located below of this shape.
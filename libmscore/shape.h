@@ -26,6 +26,9 @@ class Segment;
 //---------------------------------------------------------
 
 class Shape : std::vector<QRectF> {
+      friend class Skyline;
+      friend class SkylineLine;
+
    public:
       Shape() {}
       Shape(const QRectF& r) { add(r); }
@@ -59,6 +62,65 @@ class Shape : std::vector<QRectF> {
 #endif
       };
 
+//---------------------------------------------------------
+//   Skyline
+//    Right edge profile of shapes placed one after another,
+//    used for the horizontal spacing of segments. The profile
+//    is a piecewise constant function of y; adding a shape
+//    raises the pieces it covers and a lookup only visits the
+//    pieces overlapping a rectangle. Rectangles collide like
+//    in Shape::minHorizontalDistance(): zero width ones at
+//    any y, zero height ones only with other zero height
+//    rectangles at the same y.
+//---------------------------------------------------------
+
+class Skyline {
+   public:
+      struct Edge {
+            qreal x                { -1000000.0 };    // min real
+            const Segment* segment { 0 };             // owner of the edge
+            void raise(qreal v, const Segment* s) { if (s && v > x) { x = v; segment = s; } }
+            };
+
+   private:
+      std::map<qreal, Edge> _pieces;      // piece starts at key and ends at the next key
+      std::map<qreal, Edge> _lines;       // zero height rectangles
+      Edge _full;                         // zero width rectangles
+      Edge _all;
+
+      void split(qreal y);
+
+   public:
+      void clear();
+      void add(const Shape&, qreal x, const Segment*);
+      Edge minPosition(const Shape&) const;
+      };
+
+//---------------------------------------------------------
+//   SkylineLine
+//    North (top) or south (bottom) outline of shapes as a
+//    piecewise constant function of x, used for vertical
+//    distances. Rectangles overlap like in
+//    Shape::minVerticalDistance(): zero width ones never.
+//---------------------------------------------------------
+
+class SkylineLine {
+      bool _north;
+      std::map<qreal, qreal> _pieces;     // piece starts at key and ends at the next key
+
+      qreal emptyValue() const { return _north ? 1000000.0 : -1000000.0; }
+      void split(qreal x);
+
+   public:
+      SkylineLine(bool north) : _north(north) {}
+      bool north() const { return _north; }
+      void clear()       { _pieces.clear(); }
+      void add(const QRectF&);
+      void add(const Shape&);
+      qreal minDistance(const SkylineLine&, qreal x1 = -1000000.0, qreal x2 = 1000000.0) const;
+      qreal minDistance(const Shape&) const;
+      };
+
 //---------------------------------------------------------
 //   intersects
 //---------------------------------------------------------
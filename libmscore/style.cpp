@@ -1227,6 +1227,15 @@ const char* MStyle::valueType(const StyleIdx i)
       return styleTypes[int(i)].valueType();
       }
 
+//---------------------------------------------------------
+//   valueTypeId
+//---------------------------------------------------------
+
+int MStyle::valueTypeId(const StyleIdx i)
+      {
+      return styleTypes[int(i)].defaultValue().userType();
+      }
+
 //---------------------------------------------------------
 //   valueName
 //---------------------------------------------------------
@@ -1258,7 +1267,7 @@ MStyle::MStyle()
       _customChordList = false;
       for (const StyleType& t : styleTypes)
             _values[t.idx()] = t.defaultValue();
-      //precomputeValues();
+      precomputeValues();
       };
 
 //---------------------------------------------------------
@@ -1267,10 +1276,39 @@ MStyle::MStyle()
 
 void MStyle::precomputeValues()
       {
-      qreal _spatium = value(StyleIdx::spatium).toDouble();
-      for (const StyleType& t : styleTypes) {
-            if (!strcmp(t.valueType(), "Ms::Spatium"))
-                  _precomputedValues[t.idx()] = _values[t.idx()].value<Spatium>().val() * _spatium;
+      precomputeValue(StyleIdx::spatium);
+      for (const StyleType& t : styleTypes)
+            precomputeValue(t.styleIdx());
+      }
+
+//---------------------------------------------------------
+//   precomputeValue
+//    update the typed copies of one value; values are
+//    converted like the QVariant of the declared type
+//    would be. Spatium values depend on the spatium,
+//    which must be up to date.
+//---------------------------------------------------------
+
+void MStyle::precomputeValue(StyleIdx i)
+      {
+      const int idx     = int(i);
+      const QVariant& v = _values[idx];
+      const int type    = styleTypes[idx].defaultValue().userType();
+      if (type == qMetaTypeId<Spatium>()) {
+            qreal val               = v.value<Spatium>().val();
+            _doubleValues[idx]      = val;
+            _intValues[idx]         = 0;
+            _precomputedValues[idx] = val * _doubleValues[int(StyleIdx::spatium)];
+            }
+      else if (type == QMetaType::Double || type == QMetaType::Int || type == QMetaType::Bool) {
+            _doubleValues[idx]      = v.toDouble();
+            _intValues[idx]         = type == QMetaType::Bool ? int(v.toBool()) : v.toInt();
+            _precomputedValues[idx] = 0.0;
+            }
+      else {
+            _doubleValues[idx]      = 0.0;
+            _intValues[idx]         = 0;
+            _precomputedValues[idx] = 0.0;
             }
       }
 
@@ -1312,16 +1350,11 @@ void MStyle::setChordList(ChordList* cl, bool custom)
 
 void MStyle::set(const StyleIdx t, const QVariant& val)
       {
-      const int idx = int(t);
-      _values[idx] = val;
+      _values[int(t)] = val;
       if (t == StyleIdx::spatium)
             precomputeValues();
-      else {
-            if (!strcmp(styleTypes[idx].valueType(), "Ms::Spatium")) {
-                  qreal _spatium = value(StyleIdx::spatium).toDouble();
-                  _precomputedValues[idx] = _values[idx].value<Spatium>().val() * _spatium;
-                  }
-            }
+      else
+            precomputeValue(t);
       }
 
 //---------------------------------------------------------
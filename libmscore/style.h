@@ -740,7 +740,12 @@ enum class SubStyle {
 
 class MStyle {
       std::array<QVariant, int(StyleIdx::STYLES)> _values;
-      std::array<qreal, int(StyleIdx::STYLES)> _precomputedValues;
+
+      // typed copies of _values for the accessors used during
+      // layout, updated by set()
+      std::array<qreal, int(StyleIdx::STYLES)> _precomputedValues;    // Spatium values in points
+      std::array<qreal, int(StyleIdx::STYLES)> _doubleValues;         // double, int, bool, Spatium
+      std::array<int, int(StyleIdx::STYLES)> _intValues;              // int, bool
 
       ChordList _chordList;
       bool _customChordList;        // if true, chordlist will be saved as part of score
@@ -749,8 +754,11 @@ class MStyle {
       MStyle();
 
       void precomputeValues();
+      void precomputeValue(StyleIdx idx);
       QVariant value(StyleIdx idx) const  { return _values[int(idx)]; }
       qreal pvalue(StyleIdx idx) const    { return _precomputedValues[int(idx)]; }
+      qreal dvalue(StyleIdx idx) const    { return _doubleValues[int(idx)]; }
+      int ivalue(StyleIdx idx) const      { return _intValues[int(idx)]; }
       void set(StyleIdx idx, const QVariant& v);
 
       bool isDefault(StyleIdx idx) const;
@@ -766,6 +774,7 @@ class MStyle {
       bool readProperties(XmlReader&);
 
       static const char* valueType(const StyleIdx);
+      static int valueTypeId(const StyleIdx);
       static const char* valueName(const StyleIdx);
       static StyleIdx styleIdx(const QString& name);
       };
@@ -41,6 +41,7 @@ QVector<ScoreFont> ScoreFont::_scoreFonts {
       };
 
 QJsonObject ScoreFont::_glyphnamesJson;
+QString ScoreFont::_metricsCachePath;
 
 //---------------------------------------------------------
 //   table of symbol names
@@ -5598,13 +5599,249 @@ SymId Sym::userName2id(const QString& s)
       }
 
 //---------------------------------------------------------
-//   GlyphKey operator==
+//   GlyphAtlas::Page
 //---------------------------------------------------------
 
-bool GlyphKey::operator==(const GlyphKey& k) const
+static const int ATLAS_PAGE_SIZE = 512;
+
+struct GlyphAtlas::Page {
+      QImage alpha;                                   // Format_Alpha8
+      struct Shelf {
+            int y, height, x;
+            };
+      std::vector<Shelf> shelves;
+
+      Page(const QSize& size) : alpha(size, QImage::Format_Alpha8) {
+            alpha.fill(0);
+            }
+      int memory() const { return alpha.byteCount(); }
+      };
+
+//---------------------------------------------------------
+//   tint
+//    fill dst with color, using the coverage of rect r
+//    of alpha as alpha channel
+//---------------------------------------------------------
+
+static void tint(QImage* dst, const QImage& alpha, QRgb color, const QRect& r)
       {
-      return (face == k.face) && (id == k.id)
-         && (mag == k.mag) && (worldScale == k.worldScale) && (color == k.color);
+      QPainter p(dst);
+      p.setCompositionMode(QPainter::CompositionMode_Source);
+      p.fillRect(dst->rect(), QColor(color));
+      p.setCompositionMode(QPainter::CompositionMode_DestinationIn);
+      p.drawImage(QPoint(0, 0), alpha, r);
+      }
+
+//---------------------------------------------------------
+//   instance
+//---------------------------------------------------------
+
+GlyphAtlas* GlyphAtlas::instance()
+      {
+      static GlyphAtlas atlas;
+      return &atlas;
+      }
+
+GlyphAtlas::~GlyphAtlas()
+      {
+      clear();
+      }
+
+//---------------------------------------------------------
+//   clear
+//---------------------------------------------------------
+
+void GlyphAtlas::clear()
+      {
+      QMutexLocker locker(&_mutex);
+      glyphs.clear();
+      tints.clear();
+      tintLru.clear();
+      qDeleteAll(pages);
+      pages.clear();
+      _memory = 0;
+      }
+
+//---------------------------------------------------------
+//   setBudget
+//---------------------------------------------------------
+
+void GlyphAtlas::setBudget(int bytes)
+      {
+      QMutexLocker locker(&_mutex);
+      _budget = bytes;
+      shrink(0);
+      }
+
+//---------------------------------------------------------
+//   find
+//---------------------------------------------------------
+
+bool GlyphAtlas::find(const Key& key, Glyph* glyph)
+      {
+      auto i = glyphs.constFind(key);
+      if (i == glyphs.constEnd()) {
+            ++_misses;
+            return false;
+            }
+      ++_hits;
+      *glyph = i.value();
+      return true;
+      }
+
+//---------------------------------------------------------
+//   allocate
+//    find space for a glyph of the given size on a page,
+//    shelf packed; glyphs larger than a page get a page
+//    of their own
+//---------------------------------------------------------
+
+GlyphAtlas::Page* GlyphAtlas::allocate(const QSize& size, QRect* r)
+      {
+      int w = size.width() + 1;           // one pixel padding
+      int h = size.height() + 1;
+      if (w > ATLAS_PAGE_SIZE || h > ATLAS_PAGE_SIZE) {
+            Page* page = new Page(size);
+            pages.push_front(page);
+            _memory += page->memory();
+            *r = QRect(QPoint(0, 0), size);
+            return page;
+            }
+      for (Page* page : pages) {
+            if (page->alpha.width() != ATLAS_PAGE_SIZE || page->alpha.height() != ATLAS_PAGE_SIZE)
+                  continue;
+            // use an existing shelf if it does not waste too much space
+            for (Page::Shelf& shelf : page->shelves) {
+                  if (h <= shelf.height && h * 3 >= shelf.height * 2 && shelf.x + w <= ATLAS_PAGE_SIZE) {
+                        *r = QRect(QPoint(shelf.x, shelf.y), size);
+                        shelf.x += w;
+                        return page;
+                        }
+                  }
+            int y = page->shelves.empty() ? 0 : page->shelves.back().y + page->shelves.back().height;
+            if (y + h <= ATLAS_PAGE_SIZE) {
+                  page->shelves.push_back({ y, h, w });
+                  *r = QRect(QPoint(0, y), size);
+                  return page;
+                  }
+            }
+      Page* page = new Page(QSize(ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE));
+      pages.push_front(page);
+      _memory += page->memory();
+      page->shelves.push_back({ 0, h, w });
+      *r = QRect(QPoint(0, 0), size);
+      return page;
+      }
+
+//---------------------------------------------------------
+//   insert
+//    store the coverage of a rendered glyph
+//---------------------------------------------------------
+
+GlyphAtlas::Glyph GlyphAtlas::insert(const Key& key, const FT_Bitmap* bm, int left, int top)
+      {
+      Glyph glyph;
+      if (bm->width > 0 && bm->rows > 0) {
+            glyph.page   = allocate(QSize(bm->width, bm->rows), &glyph.rect);
+            glyph.offset = QPoint(left, -top);
+            Page* page   = glyph.page;
+            for (int y = 0; y < int(bm->rows); ++y) {
+                  const unsigned char* src = bm->buffer + bm->pitch * y;
+                  memcpy(page->alpha.scanLine(glyph.rect.y() + y) + glyph.rect.x(), src, bm->width);
+                  }
+            shrink(page);
+            }
+      glyphs.insert(key, glyph);
+      return glyph;
+      }
+
+//---------------------------------------------------------
+//   tinted
+//    return the glyph colored with color, an image of the
+//    size of the glyph
+//---------------------------------------------------------
+
+QImage GlyphAtlas::tinted(const Glyph& glyph, QRgb color)
+      {
+      TintKey key { glyph.page, glyph.rect.topLeft(), color };
+      auto i = tints.find(key);
+      if (i != tints.end()) {
+            tintLru.splice(tintLru.begin(), tintLru, i.value().lru);
+            return i.value().image;
+            }
+      QImage img(glyph.rect.size(), QImage::Format_ARGB32_Premultiplied);
+      tint(&img, glyph.page->alpha, color, glyph.rect);
+      tintLru.push_front(key);
+      tints.insert(key, Tint { img, tintLru.begin() });
+      _memory += img.byteCount();
+      shrink(glyph.page);
+      return img;
+      }
+
+//---------------------------------------------------------
+//   removeTint
+//---------------------------------------------------------
+
+void GlyphAtlas::removeTint(TintKey key)
+      {
+      auto i = tints.find(key);
+      _memory -= i.value().image.byteCount();
+      tintLru.erase(i.value().lru);
+      tints.erase(i);
+      }
+
+//---------------------------------------------------------
+//   removePage
+//---------------------------------------------------------
+
+void GlyphAtlas::removePage(Page* page)
+      {
+      for (auto i = tintLru.begin(); i != tintLru.end();) {
+            TintKey key = *i++;
+            if (key.page == page)
+                  removeTint(key);
+            }
+      for (auto i = glyphs.begin(); i != glyphs.end();) {
+            if (i.value().page == page)
+                  i = glyphs.erase(i);
+            else
+                  ++i;
+            }
+      _memory -= page->memory();
+      pages.remove(page);
+      delete page;
+      }
+
+//---------------------------------------------------------
+//   shrink
+//    free memory until the budget is met; the least
+//    recently used colored glyphs go first, then the least
+//    recently used pages. The page keep is not touched.
+//---------------------------------------------------------
+
+void GlyphAtlas::shrink(Page* keep)
+      {
+      while (_memory > _budget && !tintLru.empty())
+            removeTint(tintLru.back());
+      while (_memory > _budget && !pages.empty() && pages.back() != keep)
+            removePage(pages.back());
+      }
+
+//---------------------------------------------------------
+//   image
+//    return a shallow copy of glyph colored with color; it
+//    stays valid when the glyph is evicted, so it can be
+//    painted without holding the lock
+//---------------------------------------------------------
+
+QImage GlyphAtlas::image(const Glyph& glyph, QRgb color)
+      {
+      Page* page = glyph.page;
+      if (pages.front() != page) {
+            pages.remove(page);
+            pages.push_front(page);
+            }
+      return tinted(glyph, color);
       }
 
 //---------------------------------------------------------
@@ -5630,13 +5867,8 @@ void ScoreFont::draw(SymId id, QPainter* painter, qreal mag, const QPointF& pos,
                   qDebug("ScoreFont::draw: invalid sym %d", int(id));
             return;
             }
-      int rv = FT_Load_Glyph(face, sym(id).index(), FT_LOAD_DEFAULT);
-      if (rv) {
-            qDebug("load glyph id %d, failed: 0x%x", int(id), rv);
-            return;
-            }
 
-      if (MScore::pdfPrinting) {
+      if (MScore::pdfPrinting()) {
             if (font == 0) {
                   QString s(_fontPath+_filename);
                   if (-1 == QFontDatabase::addApplicationFont(s)) {
@@ -5649,7 +5881,7 @@ void ScoreFont::draw(SymId id, QPainter* painter, qreal mag, const QPointF& pos,
                   font->setFamily(_family);
                   font->setStyleStrategy(QFont::NoFontMerging);
                   font->setHintingPreference(QFont::PreferVerticalHinting);
-                  qreal size = 20.0 * MScore::pixelRatio;
+                  qreal size = 20.0 * MScore::pixelRatio();
                   font->setPointSize(size);
                   }
             qreal imag = 1.0 / mag;
@@ -5660,8 +5892,6 @@ void ScoreFont::draw(SymId id, QPainter* painter, qreal mag, const QPointF& pos,
             return;
             }
 
-      QColor color(painter->pen().color());
-
       int pr           = painter->device()->devicePixelRatio();
       qreal pixelRatio = qreal(pr > 0 ? pr : 1);
       worldScale      *= pixelRatio;
@@ -5669,51 +5899,45 @@ void ScoreFont::draw(SymId id, QPainter* painter, qreal mag, const QPointF& pos,
 //            worldScale = 1.0;
       int scale16      = lrint(worldScale * 6553.6 * mag * DPI_F);
 
-      GlyphKey gk(face, id, mag, worldScale, color);
-      GlyphPixmap* pm = cache->object(gk);
-      if (!pm) {
+      GlyphAtlas* atlas = GlyphAtlas::instance();
+      GlyphAtlas::Key key { face, id, scale16 };
+      GlyphAtlas::Glyph glyph;
+      QImage img;
+      QMutexLocker locker(atlas->mutex());
+      if (!atlas->find(key, &glyph)) {
+            int rv = FT_Load_Glyph(face, sym(id).index(), FT_LOAD_DEFAULT);
+            if (rv) {
+                  qDebug("load glyph id %d, failed: 0x%x", int(id), rv);
+                  return;
+                  }
             FT_Matrix matrix {
                   scale16, 0,
                   0,       scale16
                   };
 
-            FT_Glyph glyph;
-            FT_Get_Glyph(face->glyph, &glyph);
-            FT_Glyph_Transform(glyph, &matrix, 0);
-            rv = FT_Glyph_To_Bitmap(&glyph, FT_RENDER_MODE_NORMAL, 0, 1);
+            FT_Glyph ftGlyph;
+            FT_Get_Glyph(face->glyph, &ftGlyph);
+            FT_Glyph_Transform(ftGlyph, &matrix, 0);
+            rv = FT_Glyph_To_Bitmap(&ftGlyph, FT_RENDER_MODE_NORMAL, 0, 1);
             if (rv) {
                   qDebug("glyph to bitmap failed: 0x%x", rv);
                   return;
                   }
 
-            FT_BitmapGlyph gb = (FT_BitmapGlyph)glyph;
-            FT_Bitmap* bm     = &gb->bitmap;
-
-            if (bm->width == 0 || bm->rows == 0) {
+            FT_BitmapGlyph gb = (FT_BitmapGlyph)ftGlyph;
+            if (gb->bitmap.width == 0 || gb->bitmap.rows == 0)
                   qDebug("zero glyph");
-                  return;
-                  }
-            QImage img(QSize(bm->width, bm->rows), QImage::Format_ARGB32);
-            img.fill(Qt::transparent);
-
-            for (int y = 0; y < int(bm->rows); ++y) {
-                  unsigned* dst      = (unsigned*)img.scanLine(y);
-                  unsigned char* src = (unsigned char*)(bm->buffer) + bm->pitch * y;
-                  for (int x = 0; x < int(bm->width); ++x) {
-                        unsigned val = *src++;
-                        color.setAlpha(val);
-                        *dst++ = color.rgba();
-                        }
-                  }
-            pm = new GlyphPixmap;
-            pm->pm = QPixmap::fromImage(img, Qt::NoFormatConversion);
-            pm->pm.setDevicePixelRatio(worldScale);
-            pm->offset = QPointF(qreal(gb->left), -qreal(gb->top)) / worldScale;
-            if (!cache->insert(gk, pm))
-                  qDebug("cannot cache glyph");
-            FT_Done_Glyph(glyph);
+            glyph = atlas->insert(key, &gb->bitmap, gb->left, gb->top);
+            FT_Done_Glyph(ftGlyph);
             }
-      painter->drawPixmap(pos + pm->offset, pm->pm);
+      if (!glyph.page)
+            return;
+      // the glyph coverage replaces the alpha of the pen color
+      img = atlas->image(glyph, painter->pen().color().rgb());
+      locker.unlock();
+
+      QRectF r(pos + QPointF(glyph.offset) / worldScale, QSizeF(glyph.rect.size()) / worldScale);
+      painter->drawImage(r, img);
       }
 
 void ScoreFont::draw(SymId id, QPainter* painter, qreal mag, const QPointF& pos, int n) const
@@ -5755,7 +5979,6 @@ const char* Sym::id2name(SymId id)
 
 void initScoreFonts()
       {
-      ScoreFont::initGlyphNamesJson();
       int error = FT_Init_FreeType(&ftlib);
       if (!ftlib || error)
             qFatal("init freetype library failed");
@@ -5820,28 +6043,13 @@ void ScoreFont::computeMetrics(Sym* sym, int code)
       }
 
 //---------------------------------------------------------
-//   load
+//   computeSymbolMetrics
+//    get symbol metrics from the font, glyphnames.json and
+//    the metadata of the font
 //---------------------------------------------------------
 
-void ScoreFont::load()
+void ScoreFont::computeSymbolMetrics(const QByteArray& metadata)
       {
-      QString facePath = _fontPath + _filename;
-      QFile f(facePath);
-      if (!f.open(QIODevice::ReadOnly)) {
-            qDebug("ScoreFont::load(): open failed <%s>", qPrintable(facePath));
-            return;
-            }
-      fontImage = f.readAll();
-      int rval = FT_New_Memory_Face(ftlib, (FT_Byte*)fontImage.data(), fontImage.size(), 0, &face);
-      if (rval) {
-            qDebug("freetype: cannot create face <%s>: %d", qPrintable(facePath), rval);
-            return;
-            }
-      cache = new QCache<GlyphKey, GlyphPixmap>(100);
-
-      qreal pixelSize = 200.0;
-      FT_Set_Pixel_Sizes(face, 0, int(pixelSize+.5));
-
       for (auto i : ScoreFont::glyphNamesJson().keys()) {
             bool ok;
             int code = ScoreFont::glyphNamesJson().value(i).toObject().value("codepoint").toString().mid(2).toInt(&ok, 16);
@@ -5857,12 +6065,9 @@ void ScoreFont::load()
             }
 
       QJsonParseError error;
-      QFile fi(_fontPath + "metadata.json");
-      if (!fi.open(QIODevice::ReadOnly))
-            qDebug("ScoreFont: open glyph metadata file <%s> failed", qPrintable(fi.fileName()));
-      QJsonObject metadataJson = QJsonDocument::fromJson(fi.readAll(), &error).object();
+      QJsonObject metadataJson = QJsonDocument::fromJson(metadata, &error).object();
       if (error.error != QJsonParseError::NoError)
-            qDebug("Json parse error in <%s>(offset: %d): %s", qPrintable(fi.fileName()),
+            qDebug("Json parse error in <%s>(offset: %d): %s", qPrintable(_fontPath + "metadata.json"),
                error.offset, qPrintable(error.errorString()));
 
       QJsonObject oo = metadataJson.value("glyphsWithAnchors").toObject();
@@ -5943,85 +6148,6 @@ void ScoreFont::load()
                         _textEnclosureThickness = oo.value(i).toDouble();
                   }
             }
-      _engravingDefaults.push_back(std::make_pair(StyleIdx::MusicalTextFont, QString("%1 Text").arg(_family)));
-
-      // create missing composed glyphs
-      struct Composed {
-            SymId id;
-            std::vector<SymId> rids;
-            } composed[] = {
-
-            { SymId::ornamentPrallMordent,
-                  {
-                  SymId::ornamentZigZagLineNoRightEnd,
-                  SymId::ornamentZigZagLineNoRightEnd,
-                  SymId::ornamentMiddleVerticalStroke,
-                  SymId::ornamentZigZagLineWithRightEnd
-                  } },
-            { SymId::ornamentUpPrall,
-                  {
-                  SymId::ornamentBottomLeftConcaveStroke,
-                  SymId::ornamentZigZagLineNoRightEnd,
-                  SymId::ornamentZigZagLineNoRightEnd,
-                  SymId::ornamentZigZagLineWithRightEnd
-                  }},
-            { SymId::ornamentUpMordent,
-                  {
-                  SymId::ornamentBottomLeftConcaveStroke,
-                  SymId::ornamentZigZagLineNoRightEnd,
-                  SymId::ornamentZigZagLineNoRightEnd,
-                  SymId::ornamentMiddleVerticalStroke,
-                  SymId::ornamentZigZagLineWithRightEnd
-                  }},
-            { SymId::ornamentPrallDown,
-                  {
-                  SymId::ornamentZigZagLineNoRightEnd,
-                  SymId::ornamentZigZagLineNoRightEnd,
-                  SymId::ornamentZigZagLineNoRightEnd,
-                  SymId::ornamentBottomRightConcaveStroke,
-                  }},
-            { SymId::ornamentDownPrall,
-                  {
-                  SymId::ornamentLeftVerticalStroke,
-                  SymId::ornamentZigZagLineNoRightEnd,
-                  SymId::ornamentZigZagLineNoRightEnd,
-                  SymId::ornamentZigZagLineWithRightEnd
-                  }},
-            { SymId::ornamentDownMordent,
-                  {
-                  SymId::ornamentLeftVerticalStroke,
-                  SymId::ornamentZigZagLineNoRightEnd,
-                  SymId::ornamentZigZagLineNoRightEnd,
-                  SymId::ornamentMiddleVerticalStroke,
-                  SymId::ornamentZigZagLineWithRightEnd
-                  }},
-            { SymId::ornamentPrallUp,
-                  {
-                  SymId::ornamentZigZagLineNoRightEnd,
-                  SymId::ornamentZigZagLineNoRightEnd,
-                  SymId::ornamentZigZagLineNoRightEnd,
-                  SymId::ornamentTopRightConvexStroke,
-                  }},
-            { SymId::ornamentLinePrall,
-                  {
-                  SymId::ornamentLeftVerticalStroke,
-                  SymId::ornamentZigZagLineNoRightEnd,
-                  SymId::ornamentZigZagLineNoRightEnd,
-                  SymId::ornamentZigZagLineWithRightEnd
-                  }}
-            };
-
-      for (const Composed& c : composed) {
-            if (!_symbols[int(c.id)].isValid()) {
-                  Sym* sym = &_symbols[int(c.id)];
-                  std::vector<SymId> s;
-                  for (SymId id : c.rids)
-                        s.push_back(id);
-                  sym->setSymList(s);
-                  sym->setBbox(bbox(s, 1.0));
-                  }
-            }
-
       // access needed stylistic alternates
 
       struct StylisticAlternate {
@@ -6116,6 +6242,313 @@ void ScoreFont::load()
       // add space symbol
       Sym* sym = &_symbols[int(SymId::space)];
       computeMetrics(sym, 32);
+      }
+
+//---------------------------------------------------------
+//   symbol metrics cache
+//    The metrics computed by computeSymbolMetrics() are
+//    stored in a binary file per font, which is mapped
+//    into memory on the next start. The file is valid as
+//    long as its key matches the hash of the font, its
+//    metadata and glyphnames.json.
+//---------------------------------------------------------
+
+static const char METRICS_MAGIC[4] = { 'M', 'S', 'F', 'M' };
+static const quint32 METRICS_VERSION = 1;
+
+struct MetricsHeader {
+      char magic[4];
+      quint32 version;
+      char key[20];                 // sha1
+      quint32 symbols;              // number of MetricsSymbol records
+      quint32 defaults;             // number of MetricsDefault records
+      double textEnclosureThickness;
+      };
+
+struct MetricsSymbol {
+      qint32 id;
+      qint32 code;
+      quint32 index;
+      qint32 reserved;
+      double bbox[4];               // x, y, width, height
+      double advance;
+      double anchors[12];           // stemDownNW, stemUpSE, cutOutNE, cutOutNW, cutOutSE, cutOutSW
+      };
+
+struct MetricsDefault {
+      qint32 idx;                   // StyleIdx
+      qint32 reserved;
+      double value;
+      };
+
+//---------------------------------------------------------
+//   metricsCachePath
+//---------------------------------------------------------
+
+QString ScoreFont::metricsCachePath()
+      {
+      if (_metricsCachePath.isNull()) {
+            QString path = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+            _metricsCachePath = path.isEmpty() ? QString("") : path + "/fontmetrics";
+            }
+      return _metricsCachePath;
+      }
+
+//---------------------------------------------------------
+//   metricsCacheFile
+//---------------------------------------------------------
+
+QString ScoreFont::metricsCacheFile() const
+      {
+      QString path = metricsCachePath();
+      if (path.isEmpty())
+            return QString();
+      return path + "/" + _name + ".metrics";
+      }
+
+//---------------------------------------------------------
+//   metricsKey
+//---------------------------------------------------------
+
+QByteArray ScoreFont::metricsKey(const QByteArray& metadata) const
+      {
+      QCryptographicHash h(QCryptographicHash::Sha1);
+      h.addData(fontImage);
+      h.addData(metadata);
+      QFile fi(":fonts/smufl/glyphnames.json");
+      if (fi.open(QIODevice::ReadOnly))
+            h.addData(&fi);
+      return h.result();
+      }
+
+//---------------------------------------------------------
+//   readMetricsCache
+//    return false if there is no valid cache file
+//---------------------------------------------------------
+
+bool ScoreFont::readMetricsCache(const QByteArray& key)
+      {
+      QString fn = metricsCacheFile();
+      if (fn.isEmpty())
+            return false;
+      QFile f(fn);
+      if (!f.open(QIODevice::ReadOnly) || f.size() < qint64(sizeof(MetricsHeader)))
+            return false;
+      qint64 size = f.size();
+      const uchar* data = f.map(0, size);
+      if (!data)
+            return false;
+
+      MetricsHeader h;
+      memcpy(&h, data, sizeof(h));
+      if (memcmp(h.magic, METRICS_MAGIC, sizeof(h.magic)) || h.version != METRICS_VERSION
+         || key.size() != int(sizeof(h.key)) || memcmp(h.key, key.constData(), sizeof(h.key))
+         || size != qint64(sizeof(MetricsHeader) + h.symbols * sizeof(MetricsSymbol) + h.defaults * sizeof(MetricsDefault))) {
+            f.unmap(const_cast<uchar*>(data));
+            return false;
+            }
+
+      const uchar* p = data + sizeof(MetricsHeader);
+      for (quint32 i = 0; i < h.symbols; ++i, p += sizeof(MetricsSymbol)) {
+            MetricsSymbol ms;
+            memcpy(&ms, p, sizeof(ms));
+            if (ms.id <= 0 || ms.id > int(SymId::lastSym))
+                  continue;
+            Sym* sym = &_symbols[ms.id];
+            sym->setCode(ms.code);
+            sym->setIndex(ms.index);
+            sym->setBbox(QRectF(ms.bbox[0], ms.bbox[1], ms.bbox[2], ms.bbox[3]));
+            sym->setAdvance(ms.advance);
+            sym->setStemDownNW(QPointF(ms.anchors[0], ms.anchors[1]));
+            sym->setStemUpSE(QPointF(ms.anchors[2], ms.anchors[3]));
+            sym->setCutOutNE(QPointF(ms.anchors[4], ms.anchors[5]));
+            sym->setCutOutNW(QPointF(ms.anchors[6], ms.anchors[7]));
+            sym->setCutOutSE(QPointF(ms.anchors[8], ms.anchors[9]));
+            sym->setCutOutSW(QPointF(ms.anchors[10], ms.anchors[11]));
+            }
+      for (quint32 i = 0; i < h.defaults; ++i, p += sizeof(MetricsDefault)) {
+            MetricsDefault md;
+            memcpy(&md, p, sizeof(md));
+            _engravingDefaults.push_back(std::make_pair(StyleIdx(md.idx), md.value));
+            }
+      _textEnclosureThickness = h.textEnclosureThickness;
+      f.unmap(const_cast<uchar*>(data));
+      return true;
+      }
+
+//---------------------------------------------------------
+//   writeMetricsCache
+//---------------------------------------------------------
+
+void ScoreFont::writeMetricsCache(const QByteArray& key) const
+      {
+      QString fn = metricsCacheFile();
+      if (fn.isEmpty() || key.size() != int(sizeof(MetricsHeader::key)))
+            return;
+
+      QByteArray data;
+      MetricsHeader h;
+      memset(&h, 0, sizeof(h));
+      memcpy(h.magic, METRICS_MAGIC, sizeof(h.magic));
+      h.version = METRICS_VERSION;
+      memcpy(h.key, key.constData(), sizeof(h.key));
+      h.textEnclosureThickness = _textEnclosureThickness;
+      data.append(reinterpret_cast<const char*>(&h), sizeof(h));
+
+      for (int i = 1; i < _symbols.size(); ++i) {
+            const Sym& sym = _symbols[i];
+            MetricsSymbol ms;
+            memset(&ms, 0, sizeof(ms));
+            ms.id    = i;
+            ms.code  = sym.code();
+            ms.index = sym.isValid() ? sym.index() : 0;
+            QRectF r = sym.bbox();
+            ms.bbox[0] = r.x();
+            ms.bbox[1] = r.y();
+            ms.bbox[2] = r.width();
+            ms.bbox[3] = r.height();
+            ms.advance = sym.isValid() ? sym.advance() : 0.0;
+            const QPointF anchors[] = { sym.stemDownNW(), sym.stemUpSE(), sym.cutOutNE(),
+                                        sym.cutOutNW(), sym.cutOutSE(), sym.cutOutSW() };
+            bool empty = !sym.isValid();
+            for (int k = 0; k < 6; ++k) {
+                  ms.anchors[k * 2]     = anchors[k].x();
+                  ms.anchors[k * 2 + 1] = anchors[k].y();
+                  if (!anchors[k].isNull())
+                        empty = false;
+                  }
+            if (empty)
+                  continue;
+            data.append(reinterpret_cast<const char*>(&ms), sizeof(ms));
+            ++h.symbols;
+            }
+      for (const auto& d : _engravingDefaults) {
+            MetricsDefault md;
+            memset(&md, 0, sizeof(md));
+            md.idx   = int(d.first);
+            md.value = d.second.toDouble();
+            data.append(reinterpret_cast<const char*>(&md), sizeof(md));
+            ++h.defaults;
+            }
+      memcpy(data.data(), &h, sizeof(h));
+
+      QDir().mkpath(metricsCachePath());
+      QSaveFile f(fn);
+      if (!f.open(QIODevice::WriteOnly) || f.write(data) != data.size() || !f.commit())
+            qDebug("ScoreFont: cannot write metrics cache <%s>", qPrintable(fn));
+      }
+
+//---------------------------------------------------------
+//   load
+//---------------------------------------------------------
+
+void ScoreFont::load()
+      {
+      QString facePath = _fontPath + _filename;
+      QFile f(facePath);
+      if (!f.open(QIODevice::ReadOnly)) {
+            qDebug("ScoreFont::load(): open failed <%s>", qPrintable(facePath));
+            return;
+            }
+      fontImage = f.readAll();
+      int rval = FT_New_Memory_Face(ftlib, (FT_Byte*)fontImage.data(), fontImage.size(), 0, &face);
+      if (rval) {
+            qDebug("freetype: cannot create face <%s>: %d", qPrintable(facePath), rval);
+            return;
+            }
+
+      qreal pixelSize = 200.0;
+      FT_Set_Pixel_Sizes(face, 0, int(pixelSize+.5));
+
+      QFile fi(_fontPath + "metadata.json");
+      if (!fi.open(QIODevice::ReadOnly))
+            qDebug("ScoreFont: open glyph metadata file <%s> failed", qPrintable(fi.fileName()));
+      QByteArray metadata = fi.readAll();
+
+      QByteArray key = metricsKey(metadata);
+      if (!readMetricsCache(key)) {
+            computeSymbolMetrics(metadata);
+            writeMetricsCache(key);
+            }
+      _engravingDefaults.push_back(std::make_pair(StyleIdx::MusicalTextFont, QString("%1 Text").arg(_family)));
+
+      // create missing composed glyphs
+      struct Composed {
+            SymId id;
+            std::vector<SymId> rids;
+            } composed[] = {
+
+            { SymId::ornamentPrallMordent,
+                  {
+                  SymId::ornamentZigZagLineNoRightEnd,
+                  SymId::ornamentZigZagLineNoRightEnd,
+                  SymId::ornamentMiddleVerticalStroke,
+                  SymId::ornamentZigZagLineWithRightEnd
+                  } },
+            { SymId::ornamentUpPrall,
+                  {
+                  SymId::ornamentBottomLeftConcaveStroke,
+                  SymId::ornamentZigZagLineNoRightEnd,
+                  SymId::ornamentZigZagLineNoRightEnd,
+                  SymId::ornamentZigZagLineWithRightEnd
+                  }},
+            { SymId::ornamentUpMordent,
+                  {
+                  SymId::ornamentBottomLeftConcaveStroke,
+                  SymId::ornamentZigZagLineNoRightEnd,
+                  SymId::ornamentZigZagLineNoRightEnd,
+                  SymId::ornamentMiddleVerticalStroke,
+                  SymId::ornamentZigZagLineWithRightEnd
+                  }},
+            { SymId::ornamentPrallDown,
+                  {
+                  SymId::ornamentZigZagLineNoRightEnd,
+                  SymId::ornamentZigZagLineNoRightEnd,
+                  SymId::ornamentZigZagLineNoRightEnd,
+                  SymId::ornamentBottomRightConcaveStroke,
+                  }},
+            { SymId::ornamentDownPrall,
+                  {
+                  SymId::ornamentLeftVerticalStroke,
+                  SymId::ornamentZigZagLineNoRightEnd,
+                  SymId::ornamentZigZagLineNoRightEnd,
+                  SymId::ornamentZigZagLineWithRightEnd
+                  }},
+            { SymId::ornamentDownMordent,
+                  {
+                  SymId::ornamentLeftVerticalStroke,
+                  SymId::ornamentZigZagLineNoRightEnd,
+                  SymId::ornamentZigZagLineNoRightEnd,
+                  SymId::ornamentMiddleVerticalStroke,
+                  SymId::ornamentZigZagLineWithRightEnd
+                  }},
+            { SymId::ornamentPrallUp,
+                  {
+                  SymId::ornamentZigZagLineNoRightEnd,
+                  SymId::ornamentZigZagLineNoRightEnd,
+                  SymId::ornamentZigZagLineNoRightEnd,
+                  SymId::ornamentTopRightConvexStroke,
+                  }},
+            { SymId::ornamentLinePrall,
+                  {
+                  SymId::ornamentLeftVerticalStroke,
+                  SymId::ornamentZigZagLineNoRightEnd,
+                  SymId::ornamentZigZagLineNoRightEnd,
+                  SymId::ornamentZigZagLineWithRightEnd
+                  }}
+            };
+
+      for (const Composed& c : composed) {
+            if (!_symbols[int(c.id)].isValid()) {
+                  Sym* sym = &_symbols[int(c.id)];
+                  std::vector<SymId> s;
+                  for (SymId id : c.rids)
+                        s.push_back(id);
+                  sym->setSymList(s);
+                  sym->setBbox(bbox(s, 1.0));
+                  }
+            }
+
 #if 0
       //
       // check for missing symbols
@@ -6201,6 +6634,19 @@ bool ScoreFont::initGlyphNamesJson()
       return true;
       }
 
+//---------------------------------------------------------
+//   glyphNamesJson
+//    glyphnames.json is only parsed if symbol metrics
+//    have to be computed
+//---------------------------------------------------------
+
+const QJsonObject& ScoreFont::glyphNamesJson()
+      {
+      if (_glyphnamesJson.isEmpty())
+            initGlyphNamesJson();
+      return _glyphnamesJson;
+      }
+
 //---------------------------------------------------------
 //   useFallbackFont
 //---------------------------------------------------------
@@ -6301,12 +6747,10 @@ ScoreFont::ScoreFont(const ScoreFont& f)
       _filename = f._filename;
 
       // fontImage;
-      cache = 0;
       }
 
 ScoreFont::~ScoreFont()
       {
-      delete cache;
       }
 }
 
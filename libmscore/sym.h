@@ -2734,30 +2734,86 @@ class Sym {
       };
 
 //---------------------------------------------------------
-//   GlyphKey
+//   GlyphAtlas
+//    Cache of rendered glyphs shared by all score fonts.
+//    Glyphs are keyed by font face, symbol and the fixed
+//    point scale they are rendered at. The coverage is
+//    stored alpha only on atlas pages and shared by all
+//    colors; a colored copy of the size of the glyph is
+//    kept per pen color.
 //---------------------------------------------------------
 
-struct GlyphKey {
-      FT_Face face;
-      SymId id;
-      qreal mag;
-      qreal worldScale;
-      QColor color;
+class GlyphAtlas {
+   public:
+      struct Key {
+            FT_Face face;
+            SymId id;
+            int scale16;            // fixed point scale passed to FreeType
+            bool operator==(const Key& k) const { return face == k.face && id == k.id && scale16 == k.scale16; }
+            };
+      struct Page;
+      struct Glyph {
+            Page* page { 0 };       // 0: empty glyph
+            QRect rect;             // position on page
+            QPoint offset;          // top left relative to glyph origin in pixel
+            };
+      struct TintKey {
+            const Page* page;
+            QPoint pos;             // position of the glyph on page
+            QRgb color;
+            bool operator==(const TintKey& k) const { return page == k.page && pos == k.pos && color == k.color; }
+            };
+
+   private:
+      struct Tint {
+            QImage image;
+            std::list<TintKey>::iterator lru;
+            };
+
+      QMutex _mutex;
+      QHash<Key, Glyph> glyphs;
+      std::list<Page*> pages;       // most recently used first
+      QHash<TintKey, Tint> tints;   // colored glyphs
+      std::list<TintKey> tintLru;   // most recently used first
+      int _budget       { 32 * 1024 * 1024 };    // bytes
+      int _memory       { 0 };
+      quint64 _hits     { 0 };
+      quint64 _misses   { 0 };
+
+      Page* allocate(const QSize&, QRect*);
+      QImage tinted(const Glyph&, QRgb);
+      void removeTint(TintKey);
+      void removePage(Page*);
+      void shrink(Page* keep);
 
    public:
-      GlyphKey(FT_Face _f, SymId _id, float m, float s, QColor c)
-         : face(_f), id(_id), mag(m), worldScale(s), color(c) {}
-      bool operator==(const GlyphKey&) const;
-      };
+      ~GlyphAtlas();
+      static GlyphAtlas* instance();
 
-struct GlyphPixmap {
-      QPixmap pm;
-      QPointF offset;
+      // find(), insert() and image() must be called with mutex()
+      // held; it also serializes the use of the FreeType faces
+      QMutex* mutex()               { return &_mutex; }
+      bool find(const Key&, Glyph*);
+      Glyph insert(const Key&, const FT_Bitmap*, int left, int top);
+      QImage image(const Glyph&, QRgb);
+      void clear();
+
+      int budget() const            { return _budget; }
+      void setBudget(int bytes);
+      int memory() const            { return _memory; }
+      quint64 hits() const          { return _hits;   }
+      quint64 misses() const        { return _misses; }
+      void resetStatistics()        { _hits = 0; _misses = 0; }
       };
 
-inline uint qHash(const GlyphKey& k)
+inline uint qHash(const GlyphAtlas::Key& k)
+      {
+      return (uint(k.id) << 16) ^ uint(k.scale16) ^ uint(quintptr(k.face));
+      }
+
+inline uint qHash(const GlyphAtlas::TintKey& k)
       {
-      return (int(k.id) << 16) + k.mag;
+      return (uint(k.pos.x()) << 16) ^ uint(k.pos.y()) ^ uint(k.color) ^ uint(quintptr(k.page));
       }
 
 //---------------------------------------------------------
@@ -2772,16 +2828,21 @@ class ScoreFont {
       QString _fontPath;
       QString _filename;
       QByteArray fontImage;
-      QCache<GlyphKey, GlyphPixmap>* cache { 0 };
       std::list<std::pair<StyleIdx, QVariant>> _engravingDefaults;
       double _textEnclosureThickness = 0;
       mutable QFont* font { 0 };
 
       static QVector<ScoreFont> _scoreFonts;
       static QJsonObject _glyphnamesJson;
+      static QString _metricsCachePath;
       const Sym& sym(SymId id) const { return _symbols[int(id)]; }
       void load();
       void computeMetrics(Sym* sym, int code);
+      void computeSymbolMetrics(const QByteArray& metadata);
+      QByteArray metricsKey(const QByteArray& metadata) const;
+      QString metricsCacheFile() const;
+      bool readMetricsCache(const QByteArray& key);
+      void writeMetricsCache(const QByteArray& key) const;
 
    public:
       ScoreFont() {}
@@ -2804,7 +2865,9 @@ class ScoreFont {
       static const char* fallbackTextFont();
       static const QVector<ScoreFont>& scoreFonts() { return _scoreFonts; }
       static bool initGlyphNamesJson();
-      static const QJsonObject& glyphNamesJson() { return _glyphnamesJson; }
+      static const QJsonObject& glyphNamesJson();
+      static QString metricsCachePath();
+      static void setMetricsCachePath(const QString& path) { _metricsCachePath = path; }
 
       QString toString(SymId) const;
       QPixmap sym2pixmap(SymId, qreal) { return QPixmap(); }      // TODOxxxx
@@ -243,7 +243,7 @@ void FSymbol::draw(QPainter* painter) const
       {
       QString s;
       QFont f(_font);
-      f.setPointSizeF(f.pointSizeF() * MScore::pixelRatio);
+      f.setPointSizeF(f.pointSizeF() * MScore::pixelRatio());
       painter->setFont(f);
       if (_code & 0xffff0000) {
             s = QChar(QChar::highSurrogate(_code));
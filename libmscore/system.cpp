@@ -84,6 +84,8 @@ System::~System()
 void System::clear()
       {
       ml.clear();
+      for (SysStaff* s : _staves)
+            s->clearSkyline();
       for (SpannerSegment* ss : _spannerSegments) {
             if (ss->system() == this)
                   ss->setParent(0);       // assume parent() is System
@@ -381,17 +383,12 @@ void System::layout2()
                         break;
                   }
             dist += score()->staff(si2)->userDist();
+            dist = qMax(dist, ss->south().minDistance(ni->second->north()) + minVerticalDistance);
 
             for (MeasureBase* mb : ml) {
                   if (!mb->isMeasure())
                         continue;
                   Measure* m = toMeasure(mb);
-                  Shape& s1 = m->staffShape(si1);
-                  Shape& s2 = m->staffShape(si2);
-
-                  qreal d = s1.minVerticalDistance(s2) + minVerticalDistance;
-                  dist    = qMax(dist, d);
-
                   Spacer* sp = m->vspacerDown(si1);
                   if (sp) {
                         if (sp->spacerType() == SpacerType::FIXED) {
@@ -1035,27 +1032,17 @@ qreal System::minDistance(System* s2) const
                         }
                   }
 
-            for (MeasureBase* mb1 : ml) {
-                  if (!mb1->isMeasure())
-                        continue;
-                  Measure* m1 = toMeasure(mb1);
-                  qreal bx1 = m1->x();
-                  qreal bx2 = m1->x() + m1->width();
-
-                  for (MeasureBase* mb2 : s2->measures()) {
-                        if (!mb2->isMeasure())
+            // the staff lines height may change within a system,
+            // every measure is set off by its own height
+            if (!s2->staves()->empty()) {
+                  const SkylineLine& south = _staves[lastStaff]->south();
+                  const SkylineLine& north = s2->staff(0)->north();
+                  for (MeasureBase* mb1 : ml) {
+                        if (!mb1->isMeasure())
                               continue;
-                        Measure* m2 = toMeasure(mb2);
-                        qreal ax1 = mb2->x();
-                        if (ax1 >= bx2)
-                              break;
-                        qreal ax2 = mb2->x() + mb2->width();
-                        if (ax2 < bx1)
-                              continue;
-                        Shape s1 = m1->staffShape(lastStaff).translated(m1->pos());
-                        Shape s2 = m2->staffShape(0).translated(m2->pos());
-                        qreal d  = s1.minVerticalDistance(s2) + minVerticalDistance;
-                        dist = qMax(dist, d - m1->staffLines(lastStaff)->height());
+                        Measure* m1 = toMeasure(mb1);
+                        qreal d = south.minDistance(north, m1->x(), m1->x() + m1->width()) + minVerticalDistance;
+                        dist    = qMax(dist, d - m1->staffLines(lastStaff)->height());
                         }
                   }
             }
@@ -1069,14 +1056,7 @@ qreal System::minDistance(System* s2) const
 
 qreal System::topDistance(int staffIdx, const Shape& s) const
       {
-      qreal dist = -1000000.0;
-      for (MeasureBase* mb1 : ml) {
-            if (!mb1->isMeasure())
-                  continue;
-            Measure* m1 = toMeasure(mb1);
-            dist = qMax(dist, s.minVerticalDistance(m1->staffShape(staffIdx).translated(m1->pos())));
-            }
-      return dist;
+      return _staves[staffIdx]->north().minDistance(s);
       }
 
 //---------------------------------------------------------
@@ -1085,14 +1065,7 @@ qreal System::topDistance(int staffIdx, const Shape& s) const
 
 qreal System::bottomDistance(int staffIdx, const Shape& s) const
       {
-      qreal dist = -1000000.0;
-      for (MeasureBase* mb1 : ml) {
-            if (!mb1->isMeasure())
-                  continue;
-            Measure* m1 = toMeasure(mb1);
-            dist = qMax(dist, m1->staffShape(staffIdx).translated(m1->pos()).minVerticalDistance(s));
-            }
-      return dist;
+      return _staves[staffIdx]->south().minDistance(s);
       }
 
 //---------------------------------------------------------
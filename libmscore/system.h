@@ -48,6 +48,9 @@ class SysStaff {
       qreal _yOff { 0    };         // offset of top staff line within bbox
       bool _show  { true };         // derived from Staff or false if empty
                                     // staff is hidden
+      SkylineLine _north { true };  // outline of the measure shapes
+      SkylineLine _south { false }; // in system coordinates
+
    public:
       int idx     { 0    };
       QList<InstrumentName*> instrumentNames;
@@ -61,6 +64,11 @@ class SysStaff {
       bool show() const             { return _show; }
       void setShow(bool v)          { _show = v; }
 
+      const SkylineLine& north() const    { return _north; }
+      const SkylineLine& south() const    { return _south; }
+      void addToSkyline(const Shape& s)   { _north.add(s); _south.add(s); }
+      void clearSkyline()                 { _north.clear(); _south.clear(); }
+
       SysStaff() {}
       ~SysStaff();
       };
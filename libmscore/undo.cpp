@@ -3434,7 +3434,7 @@ void InsertTime::undo()
 
 void ChangeNoteEvent::flip()
       {
-      note->score()->setPlaylistDirty();
+      note->score()->setPlaylistDirty(note->tick(), note->tick());
       NoteEvent e = *oldEvent;
       *oldEvent   = newEvent;
       newEvent    = e;
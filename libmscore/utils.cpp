@@ -47,18 +47,7 @@ Measure* Score::tick2measure(int tick) const
       {
       if (tick == -1)
             return lastMeasure();
-
-      Measure* lm = 0;
-      for (Measure* m = firstMeasure(); m; m = m->nextMeasure()) {
-            if (tick < m->tick())
-                  return lm;
-            lm = m;
-            }
-      // check last measure
-      if (lm && (tick >= lm->tick()) && (tick <= lm->endTick()))
-            return lm;
-      qDebug("tick2measure %d (max %d) not found", tick, lm ? lm->tick() : -1);
-      return 0;
+      return _measures.tick2measure(tick);
       }
 
 //---------------------------------------------------------
@@ -69,6 +58,10 @@ Measure* Score::tick2measureMM(int tick) const
       {
       if (tick == -1)
             return lastMeasureMM();
+      // without multi measure rests the MM chain is the plain
+      // measure list and the tick index can be used
+      if (!styleB(StyleIdx::createMultiMeasureRests))
+            return _measures.tick2measure(tick);
       Measure* lm = 0;
 
       for (Measure* m = firstMeasureMM(); m; m = m->nextMeasureMM()) {
@@ -0,0 +1,139 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2017 Werner Schweer and others
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include "audiorender.h"
+#include "synthesizer/msynthesizer.h"
+
+namespace Ms {
+
+// after the end of the score the jobs render this many
+// frames between two checks for the end of the sound
+static const qint64 ROUND_FRAMES = AUDIO_FRAMES * 64;
+
+//---------------------------------------------------------
+//   renderJob
+//    continue rendering job up to frame until
+//---------------------------------------------------------
+
+static void renderJob(AudioRenderJob* job, qint64 until, qint64 et, const std::atomic<bool>* canceled)
+      {
+      MasterSynthesizer* synti = job->synti;
+      if (job->frames == 0) {
+            synti->allSoundsOff(-1);
+            for (const AudioEvent& e : job->init)
+                  synti->play(e.event, e.synti);
+            }
+      job->spill.seek(job->frames * 2 * sizeof(float));
+
+      float buffer[AUDIO_FRAMES * 2];
+      qint64 playTime = job->frames;
+      while (playTime < until && !*canceled) {
+            unsigned frames = AUDIO_FRAMES;
+            memset(buffer, 0, sizeof(buffer));
+            qint64 endTime = playTime + frames;
+            float* p = buffer;
+            for (; job->next < job->events.size(); ++job->next) {
+                  const AudioEvent& e = job->events[job->next];
+                  if (e.frame >= endTime)
+                        break;
+                  int n = e.frame - playTime;
+                  if (n) {
+                        synti->process(n, p);
+                        p += 2 * n;
+                        }
+                  playTime  += n;
+                  frames    -= n;
+                  synti->play(e.event, e.synti);
+                  }
+            if (frames)
+                  synti->process(frames, p);
+            job->spill.write(reinterpret_cast<const char*>(buffer), sizeof(buffer));
+            job->frames += AUDIO_FRAMES;
+            playTime = endTime;
+            job->playTime = playTime;
+            if (playTime >= et)
+                  synti->allNotesOff(-1);
+            }
+      }
+
+//---------------------------------------------------------
+//   mixDown
+//    sum the frames from - to of the spill files in job
+//    order into out; returns true after the block in
+//    which the sound has decayed
+//---------------------------------------------------------
+
+static bool mixDown(const QList<AudioRenderJob*>& jobs, qint64 from, qint64 to, qint64 et, qint64 maxEndTime,
+   QIODevice* out, float* peak)
+      {
+      float mix[AUDIO_FRAMES * 2];
+      float buffer[AUDIO_FRAMES * 2];
+      for (AudioRenderJob* job : jobs)
+            job->spill.seek(from * 2 * sizeof(float));
+      for (qint64 frame = from; frame < to; frame += AUDIO_FRAMES) {
+            memset(mix, 0, sizeof(mix));
+            for (AudioRenderJob* job : jobs) {
+                  job->spill.read(reinterpret_cast<char*>(buffer), sizeof(buffer));
+                  for (unsigned i = 0; i < AUDIO_FRAMES * 2; ++i)
+                        mix[i] += buffer[i];
+                  }
+            float max = 0.0;
+            for (unsigned i = 0; i < AUDIO_FRAMES * 2; ++i)
+                  max = qMax(max, qAbs(mix[i]));
+            *peak = qMax(*peak, max);
+            out->write(reinterpret_cast<const char*>(mix), sizeof(mix));
+            qint64 playTime = frame + AUDIO_FRAMES;
+            // create sound until the sound decays
+            if (playTime >= et && max * *peak < 0.000001)
+                  return true;
+            // hard limit
+            if (playTime > maxEndTime)
+                  return true;
+            }
+      return false;
+      }
+
+//---------------------------------------------------------
+//   renderAudio
+//    Render all jobs, the first one on the calling thread
+//    and the others on worker threads, and write the mix
+//    of raw stereo floats to out. The end of the sound is
+//    detected on the mix, so any number of jobs renders
+//    the same frames as a single job. Returns the peak of
+//    the mix for normalization.
+//---------------------------------------------------------
+
+float renderAudio(const QList<AudioRenderJob*>& jobs, qint64 et, qint64 maxEndTime,
+   QIODevice* out, const std::atomic<bool>* canceled)
+      {
+      QThreadPool pool;
+      pool.setMaxThreadCount(qMax(jobs.size() - 1, 1));
+
+      float peak   = 0.0;
+      qint64 mixed = 0;
+      qint64 until = (et + AUDIO_FRAMES - 1) / AUDIO_FRAMES * AUDIO_FRAMES;
+      for (;;) {
+            QList<QFuture<void>> futures;
+            for (int i = 1; i < jobs.size(); ++i)
+                  futures.append(QtConcurrent::run(&pool, renderJob, jobs[i], until, et, canceled));
+            renderJob(jobs[0], until, et, canceled);
+            for (QFuture<void>& f : futures)
+                  f.waitForFinished();
+            if (*canceled || mixDown(jobs, mixed, until, et, maxEndTime, out, &peak))
+                  break;
+            mixed  = until;
+            until += ROUND_FRAMES;
+            }
+      return peak;
+      }
+
+}     // namespace Ms
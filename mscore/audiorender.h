@@ -0,0 +1,57 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2017 Werner Schweer and others
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __AUDIORENDER_H__
+#define __AUDIORENDER_H__
+
+#include <atomic>
+#include <vector>
+#include "synthesizer/event.h"
+
+namespace Ms {
+
+class MasterSynthesizer;
+
+//---------------------------------------------------------
+//   AudioEvent
+//    a play event with its precomputed frame position
+//---------------------------------------------------------
+
+struct AudioEvent {
+      qint64 frame;
+      int synti;
+      NPlayEvent event;
+      };
+
+//---------------------------------------------------------
+//   AudioRenderJob
+//    renders the events of a group of parts with its own
+//    synthesizer into a spill file of raw stereo floats
+//---------------------------------------------------------
+
+struct AudioRenderJob {
+      MasterSynthesizer* synti { 0 };    // not owned
+      std::vector<AudioEvent> init;       // instrument init events
+      std::vector<AudioEvent> events;
+      QTemporaryFile spill;
+      size_t next                    { 0 };   // next event to play
+      qint64 frames                  { 0 };   // frames in spill
+      std::atomic<qint64> playTime   { 0 };
+      };
+
+static const unsigned AUDIO_FRAMES = 512;
+
+extern float renderAudio(const QList<AudioRenderJob*>& jobs, qint64 et, qint64 maxEndTime,
+   QIODevice* out, const std::atomic<bool>* canceled);
+
+}     // namespace Ms
+#endif
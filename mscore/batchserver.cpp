@@ -0,0 +1,502 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2017 Werner Schweer and others
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include "batchserver.h"
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace Ms {
+
+//---------------------------------------------------------
+//   run
+//---------------------------------------------------------
+
+void BatchInputReader::run()
+      {
+      QFile in;
+      if (in.open(stdin, QIODevice::ReadOnly)) {
+            for (;;) {
+                  QByteArray line = in.readLine();
+                  if (line.isEmpty())
+                        break;
+                  line = line.trimmed();
+                  if (!line.isEmpty())
+                        emit lineReceived(line);
+                  }
+            }
+      emit closed();
+      }
+
+//---------------------------------------------------------
+//   takeStdout
+//    Returns a copy of the stdout file descriptor and
+//    sends stdout itself to stderr, so the output of a
+//    conversion cannot be taken for a result.
+//---------------------------------------------------------
+
+static int takeStdout()
+      {
+      fflush(stdout);
+#ifdef Q_OS_WIN
+      int fd = _dup(_fileno(stdout));
+      _dup2(_fileno(stderr), _fileno(stdout));
+#else
+      int fd = dup(STDOUT_FILENO);
+      dup2(STDERR_FILENO, STDOUT_FILENO);
+#endif
+      return fd;
+      }
+
+//---------------------------------------------------------
+//   BatchServer
+//    jobs: number of jobs converted at the same time
+//    timeout: ms a job may take, 0 for no limit; a job
+//       running longer fails and its worker is replaced
+//    runner: converts a job in this process
+//    workerArguments: command line of worker process n
+//---------------------------------------------------------
+
+BatchServer::BatchServer(int jobs, int timeout, const Runner& runner, const WorkerArguments& workerArguments)
+   : QObject(0), _runner(runner), _jobs(qMax(jobs, 1)), _timeout(qMax(timeout, 0)), _workerArguments(workerArguments)
+      {
+      // only a worker process can be stopped
+      if (_jobs > 1 || _timeout > 0) {
+            for (int i = 0; i < _jobs; ++i) {
+                  BatchWorker* w = new BatchWorker { i, 0, 0, QByteArray(), new QTimer(this), false };
+                  w->timer->setSingleShot(true);
+                  w->timer->setProperty("worker", i);
+                  connect(w->timer, SIGNAL(timeout()), SLOT(workerTimeout()));
+                  _workers.append(w);
+                  startWorker(w);
+                  }
+            }
+      }
+
+//---------------------------------------------------------
+//   ~BatchServer
+//---------------------------------------------------------
+
+BatchServer::~BatchServer()
+      {
+      for (BatchWorker* w : _workers) {
+            if (w->process) {
+                  w->process->disconnect(this);
+                  w->process->closeWriteChannel();
+                  if (!w->process->waitForFinished(5000))
+                        w->process->kill();
+                  delete w->process;
+                  }
+            delete w->job;
+            delete w;
+            }
+      qDeleteAll(_queue);
+      if (_input) {
+            // the reader may still block on stdin
+            _input->disconnect(this);
+            if (!_input->wait(100))
+                  _input->terminate();
+            delete _input;
+            }
+      }
+
+//---------------------------------------------------------
+//   listen
+//    accept jobs from the clients of the local socket
+//    socketName
+//---------------------------------------------------------
+
+bool BatchServer::listen(const QString& socketName)
+      {
+      _server = new QLocalServer(this);
+      QLocalServer::removeServer(socketName);
+      if (!_server->listen(socketName)) {
+            fprintf(stderr, "cannot listen on <%s>: %s\n", qPrintable(socketName), qPrintable(_server->errorString()));
+            return false;
+            }
+      connect(_server, SIGNAL(newConnection()), SLOT(newConnection()));
+      return true;
+      }
+
+//---------------------------------------------------------
+//   readStdin
+//    accept jobs from stdin; the server is done when
+//    stdin is closed and all jobs are converted
+//---------------------------------------------------------
+
+void BatchServer::readStdin()
+      {
+      _stdout.open(takeStdout(), QIODevice::WriteOnly, QFileDevice::AutoCloseHandle);
+      _input = new BatchInputReader;
+      connect(_input, SIGNAL(lineReceived(const QByteArray&)), SLOT(lineReceived(const QByteArray&)));
+      connect(_input, SIGNAL(closed()), SLOT(inputClosed()));
+      _input->start();
+      }
+
+//---------------------------------------------------------
+//   startWorker
+//---------------------------------------------------------
+
+void BatchServer::startWorker(BatchWorker* w)
+      {
+      w->process = new QProcess(this);
+      w->process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+      w->process->setProperty("worker", w->index);
+      connect(w->process, SIGNAL(readyReadStandardOutput()), SLOT(workerReadyRead()));
+      connect(w->process, SIGNAL(finished(int, QProcess::ExitStatus)), SLOT(workerFinished()));
+      connect(w->process, SIGNAL(errorOccurred(QProcess::ProcessError)), SLOT(workerError(QProcess::ProcessError)));
+      w->process->start(QCoreApplication::applicationFilePath(), _workerArguments(w->index));
+      w->output.clear();
+      }
+
+//---------------------------------------------------------
+//   lineReceived
+//---------------------------------------------------------
+
+void BatchServer::lineReceived(const QByteArray& line)
+      {
+      addJob(line, 0);
+      }
+
+//---------------------------------------------------------
+//   inputClosed
+//---------------------------------------------------------
+
+void BatchServer::inputClosed()
+      {
+      _inputClosed = true;
+      checkDone();
+      }
+
+//---------------------------------------------------------
+//   newConnection
+//---------------------------------------------------------
+
+void BatchServer::newConnection()
+      {
+      while (QLocalSocket* client = _server->nextPendingConnection()) {
+            connect(client, SIGNAL(readyRead()), SLOT(clientReadyRead()));
+            connect(client, SIGNAL(disconnected()), SLOT(clientDisconnected()));
+            }
+      }
+
+//---------------------------------------------------------
+//   clientReadyRead
+//---------------------------------------------------------
+
+void BatchServer::clientReadyRead()
+      {
+      QLocalSocket* client = static_cast<QLocalSocket*>(sender());
+      while (client->canReadLine()) {
+            QByteArray line = client->readLine().trimmed();
+            if (!line.isEmpty())
+                  addJob(line, client);
+            }
+      }
+
+//---------------------------------------------------------
+//   clientDisconnected
+//    jobs of the client still in the queue are dropped
+//---------------------------------------------------------
+
+void BatchServer::clientDisconnected()
+      {
+      QLocalSocket* client = static_cast<QLocalSocket*>(sender());
+      for (auto i = _queue.begin(); i != _queue.end();) {
+            if ((*i)->client == client) {
+                  delete *i;
+                  i = _queue.erase(i);
+                  }
+            else
+                  ++i;
+            }
+      client->deleteLater();
+      }
+
+//---------------------------------------------------------
+//   addJob
+//    check the job and queue it; a bad job is answered
+//    right away
+//---------------------------------------------------------
+
+void BatchServer::addJob(const QByteArray& line, QLocalSocket* client)
+      {
+      BatchJob* job   = new BatchJob;
+      job->fromSocket = client != 0;
+      job->client     = client;
+      job->waitMs     = 0;
+      job->queued.start();
+
+      QString error;
+      QJsonParseError pe;
+      QJsonDocument doc = QJsonDocument::fromJson(line, &pe);
+      if (pe.error != QJsonParseError::NoError)
+            error = QString("error reading job at %1: %2").arg(pe.offset).arg(pe.errorString());
+      else if (!doc.isObject())
+            error = "job is not an object";
+      else {
+            job->job = doc.object();
+            static const QStringList keys { "id", "in", "out", "style", "parts" };
+            for (const QString& key : job->job.keys()) {
+                  if (!keys.contains(key)) {
+                        error = QString("unknown key <%1>").arg(key);
+                        break;
+                        }
+                  }
+            QJsonValue out = job->job.value("out");
+            bool outOk = out.isString() && !out.toString().isEmpty();
+            if (out.isArray()) {
+                  outOk = !out.toArray().isEmpty();
+                  for (const QJsonValue& v : out.toArray())
+                        outOk = outOk && v.isString() && !v.toString().isEmpty();
+                  }
+            if (error.isEmpty() && job->job.value("in").toString().isEmpty())
+                  error = "no input file";
+            else if (error.isEmpty() && !outOk)
+                  error = "no output file";
+            }
+      if (!error.isEmpty()) {
+            QJsonObject result;
+            result["ok"]    = false;
+            result["error"] = error;
+            finish(job, result, -1);
+            return;
+            }
+      _queue.append(job);
+      dispatch();
+      }
+
+//---------------------------------------------------------
+//   dispatch
+//    hand queued jobs to idle workers
+//---------------------------------------------------------
+
+void BatchServer::dispatch()
+      {
+      bool workers = false;
+      for (const BatchWorker* w : _workers)
+            workers = workers || w->process;
+      if (!workers) {
+            if (!_running && !_queue.isEmpty()) {
+                  _running = true;
+                  QTimer::singleShot(0, this, [this]() { runInProcess(); });
+                  }
+            }
+      else {
+            for (BatchWorker* w : _workers) {
+                  if (_queue.isEmpty())
+                        break;
+                  if (w->job || !w->process)
+                        continue;
+                  w->job = _queue.takeFirst();
+                  w->job->waitMs = w->job->queued.elapsed();
+                  QByteArray line = QJsonDocument(w->job->job).toJson(QJsonDocument::Compact);
+                  w->process->write(line + '\n');
+                  if (_timeout > 0)
+                        w->timer->start(_timeout);
+                  }
+            }
+      checkDone();
+      }
+
+//---------------------------------------------------------
+//   runInProcess
+//---------------------------------------------------------
+
+void BatchServer::runInProcess()
+      {
+      if (!_queue.isEmpty()) {
+            BatchJob* job = _queue.takeFirst();
+            job->waitMs = job->queued.elapsed();
+            finish(job, _runner(job->job), 0);
+            }
+      _running = false;
+      dispatch();
+      }
+
+//---------------------------------------------------------
+//   workerReadyRead
+//    a worker answers every job with one JSON line on its
+//    stdout, the output of the conversion goes to stderr
+//---------------------------------------------------------
+
+void BatchServer::workerReadyRead()
+      {
+      QProcess* process = static_cast<QProcess*>(sender());
+      BatchWorker* w    = _workers[process->property("worker").toInt()];
+      w->output += process->readAllStandardOutput();
+      int n;
+      while ((n = w->output.indexOf('\n')) >= 0) {
+            QByteArray line = w->output.left(n).trimmed();
+            w->output.remove(0, n + 1);
+            if (!w->job)
+                  continue;
+            QJsonDocument doc = QJsonDocument::fromJson(line);
+            if (!doc.isObject()) {
+                  fprintf(stderr, "worker %d: bad result <%s>\n", w->index, line.constData());
+                  continue;
+                  }
+            BatchJob* job = w->job;
+            w->job = 0;
+            w->timer->stop();
+            finish(job, doc.object(), w->index);
+            }
+      dispatch();
+      }
+
+//---------------------------------------------------------
+//   workerFinished
+//    the job of a crashed or stopped worker fails, the
+//    worker is replaced
+//---------------------------------------------------------
+
+void BatchServer::workerFinished()
+      {
+      QProcess* process = static_cast<QProcess*>(sender());
+      BatchWorker* w    = _workers[process->property("worker").toInt()];
+      w->timer->stop();
+      if (w->job) {
+            QJsonObject result;
+            result["ok"] = false;
+            if (w->timedOut)
+                  result["error"] = QString("timeout after %1 s").arg(_timeout / 1000.0);
+            else if (process->exitStatus() == QProcess::CrashExit)
+                  result["error"] = QString("worker crashed");
+            else
+                  result["error"] = QString("worker exited with code %1").arg(process->exitCode());
+            BatchJob* job = w->job;
+            w->job = 0;
+            finish(job, result, w->index);
+            }
+      w->timedOut = false;
+      process->deleteLater();
+      w->process = 0;
+      if (!(_inputClosed && _queue.isEmpty() && !_server))
+            startWorker(w);
+      dispatch();
+      }
+
+//---------------------------------------------------------
+//   workerTimeout
+//    the job of the worker takes too long, the worker is
+//    stopped and workerFinished() fails the job
+//---------------------------------------------------------
+
+void BatchServer::workerTimeout()
+      {
+      BatchWorker* w = _workers[sender()->property("worker").toInt()];
+      if (!w->job || !w->process)
+            return;
+      w->timedOut = true;
+      w->process->kill();
+      }
+
+//---------------------------------------------------------
+//   workerError
+//    a worker which cannot be started is given up, without
+//    workers the jobs are converted in this process
+//---------------------------------------------------------
+
+void BatchServer::workerError(QProcess::ProcessError error)
+      {
+      if (error != QProcess::FailedToStart)
+            return;
+      QProcess* process = static_cast<QProcess*>(sender());
+      BatchWorker* w    = _workers[process->property("worker").toInt()];
+      fprintf(stderr, "cannot start worker %d: %s\n", w->index, qPrintable(process->errorString()));
+      w->timer->stop();
+      if (w->job) {
+            _queue.prepend(w->job);
+            w->job = 0;
+            }
+      process->deleteLater();
+      w->process = 0;
+      dispatch();
+      }
+
+//---------------------------------------------------------
+//   finish
+//    answer job with result and delete it
+//---------------------------------------------------------
+
+void BatchServer::finish(BatchJob* job, QJsonObject result, int worker)
+      {
+      if (job->job.contains("id"))
+            result["id"] = job->job.value("id");
+      else
+            result.remove("id");
+      if (job->job.contains("in"))
+            result["in"] = job->job.value("in");
+      if (worker >= 0)
+            result["worker"] = worker;
+      result["waitMs"] = double(job->waitMs);
+      if (!result.contains("ms"))
+            result["ms"] = double(job->queued.elapsed() - job->waitMs);
+      if (!result.value("ok").toBool())
+            ++_failed;
+
+      if (!job->fromSocket)
+            write(0, result);
+      else if (job->client)
+            write(job->client, result);
+      delete job;
+      }
+
+//---------------------------------------------------------
+//   write
+//    one JSON line to client or stdout
+//---------------------------------------------------------
+
+void BatchServer::write(QLocalSocket* client, const QJsonObject& result)
+      {
+      QByteArray line = QJsonDocument(result).toJson(QJsonDocument::Compact) + '\n';
+      if (client) {
+            client->write(line);
+            client->flush();
+            }
+      else {
+            _stdout.write(line);
+            _stdout.flush();
+            }
+      }
+
+//---------------------------------------------------------
+//   idle
+//---------------------------------------------------------
+
+bool BatchServer::idle() const
+      {
+      if (_running || !_queue.isEmpty())
+            return false;
+      for (const BatchWorker* w : _workers) {
+            if (w->job)
+                  return false;
+            }
+      return true;
+      }
+
+//---------------------------------------------------------
+//   checkDone
+//    without a socket the server ends with stdin
+//---------------------------------------------------------
+
+void BatchServer::checkDone()
+      {
+      if (_inputClosed && !_server && !_done && idle()) {
+            _done = true;
+            emit done(_failed ? 1 : 0);
+            }
+      }
+}
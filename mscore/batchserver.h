@@ -0,0 +1,136 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2017 Werner Schweer and others
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __BATCHSERVER_H__
+#define __BATCHSERVER_H__
+
+#include <functional>
+#include <QLocalServer>
+#include <QLocalSocket>
+
+namespace Ms {
+
+//---------------------------------------------------------
+//   BatchInputReader
+//    reads the lines of stdin without blocking the
+//    event loop
+//---------------------------------------------------------
+
+class BatchInputReader : public QThread {
+      Q_OBJECT
+
+      virtual void run() override;
+
+   signals:
+      void lineReceived(const QByteArray&);
+      void closed();
+      };
+
+//---------------------------------------------------------
+//   BatchJob
+//---------------------------------------------------------
+
+struct BatchJob {
+      QJsonObject job;
+      bool fromSocket;
+      QPointer<QLocalSocket> client;      // gone if the client disconnected
+      QElapsedTimer queued;
+      qint64 waitMs;                      // time in the queue
+      };
+
+//---------------------------------------------------------
+//   BatchWorker
+//    a headless mscore process converting one job at a
+//    time; fonts, templates and soundfonts stay loaded
+//    between the jobs
+//---------------------------------------------------------
+
+struct BatchWorker {
+      int index;
+      QProcess* process;
+      BatchJob* job;                // job in progress
+      QByteArray output;            // incomplete line from the process
+      QTimer* timer;                // stops a job running too long
+      bool timedOut;
+      };
+
+//---------------------------------------------------------
+//   BatchServer
+//    Long running converter. Jobs are JSON objects, one
+//    per line, read from stdin or from the clients of a
+//    local socket:
+//       { "id": any, "in": file, "out": file or [files],
+//         "style": file, "parts": bool }
+//    For every job a JSON line with the outcome and the
+//    timing is written back to where the job came from;
+//    on stdin the results have stdout to themselves, any
+//    other output goes to stderr.
+//    With one job at a time and no timeout the conversion
+//    runs in this process, otherwise the jobs are
+//    distributed over worker processes, so a crashing or
+//    hanging job does not take other jobs down.
+//---------------------------------------------------------
+
+class BatchServer : public QObject {
+      Q_OBJECT
+
+   public:
+      typedef std::function<QJsonObject(const QJsonObject&)> Runner;
+      typedef std::function<QStringList(int worker)> WorkerArguments;
+
+   private:
+      Runner _runner;
+      int _jobs;
+      int _timeout;                       // ms per job, 0: none
+      WorkerArguments _workerArguments;
+      QList<BatchWorker*> _workers;
+      QList<BatchJob*> _queue;
+      QLocalServer* _server { 0 };
+      BatchInputReader* _input { 0 };
+      bool _inputClosed { false };
+      bool _running { false };            // in process job in progress
+      bool _done { false };
+      QFile _stdout;
+      int _failed { 0 };
+
+      void startWorker(BatchWorker*);
+      void dispatch();
+      void runInProcess();
+      void finish(BatchJob*, QJsonObject result, int worker);
+      void write(QLocalSocket*, const QJsonObject&);
+      void addJob(const QByteArray& line, QLocalSocket* client);
+      bool idle() const;
+      void checkDone();
+
+   private slots:
+      void lineReceived(const QByteArray&);
+      void inputClosed();
+      void newConnection();
+      void clientReadyRead();
+      void clientDisconnected();
+      void workerReadyRead();
+      void workerFinished();
+      void workerTimeout();
+      void workerError(QProcess::ProcessError);
+
+   signals:
+      void done(int exitCode);
+
+   public:
+      BatchServer(int jobs, int timeout, const Runner& runner, const WorkerArguments& workerArguments);
+      ~BatchServer();
+      bool listen(const QString& socketName);
+      void readStdin();
+      };
+
+}
+#endif
@@ -24,7 +24,9 @@
 #include "libmscore/note.h"
 #include "libmscore/part.h"
 #include "libmscore/mscore.h"
+#include "libmscore/instrument.h"
 #include "synthesizer/msynthesizer.h"
+#include "audiorender.h"
 #include "musescore.h"
 #include "preferences.h"
 
@@ -32,8 +34,87 @@ namespace Ms {
 
 #ifdef HAS_AUDIOFILE
 
+//---------------------------------------------------------
+//   synthesizer pool
+//    With setKeepSynthesizers(true) the synthesizers of
+//    an export are kept with their soundfonts loaded and
+//    reused by the next export with the same sample rate.
+//    Used by the batch converter.
+//---------------------------------------------------------
+
+static bool keepSynthesizers = false;
+static QList<MasterSynthesizer*> idleSynthesizers;
+
+void setKeepSynthesizers(bool val)
+      {
+      keepSynthesizers = val;
+      if (!keepSynthesizers) {
+            qDeleteAll(idleSynthesizers);
+            idleSynthesizers.clear();
+            }
+      }
+
+//---------------------------------------------------------
+//   takeSynthesizer
+//    an idle synthesizer for sampleRate, or a new one;
+//    an idle one is cleared of the voices, controllers
+//    and effect tails of its last rendering
+//---------------------------------------------------------
+
+static MasterSynthesizer* takeSynthesizer(int sampleRate)
+      {
+      for (MasterSynthesizer* synti : idleSynthesizers) {
+            if (synti->sampleRate() == sampleRate) {
+                  idleSynthesizers.removeOne(synti);
+                  synti->clear();
+                  synti->init();
+                  return synti;
+                  }
+            }
+      MasterSynthesizer* synti = synthesizerFactory();
+      synti->init();
+      synti->setSampleRate(sampleRate);
+      return synti;
+      }
+
+//---------------------------------------------------------
+//   releaseSynthesizer
+//---------------------------------------------------------
+
+static void releaseSynthesizer(MasterSynthesizer* synti)
+      {
+      if (!synti)
+            return;
+      if (keepSynthesizers)
+            idleSynthesizers.append(synti);
+      else
+            delete synti;
+      }
+
+//---------------------------------------------------------
+//   parallelAudioSafe
+//    rendering parts with separate synthesizers and summing
+//    them is only equivalent to a single synthesizer if
+//    the master effects are linear
+//---------------------------------------------------------
+
+static bool parallelAudioSafe(MasterSynthesizer* synti)
+      {
+      for (int i = 0; i < MasterSynthesizer::MAX_EFFECTS; ++i) {
+            Effect* e = synti->effect(i);
+            if (e && strcmp(e->name(), "SC4") == 0)     // compressor
+                  return false;
+            }
+      return true;
+      }
+
 //---------------------------------------------------------
 //   saveAudio
+//    The score is synthesized once into a spill file,
+//    then normalized while writing the sound file. With
+//    preferences.exportAudioThreads > 1 the parts are
+//    distributed over several synthesizers which render
+//    on worker threads and are mixed in part order.
 //---------------------------------------------------------
 
 bool MuseScore::saveAudio(Score* score, const QString& name)
@@ -55,13 +136,15 @@ bool MuseScore::saveAudio(Score* score, const QString& name)
       if(events.size() == 0)
             return false;
 
-      MasterSynthesizer* synti = synthesizerFactory();
-      synti->init();
       int sampleRate = preferences.exportAudioSampleRate;
-      synti->setSampleRate(sampleRate);
-      bool r = synti->setState(score->synthesizerState());
-      if (!r)
-          synti->init();
+      auto createSynti = [score, sampleRate]() {
+            MasterSynthesizer* synti = takeSynthesizer(sampleRate);
+            bool r = synti->setState(score->synthesizerState());
+            if (!r)
+                  synti->init();
+            return synti;
+            };
+      MasterSynthesizer* synti = createSynti();
 
       int oldSampleRate  = MScore::sampleRate;
       MScore::sampleRate = sampleRate;
@@ -74,7 +157,7 @@ bool MuseScore::saveAudio(Score* score, const QString& name)
       SNDFILE* sf     = sf_open(qPrintable(name), SFM_WRITE, &info);
       if (sf == 0) {
             qDebug("open soundfile failed: %s", sf_strerror(sf));
-            delete synti;
+            releaseSynthesizer(synti);
             MScore::sampleRate = oldSampleRate;
             return false;
             }
@@ -88,120 +171,118 @@ bool MuseScore::saveAudio(Score* score, const QString& name)
       if (!MScore::noGui)
             progress.show();
 
-      float peak  = 0.0;
-      double gain = 1.0;
       EventMap::const_iterator endPos = events.cend();
       --endPos;
-      const int et = (score->utick2utime(endPos->first) + 1) * MScore::sampleRate;
-      const int maxEndTime = (score->utick2utime(endPos->first) + 3) * MScore::sampleRate;
-
-      progress.setRange(0, et);
+      const qint64 et = (score->utick2utime(endPos->first) + 1) * MScore::sampleRate;
+      const qint64 maxEndTime = (score->utick2utime(endPos->first) + 3) * MScore::sampleRate;
 
-      for (int pass = 0; pass < 2; ++pass) {
-            EventMap::const_iterator playPos;
-            playPos = events.cbegin();
-            synti->allSoundsOff(-1);
+      progress.setRange(0, int(et));
 
+      //
+      // distribute the parts over the render jobs
+      //
+      MasterScore* ms = score->masterScore();
+      int nJobs = qMax(qMin(preferences.exportAudioThreads, score->parts().size()), 1);
+      if (nJobs > 1 && !parallelAudioSafe(synti))
+            nJobs = 1;
+      QList<AudioRenderJob*> jobs;
+      QHash<const Part*, AudioRenderJob*> partJob;
+      for (int i = 0; i < nJobs; ++i) {
+            AudioRenderJob* job = new AudioRenderJob;
+            job->synti = i == 0 ? synti : createSynti();
+            job->spill.open();
+            jobs.append(job);
+            }
+      int partIdx = 0;
+      foreach(Part* part, score->parts()) {
+            AudioRenderJob* job = jobs[partIdx++ % nJobs];
             //
             // init instruments
             //
-            foreach(Part* part, score->parts()) {
-                  const InstrumentList* il = part->instruments();
-                  for(auto i = il->begin(); i!= il->end(); i++) {
-                        foreach(const Channel* a, i->second->channel()) {
-                              a->updateInitList();
-                              foreach(MidiCoreEvent e, a->init) {
-                                    if (e.type() == ME_INVALID)
-                                          continue;
-                                    e.setChannel(a->channel);
-                                    int syntiIdx = synti->index(score->masterScore()->midiMapping(a->channel)->articulation->synti);
-                                    synti->play(e, syntiIdx);
-                                    }
+            const InstrumentList* il = part->instruments();
+            for(auto i = il->begin(); i!= il->end(); i++) {
+                  foreach(const Channel* a, i->second->channel()) {
+                        // events are mapped to the parts of the master
+                        // score, which for a part score are not part
+                        const MidiMapping* mm = ms->midiMapping(a->channel);
+                        partJob[mm->part] = job;
+                        a->updateInitList();
+                        foreach(MidiCoreEvent e, a->init) {
+                              if (e.type() == ME_INVALID)
+                                    continue;
+                              e.setChannel(a->channel);
+                              int syntiIdx = synti->index(mm->articulation->synti);
+                              job->init.push_back({ 0, syntiIdx, NPlayEvent(e) });
                               }
                         }
                   }
+            }
 
-            static const unsigned FRAMES = 512;
-            float buffer[FRAMES * 2];
-            int playTime = 0;
-
-            for (;;) {
-                  unsigned frames = FRAMES;
-                  //
-                  // collect events for one segment
-                  //
-                  float max = 0.0;
-                  memset(buffer, 0, sizeof(float) * FRAMES * 2);
-                  int endTime = playTime + frames;
-                  float* p = buffer;
-                  for (; playPos != events.cend(); ++playPos) {
-                        int f = score->utick2utime(playPos->first) * MScore::sampleRate;
-                        if (f >= endTime)
-                              break;
-                        int n = f - playTime;
-                        if (n) {
-                              synti->process(n, p);
-                              p += 2 * n;
-                              }
-
-                        playTime  += n;
-                        frames    -= n;
-                        const NPlayEvent& e = playPos->second;
-                        if (e.isChannelEvent()) {
-                              int channelIdx = e.channel();
-                              Channel* c = score->masterScore()->midiMapping(channelIdx)->articulation;
-                              if (!c->mute) {
-                                    synti->play(e, synti->index(c->synti));
-                                    }
-                              }
-                        }
-                  if (frames) {
-                        synti->process(frames, p);
-                        playTime += frames;
-                        }
-                  if (pass == 1) {
-                        for (unsigned i = 0; i < FRAMES * 2; ++i) {
-                              max = qMax(max, qAbs(buffer[i]));
-                              buffer[i] *= gain;
-                              }
-                        sf_writef_float(sf, buffer, FRAMES);
-                        }
-                  else {
-                        for (unsigned i = 0; i < FRAMES * 2; ++i) {
-                              max = qMax(max, qAbs(buffer[i]));
-                              peak = qMax(peak, qAbs(buffer[i]));
-                              }
-                        }
-                  playTime = endTime;
-                  if (!MScore::noGui) {
-                        if (progress.wasCanceled())
-                              break;
-                        progress.setValue((pass * et + playTime) / 2);
-                        qApp->processEvents();
-                        }
-                  if (playTime >= et)
-                        synti->allNotesOff(-1);
-                  // create sound until the sound decays
-                  if (playTime >= et && max*peak < 0.000001)
-                        break;
-                  // hard limit
-                  if (playTime > maxEndTime)
-                        break;
+      //
+      // convert ticks to frames once
+      //
+      int lastTick     = -1;
+      qint64 lastFrame = 0;
+      for (const auto& pe : events) {
+            const NPlayEvent& e = pe.second;
+            if (!e.isChannelEvent())
+                  continue;
+            const MidiMapping* mm = ms->midiMapping(e.channel());
+            Channel* c = mm->articulation;
+            if (c->mute)
+                  continue;
+            if (pe.first != lastTick) {
+                  lastTick  = pe.first;
+                  lastFrame = score->utick2utime(lastTick) * MScore::sampleRate;
                   }
+            AudioRenderJob* job = partJob.value(mm->part, jobs[0]);
+            job->events.push_back({ lastFrame, synti->index(c->synti), e });
+            }
+
+      //
+      // render and mix
+      //
+      std::atomic<bool> canceled { false };
+      QTemporaryFile mixFile;
+      mixFile.open();
+      QFuture<float> future = QtConcurrent::run(renderAudio, jobs, et, maxEndTime, &mixFile, &canceled);
+      if (MScore::noGui)
+            future.waitForFinished();
+      while (!future.isFinished()) {
             if (progress.wasCanceled())
-                  break;
-            if (pass == 0 && peak == 0.0) {
-                  qDebug("song is empty");
-                  break;
+                  canceled = true;
+            qint64 playTime = 0;
+            for (AudioRenderJob* job : jobs)
+                  playTime += job->playTime;
+            progress.setValue(int(qMin(playTime / jobs.size(), et)));
+            qApp->processEvents();
+            QThread::msleep(20);
+            }
+      float peak = future.result();
+
+      //
+      // write normalized
+      //
+      if (!canceled && peak == 0.0)
+            qDebug("song is empty");
+      else if (!canceled) {
+            double gain = 0.99 / peak;
+            float buffer[AUDIO_FRAMES * 2];
+            mixFile.seek(0);
+            while (mixFile.read(reinterpret_cast<char*>(buffer), sizeof(buffer)) == sizeof(buffer)) {
+                  for (unsigned i = 0; i < AUDIO_FRAMES * 2; ++i)
+                        buffer[i] *= gain;
+                  sf_writef_float(sf, buffer, AUDIO_FRAMES);
                   }
-            gain = 0.99 / peak;
             }
 
-      bool wasCanceled = progress.wasCanceled();
+      bool wasCanceled = canceled;
       progress.close();
 
       MScore::sampleRate = oldSampleRate;
-      delete synti;
+      for (AudioRenderJob* job : jobs)
+            releaseSynthesizer(job->synti);
+      qDeleteAll(jobs);
       if (sf_close(sf)) {
             qDebug("close soundfile failed");
             return false;
@@ -240,6 +240,7 @@ bool ExportMidi::write(const QString& name, bool midiExpandRepeats)
             EventMap events;
             cs->renderStaff(&events, staff);
             cs->renderSpanners(&events, staffIdx);
+            events.finalize();
 
             // Pass throught the all instruments in the part
             const InstrumentList* il = part->instruments();
@@ -140,6 +140,21 @@ static QString createDefaultFileName(QString fn)
       return fn;
       }
 
+//---------------------------------------------------------
+//   flushDeferredLayout
+//    lay out the scores written with score: the score
+//    itself and the part scores of a master score
+//---------------------------------------------------------
+
+static void flushDeferredLayout(Score* score)
+      {
+      score->doDeferredLayout();
+      if (score->isMaster()) {
+            for (Excerpt* e : score->excerpts())
+                  e->partScore()->doDeferredLayout();
+            }
+      }
+
 //---------------------------------------------------------
 //   readScoreError
 //    if "ask" is true, ask to ignore; returns true if
@@ -385,6 +400,7 @@ bool MuseScore::saveFile(MasterScore* score)
       {
       if (score == 0)
             return false;
+      flushDeferredLayout(score);
       if (score->created()) {
             QString fn = score->masterScore()->fileInfo()->fileName();
             Text* t = score->getText(SubStyle::TITLE);
@@ -433,6 +449,7 @@ bool MuseScore::saveFile(MasterScore* score)
             tab2->setTabText(idx, score->fileInfo()->completeBaseName());
       QString tmp = score->tmpName();
       if (!tmp.isEmpty()) {
+            autoSaveFuture.waitForFinished();   // a running autosave could recreate the file
             QFile f(tmp);
             if (!f.remove())
                   qDebug("cannot remove temporary file <%s>", qPrintable(f.fileName()));
@@ -1512,8 +1529,7 @@ void MuseScore::printFile()
             p.setRenderHint(QPainter::TextAntialiasing, true);
             double mag = printerDev.logicalDpiX() / DPI;
 
-            double pr = MScore::pixelRatio;
-            MScore::pixelRatio = 1.0 / mag;
+            RenderScope rs(1.0 / mag, true);
             p.scale(mag, mag);
 
             int fromPage = printerDev.fromPage() - 1;
@@ -1536,7 +1552,6 @@ void MuseScore::printFile()
                         }
                   }
             p.end();
-            MScore::pixelRatio = pr;
             }
 
       if (layoutMode != cs->layoutMode()) {
@@ -1775,6 +1790,7 @@ bool MuseScore::saveAs(Score* cs, bool saveCopy, const QString& path, const QStr
       if (!fn.endsWith(suffix))
             fn += suffix;
 
+      flushDeferredLayout(cs);
       LayoutMode layoutMode = cs->layoutMode();
       if (layoutMode != LayoutMode::PAGE) {
             cs->setLayoutMode(LayoutMode::PAGE);
@@ -1888,8 +1904,7 @@ bool MuseScore::savePdf(const QString& saveName)
 
 bool MuseScore::savePdf(Score* cs, const QString& saveName)
       {
-      cs->setPrinting(true);
-      MScore::pdfPrinting = true;
+      cs->doDeferredLayout();
 
       QPdfWriter printerDev(saveName);
       printerDev.setResolution(preferences.exportPdfDpi);
@@ -1922,8 +1937,7 @@ bool MuseScore::savePdf(Score* cs, const QString& saveName)
          size.height()*printerDev.logicalDpiY()));
       p.setWindow(QRect(0.0, 0.0, size.width() * DPI, size.height() * DPI));
 
-      double pr = MScore::pixelRatio;
-      MScore::pixelRatio = DPI / printerDev.logicalDpiX();
+      RenderScope rs(DPI / printerDev.logicalDpiX(), true, true);
 
       const QList<Page*> pl = cs->pages();
       int pages = pl.size();
@@ -1935,10 +1949,6 @@ bool MuseScore::savePdf(Score* cs, const QString& saveName)
             cs->print(&p, n);
             }
       p.end();
-      cs->setPrinting(false);
-
-      MScore::pixelRatio = pr;
-      MScore::pdfPrinting = false;
       return true;
       }
 
@@ -1946,6 +1956,8 @@ bool MuseScore::savePdf(QList<Score*> cs, const QString& saveName)
       {
       if (cs.empty())
             return false;
+      for (Score* s : cs)
+            s->doDeferredLayout();
       Score* firstScore = cs[0];
 
       QPrinter printerDev(QPrinter::HighResolution);
@@ -1980,9 +1992,7 @@ bool MuseScore::savePdf(QList<Score*> cs, const QString& saveName)
          size.height() * printerDev.logicalDpiY()));
       p.setWindow(QRect(0.0, 0.0, size.width() * DPI, size.height() * DPI));
 
-      double pr = MScore::pixelRatio;
-      MScore::pixelRatio = DPI / printerDev.logicalDpiX();
-      MScore::pdfPrinting = true;
+      RenderScope rs(DPI / printerDev.logicalDpiX(), true, true);
 
       bool firstPage = true;
       for (Score* s : cs) {
@@ -1992,7 +2002,6 @@ bool MuseScore::savePdf(QList<Score*> cs, const QString& saveName)
             //      s->doLayout();
                   }
             s->doLayout();
-            s->setPrinting(true);
 
 //            const PageFormat* pf = s->pageFormat();
 //            printerDev.setPaperSize(pf->size(), QPrinter::Inch);
@@ -2006,16 +2015,12 @@ bool MuseScore::savePdf(QList<Score*> cs, const QString& saveName)
                   s->print(&p, n);
                   }
             //reset score
-            s->setPrinting(false);
-
             if (layoutMode != s->layoutMode()) {
                   s->setLayoutMode(layoutMode);
                   s->doLayout();
                   }
             }
       p.end();
-      MScore::pdfPrinting = false;
-      MScore::pixelRatio = pr;
       return true;
       }
 
@@ -2261,6 +2266,7 @@ bool MuseScore::saveSelection(Score* cs)
             return false;
             }
       bool rv = true;
+      cs->doDeferredLayout();
       try {
             cs->saveCompressedFile(fi, true);
             }
@@ -2358,9 +2364,7 @@ bool MuseScore::savePng(Score* score, const QString& name)
 
 bool MuseScore::savePng(Score* score, const QString& name, bool screenshot, bool transparent, double convDpi, int trimMargin, QImage::Format format)
       {
-      bool rv = true;
-      score->setPrinting(!screenshot);    // dont print page break symbols etc.
-      double pr = MScore::pixelRatio;
+      score->doDeferredLayout();
 
       QImage::Format f;
       if (format != QImage::Format_Indexed8)
@@ -2371,11 +2375,50 @@ bool MuseScore::savePng(Score* score, const QString& name, bool screenshot, bool
       const QList<Page*>& pl = score->pages();
       int pages = pl.size();
 
+      // ask for overwrite confirmation first, the pages are
+      // rendered outside of the gui thread
+      QList<QPair<int, QString>> jobs;
       int padding = QString("%1").arg(pages).size();
       bool overwrite = false;
       bool noToAll = false;
       for (int pageNumber = 0; pageNumber < pages; ++pageNumber) {
-            Page* page = pl.at(pageNumber);
+            QString fileName(name);
+            if (fileName.endsWith(".png"))
+                  fileName = fileName.left(fileName.size() - 4);
+            fileName += QString("-%1.png").arg(pageNumber+1, padding, 10, QLatin1Char('0'));
+            if (!converterMode) {
+                  QFileInfo fip(fileName);
+                  if(fip.exists() && !overwrite) {
+                        if(noToAll)
+                              continue;
+                        QMessageBox msgBox( QMessageBox::Question, tr("Confirm Replace"),
+                              tr("\"%1\" already exists.\nDo you want to replace it?\n").arg(QDir::toNativeSeparators(fileName)),
+                              QMessageBox::Yes |  QMessageBox::YesToAll | QMessageBox::No |  QMessageBox::NoToAll);
+                        msgBox.setButtonText(QMessageBox::Yes, tr("Replace"));
+                        msgBox.setButtonText(QMessageBox::No, tr("Skip"));
+                        msgBox.setButtonText(QMessageBox::YesToAll, tr("Replace All"));
+                        msgBox.setButtonText(QMessageBox::NoToAll, tr("Skip All"));
+                        int sb = msgBox.exec();
+                        if(sb == QMessageBox::YesToAll) {
+                              overwrite = true;
+                              }
+                        else if (sb == QMessageBox::NoToAll) {
+                              noToAll = true;
+                              continue;
+                              }
+                        else if (sb == QMessageBox::No)
+                              continue;
+                        }
+                  }
+            jobs.append(qMakePair(pageNumber, fileName));
+            }
+
+      //
+      // every page is painted into its own image with its own
+      // render context, so the pages can be rendered in parallel
+      //
+      std::function<bool(const QPair<int, QString>&)> renderPage = [&](const QPair<int, QString>& job) {
+            Page* page = pl.at(job.first);
 
             QRectF r;
             if (trimMargin >= 0) {
@@ -2394,7 +2437,7 @@ bool MuseScore::savePng(Score* score, const QString& name, bool screenshot, bool
             printer.fill(transparent ? 0 : 0xffffffff);
 
             double mag = convDpi / DPI;
-            MScore::pixelRatio = 1.0 / mag;
+            RenderScope rs(1.0 / mag, !screenshot);     // dont print page break symbols etc.
 
             QPainter p(&printer);
             p.setRenderHint(QPainter::Antialiasing, true);
@@ -2406,6 +2449,7 @@ bool MuseScore::savePng(Score* score, const QString& name, bool screenshot, bool
             QList<Element*> pel = page->elements();
             qStableSort(pel.begin(), pel.end(), elementLessThan);
             paintElements(p, pel);
+            p.end();
 
             if (format == QImage::Format_Indexed8) {
                   //convert to grayscale & respect alpha
@@ -2421,42 +2465,11 @@ bool MuseScore::savePng(Score* score, const QString& name, bool screenshot, bool
                         }
                   printer = printer.convertToFormat(QImage::Format_Indexed8, colorTable);
                   }
+            return printer.save(job.second, "png");
+            };
 
-            QString fileName(name);
-            if (fileName.endsWith(".png"))
-                  fileName = fileName.left(fileName.size() - 4);
-            fileName += QString("-%1.png").arg(pageNumber+1, padding, 10, QLatin1Char('0'));
-            if (!converterMode) {
-                  QFileInfo fip(fileName);
-                  if(fip.exists() && !overwrite) {
-                        if(noToAll)
-                              continue;
-                        QMessageBox msgBox( QMessageBox::Question, tr("Confirm Replace"),
-                              tr("\"%1\" already exists.\nDo you want to replace it?\n").arg(QDir::toNativeSeparators(fileName)),
-                              QMessageBox::Yes |  QMessageBox::YesToAll | QMessageBox::No |  QMessageBox::NoToAll);
-                        msgBox.setButtonText(QMessageBox::Yes, tr("Replace"));
-                        msgBox.setButtonText(QMessageBox::No, tr("Skip"));
-                        msgBox.setButtonText(QMessageBox::YesToAll, tr("Replace All"));
-                        msgBox.setButtonText(QMessageBox::NoToAll, tr("Skip All"));
-                        int sb = msgBox.exec();
-                        if(sb == QMessageBox::YesToAll) {
-                              overwrite = true;
-                              }
-                        else if (sb == QMessageBox::NoToAll) {
-                              noToAll = true;
-                              continue;
-                              }
-                        else if (sb == QMessageBox::No)
-                              continue;
-                        }
-                  }
-            rv = printer.save(fileName, "png");
-            if (!rv)
-                  break;
-            }
-      score->setPrinting(false);
-      MScore::pixelRatio = pr;
-      return rv;
+      QList<bool> results = QtConcurrent::blockingMapped<QList<bool>>(jobs, renderPage);
+      return !results.contains(false);
       }
 
 //---------------------------------------------------------
@@ -2569,14 +2582,12 @@ QString MuseScore::getWallpaper(const QString& caption)
 bool MuseScore::saveSvg(Score* score, const QString& saveName)
       {
       QString title(score->title());
-      score->setPrinting(true);
-      MScore::pdfPrinting = true;
+      score->doDeferredLayout();
       const QList<Page*>& pl = score->pages();
       int pages = pl.size();
       int padding = QString("%1").arg(pages).size();
       bool overwrite = false;
       bool noToAll = false;
-      double pr = MScore::pixelRatio;
       for (int pageNumber = 0; pageNumber < pages; ++pageNumber) {
             Page* page = pl.at(pageNumber);
             SvgGenerator printer;
@@ -2628,7 +2639,7 @@ bool MuseScore::saveSvg(Score* score, const QString& saveName)
             p.setRenderHint(QPainter::TextAntialiasing, true);
             if (trimMargin >= 0 && score->npages() == 1)
                   p.translate(-r.topLeft());
-            MScore::pixelRatio = DPI / printer.logicalDpiX();
+            RenderScope rs(DPI / printer.logicalDpiX(), true, true);
             if (trimMargin >= 0)
                    p.translate(-r.topLeft());
             // 1st pass: StaffLines
@@ -2705,10 +2716,6 @@ bool MuseScore::saveSvg(Score* score, const QString& saveName)
             p.end(); // Writes MuseScore SVG file to disk, finally
             }
 
-      // Clean up and return
-      MScore::pixelRatio = pr;
-      score->setPrinting(false);
-      MScore::pdfPrinting = false;
       return true;
       }
 
@@ -779,7 +779,6 @@ bool ScoreView::saveFotoAs(bool printMode, const QRectF& r)
       int w = lrint(r.width()  * mag);
       int h = lrint(r.height() * mag);
 
-      double pr = MScore::pixelRatio;
       if (ext == "pdf") {
             QPrinter printer(QPrinter::HighResolution);
             mag = printer.logicalDpiX() / DPI;
@@ -791,7 +790,7 @@ bool ScoreView::saveFotoAs(bool printMode, const QRectF& r)
             printer.setOutputFileName(fn);
             if (ext == "pdf")
                   printer.setOutputFormat(QPrinter::PdfFormat);
-            MScore::pixelRatio = DPI / printer.logicalDpiX();
+            RenderScope rs(DPI / printer.logicalDpiX(), printMode);
             QPainter p(&printer);
             paintRect(printMode, p, r, mag);
             }
@@ -803,11 +802,9 @@ bool ScoreView::saveFotoAs(bool printMode, const QRectF& r)
             printer.setTitle(_score->title());
             printer.setSize(QSize(w, h));
             printer.setViewBox(QRect(0, 0, w, h));
-            MScore::pixelRatio = DPI / printer.logicalDpiX();
+            RenderScope rs(DPI / printer.logicalDpiX(), printMode, true);
             QPainter p(&printer);
-            MScore::pdfPrinting = true;
             paintRect(printMode, p, r, mag);
-            MScore::pdfPrinting = false;
             }
       else if (ext == "png") {
             QImage::Format f = QImage::Format_ARGB32_Premultiplied;
@@ -815,14 +812,13 @@ bool ScoreView::saveFotoAs(bool printMode, const QRectF& r)
             printer.setDotsPerMeterX(lrint((convDpi * 1000) / INCH));
             printer.setDotsPerMeterY(lrint((convDpi * 1000) / INCH));
             printer.fill(transparent ? 0 : 0xffffffff);
-            MScore::pixelRatio = 1.0 / mag;
+            RenderScope rs(1.0 / mag, printMode);
             QPainter p(&printer);
             paintRect(printMode, p, r, mag);
             printer.save(fn, "png");
             }
       else
             qDebug("unknown extension <%s>", qPrintable(ext));
-      MScore::pixelRatio = pr;
       return true;
       }
 
@@ -837,7 +833,7 @@ void ScoreView::paintRect(bool printMode, QPainter& p, const QRectF& r, double m
       p.setRenderHint(QPainter::Antialiasing, true);
       p.setRenderHint(QPainter::TextAntialiasing, true);
 
-      score()->setPrinting(printMode);
+      RenderScope rs(MScore::pixelRatio(), printMode, MScore::pdfPrinting());
 
       foreach (Page* page, _score->pages()) {
             // QRectF pr(page->abbox());
@@ -852,8 +848,6 @@ void ScoreView::paintRect(bool printMode, QPainter& p, const QRectF& r, double m
             drawElements(p, ell);
             p.translate(-page->pos());
             }
-
-      score()->setPrinting(false);
       p.end();
       }
 
@@ -883,9 +877,8 @@ void ScoreView::fotoDragDrop(QMouseEvent*)
       printer.setSize(QSize(w, h));
       printer.setViewBox(QRect(0, 0, w, h));
       QPainter p(&printer);
-      MScore::pdfPrinting = true;
+      RenderScope rs(MScore::pixelRatio(), printMode, true);
       paintRect(printMode, p, r, 1);
-      MScore::pdfPrinting = false;
 
       QDrag* drag = new QDrag(this);
       QMimeData* mimeData = new QMimeData;
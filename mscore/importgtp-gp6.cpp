@@ -73,46 +73,54 @@ const static std::map<QString, QString> instrumentMapping = {
             };
 
 //---------------------------------------------------------
-//   readBit
+//   GPXBitReader
+//    msb first bit reader for the BCFZ stream; bits are
+//    loaded a byte at a time into a 64 bit accumulator,
+//    reading past the end of the data yields zero bits
 //---------------------------------------------------------
 
-int GuitarPro6::readBit() {
-      // calculate the byte index by dividing the position in bits by the bits per byte
-      int byteIndex = this->position / BITS_IN_BYTE;
-      // calculate our offset so we know how much to bit shift
-      int byteOffset = ((BITS_IN_BYTE-1) - (this->position % BITS_IN_BYTE));
-      // calculate the bit which we want to read
-      int bit = ((((*buffer)[byteIndex] & 0xff) >> byteOffset) & 0x01);
-      // increment our curent position so we know this bit has been read
-      this->position++;
-      // return the bit we calculated
-      return bit;
-      }
-
-
-//---------------------------------------------------------
-//   readBits
-//---------------------------------------------------------
-
-int GuitarPro6::readBits(int bitsToRead) {
-      int bits = 0;
-      for (int i = (bitsToRead-1); i>=0; i--) {
-            bits |= (readBit() << i);
+class GPXBitReader {
+      const uchar* _data;
+      int _size;
+      int _next;              // next byte to load into _acc
+      quint64 _acc { 0 };     // pending bits, left aligned
+      int _bits    { 0 };     // number of pending bits
+
+      void fill() {
+            while (_bits <= 56) {
+                  quint64 b = _next < _size ? _data[_next] : 0;
+                  ++_next;
+                  _acc  |= b << (56 - _bits);
+                  _bits += 8;
+                  }
             }
-      return bits;
-      }
 
-//---------------------------------------------------------
-//   readBitsReversed
-//---------------------------------------------------------
-
-int GuitarPro6::readBitsReversed(int bitsToRead) {
-      int bits = 0;
-      for( int i = 0 ; i < bitsToRead ; i ++ ) {
-            bits |= (readBit() << i );
+   public:
+      GPXBitReader(const QByteArray& data, int offset)
+         : _data(reinterpret_cast<const uchar*>(data.constData())), _size(data.size()), _next(offset) {}
+      qint64 position() const { return qint64(_next) * 8 - _bits; }
+      bool atEnd() const      { return position() >= qint64(_size) * 8; }
+
+      int readBits(int n) {
+            if (n == 0)
+                  return 0;
+            if (_bits < n)
+                  fill();
+            int v = int(_acc >> (64 - n));
+            _acc <<= n;
+            _bits -= n;
+            return v;
             }
-      return bits;
-      }
+      int readBitsReversed(int n) {
+            int v = readBits(n);
+            int r = 0;
+            for (int i = 0; i < n; ++i) {
+                  r = (r << 1) | (v & 1);
+                  v >>= 1;
+                  }
+            return r;
+            }
+      };
 
 //---------------------------------------------------------
 //   getBytes
@@ -162,6 +170,50 @@ QByteArray GuitarPro6::readString(QByteArray* buffer, int offset, int length) {
       return filename;
 }
 
+//---------------------------------------------------------
+//   decompressBCFZ
+//    decode a BCFZ compressed file (header, expected length,
+//    then a stream of literal and back reference chunks)
+//    into the contained BCFS file
+//---------------------------------------------------------
+
+QByteArray GuitarPro6::decompressBCFZ(const QByteArray& buffer)
+      {
+      QByteArray bcfsBuffer;
+      if (buffer.size() < 8)
+            return bcfsBuffer;
+      const uchar* d = reinterpret_cast<const uchar*>(buffer.constData());
+      int length = d[4] | (d[5] << 8) | (d[6] << 16) | (d[7] << 24);
+      bcfsBuffer.reserve(int(qBound(qint64(0), qint64(length), qint64(buffer.size()) * 64)));
+
+      GPXBitReader reader(buffer, 8);
+      while (reader.position() / 8 < length && !reader.atEnd()) {
+            // read the bit indicating compression information
+            if (reader.readBits(1)) {
+                  int bits = reader.readBits(4);
+                  int offs = reader.readBitsReversed(bits);
+                  int size = reader.readBitsReversed(bits);
+
+                  int pos = bcfsBuffer.size() - offs;
+                  if (pos < 0) {
+                        qDebug("GuitarPro6::decompressBCFZ: bad back reference");
+                        break;
+                        }
+                  int n = qMin(size, offs);
+                  // make room first, the copy source is inside bcfsBuffer
+                  if (bcfsBuffer.capacity() < bcfsBuffer.size() + n)
+                        bcfsBuffer.reserve(qMax(bcfsBuffer.size() + n, bcfsBuffer.capacity() * 2));
+                  bcfsBuffer.append(bcfsBuffer.constData() + pos, n);
+                  }
+            else  {
+                  int size = reader.readBitsReversed(2);
+                  for (int i = 0; i < size; i++)
+                        bcfsBuffer.append(char(reader.readBits(8)));
+                  }
+            }
+      return bcfsBuffer;
+      }
+
 //---------------------------------------------------------
 //   readGPX
 //---------------------------------------------------------
@@ -172,36 +224,9 @@ void GuitarPro6::readGPX(QByteArray* buffer) {
 
       if (fileHeader == GPX_HEADER_COMPRESSED) {
             // this is  a compressed file.
-            int length = readInteger(buffer, this->position/BITS_IN_BYTE);
-            QByteArray* bcfsBuffer = new QByteArray();
-            int positionCounter = 0;
-            while(!f->error() && (this->position/this->BITS_IN_BYTE) < length) {
-                  // read the bit indicating compression information
-                  int flag = this->readBits(1);
-
-                  if (flag) {
-                        int bits = this->readBits(4);
-                        int offs = this->readBitsReversed(bits);
-                        int size = this->readBitsReversed(bits);
-
-                        QByteArray bcfsBufferCopy = *bcfsBuffer;
-                        int pos = (bcfsBufferCopy.length() - offs );
-                        for( int i = 0; i < (size > offs ? offs : size) ; i ++ ) {
-                              bcfsBuffer->insert(positionCounter, bcfsBufferCopy[pos + i] ) ;
-                              positionCounter++;
-                              }
-                        }
-                  else  {
-                        int size = this->readBitsReversed(2);
-                        for(int i = 0; i < size; i++) {
-                              bcfsBuffer->insert(positionCounter, this->readBits(8));
-                              positionCounter++;
-                              }
-                        }
-                  }
-             // recurse on the decompressed file stored as a byte array
-             readGPX(bcfsBuffer);
-             delete bcfsBuffer;
+            QByteArray bcfsBuffer = decompressBCFZ(*buffer);
+            // recurse on the decompressed file stored as a byte array
+            readGPX(&bcfsBuffer);
             }
       else if (fileHeader == GPX_HEADER_UNCOMPRESSED) {
             // this is an uncompressed file - strip the header off
@@ -354,13 +354,10 @@ class GuitarPro6 : public GuitarPro {
       // a mapping from identifiers to fret diagrams
       QMap<int, FretDiagram*> fretDiagrams;
       void parseFile(char* filename, QByteArray* data);
-      int readBit();
       QByteArray getBytes(QByteArray* buffer, int offset, int length);
       void readGPX(QByteArray* buffer);
       int readInteger(QByteArray* buffer, int offset);
       QByteArray readString(QByteArray* buffer, int offset, int length);
-      int readBits(int bitsToRead);
-      int readBitsReversed(int bitsToRead);
       void readGpif(QByteArray* data);
       void readScore(QDomNode* metadata);
       void readChord(QDomNode* diagram, int track);
@@ -385,6 +382,7 @@ class GuitarPro6 : public GuitarPro {
 
    public:
       GuitarPro6(Score* s) : GuitarPro(s, 6) {}
+      static QByteArray decompressBCFZ(const QByteArray& buffer);
       virtual void read(QFile*);
       };
 
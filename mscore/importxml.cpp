@@ -92,6 +92,32 @@ static bool initMusicXmlSchema(QXmlSchema& schema)
       return true;
       }
 
+//---------------------------------------------------------
+//   createMusicXmlSchema
+//    return 0 on error
+//---------------------------------------------------------
+
+static QXmlSchema* createMusicXmlSchema()
+      {
+      QXmlSchema* schema = new QXmlSchema;
+      if (!initMusicXmlSchema(*schema)) {
+            delete schema;
+            return 0;
+            }
+      return schema;
+      }
+
+//---------------------------------------------------------
+//   musicXmlSchema
+//    the schema is compiled on first use and kept for the
+//    lifetime of the process; return 0 on error
+//---------------------------------------------------------
+
+static const QXmlSchema* musicXmlSchema()
+      {
+      static const QXmlSchema* schema = createMusicXmlSchema();   // initialized once, also with concurrent imports
+      return schema;
+      }
 
 //---------------------------------------------------------
 //   musicXMLValidationErrorDialog
@@ -185,15 +211,15 @@ static Score::FileError doValidate(const QString& name, QIODevice* dev)
       QTime t;
       t.start();
 
-      // initialize the schema
-      ValidatorMessageHandler messageHandler;
-      QXmlSchema schema;
-      schema.setMessageHandler(&messageHandler);
-      if (!initMusicXmlSchema(schema))
+      // get the schema
+      const QXmlSchema* schema = musicXmlSchema();
+      if (!schema)
             return Score::FileError::FILE_BAD_FORMAT;  // appropriate error message has been printed by initMusicXmlSchema
 
       // validate the data
-      QXmlSchemaValidator validator(schema);
+      ValidatorMessageHandler messageHandler;
+      QXmlSchemaValidator validator(*schema);
+      validator.setMessageHandler(&messageHandler);
       bool valid = validator.validate(dev, QUrl::fromLocalFile(name));
       qDebug("Validation time elapsed: %d ms", t.elapsed());
 
@@ -226,13 +252,21 @@ static Score::FileError doValidateAndImport(Score* score, const QString& name, Q
       tupletAssert();
 
       // validate the file
+      // in converter mode an invalid file is imported anyway, so it is
+      // validated only when the import fails, to set MScore::lastError
       Score::FileError res;
-      res = doValidate(name, dev);
-      if (res != Score::FileError::FILE_NO_ERROR)
-            return res;
+      if (!MScore::noGui) {
+            res = doValidate(name, dev);
+            if (res != Score::FileError::FILE_NO_ERROR)
+                  return res;
+            }
 
       // actually do the import
-      importMusicXMLfromBuffer(score, name, dev);
+      res = importMusicXMLfromBuffer(score, name, dev);
+      if (MScore::noGui && res != Score::FileError::FILE_NO_ERROR) {
+            dev->seek(0);
+            doValidate(name, dev);
+            }
       qDebug("importMusicXml() return %d", int(res));
       return res;
       }
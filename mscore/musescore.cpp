@@ -71,6 +71,7 @@
 #include "inspector/inspector.h"
 #ifdef OMR
 #include "omrpanel.h"
+#include "omr/omr.h"
 #endif
 #include "shortcut.h"
 #ifdef SCRIPT_INTERFACE
@@ -108,13 +109,15 @@
 #include "searchComboBox.h"
 #include "startcenter.h"
 #include "help.h"
+#include "batchserver.h"
+#include "libmscore/layouttrace.h"
 #include "awl/aslider.h"
 
 #ifdef AEOLUS
 extern Ms::Synthesizer* createAeolus();
 #endif
 #ifdef ZERBERUS
-extern Ms::Synthesizer* createZerberus();
+extern Ms::Synthesizer* createZerberus(bool backgroundLoading);
 #endif
 
 #ifdef QT_NO_DEBUG
@@ -156,6 +159,10 @@ static QString audioDriver;
 static QString pluginName;
 static QString styleFile;
 static bool scoresOnCommandline { false };
+static bool batchServer = false;
+static QString batchSocket;
+static int batchJobs = 0;
+static int batchTimeout = 0;
 
 static QList<QTranslator*> translatorList;
 
@@ -388,6 +395,7 @@ void MuseScore::closeEvent(QCloseEvent* ev)
             scoreList.removeAll(score);
 
       writeSessionFile(true);
+      autoSaveFuture.waitForFinished();
       for (MasterScore* score : scoreList) {
             if (!score->tmpName().isEmpty()) {
                   QFile f(score->tmpName());
@@ -549,7 +557,7 @@ MuseScore::MuseScore()
                   guiScaling = 1.0;
             }
 
-      MScore::pixelRatio = DPI / screen->logicalDotsPerInch();
+      MScore::setPixelRatio(DPI / screen->logicalDotsPerInch());
 
       setObjectName("MuseScore");
       _sstate = STATE_INIT;
@@ -2321,6 +2329,7 @@ void MuseScore::removeTab(int i)
             setCurrentScoreView((firstTab ? tab1 : tab2)->view());
       writeSessionFile(false);
       if (!tmpName.isEmpty()) {
+            autoSaveFuture.waitForFinished();
             QFile f(tmpName);
             f.remove();
             }
@@ -2711,6 +2720,136 @@ static bool doProcessJob(QString jsonFile)
       return true;
       }
 
+//---------------------------------------------------------
+//   doBatchJob
+//    convert one job of the batch server in this process;
+//    style and parts apply to this job only
+//---------------------------------------------------------
+
+static QJsonObject doBatchJob(const QJsonObject& job)
+      {
+      QElapsedTimer timer;
+      timer.start();
+
+      QString inFile = job.value("in").toString();
+      QStringList outFiles;
+      QJsonValue out = job.value("out");
+      if (out.isArray()) {
+            for (const QJsonValue& v : out.toArray())
+                  outFiles.append(v.toString());
+            }
+      else
+            outFiles.append(out.toString());
+
+      QString oldStyleFile  = styleFile;
+      bool oldScoreParts    = exportScoreParts;
+      if (job.contains("style"))
+            styleFile = job.value("style").toString();
+      if (job.contains("parts"))
+            exportScoreParts = job.value("parts").toBool();
+
+      QString error;
+      MasterScore* score = mscore->readScore(inFile);
+      qint64 loadMs = timer.elapsed();
+      if (!score)
+            error = QString("cannot read <%1>").arg(inFile);
+      else {
+            for (const QString& outFile : outFiles) {
+                  if (!doConvert(score, outFile)) {
+                        error = QString("cannot convert to <%1>").arg(outFile);
+                        break;
+                        }
+                  }
+            delete score;
+            }
+
+      styleFile        = oldStyleFile;
+      exportScoreParts = oldScoreParts;
+
+      QJsonObject result;
+      result["ok"] = error.isEmpty();
+      if (!error.isEmpty())
+            result["error"] = error;
+      result["out"]    = QJsonArray::fromStringList(outFiles);
+      result["loadMs"] = double(loadMs);
+      result["ms"]     = double(timer.elapsed());
+      return result;
+      }
+
+//---------------------------------------------------------
+//   workerTraceFile
+//    trace file of batch worker n: the name of the trace
+//    file of the server with "-worker<n>" appended to the
+//    base name
+//---------------------------------------------------------
+
+#ifdef LAYOUT_TRACE
+static QString workerTraceFile(const QString& path, int worker)
+      {
+      QFileInfo fi(path);
+      QString name = QString("%1-worker%2").arg(fi.completeBaseName()).arg(worker);
+      if (!fi.suffix().isEmpty())
+            name += "." + fi.suffix();
+      return fi.dir().filePath(name);
+      }
+#endif
+
+//---------------------------------------------------------
+//   runBatchServer
+//    the workers run this program with the same options,
+//    converting one job at a time; each worker traces the
+//    layout into its own file
+//---------------------------------------------------------
+
+static bool runBatchServer()
+      {
+      QStringList args;
+      QString traceFile;
+      QStringList al = QCoreApplication::arguments().mid(1);
+      for (int i = 0; i < al.size(); ++i) {
+            const QString& a = al[i];
+            if (a == "--trace-layout") {
+                  if (++i < al.size())
+                        traceFile = al[i];
+                  }
+            else if (a.startsWith("--trace-layout="))
+                  traceFile = a.mid(int(strlen("--trace-layout=")));
+            else if (a == "--batch-socket" || a == "--batch-jobs" || a == "--batch-timeout")
+                  ++i;
+            else if (!a.startsWith("--batch-socket=") && !a.startsWith("--batch-jobs=") && !a.startsWith("--batch-timeout="))
+                  args.append(a);
+            }
+      args << "--batch-jobs" << "1";
+      auto workerArguments = [args, traceFile](int worker) {
+            QStringList wa = args;
+#ifdef LAYOUT_TRACE
+            if (!traceFile.isEmpty())
+                  wa << "--trace-layout" << workerTraceFile(traceFile, worker);
+#else
+            Q_UNUSED(worker);
+#endif
+            return wa;
+            };
+
+#ifdef HAS_AUDIOFILE
+      setKeepSynthesizers(true);
+#endif
+      int jobs = batchJobs > 0 ? batchJobs : QThread::idealThreadCount();
+      BatchServer server(jobs, batchTimeout * 1000, doBatchJob, workerArguments);
+      if (!batchSocket.isEmpty()) {
+            if (!server.listen(batchSocket))
+                  return false;
+            }
+      else
+            server.readStdin();
+      QObject::connect(&server, &BatchServer::done, qApp, &QCoreApplication::exit);
+      int rv = qApp->exec();
+#ifdef HAS_AUDIOFILE
+      setKeepSynthesizers(false);
+#endif
+      return rv == 0;
+      }
+
 //---------------------------------------------------------
 //   processNonGui
 //---------------------------------------------------------
@@ -2744,6 +2883,8 @@ static bool processNonGui(const QStringList& argv)
                   return res;
             }
       bool rv = true;
+      if (batchServer)
+            return runBatchServer();
       if (converterMode) {
             if (processJob)
                   return doProcessJob(jsonFileName);
@@ -2785,21 +2926,24 @@ static void mscoreMessageHandler(QtMsgType type, const QMessageLogContext &conte
 
 //---------------------------------------------------------
 //   synthesizerFactory
-//    create and initialize the master synthesizer
+//    create and initialize the master synthesizer;
+//    a realtime synthesizer must not block on sample
+//    decoding and may render its synthesizers in parallel
 //---------------------------------------------------------
 
-MasterSynthesizer* synthesizerFactory()
+MasterSynthesizer* synthesizerFactory(bool realTime)
       {
       MasterSynthesizer* ms = new MasterSynthesizer();
 
       FluidS::Fluid* fluid = new FluidS::Fluid();
+      fluid->setBackgroundLoading(realTime);
       ms->registerSynthesizer(fluid);
 
 #ifdef AEOLUS
       ms->registerSynthesizer(::createAeolus());
 #endif
 #ifdef ZERBERUS
-      ms->registerSynthesizer(createZerberus());
+      ms->registerSynthesizer(createZerberus(realTime));
 #endif
       ms->registerEffect(0, new NoEffect);
       ms->registerEffect(0, new ZitaReverb);
@@ -2811,6 +2955,7 @@ MasterSynthesizer* synthesizerFactory()
       // ms->registerEffect(1, new Freeverb);
       ms->setEffect(0, 1);
       ms->setEffect(1, 0);
+      ms->setParallel(realTime && preferences.parallelSynthesizers);
       return ms;
       }
 
@@ -3830,39 +3975,66 @@ void MuseScore::removeSessionFile()
             }
       }
 
+//---------------------------------------------------------
+//   writeAutoSaveFiles
+//    runs in a worker thread
+//---------------------------------------------------------
+
+static void writeAutoSaveFiles(const QList<QPair<QString, SaveSnapshot>>& files)
+      {
+      for (const QPair<QString, SaveSnapshot>& file : files) {
+            // write to a temporary file first, so a crash while saving
+            // does not destroy the previous autosave
+            QSaveFile f(file.first);
+            if (!f.open(QIODevice::WriteOnly)) {
+                  qDebug("autosave: cannot open <%s>: %s", qPrintable(file.first), qPrintable(f.errorString()));
+                  continue;
+                  }
+            if (!Score::writeCompressedFile(&f, file.second) || !f.commit())
+                  qDebug("autosave: writing <%s> failed", qPrintable(file.first));
+            }
+      }
+
 //---------------------------------------------------------
 //   autoSaveTimerTimeout
+//    The scores are serialized here; compression and
+//    writing are done in a worker thread. A thumbnail is
+//    only created if the score is in page mode.
 //---------------------------------------------------------
 
 void MuseScore::autoSaveTimerTimeout()
       {
       bool sessionChanged = false;
+      if (autoSaveFuture.isRunning()) {
+            // previous autosave not finished yet, try again later
+            autoSaveTimer->start(5000);
+            return;
+            }
+      QList<QPair<QString, SaveSnapshot>> files;
       foreach (MasterScore* s, scoreList) {
             if (s->autosaveDirty()) {
                   QString tmp = s->tmpName();
-                  if (!tmp.isEmpty()) {
-                        QFileInfo fi(tmp);
-                        // TODO: cannot catch exeption here:
-                        s->saveCompressedFile(fi, false);
-                        }
-                  else {
+                  if (tmp.isEmpty()) {
                         QDir dir;
                         dir.mkpath(dataPath);
                         QTemporaryFile tf(dataPath + "/scXXXXXX.mscz");
                         tf.setAutoRemove(false);
                         if (!tf.open()) {
                               qDebug("autoSaveTimerTimeout(): create temporary file failed");
-                              return;
+                              break;
                               }
-                        s->setTmpName(tf.fileName());
-                        QFileInfo info(tf.fileName());
-                        s->saveCompressedFile(&tf, info, false);
+                        tmp = tf.fileName();
                         tf.close();
+                        s->setTmpName(tmp);
                         sessionChanged = true;
                         }
+                  files.append(QPair<QString, SaveSnapshot>(tmp, SaveSnapshot()));
+                  s->createSnapshot(&files.last().second, QFileInfo(tmp), false, false);
                   s->setAutosaveDirty(false);
                   }
             }
+      if (!files.isEmpty())
+            autoSaveFuture = QtConcurrent::run(writeAutoSaveFiles, files);
       if (sessionChanged)
             writeSessionFile(false);
       if (preferences.autoSave) {
@@ -5382,6 +5554,10 @@ int main(int argc, char* av[])
       parser.addOption(QCommandLineOption({"R", "revert-settings"}, "Revert to default preferences"));
       parser.addOption(QCommandLineOption({"i", "load-icons"}, "Load icons from INSTALLPATH/icons"));
       parser.addOption(QCommandLineOption({"j", "job"}, "process a conversion job", "file"));
+      parser.addOption(QCommandLineOption(      "batch-server", "Convert JSON jobs, one per line, read from stdin; results are written as JSON lines"));
+      parser.addOption(QCommandLineOption(      "batch-socket", "Used with --batch-server, accept jobs on a local socket instead of stdin", "name"));
+      parser.addOption(QCommandLineOption(      "batch-jobs", "Used with --batch-server, number of jobs converted concurrently, default one per core", "n"));
+      parser.addOption(QCommandLineOption(      "batch-timeout", "Used with --batch-server, a job converting longer than 'seconds' fails", "seconds"));
       parser.addOption(QCommandLineOption({"e", "experimental"}, "Enable experimental features"));
       parser.addOption(QCommandLineOption({"c", "config-folder"}, "Override config/settings folder", "dir"));
       parser.addOption(QCommandLineOption({"t", "test-mode"}, "Set testMode flag for all files"));
@@ -5390,6 +5566,10 @@ int main(int argc, char* av[])
       parser.addOption(QCommandLineOption({"P", "export-score-parts"}, "Used with -o <file>.pdf, export score + parts"));
       parser.addOption(QCommandLineOption(      "no-fallback-font", "will not use Bravura as fallback musical font"));
       parser.addOption(QCommandLineOption({"f", "force"}, "Used with -o, ignore warnings reg. score being corrupted or from wrong version"));
+      parser.addOption(QCommandLineOption(      "omr-threads", "Number of threads processing pdf pages on import, default one per core", "n"));
+#ifdef LAYOUT_TRACE
+      parser.addOption(QCommandLineOption(      "trace-layout", "Time the layout phases; write a Chrome trace if 'file' ends in .json, else a table of the phases; batch workers write 'file-worker<n>'", "file"));
+#endif
 
       parser.addPositionalArgument("scorefiles", "The files to open", "[scorefile...]");
 
@@ -5430,6 +5610,27 @@ int main(int argc, char* av[])
                   parser.showHelp(EXIT_FAILURE);
                   }
             }
+      if ((batchServer = parser.isSet("batch-server"))) {
+            MScore::noGui = true;
+            converterMode = true;
+            }
+      if (parser.isSet("batch-socket")) {
+            batchSocket = parser.value("batch-socket");
+            if (batchSocket.isEmpty() || !batchServer)
+                  parser.showHelp(EXIT_FAILURE);
+            }
+      if (parser.isSet("batch-jobs")) {
+            QString temp = parser.value("batch-jobs");
+            if (temp.isEmpty() || !batchServer)
+                  parser.showHelp(EXIT_FAILURE);
+            batchJobs = qMax(temp.toInt(), 0);
+            }
+      if (parser.isSet("batch-timeout")) {
+            QString temp = parser.value("batch-timeout");
+            if (temp.isEmpty() || !batchServer)
+                  parser.showHelp(EXIT_FAILURE);
+            batchTimeout = qMax(temp.toInt(), 0);
+            }
       if ((pluginMode = parser.isSet("p"))) {
             MScore::noGui = true;
             pluginName = parser.value("p");
@@ -5501,6 +5702,23 @@ int main(int argc, char* av[])
       if (exportScoreParts && !converterMode)
             parser.showHelp(EXIT_FAILURE);
       ignoreWarnings = parser.isSet("f");
+      if (parser.isSet("omr-threads")) {
+            QString temp = parser.value("omr-threads");
+            if (temp.isEmpty())
+                  parser.showHelp(EXIT_FAILURE);
+#ifdef OMR
+            Omr::threads = qMax(temp.toInt(), 0);
+#endif
+            }
+#ifdef LAYOUT_TRACE
+      if (parser.isSet("trace-layout")) {
+            QString temp = parser.value("trace-layout");
+            if (temp.isEmpty())
+                  parser.showHelp(EXIT_FAILURE);
+            LayoutTrace::start(temp);
+            atexit([]() { LayoutTrace::stop(); });
+            }
+#endif
 
       QStringList argv = parser.positionalArguments();
 
@@ -5686,7 +5904,7 @@ int main(int argc, char* av[])
             seq            = new Seq();
             MScore::seq    = seq;
             Driver* driver = driverFactory(seq, audioDriver);
-            synti          = synthesizerFactory();
+            synti          = synthesizerFactory(true);
             if (driver) {
                   MScore::sampleRate = driver->sampleRate();
                   synti->setSampleRate(MScore::sampleRate);
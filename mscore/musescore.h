@@ -331,6 +331,7 @@ class MuseScore : public QMainWindow, public MuseScoreCore {
       void removeMenuEntry(PluginDescription*);
 
       QTimer* autoSaveTimer;
+      QFuture<void> autoSaveFuture;       // autosave files being written
       QList<QAction*> pluginActions;
       QSignalMapper* pluginMapper        { 0 };
 
@@ -751,7 +752,8 @@ extern MuseScore* mscore;
 extern QStringList recentScores;
 extern QString dataPath;
 extern MasterSynthesizer* synti;
-MasterSynthesizer* synthesizerFactory();
+MasterSynthesizer* synthesizerFactory(bool realTime = false);
+extern void setKeepSynthesizers(bool);
 Driver* driverFactory(Seq*, QString driver);
 
 extern QAction* getAction(const char*);
@@ -202,6 +202,10 @@ void Preferences::init()
       nativeDialogs           = false;    // don't use system native file dialogs
 #endif
       exportAudioSampleRate   = exportAudioSampleRates[0];
+      exportAudioThreads      = 1;
+      zerberusStreaming       = false;
+      zerberusPreloadFrames   = 32768;
+      parallelSynthesizers    = true;
 
       workspace               = "Basic";
       exportPdfDpi            = 300;
@@ -337,6 +341,10 @@ void Preferences::write()
       s.setValue("vraster", MScore::vRaster());
       s.setValue("nativeDialogs", nativeDialogs);
       s.setValue("exportAudioSampleRate", exportAudioSampleRate);
+      s.setValue("exportAudioThreads", exportAudioThreads);
+      s.setValue("zerberusStreaming", zerberusStreaming);
+      s.setValue("zerberusPreloadFrames", zerberusPreloadFrames);
+      s.setValue("parallelSynthesizers", parallelSynthesizers);
 
       s.setValue("workspace", workspace);
       s.setValue("exportPdfDpi", exportPdfDpi);
@@ -509,6 +517,10 @@ void Preferences::read()
 
       nativeDialogs    = s.value("nativeDialogs", nativeDialogs).toBool();
       exportAudioSampleRate = s.value("exportAudioSampleRate", exportAudioSampleRate).toInt();
+      exportAudioThreads    = s.value("exportAudioThreads", exportAudioThreads).toInt();
+      zerberusStreaming     = s.value("zerberusStreaming", zerberusStreaming).toBool();
+      zerberusPreloadFrames = s.value("zerberusPreloadFrames", zerberusPreloadFrames).toInt();
+      parallelSynthesizers  = s.value("parallelSynthesizers", parallelSynthesizers).toBool();
 
       workspace          = s.value("workspace", workspace).toString();
       exportPdfDpi       = s.value("exportPdfDpi", exportPdfDpi).toInt();
@@ -177,6 +177,10 @@ struct Preferences {
       bool nativeDialogs;
 
       int exportAudioSampleRate;
+      int exportAudioThreads;       // number of synthesizers rendering parts in parallel
+      bool zerberusStreaming;       // read sfz samples from disk while playing
+      int zerberusPreloadFrames;    // frames of a streamed sample kept in memory
+      bool parallelSynthesizers;    // render the synthesizers of a playback block concurrently
 
       QString workspace;
       int exportPdfDpi;
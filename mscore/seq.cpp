@@ -23,6 +23,7 @@
 #include "musescore.h"
 
 #include "synthesizer/msynthesizer.h"
+#include "fluid/fluid.h"
 #include "libmscore/slur.h"
 #include "libmscore/tie.h"
 #include "libmscore/score.h"
@@ -47,6 +48,7 @@
 #include "click.h"
 
 #include <vorbis/vorbisfile.h>
+#include <chrono>
 
 namespace Ms {
 
@@ -147,7 +149,9 @@ Seq::Seq()
       state    = Transport::STOP;
       oggInit  = false;
       _driver  = 0;
-      playPos  = events.cbegin();
+      playEvents = new EventMap;
+      playPos  = playEvents->cbegin();
+      guiPos   = events.cbegin();
 
       playTime  = 0;
       metronomeVolume = 0.3;
@@ -187,6 +191,9 @@ Seq::Seq()
 Seq::~Seq()
       {
       delete _driver;
+      deleteOldPlayEvents();
+      delete newPlayEvents.exchange(0);
+      delete playEvents;
       }
 
 //---------------------------------------------------------
@@ -206,7 +213,14 @@ void Seq::setScoreView(ScoreView* v)
       cv = v;
       if (cs)
             disconnect(cs, SIGNAL(playlistChanged()), this, SLOT(setPlaylistChanged()));
-      cs = cv ? cv->score()->masterScore() : 0;
+      MasterScore* ns = cv ? cv->score()->masterScore() : 0;
+      if (ns != cs) {
+            // events are spliced by the score which rendered them
+            events.clear();
+            guiPos = events.cbegin();
+            publishPlayEvents();
+            }
+      cs = ns;
 
       if (!heartBeatTimer->isActive())
             heartBeatTimer->start(20);    // msec
@@ -356,6 +370,7 @@ void Seq::stop()
 void Seq::stopWait()
       {
       stop();
+      QMutex mutex;
       QWaitCondition sleep;
       int idx = 0;
       while (state != Transport::STOP) {
@@ -435,11 +450,14 @@ void Seq::seqMessage(int msg, int arg)
       {
       switch(msg) {
             case '5': {
-                  // Update the screen after seeking from the realtime thread
-                  Segment* seg = cs->tick2segment(arg);
+                  // The realtime thread did seek to utick arg, update
+                  // the gui position and the screen
+                  seekCommon(arg);
+                  int tick = cs->repeatList()->utick2tick(arg);
+                  Segment* seg = cs->tick2segment(tick);
                   if (seg)
                         mscore->currentScoreView()->moveCursor(seg->tick());
-                  cs->setPlayPos(arg);
+                  cs->setPlayPos(tick);
                   cs->update();
                   break;
                   }
@@ -538,10 +556,8 @@ void Seq::recomputeMaxMidiOutPort()
 
 void Seq::processMessages()
       {
-      for (;;) {
-            if (toSeq.empty())
-                  break;
-            SeqMsg msg = toSeq.dequeue();
+      SeqMsg msg;
+      while (toSeq.dequeue(&msg)) {
             switch(msg.id) {
                   case SeqMsgId::TEMPO_CHANGE:
                         {
@@ -641,6 +657,7 @@ void Seq::addCountInClicks()
       event.setType(ME_INVALID);
       event.setPitch(0);
       countInEvents.insert( std::pair<int,NPlayEvent>(endTick, event));
+      countInEvents.finalize();
       // initialize play parameters to count-in events
       countInPlayPos  = countInEvents.cbegin();
       countInPlayTime = 0;
@@ -655,6 +672,25 @@ void Seq::addCountInClicks()
 //-------------------------------------------------------------------
 
 void Seq::process(unsigned n, float* buffer)
+      {
+      auto startTime = std::chrono::steady_clock::now();
+
+      processBuffer(n, buffer);
+
+      int usec   = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+      int budget = int(qint64(n) * 1000000 / MScore::sampleRate);
+      if (usec > _maxProcessTime.load(std::memory_order_relaxed))
+            _maxProcessTime.store(usec, std::memory_order_relaxed);
+      if (usec > budget)
+            _xruns.fetch_add(1, std::memory_order_relaxed);
+      }
+
+//---------------------------------------------------------
+//   processBuffer
+//    realtime thread
+//---------------------------------------------------------
+
+void Seq::processBuffer(unsigned n, float* buffer)
       {
       unsigned frames = n;
       Transport driverState = _driver->getState();
@@ -705,9 +741,9 @@ void Seq::process(unsigned n, float* buffer)
                   // Muting all notes
                   stopNotes(-1, true);
                   initInstruments(true);
-                  if (playPos == events.cend()) {
+                  if (playPos == playEvents->cend()) {
                         if (mscore->loop()) {
-                              qDebug("Seq.cpp - Process - Loop whole score. playPos = %d     cs->pos() = %d", playPos->first,cs->pos());
+                              qDebug("Seq.cpp - Process - Loop whole score. playPos = %d     cs->pos() = %d", int(playPosUtick), cs->pos());
                               emit toGui('4');
                               return;
                               }
@@ -727,13 +763,14 @@ void Seq::process(unsigned n, float* buffer)
       memset(buffer, 0, sizeof(float) * n * 2); // assume two channels
       float* p = buffer;
 
+      takePlayEvents();
       processMessages();
 
       if (state == Transport::PLAY) {
             if (!cs)
                   return;
             EventMap::const_iterator* pPlayPos = &playPos;
-            EventMap* pEvents   = &events;
+            const EventMap* pEvents = playEvents;
             int*      pPlayTime = &playTime;
             //
             // in count-in?
@@ -839,9 +876,9 @@ void Seq::process(unsigned n, float* buffer)
                         tackRemain = tackLength;
                         tackVolume = event.velo() ? qreal(event.value()) / 127.0 : 1.0;
                         }
-                  mutex.lock();
                   ++(*pPlayPos);
-                  mutex.unlock();
+                  if (!inCountIn)
+                        updatePlayPosUtick();
                   }
             if (frames) {
                   if (cs->playMode() == PlayMode::SYNTHESIZER) {
@@ -886,8 +923,8 @@ void Seq::process(unsigned n, float* buffer)
             }
       else {
             // Outside of playback mode
-            while (!liveEventQueue()->empty()) {
-                  const NPlayEvent& event = liveEventQueue()->dequeue();
+            NPlayEvent event;
+            while (liveEventQueue.dequeue(&event)) {
                   if (event.type() == ME_TICK1) {
                         tickRemain = tickLength;
                         tickVolume = event.velo() ? qreal(event.value()) / 127.0 : 1.0;
@@ -986,10 +1023,8 @@ void Seq::collectEvents()
       //do not collect even while playing
       if (state ==  Transport::PLAY)
             return;
-      events.clear();
 
-      mutex.lock();
-      cs->renderMidi(&events);
+      cs->renderMidiIncremental(&events);
       endTick = 0;
 
       if (!events.empty()) {
@@ -997,12 +1032,78 @@ void Seq::collectEvents()
             --e;
             endTick = e->first;
             }
-      playPos  = events.cbegin();
-      mutex.unlock();
+      guiPos = events.cbegin();
+      publishPlayEvents();
 
       playlistChanged = false;
       }
 
+//---------------------------------------------------------
+//   publishPlayEvents
+//    hand a copy of events to the realtime thread
+//    gui thread
+//---------------------------------------------------------
+
+void Seq::publishPlayEvents()
+      {
+      deleteOldPlayEvents();
+      EventMap* ev = new EventMap(events);
+      ev->finalize();   // the realtime thread only reads the map
+      // a map not yet taken by the realtime thread was never used there
+      delete newPlayEvents.exchange(ev, std::memory_order_acq_rel);
+      }
+
+//---------------------------------------------------------
+//   deleteOldPlayEvents
+//    gui thread
+//---------------------------------------------------------
+
+void Seq::deleteOldPlayEvents()
+      {
+      EventMap* ev;
+      while (oldPlayEvents.dequeue(&ev))
+            delete ev;
+      }
+
+//---------------------------------------------------------
+//   takePlayEvents
+//    switch to the events published last by the gui
+//    thread, keeping the play position
+//    realtime thread
+//---------------------------------------------------------
+
+void Seq::takePlayEvents()
+      {
+      EventMap* ev = newPlayEvents.exchange(0, std::memory_order_acq_rel);
+      if (!ev)
+            return;
+      playPos = playPos == playEvents->cend() ? ev->cend() : ev->lower_bound(playPos->first);
+      // the queue cannot overflow as the gui thread empties it
+      // before publishing new events
+      if (!oldPlayEvents.enqueue(playEvents))
+            delete playEvents;
+      playEvents = ev;
+      updatePlayPosUtick();
+      }
+
+//---------------------------------------------------------
+//   updatePlayPosUtick
+//    publish the play position to the gui thread
+//    realtime thread
+//---------------------------------------------------------
+
+void Seq::updatePlayPosUtick()
+      {
+      if (playPos != playEvents->cend())
+            playPosUtick.store(playPos->first, std::memory_order_relaxed);
+      else
+            playPosUtick.store(endTick, std::memory_order_relaxed);
+      auto ppos = playPos;
+      if (ppos != playEvents->cbegin())
+            --ppos;
+      lastPlayedUtick.store(ppos != playEvents->cend() ? ppos->first : 0, std::memory_order_relaxed);
+      }
+
 //---------------------------------------------------------
 //   getCurTick
 //---------------------------------------------------------
@@ -1024,18 +1125,19 @@ void Seq::setRelTempo(double relTempo)
 
 //---------------------------------------------------------
 //   setPos
-//    seek
+//    seek; with skipTarget playback starts behind the
+//    events at utick
 //    realtime environment
 //---------------------------------------------------------
 
-void Seq::setPos(int utick)
+void Seq::setPos(int utick, bool skipTarget)
       {
       if (cs == 0)
             return;
       stopNotes(-1, true);
 
       int ucur;
-      if (playPos != events.end())
+      if (playPos != playEvents->cend())
             ucur = cs->repeatList()->utick2tick(playPos->first);
       else
             ucur = utick - 1;
@@ -1043,16 +1145,15 @@ void Seq::setPos(int utick)
             updateSynthesizerState(ucur, utick);
 
       playTime  = cs->utick2utime(utick) * MScore::sampleRate;
-      mutex.lock();
-      playPos   = events.lower_bound(utick);
-      mutex.unlock();
+      playPos   = skipTarget ? playEvents->upper_bound(utick) : playEvents->lower_bound(utick);
+      updatePlayPosUtick();
       }
 
 //---------------------------------------------------------
 //   seekCommon
-//   a common part of seek() and seekRT(), contains code
-//   that could be safely called from any thread.
+//   the gui thread part of seek() and seekRT().
 //   Do not use explicitly, use seek() or seekRT()
+//   gui thread
 //---------------------------------------------------------
 
 void Seq::seekCommon(int utick)
@@ -1101,6 +1202,8 @@ void Seq::seek(int utick)
 
 //---------------------------------------------------------
 //   seekRT
+//   moves the play position only, the gui thread is sent
+//   a request to follow
 //   realtime thread
 //---------------------------------------------------------
 
@@ -1108,10 +1211,10 @@ void Seq::seekRT(int utick)
       {
       if (preferences.useJackTransport && utick > endTick)
                   utick = 0;
-      seekCommon(utick);
-      setPos(utick);
-      // Update the screen in GUI thread
-      emit toGui('5', cs->repeatList()->utick2tick(utick));
+      // the events at utick were just played, do not play them again
+      bool played = playPos != playEvents->cbegin() && std::prev(playPos)->first == utick;
+      setPos(utick, played);
+      emit toGui('5', utick);
       }
 
 //---------------------------------------------------------
@@ -1142,7 +1245,8 @@ void Seq::playMetronomeBeat(BeatType type)
       {
       if (state != Transport::STOP)
             return;
-      liveEventQueue()->enqueue(NPlayEvent(type));
+      if (!liveEventQueue.enqueue(NPlayEvent(type)))
+            ++_droppedMessages;
       }
 
 //---------------------------------------------------------
@@ -1273,9 +1377,13 @@ void Seq::prevMeasure()
 
 void Seq::prevChord()
       {
-      int tick  = playPos->first;
+      if (events.empty())
+            return;
+      int tick  = playPosUtick;
       //find the chord just before playpos
       EventMap::const_iterator i = events.upper_bound(cs->repeatList()->tick2utick(tick));
+      if (i == events.cend())
+            --i;
       for (;;) {
             if (i->second.type() == ME_NOTEON) {
                   const NPlayEvent& n = i->second;
@@ -1290,7 +1398,9 @@ void Seq::prevChord()
             }
       //go the previous chord
       if (i != events.cbegin()) {
-            i = playPos;
+            i = events.lower_bound(playPosUtick);
+            if (i == events.cend())
+                  --i;
             for (;;) {
                   if (i->second.type() == ME_NOTEON) {
                         const NPlayEvent& n = i->second;
@@ -1323,7 +1433,10 @@ void Seq::guiToSeq(const SeqMsg& msg)
       {
       if (!_driver || !running)
             return;
-      toSeq.enqueue(msg);
+      if (!toSeq.enqueue(msg)) {
+            ++_droppedMessages;
+            qDebug("===SeqMsgFifo: overflow");
+            }
       }
 
 //---------------------------------------------------------
@@ -1332,7 +1445,8 @@ void Seq::guiToSeq(const SeqMsg& msg)
 
 void Seq::eventToGui(NPlayEvent e)
       {
-      fromSeq.enqueue(SeqMsg(SeqMsgId::MIDI_INPUT_EVENT, e));
+      if (!fromSeq.enqueue(SeqMsg(SeqMsgId::MIDI_INPUT_EVENT, e)))
+            ++_droppedMessages;
       }
 
 //---------------------------------------------------------
@@ -1345,53 +1459,6 @@ void Seq::midiInputReady()
             _driver->midiRead();
       }
 
-//---------------------------------------------------------
-//   SeqMsgFifo
-//---------------------------------------------------------
-
-SeqMsgFifo::SeqMsgFifo()
-      {
-      maxCount = SEQ_MSG_FIFO_SIZE;
-      clear();
-      }
-
-//---------------------------------------------------------
-//   enqueue
-//---------------------------------------------------------
-
-void SeqMsgFifo::enqueue(const SeqMsg& msg)
-      {
-      int i = 0;
-      int n = 50;
-
-      QMutex mutex;
-      QWaitCondition qwc;
-      mutex.lock();
-      for (; i < n; ++i) {
-            if (!isFull())
-                  break;
-            qwc.wait(&mutex,100);
-            }
-      mutex.unlock();
-      if (i == n) {
-            qDebug("===SeqMsgFifo: overflow");
-            return;
-            }
-      messages[widx] = msg;
-      push();
-      }
-
-//---------------------------------------------------------
-//   dequeue
-//---------------------------------------------------------
-
-SeqMsg SeqMsgFifo::dequeue()
-      {
-      SeqMsg msg = messages[ridx];
-      pop();
-      return msg;
-      }
-
 //---------------------------------------------------------
 //   putEvent
 //---------------------------------------------------------
@@ -1427,8 +1494,22 @@ void Seq::heartBeatTimeout()
             sc->setMeter(meterValue[0], meterValue[1], meterPeakValue[0], meterPeakValue[1]);
             }
 
-      while (!fromSeq.empty()) {
-            SeqMsg msg = fromSeq.dequeue();
+      deleteOldPlayEvents();
+      if (MScore::debugMode && _xruns != reportedXruns) {
+            reportedXruns = _xruns;
+            qDebug("Seq: %d xruns, max. process time %d usec, %d messages dropped",
+               reportedXruns, int(_maxProcessTime), int(_droppedMessages));
+            }
+      // counted by the synthesizer in the realtime thread
+      Synthesizer* fluid = _synti ? _synti->synthesizer("Fluid") : 0;
+      int droppedNotes   = fluid ? static_cast<FluidS::Fluid*>(fluid)->droppedNotes() : 0;
+      if (droppedNotes != reportedDroppedNotes) {
+            qDebug("Seq: %d notes dropped, their samples were not loaded in time", droppedNotes - reportedDroppedNotes);
+            reportedDroppedNotes = droppedNotes;
+            }
+
+      SeqMsg msg;
+      while (fromSeq.dequeue(&msg)) {
             if (msg.id == SeqMsgId::MIDI_INPUT_EVENT) {
                   int type = msg.event.type();
                   if (type == ME_NOTEON)
@@ -1444,12 +1525,7 @@ void Seq::heartBeatTimeout()
             return;
 
       int endTime = playTime;
-
-      mutex.lock();
-      auto ppos = playPos;
-      if (ppos != events.cbegin())
-            --ppos;
-      mutex.unlock();
+      int putick  = lastPlayedUtick;
 
       if (cs && cs->sigmap()->timesig(getCurTick()).nominal()!=prevTimeSig) {
             prevTimeSig = cs->sigmap()->timesig(getCurTick()).nominal();
@@ -1462,7 +1538,7 @@ void Seq::heartBeatTimeout()
 
       QRectF r;
       for (;guiPos != events.cend(); ++guiPos) {
-            if (guiPos->first > ppos->first)
+            if (guiPos->first > putick)
                   break;
             if (mscore->loop())
                   if (guiPos->first >= cs->repeatList()->tick2utick(cs->loopOutTick()))
@@ -1488,7 +1564,7 @@ void Seq::heartBeatTimeout()
                         }
                   }
             }
-      int utick = ppos->first;
+      int utick = putick;
       int tick = cs->repeatList()->utick2tick(utick);
       mscore->currentScoreView()->moveCursor(tick);
       mscore->setPos(tick);
@@ -1517,11 +1593,10 @@ void Seq::updateSynthesizerState(int tick1, int tick2)
       {
       if (tick1 > tick2)
             tick1 = 0;
-      // Making a local copy of events to avoid touching it
-      // from different threads at the same time
-      EventMap ev = events;
-      EventMap::const_iterator i1 = ev.lower_bound(tick1);
-      EventMap::const_iterator i2 = ev.upper_bound(tick2);
+      // playEvents is not modified by other threads
+      const EventMap* ev = playEvents;
+      EventMap::const_iterator i1 = ev->lower_bound(tick1);
+      EventMap::const_iterator i2 = ev->upper_bound(tick2);
 
       for (; i1 != i2; ++i1) {
             if (i1->second.type() == ME_CONTROLLER)
@@ -1535,7 +1610,7 @@ void Seq::updateSynthesizerState(int tick1, int tick2)
 
 double Seq::curTempo() const
       {
-      return cs->tempomap()->tempo(playPos->first);
+      return cs->tempomap()->tempo(playPosUtick);
       }
 
 //---------------------------------------------------------
@@ -1546,10 +1621,8 @@ void Seq::setLoopIn()
       {
       int tick;
       if (state == Transport::PLAY) {      // If in playback mode, set the In position where note is being played
-            auto ppos = playPos;
-            if (ppos != events.cbegin())
-                  --ppos;                 // We have to go back one pos to get the correct note that has just been played
-            tick = cs->repeatList()->utick2tick(ppos->first);
+            // We have to go back one pos to get the correct note that has just been played
+            tick = cs->repeatList()->utick2tick(lastPlayedUtick);
             }
       else
             tick = cs->pos();             // Otherwise, use the selected note.
@@ -1566,7 +1639,7 @@ void Seq::setLoopOut()
       {
       int tick;
       if (state == Transport::PLAY) {    // If in playback mode, set the Out position where note is being played
-            tick = cs->repeatList()->utick2tick(playPos->first);
+            tick = cs->repeatList()->utick2tick(playPosUtick);
             }
       else
             tick = cs->pos() + cs->inputState().ticks();   // Otherwise, use the selected note.
@@ -1580,6 +1653,18 @@ void Seq::setLoopOut()
             guiToSeq(SeqMsg(SeqMsgId::SEEK, tick));
       }
 
+//---------------------------------------------------------
+//   resetStatistics
+//---------------------------------------------------------
+
+void Seq::resetStatistics()
+      {
+      _xruns           = 0;
+      _maxProcessTime  = 0;
+      _droppedMessages = 0;
+      reportedXruns    = 0;
+      }
+
 void Seq::setPos(POS, unsigned tick)
       {
       qDebug("seq: setPos %d", tick);
@@ -76,17 +76,9 @@ struct SeqMsg {
 //   SeqMsgFifo
 //---------------------------------------------------------
 
-static const int SEQ_MSG_FIFO_SIZE = 1024*8;
+static const unsigned SEQ_MSG_FIFO_SIZE = 1024*8;
 
-class SeqMsgFifo : public FifoBase {
-      SeqMsg messages[SEQ_MSG_FIFO_SIZE];
-
-   public:
-      SeqMsgFifo();
-      virtual ~SeqMsgFifo()     {}
-      void enqueue(const SeqMsg&);        // put object on fifo
-      SeqMsg dequeue();                   // remove object from fifo
-      };
+typedef SpscQueue<SeqMsg, SEQ_MSG_FIFO_SIZE> SeqMsgFifo;
 
 // this are also the jack audio transport states:
 enum class Transport : char {
@@ -104,8 +96,6 @@ enum class Transport : char {
 class Seq : public QObject, public Sequencer {
       Q_OBJECT
 
-      mutable QMutex mutex;
-
       MasterScore* cs;
       ScoreView* cv;
       bool running;                       // true if sequencer is available
@@ -133,17 +123,29 @@ class Seq : public QObject, public Sequencer {
       double meterPeakValue[2];
       int peakTimer[2];
 
-      EventMap events;                    // playlist for playback mode (pre-rendered)
+      EventMap events;                    // playlist for playback mode (pre-rendered), gui thread
+      EventMap* playEvents;               // immutable copy of events played by the realtime thread
+      std::atomic<EventMap*> newPlayEvents { 0 };     // published by the gui thread, taken by process()
+      SpscQueue<EventMap*, 16> oldPlayEvents;         // replaced by process(), deleted in the gui thread
       EventMap countInEvents;
-      QQueue<NPlayEvent> _liveEventQueue;  // playlist for score editing and note entry (rendered live)
+      SpscQueue<NPlayEvent, 1024> liveEventQueue;     // playlist for score editing and note entry (rendered live)
 
       int playTime;                       // current play position in samples
       int countInPlayTime;
       int endTick;
 
-      EventMap::const_iterator playPos;   // moved in real time thread
+      EventMap::const_iterator playPos;   // moved in real time thread, points into playEvents
       EventMap::const_iterator countInPlayPos;
-      EventMap::const_iterator guiPos;    // moved in gui thread
+      EventMap::const_iterator guiPos;    // moved in gui thread, points into events
+      std::atomic<int> playPosUtick    { 0 };   // position of playPos for the gui thread
+      std::atomic<int> lastPlayedUtick { 0 };   // position of the event played last
+
+      // realtime statistics
+      std::atomic<int> _xruns           { 0 };  // process() calls which took longer than the buffer
+      std::atomic<int> _maxProcessTime  { 0 };  // usec
+      std::atomic<int> _droppedMessages { 0 };  // lost because of a full queue
+      int reportedXruns { 0 };
+      int reportedDroppedNotes { 0 };     // notes the synthesizer could not play
       QList<const Note*> markedNotes;     // notes marked as sounding
 
       uint tackRemain;        // metronome state (remaining audio samples)
@@ -157,7 +159,12 @@ class Seq : public QObject, public Sequencer {
 
       void collectMeasureEvents(Measure*, int staffIdx);
 
-      void setPos(int);
+      void setPos(int utick, bool skipTarget = false);
+      void updatePlayPosUtick();
+      void takePlayEvents();
+      void publishPlayEvents();
+      void deleteOldPlayEvents();
+      void processBuffer(unsigned, float*);
       void playEvent(const NPlayEvent&, unsigned framePos);
       void guiToSeq(const SeqMsg& msg);
       void metronome(unsigned n, float* l, bool force);
@@ -166,8 +173,6 @@ class Seq : public QObject, public Sequencer {
       void updateSynthesizerState(int tick1, int tick2);
       void addCountInClicks();
 
-      inline QQueue<NPlayEvent>* liveEventQueue() { return &_liveEventQueue; }
-
    private slots:
       void seqMessage(int msg, int arg = 0);
       void heartBeatTimeout();
@@ -249,6 +254,11 @@ class Seq : public QObject, public Sequencer {
       void stopNoteTimer();
       void recomputeMaxMidiOutPort();
       float metronomeGain() const      { return metronomeVolume; }
+
+      int xruns() const                { return _xruns;           }
+      int maxProcessTime() const       { return _maxProcessTime;  }
+      int droppedMessages() const      { return _droppedMessages; }
+      void resetStatistics();
       };
 
 extern Seq* seq;
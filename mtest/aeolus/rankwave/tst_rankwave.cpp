@@ -0,0 +1,105 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2017 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+
+#include "mtest/testutils.h"
+#include "aeolus/rankwave.h"
+#include "aeolus/scales.h"
+
+using namespace Ms;
+
+//---------------------------------------------------------
+//   TestRankwave
+//---------------------------------------------------------
+
+class TestRankwave : public QObject, public MTest
+      {
+      Q_OBJECT
+
+      QByteArray generate(Addsynth* D, const QString& dir);
+
+   private slots:
+      void initTestCase()     { initMTest(); }
+      void deterministic();   // the same waves in every generation
+      void cleanCache();
+      };
+
+//---------------------------------------------------------
+//   generate
+//    generate the rank of D, save it to dir and return
+//    the cache file
+//---------------------------------------------------------
+
+QByteArray TestRankwave::generate(Addsynth* D, const QString& dir)
+      {
+      Rankwave rw(D->_n0, D->_n1);
+      rw.gen_waves(D, 44100.0f, 440.0f, scales[0]._data);
+      if (rw.save(qPrintable(dir), D, 44100.0f, 440.0f, scales[0]._data))
+            return QByteArray();
+      QStringList files = QDir(dir).entryList(QStringList("*.ae1"), QDir::Files);
+      if (files.size() != 1)
+            return QByteArray();
+      QFile f(dir + "/" + files[0]);
+      if (!f.open(QIODevice::ReadOnly))
+            return QByteArray();
+      return f.readAll();
+      }
+
+//---------------------------------------------------------
+//   deterministic
+//---------------------------------------------------------
+
+void TestRankwave::deterministic()
+      {
+      Addsynth D;
+      strcpy(D._filename, "flute8.ae0");
+      QCOMPARE(D.load(qPrintable(root + "/aeolus/stops")), 0);
+
+      QTemporaryDir dir1;
+      QTemporaryDir dir2;
+      QByteArray a = generate(&D, dir1.path());
+      QByteArray b = generate(&D, dir2.path());
+      QVERIFY(!a.isEmpty());
+      QVERIFY(a == b);
+      }
+
+//---------------------------------------------------------
+//   cleanCache
+//    keyless files of older versions go, fresh temporary
+//    files stay and MAX_CACHED files are kept per stop
+//---------------------------------------------------------
+
+void TestRankwave::cleanCache()
+      {
+      QTemporaryDir dir;
+      QStringList files;
+      files << "flute8.ae1" << "flute8-0123456789abcdef.ae1.0x1234.tmp";
+      for (int i = 0; i < Rankwave::MAX_CACHED + 2; ++i)
+            files << QString("flute8-%1.ae1").arg(i, 16, 16, QChar('0'));
+      files << "tibia8-0123456789abcdef.ae1";
+      for (const QString& n : files) {
+            QFile f(dir.path() + "/" + n);
+            QVERIFY(f.open(QIODevice::WriteOnly));
+            }
+
+      Rankwave::clean_cache(qPrintable(dir.path()));
+
+      QDir d(dir.path());
+      QVERIFY(!d.exists("flute8.ae1"));
+      QVERIFY(d.exists("flute8-0123456789abcdef.ae1.0x1234.tmp"));
+      QVERIFY(d.exists("tibia8-0123456789abcdef.ae1"));
+      QCOMPARE(d.entryList(QStringList("flute8-*.ae1"), QDir::Files).size(), int(Rankwave::MAX_CACHED));
+      }
+
+QTEST_MAIN(TestRankwave)
+#include "tst_rankwave.moc"
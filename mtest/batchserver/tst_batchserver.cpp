@@ -0,0 +1,185 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2017 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+
+#include "mscore/batchserver.h"
+
+using namespace Ms;
+
+//---------------------------------------------------------
+//   runJob
+//    The converter of the test, "in" says what to do:
+//       "sleep:<ms>"  take ms to convert
+//       "print"       write something looking like a
+//                     failed result to stdout
+//       "crash"       abort the process
+//---------------------------------------------------------
+
+static QJsonObject runJob(const QJsonObject& job)
+      {
+      QString in = job.value("in").toString();
+      if (in.startsWith("sleep:"))
+            QThread::msleep(in.mid(6).toInt());
+      else if (in == "print") {
+            printf("{\"ok\":false,\"error\":\"printed\"}\n");
+            fflush(stdout);
+            }
+      else if (in == "crash")
+            abort();
+      QJsonObject result;
+      result["ok"] = true;
+      return result;
+      }
+
+//---------------------------------------------------------
+//   runWorker
+//    the test program started as a worker of the server
+//---------------------------------------------------------
+
+static int runWorker(int argc, char* argv[])
+      {
+      QCoreApplication app(argc, argv);
+      BatchServer server(1, 0, runJob, [](int) { return QStringList(); });
+      server.readStdin();
+      QObject::connect(&server, &BatchServer::done, &app, &QCoreApplication::exit);
+      return app.exec();
+      }
+
+//---------------------------------------------------------
+//   TestBatchServer
+//---------------------------------------------------------
+
+class TestBatchServer : public QObject
+      {
+      Q_OBJECT
+
+      QMap<int, QJsonObject> run(BatchServer* server, const QStringList& jobs);
+
+   private slots:
+      void inProcess();       // jobs and bad jobs without workers
+      void workers();         // crashes and output of the workers
+      void timeout();
+      };
+
+//---------------------------------------------------------
+//   run
+//    send jobs to server on a local socket and return the
+//    results by id
+//---------------------------------------------------------
+
+QMap<int, QJsonObject> TestBatchServer::run(BatchServer* server, const QStringList& jobs)
+      {
+      QMap<int, QJsonObject> results;
+      QString name = QString("tst_batchserver-%1").arg(QCoreApplication::applicationPid());
+      if (!server->listen(name))
+            return results;
+      QLocalSocket client;
+      client.connectToServer(name);
+      if (!client.waitForConnected(5000))
+            return results;
+      for (const QString& job : jobs)
+            client.write(job.toUtf8() + '\n');
+      client.flush();
+
+      QElapsedTimer timer;
+      timer.start();
+      int n = 0;
+      while (n < jobs.size() && timer.elapsed() < 30000) {
+            QTest::qWait(10);
+            while (client.canReadLine()) {
+                  QJsonObject result = QJsonDocument::fromJson(client.readLine()).object();
+                  results[result.value("id").toInt(-1)] = result;
+                  ++n;
+                  }
+            }
+      return results;
+      }
+
+//---------------------------------------------------------
+//   inProcess
+//---------------------------------------------------------
+
+void TestBatchServer::inProcess()
+      {
+      BatchServer server(1, 0, runJob, [](int) { return QStringList(); });
+      QMap<int, QJsonObject> r = run(&server, QStringList()
+         << "{\"id\":1,\"in\":\"sleep:10\",\"out\":\"a.pdf\"}"
+         << "{\"id\":2,\"in\":\"a.mscz\",\"out\":\"a.pdf\",\"color\":\"red\"}"
+         << "{\"id\":3,\"in\":\"a.mscz\"}"
+         << "{\"id\":4,\"in\":\"sleep:10\",\"out\":[\"a.pdf\",\"a.png\"]}");
+      QCOMPARE(r.size(), 4);
+      QVERIFY(r[1].value("ok").toBool());
+      QVERIFY(r[4].value("ok").toBool());
+      QCOMPARE(r[2].value("error").toString(), QString("unknown key <color>"));
+      QCOMPARE(r[3].value("error").toString(), QString("no output file"));
+      for (const QJsonObject& o : r) {
+            QVERIFY(o.contains("waitMs"));
+            QVERIFY(o.contains("ms"));
+            }
+      }
+
+//---------------------------------------------------------
+//   workers
+//    the output of a conversion is not taken for its
+//    result, a crash fails only the crashing job
+//---------------------------------------------------------
+
+void TestBatchServer::workers()
+      {
+      BatchServer server(2, 0, runJob, [](int) { return QStringList("--worker"); });
+      QMap<int, QJsonObject> r = run(&server, QStringList()
+         << "{\"id\":1,\"in\":\"print\",\"out\":\"a.pdf\"}"
+         << "{\"id\":2,\"in\":\"crash\",\"out\":\"a.pdf\"}"
+         << "{\"id\":3,\"in\":\"sleep:10\",\"out\":\"a.pdf\"}"
+         << "{\"id\":4,\"in\":\"sleep:10\",\"out\":\"a.pdf\"}");
+      QCOMPARE(r.size(), 4);
+      QVERIFY(r[1].value("ok").toBool());
+      QCOMPARE(r[2].value("error").toString(), QString("worker crashed"));
+      QVERIFY(r[3].value("ok").toBool());
+      QVERIFY(r[4].value("ok").toBool());
+      QVERIFY(r[3].contains("worker"));
+      }
+
+//---------------------------------------------------------
+//   timeout
+//    even with one job at a time the jobs run in a worker,
+//    which is replaced after a job taking too long
+//---------------------------------------------------------
+
+void TestBatchServer::timeout()
+      {
+      BatchServer server(1, 500, runJob, [](int) { return QStringList("--worker"); });
+      QMap<int, QJsonObject> r = run(&server, QStringList()
+         << "{\"id\":1,\"in\":\"sleep:60000\",\"out\":\"a.pdf\"}"
+         << "{\"id\":2,\"in\":\"sleep:10\",\"out\":\"a.pdf\"}");
+      QCOMPARE(r.size(), 2);
+      QVERIFY(!r[1].value("ok").toBool());
+      QCOMPARE(r[1].value("error").toString(), QString("timeout after 0.5 s"));
+      QVERIFY(r[1].value("ms").toDouble() >= 500.0);
+      QVERIFY(r[2].value("ok").toBool());
+      }
+
+//---------------------------------------------------------
+//   main
+//---------------------------------------------------------
+
+int main(int argc, char* argv[])
+      {
+      if (argc > 1 && !strcmp(argv[1], "--worker"))
+            return runWorker(argc, argv);
+      QCoreApplication app(argc, argv);
+      TestBatchServer test;
+      return QTest::qExec(&test, argc, argv);
+      }
+
+#include "tst_batchserver.moc"
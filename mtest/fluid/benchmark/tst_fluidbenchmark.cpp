@@ -0,0 +1,269 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2017 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+
+#include "mtest/testutils.h"
+#include "synthesizer/event.h"
+#include "fluid/fluid.h"
+#include "fluid/sfont.h"
+#include "fluid/voice.h"
+#include "fluid/kernels.h"
+
+using namespace Ms;
+using FluidS::DspKernels;
+
+Q_DECLARE_METATYPE(FluidS::DspKernels::Level)
+
+static const int SAMPLE_RATE = 44100;
+static const unsigned BLOCK  = 256;
+
+//---------------------------------------------------------
+//   TestFluidBenchmark
+//---------------------------------------------------------
+
+class TestFluidBenchmark : public QObject, public MTest
+      {
+      Q_OBJECT
+
+      FluidS::Sample* sample { 0 };
+
+      void levels();
+      void renderLevels();
+      std::vector<float> render(int voices, int seconds, int interpolation);
+
+   private slots:
+      void initTestCase();
+      void cleanupTestCase();
+      void kernels_data()     { levels(); }
+      void kernels();               // block kernels against the scalar version
+      void renderVoices_data()      { renderLevels(); }
+      void renderVoices();          // blocks against the per sample loop
+      void benchmark_data();
+      void benchmark();             // N voices for M seconds
+      };
+
+//---------------------------------------------------------
+//   initTestCase
+//    a looped sine wave sample, played on all voices
+//---------------------------------------------------------
+
+void TestFluidBenchmark::initTestCase()
+      {
+      initMTest();
+      const int frames = SAMPLE_RATE / 10;
+      sample = new FluidS::Sample(0);
+      sample->data       = new short[frames];
+      for (int i = 0; i < frames; ++i)
+            sample->data[i] = short(16000.0 * sin(2.0 * M_PI * 440.0 * i / SAMPLE_RATE));
+      sample->start      = 0;
+      sample->end        = frames - 1;
+      sample->loopstart  = 8;
+      sample->loopend    = frames - 8;
+      sample->samplerate = SAMPLE_RATE;
+      sample->origpitch  = 69;
+      sample->sampletype = FluidS::FLUID_SAMPLETYPE_MONO;
+      sample->setValid(true);
+      sample->optimize();
+      }
+
+//---------------------------------------------------------
+//   cleanupTestCase
+//---------------------------------------------------------
+
+void TestFluidBenchmark::cleanupTestCase()
+      {
+      delete sample;
+      DspKernels::setLevel(DspKernels::maxLevel());
+      }
+
+//---------------------------------------------------------
+//   levels
+//    all kernel implementations supported by this cpu
+//---------------------------------------------------------
+
+void TestFluidBenchmark::levels()
+      {
+      QTest::addColumn<DspKernels::Level>("level");
+      QTest::newRow("scalar") << DspKernels::Level::SCALAR;
+      if (int(DspKernels::maxLevel()) >= int(DspKernels::Level::SSE2))
+            QTest::newRow("sse2") << DspKernels::Level::SSE2;
+      if (int(DspKernels::maxLevel()) >= int(DspKernels::Level::AVX2))
+            QTest::newRow("avx2") << DspKernels::Level::AVX2;
+      }
+
+//---------------------------------------------------------
+//   kernels
+//---------------------------------------------------------
+
+void TestFluidBenchmark::kernels()
+      {
+      QFETCH(DspKernels::Level, level);
+
+      qsrand(1);
+      static float coeffLinear[FLUID_INTERP_MAX][2];
+      static float coeff4[FLUID_INTERP_MAX][4];
+      static float coeff7[FLUID_INTERP_MAX][7];
+      for (int i = 0; i < FLUID_INTERP_MAX; ++i) {
+            for (int k = 0; k < 2; ++k)
+                  coeffLinear[i][k] = (qrand() % 1000) / 1000.0f;
+            for (int k = 0; k < 4; ++k)
+                  coeff4[i][k] = (qrand() % 1000) / 1000.0f;
+            for (int k = 0; k < 7; ++k)
+                  coeff7[i][k] = (qrand() % 1000) / 1000.0f;
+            }
+      std::vector<short> data(4096);
+      for (short& d : data)
+            d = short(qrand() % 65536 - 32768);
+
+      DspKernels::setLevel(DspKernels::Level::SCALAR);
+      const DspKernels* ref = DspKernels::instance();
+      DspKernels::setLevel(level);
+      const DspKernels* k = DspKernels::instance();
+      QCOMPARE(k->level, level);
+
+      for (int t = 0; t < 100; ++t) {
+            unsigned count = 1 + qrand() % 300;
+            qint64 incr    = (qint64(qrand() % 3) << 32) + qrand();
+            qint64 phase   = (qint64(8) << 32) + qrand();
+            std::vector<float> a(count), b(count);
+
+            ref->interpolateLinear(a.data(), data.data(), phase, incr, count, 0.5f, 0.001f, coeffLinear);
+            k->interpolateLinear(b.data(), data.data(), phase, incr, count, 0.5f, 0.001f, coeffLinear);
+            for (unsigned i = 0; i < count; ++i)
+                  QVERIFY(qAbs(a[i] - b[i]) <= 1e-4 * (qAbs(a[i]) + 1.0f));
+
+            ref->interpolate4(a.data(), data.data(), phase, incr, count, 0.5f, 0.001f, coeff4);
+            k->interpolate4(b.data(), data.data(), phase, incr, count, 0.5f, 0.001f, coeff4);
+            for (unsigned i = 0; i < count; ++i)
+                  QVERIFY(qAbs(a[i] - b[i]) <= 1e-4 * (qAbs(a[i]) + 1.0f));
+
+            ref->interpolate7(a.data(), data.data(), phase, incr, count, 0.5f, 0.001f, coeff7);
+            k->interpolate7(b.data(), data.data(), phase, incr, count, 0.5f, 0.001f, coeff7);
+            for (unsigned i = 0; i < count; ++i)
+                  QVERIFY(qAbs(a[i] - b[i]) <= 1e-4 * (qAbs(a[i]) + 1.0f));
+
+            std::vector<float> out1(count * 2, 1.0f), reverb1(count * 2, 2.0f), chorus1(count * 2, 3.0f);
+            std::vector<float> out2(out1), reverb2(reverb1), chorus2(chorus1);
+            ref->mix(a.data(), count, 0.3f, 0.7f, 0.2f, 0.1f, out1.data(), reverb1.data(), chorus1.data());
+            k->mix(a.data(), count, 0.3f, 0.7f, 0.2f, 0.1f, out2.data(), reverb2.data(), chorus2.data());
+            for (unsigned i = 0; i < count * 2; ++i) {
+                  QCOMPARE(out1[i], out2[i]);
+                  QCOMPARE(reverb1[i], reverb2[i]);
+                  QCOMPARE(chorus1[i], chorus2[i]);
+                  }
+            }
+      }
+
+//---------------------------------------------------------
+//   render
+//    play voices notes on one channel and return the dry
+//    output of the given number of seconds
+//---------------------------------------------------------
+
+std::vector<float> TestFluidBenchmark::render(int voices, int seconds, int interpolation)
+      {
+      FluidS::Fluid fluid;
+      fluid.init(SAMPLE_RATE);
+      fluid.play(PlayEvent(ME_CONTROLLER, 0, CTRL_VOLUME, 100));    // creates the channel
+      fluid.set_interp_method(-1, interpolation);
+      for (int i = 0; i < voices; ++i) {
+            FluidS::Voice* v = fluid.alloc_voice(i, sample, 0, 36 + i % 48, 100, 0.0);
+            v->gen_set(FluidS::GEN_SAMPLEMODE, FluidS::FLUID_LOOP_DURING_RELEASE);
+            fluid.start_voice(v);
+            }
+      std::vector<float> out(seconds * SAMPLE_RATE * 2);
+      std::vector<float> reverb(BLOCK * 2);
+      std::vector<float> chorus(BLOCK * 2);
+      for (size_t pos = 0; pos + BLOCK * 2 <= out.size(); pos += BLOCK * 2)
+            fluid.process(BLOCK, out.data() + pos, reverb.data(), chorus.data());
+      return out;
+      }
+
+//---------------------------------------------------------
+//   renderLevels
+//    all kernel implementations supported by this cpu with
+//    every interpolation using them
+//---------------------------------------------------------
+
+void TestFluidBenchmark::renderLevels()
+      {
+      QTest::addColumn<DspKernels::Level>("level");
+      QTest::addColumn<int>("interpolation");
+
+      const struct { const char* name; DspKernels::Level level; } ll[] = {
+            { "scalar", DspKernels::Level::SCALAR },
+            { "sse2",   DspKernels::Level::SSE2   },
+            { "avx2",   DspKernels::Level::AVX2   },
+            };
+      for (const auto& l : ll) {
+            if (int(l.level) > int(DspKernels::maxLevel()))
+                  continue;
+            QTest::newRow(qPrintable(QString("%1 linear").arg(l.name)))
+               << l.level << int(FluidS::FLUID_INTERP_LINEAR);
+            QTest::newRow(qPrintable(QString("%1 4th order").arg(l.name)))
+               << l.level << int(FluidS::FLUID_INTERP_4THORDER);
+            QTest::newRow(qPrintable(QString("%1 7th order").arg(l.name)))
+               << l.level << int(FluidS::FLUID_INTERP_7THORDER);
+            }
+      }
+
+//---------------------------------------------------------
+//   renderVoices
+//    a short render through the block kernels against the
+//    voice rendering sample by sample
+//---------------------------------------------------------
+
+void TestFluidBenchmark::renderVoices()
+      {
+      QFETCH(DspKernels::Level, level);
+      QFETCH(int, interpolation);
+
+      DspKernels::setLevel(DspKernels::Level::NONE);
+      std::vector<float> ref = render(16, 1, interpolation);
+      DspKernels::setLevel(level);
+      std::vector<float> out = render(16, 1, interpolation);
+      float peak = 0.0f;
+      for (size_t i = 0; i < ref.size(); ++i) {
+            QVERIFY(qAbs(ref[i] - out[i]) <= 1e-3f * (qAbs(ref[i]) + 1.0f));
+            peak = qMax(peak, qAbs(out[i]));
+            }
+      QVERIFY(peak > 0.0f);
+      }
+
+//---------------------------------------------------------
+//   benchmark
+//    64 voices for 10 seconds; takes long and runs only
+//    with FLUID_BENCHMARK set in the environment
+//---------------------------------------------------------
+
+void TestFluidBenchmark::benchmark_data()
+      {
+      if (qEnvironmentVariableIsEmpty("FLUID_BENCHMARK"))
+            QSKIP("set FLUID_BENCHMARK to run the benchmark");
+      renderLevels();
+      }
+
+void TestFluidBenchmark::benchmark()
+      {
+      QFETCH(DspKernels::Level, level);
+      QFETCH(int, interpolation);
+
+      DspKernels::setLevel(level);
+      QBENCHMARK {
+            render(64, 10, interpolation);
+            }
+      }
+
+QTEST_MAIN(TestFluidBenchmark)
+#include "tst_fluidbenchmark.moc"
+
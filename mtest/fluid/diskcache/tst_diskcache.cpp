@@ -0,0 +1,206 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2017 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+
+#ifndef Q_OS_WIN
+#include <utime.h>
+#endif
+
+#include "mtest/testutils.h"
+#include "fluid/fluid.h"
+#include "fluid/sfont.h"
+
+using namespace FluidS;
+
+//---------------------------------------------------------
+//   TestDiskCache
+//---------------------------------------------------------
+
+class TestDiskCache : public QObject, public MTest
+      {
+      Q_OBJECT
+
+      QTemporaryDir dir;
+      SampleDiskCache* cache;
+
+      SFont* soundfont(const QString& name, const QByteArray& content);
+      Sample* sample(SFont*, int index, int frames);
+      qint64 filesSize();
+
+   private slots:
+      void initTestCase();
+      void fileHash();        // once per path, size and time
+      void rewrite();         // a file written again counts once
+      void readBack();
+      };
+
+//---------------------------------------------------------
+//   initTestCase
+//---------------------------------------------------------
+
+void TestDiskCache::initTestCase()
+      {
+      initMTest();
+      cache = SampleDiskCache::instance();
+      cache->setPath(dir.path() + "/cache");
+      cache->setLimit(qint64(1024) * 1024 * 1024);
+      }
+
+//---------------------------------------------------------
+//   soundfont
+//    The file is no soundfont and cannot be read, but its
+//    name is kept and is all the disk cache needs.
+//---------------------------------------------------------
+
+SFont* TestDiskCache::soundfont(const QString& name, const QByteArray& content)
+      {
+      QFile f(dir.path() + "/" + name);
+      if (f.open(QIODevice::WriteOnly))
+            f.write(content);
+      f.close();
+      SFont* sf = new SFont(0);
+      sf->read(f.fileName());
+      return sf;
+      }
+
+//---------------------------------------------------------
+//   sample
+//    a decoded sample of frames frames
+//---------------------------------------------------------
+
+Sample* TestDiskCache::sample(SFont* sf, int index, int frames)
+      {
+      Sample* s = new Sample(sf);
+      s->setIndex(index);
+      s->data = new short[frames];
+      for (int i = 0; i < frames; ++i)
+            s->data[i] = short(i * index);
+      s->start = 0;
+      s->end   = frames - 1;
+      s->setValid(true);
+      return s;
+      }
+
+//---------------------------------------------------------
+//   filesSize
+//    bytes of the sample files on disk
+//---------------------------------------------------------
+
+qint64 TestDiskCache::filesSize()
+      {
+      qint64 size = 0;
+      QDirIterator it(cache->path(), QStringList("*.pcm"), QDir::Files, QDirIterator::Subdirectories);
+      while (it.hasNext()) {
+            it.next();
+            size += it.fileInfo().size();
+            }
+      return size;
+      }
+
+//---------------------------------------------------------
+//   fileHash
+//---------------------------------------------------------
+
+void TestDiskCache::fileHash()
+      {
+#ifdef Q_OS_WIN
+      QSKIP("the file times are set with utime()");
+#else
+      SFont* a = soundfont("hash.sf3", "abcd");
+      SFont* b = soundfont("hash.sf3", "abcd");
+      QByteArray path = QFile::encodeName(dir.path() + "/hash.sf3");
+      struct utimbuf t { 1000000000, 1000000000 };
+      QVERIFY(utime(path.constData(), &t) == 0);
+
+      QString hash = a->fileHash();
+      QCOMPARE(hash, QString::fromLatin1(QCryptographicHash::hash("abcd", QCryptographicHash::Sha1).toHex()));
+      QCOMPARE(b->fileHash(), hash);
+
+      // same size and time, the hash is not computed again
+      QFile f(QFile::decodeName(path));
+      QVERIFY(f.open(QIODevice::WriteOnly));
+      f.write("efgh");
+      f.close();
+      QVERIFY(utime(path.constData(), &t) == 0);
+      QCOMPARE(b->fileHash(), hash);
+
+      // a changed time gives the hash of the new content
+      t.modtime += 100;
+      QVERIFY(utime(path.constData(), &t) == 0);
+      QCOMPARE(a->fileHash(), QString::fromLatin1(QCryptographicHash::hash("efgh", QCryptographicHash::Sha1).toHex()));
+
+      delete a;
+      delete b;
+#endif
+      }
+
+//---------------------------------------------------------
+//   rewrite
+//---------------------------------------------------------
+
+void TestDiskCache::rewrite()
+      {
+      SFont* sf = soundfont("rewrite.sf3", "rewrite");
+      Sample* a = sample(sf, 1, 1000);
+      Sample* b = sample(sf, 2, 500);
+      cache->write(a);
+      cache->write(b);
+      qint64 size = cache->size();
+      QCOMPARE(size, filesSize());
+
+      cache->write(a);
+      QCOMPARE(cache->size(), size);
+      QCOMPARE(cache->size(), filesSize());
+
+      // sample 1 written again with fewer frames
+      Sample* c = sample(sf, 1, 200);
+      cache->write(c);
+      QCOMPARE(cache->size(), size - 800 * qint64(sizeof(short)));
+      QCOMPARE(cache->size(), filesSize());
+
+      qDeleteAll(QList<Sample*>() << a << b << c);
+      delete sf;
+      }
+
+//---------------------------------------------------------
+//   readBack
+//---------------------------------------------------------
+
+void TestDiskCache::readBack()
+      {
+      SFont* sf = soundfont("read.sf3", "read");
+      Sample* a = sample(sf, 3, 300);
+      a->loopstart = 10;
+      a->loopend   = 290;
+      cache->write(a);
+
+      Sample* b = new Sample(sf);
+      b->setIndex(3);
+      QVERIFY(cache->read(b));
+      QCOMPARE(b->end, a->end);
+      QCOMPARE(b->loopstart, a->loopstart);
+      QCOMPARE(b->loopend, a->loopend);
+      QVERIFY(b->valid());
+      QVERIFY(!memcmp(a->data, b->data, 300 * sizeof(short)));
+
+      // another sample of the font is not in the cache
+      Sample* c = new Sample(sf);
+      c->setIndex(4);
+      QVERIFY(!cache->read(c));
+
+      qDeleteAll(QList<Sample*>() << a << b << c);
+      delete sf;
+      }
+
+QTEST_MAIN(TestDiskCache)
+#include "tst_diskcache.moc"
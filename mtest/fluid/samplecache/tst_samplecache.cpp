@@ -0,0 +1,165 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2017 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+
+#include "mtest/testutils.h"
+#include "fluid/fluid.h"
+#include "fluid/sfont.h"
+
+using namespace FluidS;
+
+static const int FRAMES = 1000;
+static const qint64 SIZE = FRAMES * sizeof(short);
+
+//---------------------------------------------------------
+//   TestSampleCache
+//---------------------------------------------------------
+
+class TestSampleCache : public QObject, public MTest
+      {
+      Q_OBJECT
+
+      SampleCache* cache;
+      Sample* decoded();
+
+   private slots:
+      void initTestCase();
+      void cleanup()          { cache->setBudget(256 * 1024 * 1024); }
+      void lru();             // the least recently used sample goes first
+      void pinned();          // samples used by presets or voices stay
+      void budget();          // a smaller budget releases unused samples
+      };
+
+//---------------------------------------------------------
+//   initTestCase
+//---------------------------------------------------------
+
+void TestSampleCache::initTestCase()
+      {
+      initMTest();
+      cache = SampleCache::instance();
+      }
+
+//---------------------------------------------------------
+//   decoded
+//    a compressed sample as it is after decoding
+//---------------------------------------------------------
+
+Sample* TestSampleCache::decoded()
+      {
+      Sample* s = new Sample(0);
+      s->data       = new short[FRAMES];
+      memset(s->data, 0, SIZE);
+      s->start      = 0;
+      s->end        = FRAMES - 1;
+      s->sampletype = FLUID_SAMPLETYPE_MONO | FLUID_SAMPLETYPE_OGG_VORBIS;
+      s->setValid(true);
+      cache->insert(s);
+      return s;
+      }
+
+//---------------------------------------------------------
+//   lru
+//---------------------------------------------------------
+
+void TestSampleCache::lru()
+      {
+      cache->setBudget(3 * SIZE);
+      Sample* a = decoded();
+      Sample* b = decoded();
+      Sample* c = decoded();
+      QCOMPARE(cache->memory(), 3 * SIZE);
+
+      // a channel preset uses a again
+      a->acquire(true);
+      a->release();
+
+      Sample* d = decoded();
+      QCOMPARE(cache->memory(), 3 * SIZE);
+      QVERIFY(a->ready());
+      QVERIFY(!b->ready());
+      QVERIFY(b->data == 0);
+      QVERIFY(c->ready());
+      QVERIFY(d->ready());
+
+      // a voice has played c
+      c->addVoice();
+      c->removeVoice();
+
+      Sample* e = decoded();
+      QVERIFY(!a->ready());
+      QVERIFY(c->ready());
+      QVERIFY(d->ready());
+      QVERIFY(e->ready());
+
+      qDeleteAll(QList<Sample*>() << a << b << c << d << e);
+      QCOMPARE(cache->memory(), qint64(0));
+      }
+
+//---------------------------------------------------------
+//   pinned
+//---------------------------------------------------------
+
+void TestSampleCache::pinned()
+      {
+      cache->setBudget(3 * SIZE);
+      Sample* a = decoded();
+      Sample* b = decoded();
+      a->acquire(true);
+      b->addVoice();
+      cache->setBudget(SIZE);
+      QVERIFY(a->ready());
+      QVERIFY(b->ready());
+      QCOMPARE(cache->memory(), 2 * SIZE);
+
+      // over budget, the only unused sample is the new one
+      Sample* c = decoded();
+      QVERIFY(!c->ready());
+      QCOMPARE(cache->memory(), 2 * SIZE);
+
+      // b is used last
+      a->release();
+      b->removeVoice();
+      cache->setBudget(SIZE);
+      QVERIFY(!a->ready());
+      QVERIFY(b->ready());
+      QCOMPARE(cache->memory(), SIZE);
+
+      qDeleteAll(QList<Sample*>() << a << b << c);
+      }
+
+//---------------------------------------------------------
+//   budget
+//---------------------------------------------------------
+
+void TestSampleCache::budget()
+      {
+      QList<Sample*> sl;
+      for (int i = 0; i < 4; ++i)
+            sl.append(decoded());
+      QCOMPARE(cache->memory(), 4 * SIZE);
+      sl[1]->acquire(true);
+
+      cache->setBudget(0);
+      QCOMPARE(cache->memory(), SIZE);
+      for (int i = 0; i < sl.size(); ++i)
+            QCOMPARE(sl[i]->ready(), i == 1);
+
+      sl[1]->release();
+      cache->setBudget(0);
+      QCOMPARE(cache->memory(), qint64(0));
+      qDeleteAll(sl);
+      }
+
+QTEST_MAIN(TestSampleCache)
+#include "tst_samplecache.moc"
@@ -0,0 +1,154 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2017 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+#include "mtest/testutils.h"
+#include "mscore/importgtp.h"
+
+#define DIR QString("guitarpro/")
+
+using namespace Ms;
+
+//---------------------------------------------------------
+//   TestGpx
+//    BCFZ decompression of the gpx files in guitarpro/
+//---------------------------------------------------------
+
+class TestGpx : public QObject, public MTest
+      {
+      Q_OBJECT
+
+      QList<QByteArray> files;
+      QStringList names;
+
+   private slots:
+      void initTestCase();
+      void gpxDecompress_data();
+      void gpxDecompress();               // against the bit at a time decoder
+      void gpxDecompressBenchmark();
+      };
+
+//---------------------------------------------------------
+//   initTestCase
+//---------------------------------------------------------
+
+void TestGpx::initTestCase()
+      {
+      initMTest();
+      QDir dir(root + "/" + DIR);
+      for (const QString& name : dir.entryList(QStringList("*.gpx"), QDir::Files)) {
+            QFile f(dir.filePath(name));
+            QVERIFY(f.open(QIODevice::ReadOnly));
+            files.append(f.readAll());
+            names.append(name);
+            }
+      QVERIFY(!files.isEmpty());
+      }
+
+//---------------------------------------------------------
+//   decompressReference
+//    the decoder GuitarPro6::readGPX() used before
+//    decompressBCFZ(), one bit at a time
+//---------------------------------------------------------
+
+static QByteArray decompressReference(const QByteArray& buffer)
+      {
+      QByteArray bcfs;
+      if (buffer.size() < 8)
+            return bcfs;
+      qint64 position = 8 * 8;
+      auto readBit = [&buffer, &position]() {
+            int byteIndex = int(position / 8);
+            int bit = byteIndex < buffer.size() ? ((buffer[byteIndex] & 0xff) >> (7 - position % 8)) & 0x01 : 0;
+            ++position;
+            return bit;
+            };
+      auto readBits = [&readBit](int n) {
+            int bits = 0;
+            for (int i = n - 1; i >= 0; --i)
+                  bits |= readBit() << i;
+            return bits;
+            };
+      auto readBitsReversed = [&readBit](int n) {
+            int bits = 0;
+            for (int i = 0; i < n; ++i)
+                  bits |= readBit() << i;
+            return bits;
+            };
+      const uchar* d = reinterpret_cast<const uchar*>(buffer.constData());
+      int length = d[4] | (d[5] << 8) | (d[6] << 16) | (d[7] << 24);
+      while (position / 8 < length && position < qint64(buffer.size()) * 8) {
+            if (readBits(1)) {
+                  int bits = readBits(4);
+                  int offs = readBitsReversed(bits);
+                  int size = readBitsReversed(bits);
+                  int pos  = bcfs.size() - offs;
+                  if (pos < 0)
+                        break;
+                  for (int i = 0; i < qMin(size, offs); ++i)
+                        bcfs.append(bcfs[pos + i]);
+                  }
+            else {
+                  int size = readBitsReversed(2);
+                  for (int i = 0; i < size; ++i)
+                        bcfs.append(char(readBits(8)));
+                  }
+            }
+      return bcfs;
+      }
+
+//---------------------------------------------------------
+//   gpxDecompress
+//---------------------------------------------------------
+
+void TestGpx::gpxDecompress_data()
+      {
+      QTest::addColumn<int>("index");
+      for (int i = 0; i < names.size(); ++i)
+            QTest::newRow(qPrintable(names[i])) << i;
+      }
+
+void TestGpx::gpxDecompress()
+      {
+      QFETCH(int, index);
+      const QByteArray& data = files[index];
+      QByteArray bcfs = GuitarPro6::decompressBCFZ(data);
+      QVERIFY(!bcfs.isEmpty());
+      QVERIFY(bcfs == decompressReference(data));
+      }
+
+//---------------------------------------------------------
+//   gpxDecompressBenchmark
+//    decompress all gpx files, report throughput in MB/s
+//---------------------------------------------------------
+
+void TestGpx::gpxDecompressBenchmark()
+      {
+      qint64 bytes = 0;
+      for (const QByteArray& data : files)
+            bytes += data.size();
+
+      QElapsedTimer t;
+      int runs = 0;
+      t.start();
+      QBENCHMARK {
+            for (const QByteArray& data : files)
+                  QVERIFY(!GuitarPro6::decompressBCFZ(data).isEmpty());
+            ++runs;
+            }
+      qint64 ns = t.nsecsElapsed();
+      if (ns > 0)
+            qDebug("gpx decompression: %.1f MB/s", double(bytes) * runs / (1024.0 * 1024.0) / (ns / 1e9));
+      }
+
+QTEST_MAIN(TestGpx)
+#include "tst_gpx.moc"
@@ -14,6 +14,10 @@
 #include <QtTest/QtTest>
 #include "mtest/testutils.h"
 #include "libmscore/score.h"
+#include "libmscore/measure.h"
+#include "libmscore/page.h"
+#include "libmscore/layouttrace.h"
+#include "synthesizer/event.h"
 
 #define DIR QString("libmscore/layout/")
 
@@ -32,7 +36,10 @@ class TestBenchmark : public QObject, public MTest
       Q_OBJECT
 
       MasterScore* score;
+      MasterScore* bigScore { 0 };
+      MasterScore* midiScore { 0 };
       void beam(const char* path);
+      void createBigScore();
 
    private slots:
       void initTestCase();
@@ -40,6 +47,16 @@ class TestBenchmark : public QObject, public MTest
       void benchmark1();
       void benchmark2();
       void benchmark4();            // incremental layout (one page)
+      void tick2measureLinear();    // reference: walk the measure list
+      void tick2measureIndexed();
+      void styleVariant();          // reference: convert the QVariant on every read
+      void styleTyped();
+      void renderMidi();
+      void iterateEvents();         // like Seq::process()
+      void iterateMultimap();       // reference: the former std::multimap storage
+#ifdef LAYOUT_TRACE
+      void layoutTrace();           // phase counters and chrome trace
+#endif
       };
 
 //---------------------------------------------------------
@@ -90,6 +107,199 @@ void TestBenchmark::benchmark4()
             }
       }
 
+//---------------------------------------------------------
+//   createBigScore
+//    a long score for the tick lookup benchmarks
+//---------------------------------------------------------
+
+void TestBenchmark::createBigScore()
+      {
+      if (bigScore)
+            return;
+      bigScore = readScore("libmscore/measure/measure-1.mscx");
+      bigScore->startCmd();
+      bigScore->appendMeasures(2000);
+      bigScore->endCmd();
+      }
+
+//---------------------------------------------------------
+//   linearTick2measure
+//    the list walk tick2measure() used before the tick index
+//---------------------------------------------------------
+
+static Measure* linearTick2measure(Score* score, int tick)
+      {
+      Measure* lm = 0;
+      for (Measure* m = score->firstMeasure(); m; m = m->nextMeasure()) {
+            if (tick < m->tick())
+                  return lm;
+            lm = m;
+            }
+      if (lm && (tick >= lm->tick()) && (tick <= lm->endTick()))
+            return lm;
+      return 0;
+      }
+
+void TestBenchmark::tick2measureLinear()
+      {
+      createBigScore();
+      int endTick = bigScore->lastMeasure()->endTick();
+      int step    = MScore::division / 3;
+      QBENCHMARK {
+            for (int tick = 0; tick < endTick; tick += step)
+                  linearTick2measure(bigScore, tick);
+            }
+      }
+
+void TestBenchmark::tick2measureIndexed()
+      {
+      createBigScore();
+      int endTick = bigScore->lastMeasure()->endTick();
+      int step    = MScore::division / 3;
+      for (int tick = 0; tick < endTick; tick += step)
+            QCOMPARE(bigScore->tick2measure(tick), linearTick2measure(bigScore, tick));
+      QBENCHMARK {
+            for (int tick = 0; tick < endTick; tick += step)
+                  bigScore->tick2measure(tick);
+            }
+      }
+
+//---------------------------------------------------------
+//   style access
+//    the typed style values against the QVariant
+//    conversion the style accessors used before
+//---------------------------------------------------------
+
+static const StyleIdx benchmarkStyles[] = {
+      StyleIdx::minNoteDistance, StyleIdx::barNoteDistance, StyleIdx::beamWidth,
+      StyleIdx::stemWidth, StyleIdx::ledgerLineLength, StyleIdx::accidentalDistance
+      };
+
+void TestBenchmark::styleVariant()
+      {
+      qreal sum = 0.0;
+      QBENCHMARK {
+            for (int i = 0; i < 100000; ++i) {
+                  for (StyleIdx idx : benchmarkStyles)
+                        sum += score->style().value(idx).value<Spatium>().val() * score->style().value(StyleIdx::spatium).toDouble();
+                  }
+            }
+      QVERIFY(sum > 0.0);
+      }
+
+void TestBenchmark::styleTyped()
+      {
+      for (StyleIdx idx : benchmarkStyles)
+            QCOMPARE(score->styleP(idx), score->style().value(idx).value<Spatium>().val() * score->spatium());
+
+      // the typed values follow changes made through undo
+      qreal spatium = score->spatium();
+      score->startCmd();
+      score->undoChangeStyleVal(StyleIdx::spatium, spatium * 2.0);
+      score->undoChangeStyleVal(StyleIdx::stemWidth, QVariant::fromValue(Spatium(0.5)));
+      score->endCmd();
+      QCOMPARE(score->spatium(), spatium * 2.0);
+      QCOMPARE(score->styleP(StyleIdx::stemWidth), spatium);
+      score->undoRedo(true);
+      QCOMPARE(score->spatium(), spatium);
+      for (StyleIdx idx : benchmarkStyles)
+            QCOMPARE(score->styleP(idx), score->style().value(idx).value<Spatium>().val() * spatium);
+
+      qreal sum = 0.0;
+      QBENCHMARK {
+            for (int i = 0; i < 100000; ++i) {
+                  for (StyleIdx idx : benchmarkStyles)
+                        sum += score->styleP(idx);
+                  }
+            }
+      QVERIFY(sum > 0.0);
+      }
+
+//---------------------------------------------------------
+//   playback events
+//    rendering and walking the EventMap, against the
+//    std::multimap the events were kept in before
+//---------------------------------------------------------
+
+void TestBenchmark::renderMidi()
+      {
+      midiScore = readScore("libmscore/midi/testAndanteExcerpts.mscx");
+      QVERIFY(midiScore);
+      QBENCHMARK {
+            EventMap events;
+            midiScore->renderMidi(&events);
+            }
+      }
+
+void TestBenchmark::iterateEvents()
+      {
+      QVERIFY(midiScore);
+      EventMap events;
+      midiScore->renderMidi(&events);
+      int sum = 0;
+      QBENCHMARK {
+            for (auto i = events.cbegin(); i != events.cend(); ++i)
+                  sum += i->first + i->second.dataA();
+            }
+      QVERIFY(sum != 0);
+      }
+
+void TestBenchmark::iterateMultimap()
+      {
+      QVERIFY(midiScore);
+      EventMap events;
+      midiScore->renderMidi(&events);
+      std::multimap<int, NPlayEvent> map(events.cbegin(), events.cend());
+      QCOMPARE(map.size(), events.size());
+      int sum = 0;
+      QBENCHMARK {
+            for (auto i = map.cbegin(); i != map.cend(); ++i)
+                  sum += i->first + i->second.dataA();
+            }
+      QVERIFY(sum != 0);
+      }
+
+#ifdef LAYOUT_TRACE
+//---------------------------------------------------------
+//   layoutTrace
+//---------------------------------------------------------
+
+void TestBenchmark::layoutTrace()
+      {
+      createBigScore();
+      QTemporaryDir dir;
+      QString path = dir.path() + "/layout.json";
+
+      LayoutTrace::start(path);
+      bigScore->doLayout();
+      Page* page = bigScore->pages().front();
+      page->items(page->bbox());                // the bsp tree is built on first use
+      QVERIFY(LayoutTrace::counter(LayoutPhase::DO_LAYOUT_RANGE).calls == 1);
+      for (LayoutPhase p : { LayoutPhase::GET_NEXT_MEASURE, LayoutPhase::COLLECT_SYSTEM, LayoutPhase::CREATE_BEAMS,
+         LayoutPhase::LAYOUT_CHORDS1, LayoutPhase::COLLECT_PAGE, LayoutPhase::REBUILD_BSP_TREE })
+            QVERIFY2(LayoutTrace::counter(p).calls > 0, LayoutTrace::name(p));
+      LayoutTrace::Counter range   = LayoutTrace::counter(LayoutPhase::DO_LAYOUT_RANGE);
+      LayoutTrace::Counter measure = LayoutTrace::counter(LayoutPhase::GET_NEXT_MEASURE);
+      QVERIFY(measure.totalNs <= range.totalNs);
+      QVERIFY(LayoutTrace::stop());
+      QVERIFY(!LayoutTrace::enabled());
+
+      QFile f(path);
+      QVERIFY(f.open(QIODevice::ReadOnly));
+      QJsonParseError pe;
+      QJsonDocument doc = QJsonDocument::fromJson(f.readAll(), &pe);
+      QCOMPARE(pe.error, QJsonParseError::NoError);
+      QJsonArray events = doc.object().value("traceEvents").toArray();
+      QCOMPARE(events.size(), LayoutTrace::events());
+      QCOMPARE(events.first().toObject().value("ph").toString(), QString("X"));
+      QCOMPARE(doc.object().value("otherData").toObject().value("getNextMeasure").toObject().value("calls").toInt(), int(measure.calls));
+
+      // not tracing, nothing is counted
+      LayoutTrace::reset();
+      bigScore->doLayout();
+      QCOMPARE(LayoutTrace::counter(LayoutPhase::DO_LAYOUT_RANGE).calls, qint64(0));
+      }
+#endif
+
 QTEST_MAIN(TestBenchmark)
 #include "tst_benchmark.moc"
-
@@ -106,6 +106,7 @@ class TestParts : public QObject, public MTest
 
       void appendMeasure();
       void insertMeasure();
+      void deferredPartLayout();
 //      void styleScore();
 //      void styleScoreReload();
 //      void stylePartDefault();
@@ -295,6 +296,38 @@ void TestParts::insertMeasure()
       delete score;
       }
 
+//---------------------------------------------------------
+//   deferredPartLayout
+//    part scores without a view are laid out on demand,
+//    writing the score does not lay them out
+//---------------------------------------------------------
+
+void TestParts::deferredPartLayout()
+      {
+      MasterScore* score = readScore(DIR + "part-all.mscx");
+      QVERIFY(score);
+      createParts(score);
+
+      score->startCmd();
+      score->insertMeasure(ElementType::MEASURE, 0);
+      score->endCmd();
+
+      QVERIFY(!score->layoutDeferred());
+      QVERIFY(score->lastMeasure()->system());
+      QBuffer buffer;
+      buffer.open(QIODevice::WriteOnly);
+      QVERIFY(score->saveFile(&buffer, false));
+      for (Excerpt* e : score->excerpts()) {
+            Score* part = e->partScore();
+            QVERIFY(part->layoutDeferred());
+            QVERIFY(!part->lastMeasure()->system());
+            part->doDeferredLayout();
+            QVERIFY(!part->layoutDeferred());
+            QVERIFY(part->lastMeasure()->system());
+            }
+      delete score;
+      }
+
 #if 0
 //---------------------------------------------------------
 //   styleScore
@@ -0,0 +1,135 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2017 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+#include "mtest/testutils.h"
+#include "libmscore/score.h"
+#include "libmscore/measure.h"
+#include "libmscore/segment.h"
+#include "libmscore/chord.h"
+#include "libmscore/note.h"
+#include "libmscore/rendermidi.h"
+
+#define DIR QString("libmscore/midi/")
+
+using namespace Ms;
+
+//---------------------------------------------------------
+//   TestPlayback
+//---------------------------------------------------------
+
+class TestPlayback : public QObject, public MTest
+      {
+      Q_OBJECT
+
+   private slots:
+      void initTestCase()     { initMTest(); }
+      void incrementalEvents_data();
+      void incrementalEvents();     // against a full render
+      };
+
+//---------------------------------------------------------
+//   eventStrings
+//    in map order, events with equal ticks are played in
+//    this order too
+//---------------------------------------------------------
+
+static QStringList eventStrings(const EventMap& events)
+      {
+      QStringList l;
+      for (const auto& e : events) {
+            l.append(QString("%1 %2 %3 %4 %5").arg(e.first).arg(e.second.type())
+               .arg(e.second.channel()).arg(e.second.dataA()).arg(e.second.dataB()));
+            }
+      return l;
+      }
+
+//---------------------------------------------------------
+//   incrementalEvents
+//    events spliced after an edit must match a full render
+//---------------------------------------------------------
+
+void TestPlayback::incrementalEvents_data()
+      {
+      QTest::addColumn<QString>("file");
+      QTest::newRow("testMetronomeSimple")               << DIR + "testMetronomeSimple";
+      QTest::newRow("testMetronomeCompound")             << DIR + "testMetronomeCompound";
+      QTest::newRow("testMetronomeAnacrusis")            << DIR + "testMetronomeAnacrusis";
+      QTest::newRow("testSwing8thSimple")                << DIR + "testSwing8thSimple";
+      QTest::newRow("testSwing8thTies")                  << DIR + "testSwing8thTies";
+      QTest::newRow("testSwing8thTriplets")              << DIR + "testSwing8thTriplets";
+      QTest::newRow("testSwing8thDots")                  << DIR + "testSwing8thDots";
+      QTest::newRow("testSwing16thSimple")               << DIR + "testSwing16thSimple";
+      QTest::newRow("testSwing16thTies")                 << DIR + "testSwing16thTies";
+      QTest::newRow("testSwing16thTriplets")             << DIR + "testSwing16thTriplets";
+      QTest::newRow("testSwing16thDots")                 << DIR + "testSwing16thDots";
+      QTest::newRow("testSwingOdd")                      << DIR + "testSwingOdd";
+      QTest::newRow("testSwingPickup")                   << DIR + "testSwingPickup";
+      QTest::newRow("testSwingStyleText")                << DIR + "testSwingStyleText";
+      QTest::newRow("testSwingTexts")                    << DIR + "testSwingTexts";
+      QTest::newRow("testMordents")                      << DIR + "testMordents";
+      QTest::newRow("testOrnamentAccidentals")           << DIR + "testOrnamentAccidentals";
+      QTest::newRow("testGraceBefore")                   << DIR + "testGraceBefore";
+      QTest::newRow("testBeforeAfterGraceTrill")         << DIR + "testBeforeAfterGraceTrill";
+      QTest::newRow("testBeforeAfterGraceTrillPlay=false") << DIR + "testBeforeAfterGraceTrillPlay=false";
+      QTest::newRow("testKantataBWV140Excerpts")         << DIR + "testKantataBWV140Excerpts";
+      QTest::newRow("testTrillTransposingInstrument")    << DIR + "testTrillTransposingInstrument";
+      QTest::newRow("testAndanteExcerpts")               << DIR + "testAndanteExcerpts";
+      QTest::newRow("testTrillLines")                    << DIR + "testTrillLines";
+      QTest::newRow("testTrillTempos")                   << DIR + "testTrillTempos";
+      // chunks played at several repeat offsets
+      for (const char* f : { "repeat01", "repeat06", "repeat09", "repeat14", "repeat17", "repeat23", "repeat36" })
+            QTest::newRow(f) << QString("libmscore/repeat/") + f;
+      }
+
+void TestPlayback::incrementalEvents()
+      {
+      QFETCH(QString, file);
+
+      MasterScore* score = readScore(file + ".mscx");
+      QVERIFY(score);
+      EventMap events;
+      score->renderMidiIncremental(&events);
+      EventMap ref;
+      score->renderMidi(&ref);
+      QCOMPARE(eventStrings(events), eventStrings(ref));
+
+      score->renderMidiIncremental(&events);
+      QCOMPARE(score->playbackCache()->renderedChunks(), 0);
+      QCOMPARE(eventStrings(events), eventStrings(ref));
+
+      // edit the first chord of the first and of the last staff
+      const Segment::Type st = Segment::Type::ChordRest;
+      for (int track : { 0, (score->nstaves() - 1) * VOICES }) {
+            Chord* chord = 0;
+            for (Segment* s = score->firstSegment(st); s && !chord; s = s->next1(st)) {
+                  if (s->element(track) && s->element(track)->isChord())
+                        chord = toChord(s->element(track));
+                  }
+            if (!chord)
+                  continue;
+            Note* note = chord->upNote();
+            score->startCmd();
+            score->undoChangePitch(note, note->pitch() > 100 ? note->pitch() - 12 : note->pitch() + 12, note->tpc1(), note->tpc2());
+            score->endCmd();
+
+            score->renderMidiIncremental(&events);
+            QVERIFY(score->playbackCache()->renderedChunks() > 0);
+            ref.clear();
+            score->renderMidi(&ref);
+            QCOMPARE(eventStrings(events), eventStrings(ref));
+            }
+      delete score;
+      }
+
+QTEST_MAIN(TestPlayback)
+#include "tst_playback.moc"
@@ -0,0 +1,276 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2017 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+#include "mtest/testutils.h"
+#include "libmscore/score.h"
+#include "libmscore/measure.h"
+#include "libmscore/segment.h"
+#include "libmscore/shape.h"
+#include "libmscore/staff.h"
+#include "libmscore/stafftype.h"
+#include "libmscore/stafflines.h"
+#include "libmscore/system.h"
+
+#define DIR QString("libmscore/spacing/")
+
+using namespace Ms;
+
+//---------------------------------------------------------
+//   TestSpacing
+//---------------------------------------------------------
+
+class TestSpacing : public QObject, public MTest
+      {
+      Q_OBJECT
+
+      unsigned _seed { 1 };
+      qreal random(int n);
+      Shape randomShape();
+
+   private slots:
+      void initTestCase()     { initMTest(); }
+      void skyline();         // against Shape::minHorizontalDistance
+      void skylineMoved();
+      void minWidth_data();
+      void minWidth();        // no segment collides with a later one
+      void systemDistance_data();
+      void systemDistance();  // against the measure shapes
+      };
+
+//---------------------------------------------------------
+//   random
+//    reproducible numbers 0 - n-1
+//---------------------------------------------------------
+
+qreal TestSpacing::random(int n)
+      {
+      _seed = _seed * 1103515245 + 12345;
+      return (_seed >> 16) % n;
+      }
+
+//---------------------------------------------------------
+//   randomShape
+//    up to four rectangles, some of zero width or height
+//---------------------------------------------------------
+
+Shape TestSpacing::randomShape()
+      {
+      Shape s;
+      int n = 1 + random(4);
+      for (int i = 0; i < n; ++i) {
+            int k   = random(6);
+            qreal w = k == 0 ? 0.0 : random(5) + 1;
+            qreal h = k == 1 ? 0.0 : random(6) + 1;
+            s.add(QRectF(random(6) - 3, random(20) - 10, w, h));
+            }
+      return s;
+      }
+
+//---------------------------------------------------------
+//   skyline
+//---------------------------------------------------------
+
+void TestSpacing::skyline()
+      {
+      const Segment* segment = reinterpret_cast<const Segment*>(1);
+      for (int i = 0; i < 5000; ++i) {
+            Skyline sk;
+            std::vector<std::pair<Shape, qreal>> placed;
+            int n = 1 + random(8);
+            for (int k = 0; k < n; ++k) {
+                  Shape s = randomShape();
+                  qreal x = random(30);
+                  sk.add(s, x, segment);
+                  placed.push_back(std::make_pair(s, x));
+                  }
+            Shape ns = randomShape();
+            qreal x  = -1000000.0;
+            for (const auto& p : placed) {
+                  qreal d = p.first.minHorizontalDistance(ns);
+                  if (d > -1000000.0)
+                        x = qMax(x, p.second + d);
+                  }
+            Skyline::Edge e = sk.minPosition(ns);
+            QCOMPARE(e.segment ? e.x : -1000000.0, x);
+            }
+      }
+
+//---------------------------------------------------------
+//   skylineMoved
+//    a shape added again further right determines the
+//    edge, the old position does not count anymore
+//---------------------------------------------------------
+
+void TestSpacing::skylineMoved()
+      {
+      const Segment* a = reinterpret_cast<const Segment*>(1);
+      const Segment* b = reinterpret_cast<const Segment*>(2);
+      Skyline sk;
+      sk.add(Shape(QRectF(0.0, 0.0, 2.0, 4.0)), 10.0, a);
+      sk.add(Shape(QRectF(0.0, 2.0, 1.0, 4.0)), 11.0, b);
+      Shape ns(QRectF(0.0, 0.0, 1.0, 1.0));
+      QCOMPARE(sk.minPosition(ns).x, 12.0);
+      QVERIFY(sk.minPosition(ns).segment == a);
+      sk.add(Shape(QRectF(0.0, 0.0, 2.0, 4.0)), 13.0, a);
+      QCOMPARE(sk.minPosition(ns).x, 15.0);
+      Shape low(QRectF(0.0, 5.0, 1.0, 1.0));
+      QCOMPARE(sk.minPosition(low).x, 12.0);
+      QVERIFY(sk.minPosition(low).segment == b);
+      sk.clear();
+      QVERIFY(!sk.minPosition(ns).segment);
+      }
+
+//---------------------------------------------------------
+//   minWidth
+//    After Measure::computeMinWidth() every segment has at
+//    least the distance of Segment::minHorizontalDistance()
+//    to all later segments of its measure, not only to the
+//    next one. The first segment is checked against the
+//    left border and the system header against its own
+//    rules instead.
+//---------------------------------------------------------
+
+void TestSpacing::minWidth_data()
+      {
+      QTest::addColumn<QString>("file");
+      QTest::newRow("spacing")     << DIR + "spacing.mscx";             // lyrics, accidentals, grace notes, clefs
+      QTest::newRow("gaps")        << QString("libmscore/measure/gaps.mscx");
+      QTest::newRow("clef")        << QString("libmscore/clef/clef-1.mscx");
+      QTest::newRow("lyricsline")  << QString("libmscore/spanners/lyricsline02.mscx");
+      }
+
+void TestSpacing::minWidth()
+      {
+      QFETCH(QString, file);
+      MasterScore* score = readScore(file);
+      QVERIFY(score);
+      score->doLayout();
+
+      int pairs = 0;
+      for (Measure* m = score->firstMeasure(); m; m = m->nextMeasure()) {
+            m->computeMinWidth();
+            Segment* fs = m->first();
+            while (fs && !fs->enabled())
+                  fs = fs->next();
+            if (!fs)
+                  continue;
+            for (Segment* ps = fs->nextEnabled(); ps; ps = ps->nextEnabled()) {
+                  if (ps->header())
+                        continue;
+                  for (Segment* ns = ps->nextEnabled(); ns; ns = ns->nextEnabled()) {
+                        qreal d = ps->minHorizontalDistance(ns, false);
+                        if (ns->x() - ps->x() < d - 0.001) {
+                              QFAIL(qPrintable(QString("segments collide in measure %1: <%2> at %3, <%4> at %5, distance %6")
+                                 .arg(m->no() + 1).arg(ps->subTypeName()).arg(ps->x())
+                                 .arg(ns->subTypeName()).arg(ns->x()).arg(d)));
+                              }
+                        ++pairs;
+                        }
+                  }
+            }
+      QVERIFY(pairs > 0);
+      delete score;
+      }
+
+//---------------------------------------------------------
+//   clipped
+//    the parts of the rectangles of s between x1 and x2
+//---------------------------------------------------------
+
+static Shape clipped(const Shape& s, qreal x1, qreal x2)
+      {
+      Shape cs;
+      for (const QRectF& r : s) {
+            qreal l = qMax(r.left(), x1);
+            qreal w = qMin(r.right(), x2) - l;
+            if (w > 0.0)
+                  cs.add(QRectF(l, r.top(), w, r.height()));
+            }
+      return cs;
+      }
+
+//---------------------------------------------------------
+//   systemDistance
+//    The last staff changes between five lines and one
+//    line from measure to measure. Below every measure
+//    the distance to the next system is computed from the
+//    measure shapes and the staff lines height of that
+//    measure.
+//---------------------------------------------------------
+
+void TestSpacing::systemDistance_data()
+      {
+      QTest::addColumn<QString>("file");
+      QTest::newRow("grouping")    << QString("libmscore/rhythmicGrouping/group8thsSimple.mscx");
+      QTest::newRow("ornaments")   << QString("libmscore/midi/testBaroqueOrnaments.mscx");
+      }
+
+void TestSpacing::systemDistance()
+      {
+      QFETCH(QString, file);
+      MasterScore* score = readScore(file);
+      QVERIFY(score);
+      int lastStaff = score->nstaves() - 1;
+      Staff* staff  = score->staff(lastStaff);
+      StaffType five(*staff->staffType(0));
+      StaffType one(five);
+      one.setLines(1);
+      int n = 0;
+      for (Measure* m = score->firstMeasure()->nextMeasure(); m; m = m->nextMeasure())
+            staff->setStaffType(m->tick(), (++n % 2) ? &one : &five);
+      score->doLayout();
+
+      const qreal minVerticalDistance = score->styleP(StyleIdx::minVerticalDistance);
+      int pairs = 0;
+      System* s1 = 0;
+      for (System* s2 : score->systems()) {
+            if (!s1 || s1->vbox() || s2->vbox()) {
+                  s1 = s2;
+                  continue;
+                  }
+            Shape north;
+            for (MeasureBase* mb : s2->measures()) {
+                  if (mb->isMeasure())
+                        north.add(toMeasure(mb)->staffShape(0).translated(mb->pos()));
+                  }
+            Shape south;
+            for (MeasureBase* mb : s1->measures()) {
+                  if (mb->isMeasure())
+                        south.add(toMeasure(mb)->staffShape(lastStaff).translated(mb->pos()));
+                  }
+            qreal dist = score->styleP(StyleIdx::minSystemDistance);
+            qreal minHeight = 1000000.0;
+            qreal maxHeight = 0.0;
+            for (MeasureBase* mb : s1->measures()) {
+                  if (!mb->isMeasure())
+                        continue;
+                  Measure* m = toMeasure(mb);
+                  qreal x1   = m->x();
+                  qreal x2   = m->x() + m->width();
+                  qreal h    = m->staffLines(lastStaff)->height();
+                  qreal d    = clipped(south, x1, x2).minVerticalDistance(clipped(north, x1, x2));
+                  dist       = qMax(dist, d + minVerticalDistance - h);
+                  minHeight  = qMin(minHeight, h);
+                  maxHeight  = qMax(maxHeight, h);
+                  }
+            QCOMPARE(s1->minDistance(s2), dist);
+            if (maxHeight > minHeight)
+                  ++pairs;
+            s1 = s2;
+            }
+      QVERIFY(pairs > 0);
+      delete score;
+      }
+
+QTEST_MAIN(TestSpacing)
+#include "tst_spacing.moc"
@@ -0,0 +1,239 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2017 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+
+#include "libmscore/score.h"
+#include "libmscore/sym.h"
+#include "mtest/testutils.h"
+
+using namespace Ms;
+
+//---------------------------------------------------------
+//   TestSym
+//---------------------------------------------------------
+
+class TestSym : public QObject, public MTest
+      {
+      Q_OBJECT
+
+   private slots:
+      void initTestCase() { initMTest(); }
+      void glyphAtlas();
+      void glyphAtlasBudget();
+      void metricsCache();
+      void renderScope();
+      void glyphAtlasThreads();
+      };
+
+//---------------------------------------------------------
+//   glyphAtlas
+//    colored glyphs share the atlas entry of the black
+//    glyph and render the same coverage
+//---------------------------------------------------------
+
+void TestSym::glyphAtlas()
+      {
+      GlyphAtlas* atlas = GlyphAtlas::instance();
+      atlas->clear();
+      atlas->resetStatistics();
+      ScoreFont* f = ScoreFont::fallbackFont();
+
+      QImage black(100, 100, QImage::Format_ARGB32_Premultiplied);
+      black.fill(Qt::transparent);
+      QPainter p(&black);
+      p.setPen(Qt::black);
+      f->draw(SymId::noteheadBlack, &p, 1.0, QPointF(20.0, 50.0));
+      p.end();
+      QCOMPARE(atlas->misses(), quint64(1));
+      QCOMPARE(atlas->hits(), quint64(0));
+
+      QImage red(100, 100, QImage::Format_ARGB32_Premultiplied);
+      red.fill(Qt::transparent);
+      p.begin(&red);
+      p.setPen(Qt::red);
+      f->draw(SymId::noteheadBlack, &p, 1.0, QPointF(20.0, 50.0));
+      p.end();
+      QCOMPARE(atlas->misses(), quint64(1));
+      QCOMPARE(atlas->hits(), quint64(1));
+
+      // same coverage in both colors
+      int n = 0;
+      for (int y = 0; y < 100; ++y) {
+            for (int x = 0; x < 100; ++x) {
+                  QRgb c = red.pixel(x, y);
+                  int a  = qAlpha(black.pixel(x, y));
+                  QCOMPARE(qAlpha(c), a);
+                  QCOMPARE(qGreen(c), 0);
+                  QCOMPARE(qBlue(c), 0);
+                  if (a)
+                        ++n;
+                  }
+            }
+      QVERIFY(n > 0);
+
+      // a color costs a copy of the glyph, not of its atlas page
+      int memory = atlas->memory();
+      p.begin(&red);
+      for (int i = 1; i <= 50; ++i) {
+            p.setPen(QColor(i, 0, 0));
+            f->draw(SymId::noteheadBlack, &p, 1.0, QPointF(20.0, 50.0));
+            }
+      p.end();
+      QCOMPARE(atlas->misses(), quint64(1));
+      QVERIFY(atlas->memory() - memory < 512 * 512 * 4);
+
+      // a different scale is a different entry
+      p.begin(&red);
+      p.scale(2.0, 2.0);
+      f->draw(SymId::noteheadBlack, &p, 1.0, QPointF(10.0, 25.0));
+      p.end();
+      QCOMPARE(atlas->misses(), quint64(2));
+      }
+
+//---------------------------------------------------------
+//   glyphAtlasBudget
+//---------------------------------------------------------
+
+void TestSym::glyphAtlasBudget()
+      {
+      GlyphAtlas* atlas = GlyphAtlas::instance();
+      int budget = atlas->budget();
+      atlas->clear();
+      atlas->resetStatistics();
+      ScoreFont* f = ScoreFont::fallbackFont();
+
+      QImage img(400, 400, QImage::Format_ARGB32_Premultiplied);
+      QPainter p(&img);
+      const QColor colors[] = { Qt::black, Qt::red, Qt::blue, Qt::gray };
+      for (const QColor& c : colors) {
+            p.setPen(c);
+            for (int i = 1; i <= 20; ++i)
+                  f->draw(SymId::gClef, &p, i * 0.25, QPointF(100.0, 200.0));
+            }
+      QCOMPARE(atlas->misses(), quint64(20));
+      QCOMPARE(atlas->hits(), quint64(60));
+
+      int limit = atlas->memory() / 40;
+      atlas->setBudget(limit);
+      QVERIFY(atlas->memory() <= limit);
+
+      // drawing still works, evicted glyphs are rendered again
+      atlas->resetStatistics();
+      for (int i = 1; i <= 20; ++i)
+            f->draw(SymId::gClef, &p, i * 0.25, QPointF(100.0, 200.0));
+      p.end();
+      QCOMPARE(atlas->hits() + atlas->misses(), quint64(20));
+      QVERIFY(atlas->misses() > 0);
+
+      atlas->setBudget(budget);
+      }
+
+//---------------------------------------------------------
+//   metricsCache
+//    loading a font replaces a stale metrics cache file
+//---------------------------------------------------------
+
+void TestSym::metricsCache()
+      {
+      QTemporaryDir dir;
+      QVERIFY(dir.isValid());
+      QString path = ScoreFont::metricsCachePath();
+      ScoreFont::setMetricsCachePath(dir.path());
+
+      QFile stale(dir.path() + "/Gonville.metrics");
+      QVERIFY(stale.open(QIODevice::WriteOnly));
+      stale.write(QByteArray(1000, 'x'));
+      stale.close();
+
+      ScoreFont* f = ScoreFont::fontFactory("Gonville");
+      QVERIFY(f->isValid(SymId::noteheadBlack));
+      QVERIFY(!f->bbox(SymId::noteheadBlack, 1.0).isEmpty());
+
+      QFile cache(dir.path() + "/Gonville.metrics");
+      QVERIFY(cache.open(QIODevice::ReadOnly));
+      QByteArray data = cache.readAll();
+      QVERIFY(data.startsWith("MSFM"));
+      QVERIFY(data.size() > 1000);
+
+      ScoreFont::setMetricsCachePath(path);
+      }
+
+//---------------------------------------------------------
+//   renderScope
+//    render contexts nest and belong to one thread
+//---------------------------------------------------------
+
+void TestSym::renderScope()
+      {
+      double pr = MScore::pixelRatio();
+      QVERIFY(!MScore::pdfPrinting());
+      QVERIFY(!MScore::renderContext().printing);
+            {
+            RenderScope rs(2.0, true, true);
+            QCOMPARE(MScore::pixelRatio(), 2.0);
+            QVERIFY(MScore::pdfPrinting());
+                  {
+                  RenderScope rs2(0.5, true);
+                  QCOMPARE(MScore::pixelRatio(), 0.5);
+                  QVERIFY(!MScore::pdfPrinting());
+                  QVERIFY(MScore::renderContext().printing);
+                  }
+            QCOMPARE(MScore::pixelRatio(), 2.0);
+
+            // other threads still see the default context
+            QFuture<double> f = QtConcurrent::run([]() { return MScore::pixelRatio(); });
+            QCOMPARE(f.result(), pr);
+            }
+      QCOMPARE(MScore::pixelRatio(), pr);
+      QVERIFY(!MScore::pdfPrinting());
+      }
+
+//---------------------------------------------------------
+//   glyphAtlasThreads
+//    symbols drawn from several threads at once look like
+//    symbols drawn from one thread
+//---------------------------------------------------------
+
+static QImage drawClefs(QRgb color)
+      {
+      ScoreFont* f = ScoreFont::fallbackFont();
+      QImage img(400, 400, QImage::Format_ARGB32_Premultiplied);
+      img.fill(Qt::transparent);
+      QPainter p(&img);
+      p.setPen(QColor(color));
+      for (int i = 1; i <= 20; ++i)
+            f->draw(SymId::gClef, &p, i * 0.25, QPointF(100.0, 200.0));
+      return img;
+      }
+
+void TestSym::glyphAtlasThreads()
+      {
+      GlyphAtlas* atlas = GlyphAtlas::instance();
+      atlas->clear();
+      QList<QRgb> colors;
+      for (int i = 0; i < 16; ++i)
+            colors.append(qRgb(i * 16, 0, 0));
+      QList<QImage> expected;
+      for (QRgb c : colors)
+            expected.append(drawClefs(c));
+
+      atlas->clear();
+      QList<QImage> images = QtConcurrent::blockingMapped<QList<QImage>>(colors, drawClefs);
+      QCOMPARE(images.size(), expected.size());
+      for (int i = 0; i < images.size(); ++i)
+            QCOMPARE(images[i], expected[i]);
+      }
+
+QTEST_MAIN(TestSym)
+#include "tst_sym.moc"
+
@@ -0,0 +1,68 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2017 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+#include "mtest/testutils.h"
+#include "libmscore/score.h"
+#include "libmscore/mscore.h"
+
+#define DIR QString("musicxml/validation/")
+
+using namespace Ms;
+
+//---------------------------------------------------------
+//   TestMxmlValidation
+//    in converter mode a MusicXML file is validated only
+//    when its import fails
+//---------------------------------------------------------
+
+class TestMxmlValidation : public QObject, public MTest
+      {
+      Q_OBJECT
+
+   private slots:
+      void initTestCase()     { initMTest(); }
+      void importValidation_data();
+      void importValidation();
+      };
+
+//---------------------------------------------------------
+//   importValidation
+//---------------------------------------------------------
+
+void TestMxmlValidation::importValidation_data()
+      {
+      QTest::addColumn<QString>("file");
+      QTest::addColumn<bool>("imported");
+      QTest::addColumn<bool>("validated");
+
+      QTest::newRow("valid")      << "valid"      << true  << false;
+      QTest::newRow("invalid")    << "invalid"    << true  << false;    // not in the schema, but readable
+      QTest::newRow("unreadable") << "unreadable" << false << true;
+      }
+
+void TestMxmlValidation::importValidation()
+      {
+      QFETCH(QString, file);
+      QFETCH(bool, imported);
+      QFETCH(bool, validated);
+
+      QVERIFY(MScore::noGui);
+      MScore::lastError.clear();
+      MasterScore* score = readScore(DIR + file + ".xml");
+      QCOMPARE(score != 0, imported);
+      QCOMPARE(MScore::lastError.contains("is not a valid MusicXML file"), validated);
+      delete score;
+      }
+
+QTEST_MAIN(TestMxmlValidation)
+#include "tst_mxml_validation.moc"
@@ -14,6 +14,9 @@
 #include <QtTest/QtTest>
 #include "mtest/testutils.h"
 #include "libmscore/score.h"
+#include "omr/omr.h"
+#include "omr/omrpage.h"
+#include "omr/pattern.h"
 
 #define DIR QString("omr/notes/")
 
@@ -28,11 +31,18 @@ class TestNotes : public QObject, public MTest
       Q_OBJECT
 
       void omrFileTest(QString file);
+      OmrPage* benchmarkPage();
+
+      Omr* omr { 0 };
 
    private slots:
       void initTestCase();
       //void notes2() { omrFileTest("notes2"); }
       //void notes1() { omrFileTest("notes1"); }
+      void patternMatch();
+      void patternMatchBenchmark();
+      void patternMatcherBenchmark();
+      void pageThreads();
       };
 
 //---------------------------------------------------------
@@ -64,6 +74,130 @@ void TestNotes::omrFileTest(QString file)
       QVERIFY(saveCompareScore(score1, file + ".mscx", DIR + file + "-ref.mscx"));
       }
 
+//---------------------------------------------------------
+//   benchmarkPage
+//    first page of the pdf created from notes1.mscx
+//---------------------------------------------------------
+
+OmrPage* TestNotes::benchmarkPage()
+      {
+      if (!omr) {
+            MasterScore* score = readScore(DIR + "notes1.mscx");
+            score->doLayout();
+            savePdf(score, "notes1-match.pdf");
+            omr = new Omr("notes1-match.pdf", score);
+            if (!omr->readPdf())
+                  return 0;
+            }
+      return omr->numPages() ? omr->page(0) : 0;
+      }
+
+//---------------------------------------------------------
+//   patternMatch
+//    the packed matcher must score like Pattern::match
+//---------------------------------------------------------
+
+void TestNotes::patternMatch()
+      {
+      OmrPage* page = benchmarkPage();
+      QVERIFY(page);
+      Pattern* pattern = Omr::quartheadPattern;
+      PatternMatcher matcher(pattern, page->ratio());
+      const QImage* img = &page->image();
+      for (int y = -pattern->h(); y < img->height(); y += 7) {
+            for (int x = -pattern->w(); x < img->width(); x += 5) {
+                  double v1 = pattern->match(img, x, y, page->ratio());
+                  double v2 = matcher.match(img, x, y);
+                  QVERIFY(qAbs(v1 - v2) <= 1e-9 * qMax(1.0, qAbs(v1)));
+                  }
+            }
+      }
+
+//---------------------------------------------------------
+//   patternMatchBenchmark
+//    scan the page with a quarter note head, as
+//    OmrSystem::searchNotes does
+//---------------------------------------------------------
+
+void TestNotes::patternMatchBenchmark()
+      {
+      OmrPage* page = benchmarkPage();
+      QVERIFY(page);
+      Pattern* pattern = Omr::quartheadPattern;
+      const QImage* img = &page->image();
+      QBENCHMARK {
+            for (int y = 0; y < img->height() - pattern->h(); y += 4) {
+                  for (int x = 0; x < img->width() - pattern->w(); x += 2)
+                        pattern->match(img, x, y, page->ratio());
+                  }
+            }
+      }
+
+void TestNotes::patternMatcherBenchmark()
+      {
+      OmrPage* page = benchmarkPage();
+      QVERIFY(page);
+      Pattern* pattern = Omr::quartheadPattern;
+      const QImage* img = &page->image();
+      QBENCHMARK {
+            PatternMatcher matcher(pattern, page->ratio());
+            for (int y = 0; y < img->height() - pattern->h(); y += 4) {
+                  for (int x = 0; x < img->width() - pattern->w(); x += 2)
+                        matcher.match(img, x, y, 50);
+                  }
+            }
+      }
+
+//---------------------------------------------------------
+//   pageThreads
+//    pages read on several threads must come out in page
+//    order and equal to the pages read one after another
+//    on a single thread
+//---------------------------------------------------------
+
+void TestNotes::pageThreads()
+      {
+      MasterScore* score = readScore("libmscore/repeat/repeat36.mscx");
+      QVERIFY(score);
+      score->doLayout();
+      QVERIFY(score->npages() > 1);
+      QVERIFY(savePdf(score, "pagethreads.pdf"));
+
+      int threads = Omr::threads;
+      Omr::threads = 1;
+      Omr serial("pagethreads.pdf", score);
+      bool serialRead = serial.readPdf();
+      Omr::threads = 4;
+      Omr parallel("pagethreads.pdf", score);
+      bool parallelRead = parallel.readPdf();
+      Omr::threads = threads;
+      QVERIFY(serialRead);
+      QVERIFY(parallelRead);
+
+      QCOMPARE(serial.numPages(), score->npages());
+      QCOMPARE(parallel.numPages(), serial.numPages());
+      for (int i = 0; i < serial.numPages(); ++i) {
+            const OmrPage* sp = serial.page(i);
+            const OmrPage* pp = parallel.page(i);
+            QVERIFY(pp->image() == sp->image());
+            QCOMPARE(pp->spatium(), sp->spatium());
+            QCOMPARE(pp->ratio(), sp->ratio());
+            QCOMPARE(pp->slices(), sp->slices());
+            QCOMPARE(pp->systems().size(), sp->systems().size());
+            for (int k = 0; k < sp->systems().size(); ++k) {
+                  const OmrSystem& ss = sp->systems()[k];
+                  const OmrSystem& ps = pp->systems()[k];
+                  QCOMPARE(ps.barLines, ss.barLines);
+                  QCOMPARE(ps.staves().size(), ss.staves().size());
+                  for (int j = 0; j < ss.staves().size(); ++j) {
+                        QCOMPARE(QRect(ps.staves()[j]), QRect(ss.staves()[j]));
+                        QCOMPARE(ps.staves()[j].notes().size(), ss.staves()[j].notes().size());
+                        }
+                  }
+            }
+      delete score;
+      }
+
 QTEST_MAIN(TestNotes)
 #include "tst_notes.moc"
 
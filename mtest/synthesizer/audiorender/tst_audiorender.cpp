@@ -0,0 +1,269 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2017 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+
+#include "mtest/testutils.h"
+#include "mscore/audiorender.h"
+#include "effects/compressor/compressor.h"
+#include "effects/zita1/zita.h"
+#include "synthesizer/msynthesizer.h"
+#include "synthesizer/synthesizer.h"
+#include "synthesizer/synthesizergui.h"
+
+using namespace Ms;
+
+//---------------------------------------------------------
+//   DecaySynth
+//    one decaying square wave per channel; a note off
+//    lets the channel decay faster
+//---------------------------------------------------------
+
+class DecaySynth : public Synthesizer {
+      QList<MidiPatch*> _patches;
+      float _amp[16];
+      float _decay[16];
+      qint64 _frame { 0 };
+
+   public:
+      DecaySynth() {
+            _gui = new SynthesizerGui(this);
+            allSoundsOff(-1);
+            }
+      ~DecaySynth() { delete _gui; }
+
+      virtual const char* name() const override                  { return "decay"; }
+      virtual bool loadSoundFonts(const QStringList&) override   { return true; }
+      virtual QStringList soundFonts() const override            { return QStringList(); }
+      virtual const QList<MidiPatch*>& getPatchInfo() const override { return _patches; }
+      virtual SynthesizerGroup state() const override            { return SynthesizerGroup(); }
+      virtual bool setState(const SynthesizerGroup&) override    { return true; }
+
+      virtual void play(const PlayEvent& n) override {
+            if (n.type() == ME_NOTEON && n.velo()) {
+                  _amp[n.channel()]   = n.velo() / 1270.0f;
+                  _decay[n.channel()] = 0.9999f;
+                  }
+            else if (n.type() == ME_NOTEOFF || n.type() == ME_NOTEON)
+                  _decay[n.channel()] = 0.999f;
+            }
+      virtual void allSoundsOff(int) override {
+            for (int i = 0; i < 16; ++i) {
+                  _amp[i]   = 0.0f;
+                  _decay[i] = 0.0f;
+                  }
+            }
+      virtual void allNotesOff(int) override {
+            for (int i = 0; i < 16; ++i)
+                  _decay[i] = qMin(_decay[i], 0.999f);
+            }
+      virtual void clear() override {
+            allSoundsOff(-1);
+            _frame = 0;
+            }
+      virtual void process(unsigned n, float* p, float*, float*) override {
+            for (unsigned i = 0; i < n; ++i, ++_frame) {
+                  for (int c = 0; c < 16; ++c) {
+                        if (_amp[c] == 0.0f)
+                              continue;
+                        float v = (_frame / (20 + c)) & 1 ? _amp[c] : -_amp[c];
+                        p[2 * i]     += v;
+                        p[2 * i + 1] += v;
+                        _amp[c]      *= _decay[c];
+                        }
+                  }
+            }
+      };
+
+//---------------------------------------------------------
+//   TestAudioRender
+//---------------------------------------------------------
+
+class TestAudioRender : public QObject, public MTest
+      {
+      Q_OBJECT
+
+      std::vector<AudioEvent> events(int channel);
+      std::vector<float> render(int nJobs, float* peak);
+      MasterSynthesizer* reverbSynthesizer();
+      QByteArray render(MasterSynthesizer*);
+
+   private slots:
+      void initTestCase()     { initMTest(); }
+      void serialParallel();  // same frames with one and with two jobs
+      void cancel();
+      void clear();           // a cleared synthesizer sounds as a new one
+      };
+
+//---------------------------------------------------------
+//   events
+//    channel 0 plays one short note at the beginning,
+//    channel 1 plays until the end
+//---------------------------------------------------------
+
+std::vector<AudioEvent> TestAudioRender::events(int channel)
+      {
+      std::vector<AudioEvent> ev;
+      int notes = channel == 0 ? 1 : 20;
+      for (int i = 0; i < notes; ++i) {
+            qint64 frame = i * 4410;
+            ev.push_back({ frame,        0, NPlayEvent(ME_NOTEON, channel, 60, 100) });
+            ev.push_back({ frame + 2205, 0, NPlayEvent(ME_NOTEON, channel, 60, 0) });
+            }
+      return ev;
+      }
+
+//---------------------------------------------------------
+//   render
+//---------------------------------------------------------
+
+static const qint64 END_TIME     = 20 * 4410;
+static const qint64 MAX_END_TIME = END_TIME + 2 * 44100;
+
+std::vector<float> TestAudioRender::render(int nJobs, float* peak)
+      {
+      QList<AudioRenderJob*> jobs;
+      for (int i = 0; i < nJobs; ++i) {
+            AudioRenderJob* job = new AudioRenderJob;
+            job->synti = new MasterSynthesizer();
+            job->synti->registerSynthesizer(new DecaySynth);
+            job->synti->setSampleRate(44100);
+            job->synti->setGain(1.0f);
+            job->synti->setBoost(1.0f);
+            job->spill.open();
+            jobs.append(job);
+            }
+      for (int channel = 0; channel < 2; ++channel) {
+            std::vector<AudioEvent> ev = events(channel);
+            std::vector<AudioEvent>& dst = jobs[channel % nJobs]->events;
+            dst.insert(dst.end(), ev.begin(), ev.end());
+            }
+      std::stable_sort(jobs[0]->events.begin(), jobs[0]->events.end(),
+         [](const AudioEvent& a, const AudioEvent& b) { return a.frame < b.frame; });
+
+      QBuffer out;
+      out.open(QIODevice::ReadWrite);
+      std::atomic<bool> canceled { false };
+      *peak = renderAudio(jobs, END_TIME, MAX_END_TIME, &out, &canceled);
+      for (AudioRenderJob* job : jobs)
+            delete job->synti;
+      qDeleteAll(jobs);
+
+      const QByteArray& data = out.data();
+      std::vector<float> frames(data.size() / sizeof(float));
+      memcpy(frames.data(), data.constData(), frames.size() * sizeof(float));
+      return frames;
+      }
+
+//---------------------------------------------------------
+//   serialParallel
+//    the sound of channel 0 ends long before the score,
+//    the job rendering it alone must not end the export
+//    early or late
+//---------------------------------------------------------
+
+void TestAudioRender::serialParallel()
+      {
+      float serialPeak;
+      float parallelPeak;
+      std::vector<float> serial   = render(1, &serialPeak);
+      std::vector<float> parallel = render(2, &parallelPeak);
+      QVERIFY(serial.size() > size_t(END_TIME * 2));
+      QVERIFY(serial.size() < size_t(MAX_END_TIME * 2));
+      QCOMPARE(parallel.size(), serial.size());
+      QCOMPARE(parallelPeak, serialPeak);
+      for (size_t i = 0; i < serial.size(); ++i)
+            QCOMPARE(parallel[i], serial[i]);
+      }
+
+//---------------------------------------------------------
+//   cancel
+//---------------------------------------------------------
+
+void TestAudioRender::cancel()
+      {
+      AudioRenderJob job;
+      job.synti = new MasterSynthesizer();
+      job.synti->registerSynthesizer(new DecaySynth);
+      job.synti->setSampleRate(44100);
+      job.events = events(1);
+      job.spill.open();
+      QBuffer out;
+      out.open(QIODevice::ReadWrite);
+      std::atomic<bool> canceled { true };
+      renderAudio(QList<AudioRenderJob*>() << &job, END_TIME, MAX_END_TIME, &out, &canceled);
+      QCOMPARE(job.frames, qint64(0));
+      QCOMPARE(out.size(), qint64(0));
+      delete job.synti;
+      }
+
+//---------------------------------------------------------
+//   reverbSynthesizer
+//---------------------------------------------------------
+
+MasterSynthesizer* TestAudioRender::reverbSynthesizer()
+      {
+      MasterSynthesizer* synti = new MasterSynthesizer();
+      synti->registerSynthesizer(new DecaySynth);
+      synti->registerEffect(0, new ZitaReverb);
+      synti->registerEffect(1, new Compressor);
+      synti->setSampleRate(44100);
+      synti->setEffect(0, 0);
+      synti->setEffect(1, 0);
+      return synti;
+      }
+
+//---------------------------------------------------------
+//   render
+//    the raw frames of channel 1 rendered by synti
+//---------------------------------------------------------
+
+QByteArray TestAudioRender::render(MasterSynthesizer* synti)
+      {
+      AudioRenderJob job;
+      job.synti  = synti;
+      job.events = events(1);
+      job.spill.open();
+      QBuffer out;
+      out.open(QIODevice::ReadWrite);
+      std::atomic<bool> canceled { false };
+      renderAudio(QList<AudioRenderJob*>() << &job, END_TIME, MAX_END_TIME, &out, &canceled);
+      return out.data();
+      }
+
+//---------------------------------------------------------
+//   clear
+//    Jobs rendered back to back with the same synthesizer
+//    give the same bytes as a new synthesizer. The job
+//    ends while the reverb still sounds, so a tail left
+//    in the effects would be heard in the next job.
+//---------------------------------------------------------
+
+void TestAudioRender::clear()
+      {
+      MasterSynthesizer* fresh = reverbSynthesizer();
+      QByteArray reference = render(fresh);
+      delete fresh;
+      QVERIFY(!reference.isEmpty());
+
+      MasterSynthesizer* synti = reverbSynthesizer();
+      for (int i = 0; i < 2; ++i) {
+            synti->clear();
+            QByteArray data = render(synti);
+            QCOMPARE(data.size(), reference.size());
+            QVERIFY(data == reference);
+            }
+      delete synti;
+      }
+
+QTEST_MAIN(TestAudioRender)
+#include "tst_audiorender.moc"
@@ -0,0 +1,166 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2017 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+
+#include "mtest/testutils.h"
+#include "synthesizer/msynthesizer.h"
+#include "synthesizer/synthesizer.h"
+#include "synthesizer/synthesizergui.h"
+#include "synthesizer/event.h"
+
+using namespace Ms;
+
+//---------------------------------------------------------
+//   TestSynth
+//    adds a ramp with a per synthesizer slope
+//---------------------------------------------------------
+
+class TestSynth : public Synthesizer {
+      QByteArray _name;
+      float _slope;
+      qint64 _frame { 0 };
+      QList<MidiPatch*> _patches;
+
+   public:
+      std::atomic<bool> foreignThread { false };  // process() was called off the creating thread
+      Qt::HANDLE owner;
+
+      TestSynth(const QString& name, float slope) : _name(name.toLatin1()), _slope(slope) {
+            _gui  = new SynthesizerGui(this);
+            owner = QThread::currentThreadId();
+            }
+      ~TestSynth() { delete _gui; }
+
+      virtual const char* name() const override                  { return _name.constData(); }
+      virtual bool loadSoundFonts(const QStringList&) override   { return true; }
+      virtual QStringList soundFonts() const override            { return QStringList(); }
+      virtual void play(const PlayEvent&) override               {}
+      virtual const QList<MidiPatch*>& getPatchInfo() const override { return _patches; }
+      virtual SynthesizerGroup state() const override            { return SynthesizerGroup(); }
+      virtual bool setState(const SynthesizerGroup&) override    { return true; }
+
+      virtual void process(unsigned n, float* p, float*, float*) override {
+            if (QThread::currentThreadId() != owner)
+                  foreignThread = true;
+            for (unsigned i = 0; i < n; ++i, ++_frame) {
+                  float v = _slope * float(_frame % 1000);
+                  *p++ += v;
+                  *p++ -= v;
+                  }
+            }
+      };
+
+//---------------------------------------------------------
+//   TestParallelSynth
+//---------------------------------------------------------
+
+class TestParallelSynth : public QObject, public MTest
+      {
+      Q_OBJECT
+
+      MasterSynthesizer* create(bool parallel, std::vector<TestSynth*>* synths);
+      std::vector<float> render(MasterSynthesizer*, unsigned block, unsigned blocks);
+
+   private slots:
+      void initTestCase()     { initMTest(); }
+      void sameOutput_data();
+      void sameOutput();            // parallel against serial rendering
+      void smallBlocks();           // serial fallback
+      };
+
+//---------------------------------------------------------
+//   create
+//    three synthesizers, the last one is never played
+//---------------------------------------------------------
+
+MasterSynthesizer* TestParallelSynth::create(bool parallel, std::vector<TestSynth*>* synths)
+      {
+      MasterSynthesizer* ms = new MasterSynthesizer();
+      for (int i = 0; i < 3; ++i) {
+            TestSynth* s = new TestSynth(QString("test%1").arg(i), 0.001f * (i + 1));
+            synths->push_back(s);
+            ms->registerSynthesizer(s);
+            }
+      ms->setParallel(parallel);
+      ms->setGain(0.1f);
+      ms->setSampleRate(44100);
+      ms->play(NPlayEvent(ME_NOTEON, 0, 60, 80), 0);
+      ms->play(NPlayEvent(ME_NOTEON, 0, 60, 80), 1);
+      return ms;
+      }
+
+//---------------------------------------------------------
+//   render
+//---------------------------------------------------------
+
+std::vector<float> TestParallelSynth::render(MasterSynthesizer* ms, unsigned block, unsigned blocks)
+      {
+      std::vector<float> out(block * blocks * 2, 0.0f);
+      for (unsigned i = 0; i < blocks; ++i)
+            ms->process(block, out.data() + i * block * 2);
+      return out;
+      }
+
+//---------------------------------------------------------
+//   sameOutput
+//---------------------------------------------------------
+
+void TestParallelSynth::sameOutput_data()
+      {
+      QTest::addColumn<unsigned>("block");
+      QTest::newRow("64")   << 64u;
+      QTest::newRow("256")  << 256u;
+      QTest::newRow("4096") << 4096u;
+      }
+
+void TestParallelSynth::sameOutput()
+      {
+      QFETCH(unsigned, block);
+
+      std::vector<TestSynth*> serialSynths;
+      std::vector<TestSynth*> parallelSynths;
+      MasterSynthesizer* serial   = create(false, &serialSynths);
+      MasterSynthesizer* parallel = create(true, &parallelSynths);
+      QVERIFY(!serial->parallel());
+      QVERIFY(parallel->parallel());
+
+      std::vector<float> a = render(serial, block, 50);
+      std::vector<float> b = render(parallel, block, 50);
+      for (size_t i = 0; i < a.size(); ++i)
+            QCOMPARE(b[i], a[i]);
+      QVERIFY(!serialSynths[0]->foreignThread && !serialSynths[1]->foreignThread);
+      if (QThread::idealThreadCount() < 2)
+            QVERIFY(!parallelSynths[0]->foreignThread && !parallelSynths[1]->foreignThread);
+
+      delete serial;
+      delete parallel;
+      }
+
+//---------------------------------------------------------
+//   smallBlocks
+//    blocks below MIN_PARALLEL_FRAMES are rendered on the
+//    calling thread
+//---------------------------------------------------------
+
+void TestParallelSynth::smallBlocks()
+      {
+      std::vector<TestSynth*> synths;
+      MasterSynthesizer* ms = create(true, &synths);
+      render(ms, MasterSynthesizer::MIN_PARALLEL_FRAMES / 2, 100);
+      for (TestSynth* s : synths)
+            QVERIFY(!s->foreignThread);
+      delete ms;
+      }
+
+QTEST_MAIN(TestParallelSynth)
+#include "tst_parallelsynth.moc"
@@ -0,0 +1,209 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//  $Id:$
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+
+#include "mtest/testutils.h"
+
+#include "zerberus/instrument.h"
+#include "zerberus/zerberus.h"
+#include "zerberus/zone.h"
+#include "zerberus/sample.h"
+#include "zerberus/stream.h"
+#include "mscore/preferences.h"
+#include "synthesizer/event.h"
+
+using namespace Ms;
+
+static const int FRAMES = 169;
+
+//---------------------------------------------------------
+//   TestSfzStreaming
+//    both instruments play the same sample, the second
+//    one keeps only 16 frames of it in memory; the stereo
+//    pair does the same for a two channel sample
+//---------------------------------------------------------
+
+class TestSfzStreaming : public QObject, public MTest
+      {
+      Q_OBJECT
+      float samplerate = 44100;
+      Zerberus* resident;
+      Zerberus* streamed;
+      Zerberus* stereoResident;
+      Zerberus* stereoStreamed;
+
+      Zerberus* load(const QString& sfz, bool stream, bool background);
+      void render(Zerberus* synth, int key, float* data, int wait = 0);
+
+   private slots:
+      void initTestCase();
+      void testPreload();
+      void testStreamFrames_data();
+      void testStreamFrames();
+      void testStreamedAudio();
+      void testBackgroundAudio();
+   public:
+      ~TestSfzStreaming();
+      };
+
+//---------------------------------------------------------
+//   load
+//---------------------------------------------------------
+
+Zerberus* TestSfzStreaming::load(const QString& sfz, bool stream, bool background)
+      {
+      Ms::preferences.zerberusStreaming     = stream;
+      Ms::preferences.zerberusPreloadFrames = 16;
+      Zerberus* synth = new Zerberus();
+      synth->init(samplerate);
+      synth->setBackgroundLoading(background);
+      synth->loadInstrument(sfz);
+      Ms::preferences.zerberusStreaming = false;
+      synth->play(Ms::PlayEvent(ME_PROGRAM, 0, 0, 0));
+      return synth;
+      }
+
+//---------------------------------------------------------
+//   render
+//    play key through note off and the release
+//---------------------------------------------------------
+
+void TestSfzStreaming::render(Zerberus* synth, int key, float* data, int wait)
+      {
+      memset(data, 0, FRAMES * 2 * sizeof(float));
+      synth->play(Ms::PlayEvent(ME_NOTEON, 0, key, 127));
+      QTest::qWait(wait);
+      synth->process(109, data, nullptr, nullptr);
+      synth->play(Ms::PlayEvent(ME_NOTEON, 0, key, 0));
+      synth->process(60, data + 109 * 2, nullptr, nullptr);
+      }
+
+//---------------------------------------------------------
+//   initTestCase
+//---------------------------------------------------------
+
+void TestSfzStreaming::initTestCase()
+      {
+      initMTest();
+      Ms::preferences.mySoundfontsPath += ";" + root;
+      resident = load("residentTest.sfz", false, false);
+      streamed = load("streamingTest.sfz", true, false);
+      stereoResident = load("stereoResidentTest.sfz", false, false);
+      stereoStreamed = load("stereoStreamingTest.sfz", true, false);
+      }
+
+//---------------------------------------------------------
+//   testPreload
+//---------------------------------------------------------
+
+void TestSfzStreaming::testPreload()
+      {
+      for (Zone* z : resident->instrument(0)->zones())
+            QVERIFY(!z->sample->streamed());
+      for (Zone* z : streamed->instrument(0)->zones()) {
+            QVERIFY(z->sample->streamed());
+            QCOMPARE(z->sample->residentFrames(), 16);
+            QVERIFY(z->sample->memory() < size_t(z->sample->frames() * z->sample->channel() * sizeof(short)));
+            }
+      }
+
+//---------------------------------------------------------
+//   testStreamFrames
+//    a stream yields the same frames as the fully resident
+//    sample, including the frame before the start and the
+//    frames behind the end read by the interpolation
+//---------------------------------------------------------
+
+void TestSfzStreaming::testStreamFrames_data()
+      {
+      QTest::addColumn<bool>("stereo");
+      QTest::newRow("mono")   << false;
+      QTest::newRow("stereo") << true;
+      }
+
+void TestSfzStreaming::testStreamFrames()
+      {
+      QFETCH(bool, stereo);
+      std::list<Zone*> rz = (stereo ? stereoResident : resident)->instrument(0)->zones();
+      std::list<Zone*> sz = (stereo ? stereoStreamed : streamed)->instrument(0)->zones();
+      QVERIFY(!sz.empty());
+      QCOMPARE(sz.size(), rz.size());
+      for (auto r = rz.begin(), s = sz.begin(); r != rz.end(); ++r, ++s) {
+            Sample* rs = (*r)->sample;
+            Sample* ss = (*s)->sample;
+            QCOMPARE(rs->channel(), stereo ? 2 : 1);
+            QVERIFY(ss->streamed());
+            SampleStream stream;
+            stream.start(ss, 0, false);
+            stream.update(0);
+            int n = (rs->frames() + 2) * rs->channel();
+            for (int i = -rs->channel(); i < n; ++i)
+                  QCOMPARE(stream.at(i), rs->data()[i]);
+            stream.stop();
+            }
+      }
+
+//---------------------------------------------------------
+//   testStreamedAudio
+//    offline synthesizers read the stream in the voice
+//---------------------------------------------------------
+
+void TestSfzStreaming::testStreamedAudio()
+      {
+      DiskReader::instance()->resetStatistics();
+      float a[FRAMES * 2];
+      float b[FRAMES * 2];
+      for (int key = 20; key <= 23; ++key) {
+            render(resident, key, a);
+            render(streamed, key, b);
+            for (int i = 0; i < FRAMES * 2; ++i)
+                  QCOMPARE(b[i], a[i]);
+            }
+      DiskReader::Statistics s = DiskReader::instance()->statistics();
+      QCOMPARE(s.underruns, 0);
+      QVERIFY(s.framesRead > 0);
+      }
+
+//---------------------------------------------------------
+//   testBackgroundAudio
+//    the disk reader fills the stream while the note is
+//    waiting to be played
+//---------------------------------------------------------
+
+void TestSfzStreaming::testBackgroundAudio()
+      {
+      Zerberus* synth = load("streamingTest.sfz", true, true);     // shares the streamed instrument
+      DiskReader::instance()->resetStatistics();
+      float a[FRAMES * 2];
+      float b[FRAMES * 2];
+      for (int key = 20; key <= 23; ++key) {
+            render(resident, key, a);
+            render(synth, key, b, 100);
+            for (int i = 0; i < FRAMES * 2; ++i)
+                  QCOMPARE(b[i], a[i]);
+            }
+      QCOMPARE(DiskReader::instance()->statistics().underruns, 0);
+      delete synth;
+      }
+
+TestSfzStreaming::~TestSfzStreaming()
+      {
+      delete resident;
+      delete streamed;
+      delete stereoResident;
+      delete stereoStreamed;
+      }
+
+QTEST_MAIN(TestSfzStreaming)
+
+#include "tst_sfzstreaming.moc"
+
@@ -44,6 +44,7 @@ Pattern* Omr::naturalPattern;
 Pattern* Omr::trebleclefPattern;
 Pattern* Omr::bassclefPattern;
 Pattern* Omr::timesigPattern[10];
+int Omr::threads = 0;
 
 //---------------------------------------------------------
 //   Omr
@@ -146,49 +147,136 @@ bool Omr::readPdf()
       progress->setWindowModality(Qt::ApplicationModal);
       progress->show();
       progress->setRange(0, ACTION_NUM);
+      _canceled.store(0);
+      QObject::connect(progress, &QProgressDialog::canceled, [this]() { _canceled.store(1); });
 
 #ifdef OCR
       if (_ocr == 0)
             _ocr = new Ocr;
       _ocr->init();
 #endif
+      QElapsedTimer t;
+      t.start();
       int ID = READ_PDF;
-      int page = 0;
-      bool val;
       while (ID < ACTION_NUM) {
-            if(ID != INIT_PAGE && ID != SYSTEM_IDENTIFICATION) {
-                  page = 0;
-                  progress->setLabelText(QWidget::tr("%1 at Page %2").arg(ActionNames.at(ID+1)).arg(1));
-                  val = omrActions(ID, page);
-                  }
-            else {
-                  progress->setLabelText(QWidget::tr("%1 at Page %2").arg(ActionNames.at(ID)).arg(page+1));
-                  val = omrActions(ID, page);
-                  page++;
-                  }
+            progress->setLabelText(ActionNames.at(ID));
+            qApp->processEvents();
+            bool val = omrActions(ID);
 
             if (!val || progress->wasCanceled()) {
                   progress->close();
+                  delete progress;
                   return false;
                   }
-            else {
-                  if (ID < ACTION_NUM)
-                        progress->setValue(ID);
-                  else
-                        progress->setValue(ACTION_NUM - 1);
-                  qApp->processEvents();
-                  }
+            progress->setValue(qMin(int(ID), ACTION_NUM - 1));
+            qApp->processEvents();
             }
       progress->close();
       delete progress;
+      printTimings(t.elapsed());
       return true;
       }
 
+//---------------------------------------------------------
+//   process1
+//    rasterize and analyze one page; pages are independent
+//    until score assembly, so this runs on a worker thread
+//    with its own pdf document
+//---------------------------------------------------------
+
+void Omr::process1(int page)
+      {
+      OmrPage* p = _pages[page];
+      QElapsedTimer t;
+      t.start();
+      Pdf pdf;
+      QImage image;
+      if (pdf.open(_path))
+            image = pdf.page(page);
+      p->setImage(image);
+      p->addStageTime(OmrPage::Stage::RASTERIZE, t.elapsed());
+      if (image.isNull())
+            return;
+
+      //load one page and rescale
+      p->read();
+
+      //do the rescaling here
+      t.restart();
+      int new_w = p->image().width() * _spatium / p->spatium();
+      int new_h = p->image().height() * _spatium / p->spatium();
+      p->setImage(p->image().scaled(new_w, new_h, Qt::KeepAspectRatio));
+      p->addStageTime(OmrPage::Stage::SCALE, t.elapsed());
+      p->read();
+      }
+
+//---------------------------------------------------------
+//   identifySystems1
+//---------------------------------------------------------
+
+void Omr::identifySystems1(int page)
+      {
+      QElapsedTimer t;
+      t.start();
+      _pages[page]->identifySystems();
+      _pages[page]->addStageTime(OmrPage::Stage::SYSTEMS, t.elapsed());
+      }
+
+//---------------------------------------------------------
+//   processPages
+//    run fn for every page on a thread pool; idle threads
+//    pick up the next unprocessed page. Results stay in
+//    the pages, so they are merged in page order.
+//    The event loop runs until the last page is done;
+//    after a cancel the queued pages are skipped.
+//    return false if canceled
+//---------------------------------------------------------
+
+bool Omr::processPages(void (Omr::*fn)(int))
+      {
+      if (_pages.isEmpty())
+            return !_canceled.load();
+      QThreadPool pool;
+      if (threads > 0)
+            pool.setMaxThreadCount(threads);
+      QEventLoop loop;
+      QAtomicInt pending(_pages.size());
+      for (int i = 0; i < _pages.size(); ++i) {
+            QtConcurrent::run(&pool, [this, fn, i, &pending, &loop]() {
+                  if (!_canceled.load())
+                        (this->*fn)(i);
+                  if (!pending.deref())
+                        QMetaObject::invokeMethod(&loop, "quit", Qt::QueuedConnection);
+                  });
+            }
+      loop.exec();
+      pool.waitForDone();
+      return !_canceled.load();
+      }
+
+//---------------------------------------------------------
+//   printTimings
+//    per stage processing time, summed over all pages
+//---------------------------------------------------------
+
+void Omr::printTimings(qint64 wall) const
+      {
+      qDebug("Omr: %d pages in %lld ms, %d threads", _pages.size(), wall,
+         threads > 0 ? threads : QThread::idealThreadCount());
+      for (int i = 0; i < int(OmrPage::Stage::STAGES); ++i) {
+            OmrPage::Stage stage = OmrPage::Stage(i);
+            qint64 ms = 0;
+            for (const OmrPage* page : _pages)
+                  ms += page->stageTime(stage);
+            qDebug("   %-12s %8lld ms", OmrPage::stageName(stage), ms);
+            }
+      }
+
 //---------------------------------------------------------
 //   actions
 //---------------------------------------------------------
 
-bool Omr::omrActions(int &ID, int page)
+bool Omr::omrActions(int &ID)
       {
       if(ID == READ_PDF) {
             _doc = new Pdf();
@@ -199,32 +287,22 @@ bool Omr::omrActions(int &ID, int page)
                   }
             int n = _doc->numPages();
             printf("readPdf: %d pages\n", n);
-            for (int i = 0; i < n; ++i) {
-                  OmrPage* page = new OmrPage(this);
-                  QImage image = _doc->page(i);
-                  if (image.isNull())
-                        return false;
-                  page->setImage(image);
-                  _pages.append(page);
-                  }
+            for (int i = 0; i < n; ++i)
+                  _pages.append(new OmrPage(this));
 
             _spatium = 15.0; //constant spatium, image will be rescaled according to this parameter
             ID++;
             return true;
             }
       else if(ID == INIT_PAGE) {
-            //load one page and rescale
-            _pages[page]->read();
-
-            //do the rescaling here
-            int new_w = _pages[page]->image().width() * _spatium/_pages[page]->spatium();
-            int new_h = _pages[page]->image().height() * _spatium/_pages[page]->spatium();
-            QImage image = _pages[page]->image().scaled(new_w,new_h, Qt::KeepAspectRatio);
-            _pages[page]->setImage(image);
-            _pages[page]->read();
-
-            if(page == _pages.size()-1)
-                  ID++;
+            // rasterize, deskew and analyze all pages concurrently
+            if (!processPages(&Omr::process1))
+                  return false;
+            for (OmrPage* page : _pages) {
+                  if (page->image().isNull())
+                        return false;
+                  }
+            ID++;
             return true;
             }
       else if(ID == FINALIZE_PARMS) {
@@ -259,8 +337,10 @@ bool Omr::omrActions(int &ID, int page)
 
             }
       else if(ID == SYSTEM_IDENTIFICATION) {
-            _pages[page]->identifySystems();
-            if(page == _pages.size()-1) ID++;
+            // the patterns are read only from here on
+            if (!processPages(&Omr::identifySystems1))
+                  return false;
+            ID++;
             return true;
             }
       return false;
@@ -49,10 +49,14 @@ class Omr {
       QList<OmrPage*> _pages;
       Ocr* _ocr;
       Score* _score;
+      QAtomicInt _canceled;               // set from the gui thread, read by the page workers
 
       static void initUtils();
 
       void process1(int page);
+      bool processPages(void (Omr::*fn)(int));
+      void identifySystems1(int page);
+      void printTimings(qint64 wall) const;
 
 
       enum ActionID { READ_PDF, INIT_PAGE, FINALIZE_PARMS, SYSTEM_IDENTIFICATION, ACTION_NUM};
@@ -63,6 +67,7 @@ public:
       Omr(const QString& path, Score*);
 
       static char bitsSetTable[256];
+      static int threads;                 // page processing threads, 0: one per core
 
       bool readPdf();
       int pagesInDocument() const;
@@ -105,7 +110,7 @@ public:
       const QString& path() const {
             return _path;
             }
-      bool omrActions(int &ID, int page = 0);
+      bool omrActions(int &ID);
 
       static Pattern* quartheadPattern;
       static Pattern* halfheadPattern;
@@ -76,6 +76,20 @@ OmrPage::OmrPage(Omr* parent)
       {
       _omr = parent;
       cropL = cropR = cropT = cropB = 0;
+      for (qint64& t : _stageTime)
+            t = 0;
+      }
+
+//---------------------------------------------------------
+//   stageName
+//---------------------------------------------------------
+
+const char* OmrPage::stageName(Stage s)
+      {
+      static const char* names[] = {
+            "rasterize", "crop", "slice", "deskew", "stafflines", "ratio", "scale", "systems"
+            };
+      return names[int(s)];
       }
 
 //---------------------------------------------------------
@@ -105,14 +119,23 @@ bool OmrPage::isBlack(int x, int y) const
 
 void OmrPage::read()
       {
+      QElapsedTimer t;
+      t.start();
       //removeBorder();
       crop();
+      addStageTime(Stage::CROP, t.restart());
       slice();
+      addStageTime(Stage::SLICE, t.restart());
       deSkew();
+      addStageTime(Stage::DESKEW, t.restart());
       crop();
+      addStageTime(Stage::CROP, t.restart());
       slice();
+      addStageTime(Stage::SLICE, t.restart());
       getStaffLines();
+      addStageTime(Stage::STAFFLINES, t.restart());
       getRatio();
+      addStageTime(Stage::RATIO, t.elapsed());
       }
 
 struct SysState {
@@ -487,12 +510,13 @@ OmrPattern OmrPage::searchPattern(const std::vector<Pattern*>& pl, int y, int x1
       p.sym = SymId::noSym;
       p.prob = 0.0;
       for (Pattern* pattern : pl) {
+            PatternMatcher matcher(pattern, ratio());
             double val = 0.0;
             int xx = 0;
             int hw = pattern->w();
 
             for (int x = x1; x < (x2 - hw); ++x) {
-                  double val1 = pattern->match(&image(), x - pattern->base().x(), y - pattern->base().y());
+                  double val1 = matcher.match(&image(), x - pattern->base().x(), y - pattern->base().y(), val);
                   if (val1 > val) {
                         val = val1;
                         xx = x;
@@ -937,6 +961,7 @@ static bool intersectFuzz(const QRect& a, const QRect& b, int fuzz)
 
 void OmrSystem::searchNotes()
       {
+      PatternMatcher matcher(Omr::quartheadPattern, _page->ratio());
       for (int i = 0; i < _staves.size(); ++i) {
             OmrStaff* r = &_staves[i];
             int x1 = r->x();
@@ -946,7 +971,7 @@ void OmrSystem::searchNotes()
             // search notes on a range of vertical line position
             //
             for (int line = 0; line < 8; ++line)
-                  searchNotes(&r->notes(), x1, x2, r->y(), line);
+                  searchNotes(matcher, &r->notes(), x1, x2, r->y(), line);
 
             //
             // detect collisions
@@ -974,6 +999,7 @@ void OmrSystem::searchNotes()
 
 void OmrSystem::searchNotes(int *note_labels, int ran)
       {
+      PatternMatcher matcher(Omr::quartheadPattern, _page->ratio());
       for (int i = 0; i < _staves.size(); ++i) {
             OmrStaff* r = &_staves[i];
             int x1 = r->x();
@@ -983,7 +1009,7 @@ void OmrSystem::searchNotes(int *note_labels, int ran)
             // search notes on a range of vertical line position
             //
             for (int line = -5; line < 14; ++line)
-                  searchNotes(&r->notes(), x1, x2, r->y(), line);
+                  searchNotes(matcher, &r->notes(), x1, x2, r->y(), line);
 
             //
             // save detected note horizontal positions into note_labels
@@ -1565,7 +1591,7 @@ void OmrPage::getRatio()
 //   searchNotes
 //---------------------------------------------------------
 
-void OmrSystem::searchNotes(QList<OmrNote*>* noteList, int x1, int x2, int y, int line)
+void OmrSystem::searchNotes(const PatternMatcher& matcher, QList<OmrNote*>* noteList, int x1, int x2, int y, int line)
       {
       //a simple and cheap note detector (heuristic approach)
       double _spatium = _page->spatium();
@@ -1580,7 +1606,7 @@ void OmrSystem::searchNotes(QList<OmrNote*>* noteList, int x1, int x2, int y, in
       int note_thresh = 50;
 
       for (int x = x1; x < (x2 - hw); x += step_size) {
-            val = pattern->match(&_page->image(), x, y - hh / 2, _page->ratio());
+            val = matcher.match(&_page->image(), x, y - hh / 2, note_thresh);
             if (val > note_thresh) {
                   notePeaks.append(Peak(x, val, 0));
                   }
@@ -35,6 +35,7 @@ class Score;
 class XmlWriter;
 class XmlReader;
 class Pattern;
+class PatternMatcher;
 class OmrPage;
 
 
@@ -163,7 +164,7 @@ class OmrSystem {
       QList<OmrStaff>  _staves;
       QList<OmrMeasure>_measures;
 
-      void searchNotes(QList<OmrNote*>*, int x1, int x2, int y, int line);
+      void searchNotes(const PatternMatcher&, QList<OmrNote*>*, int x1, int x2, int y, int line);
 
    public:
       OmrSystem(OmrPage* p) { _page = p;  }
@@ -186,10 +187,17 @@ class OmrSystem {
 //---------------------------------------------------------
 
 class OmrPage {
+   public:
+      enum class Stage : char {
+            RASTERIZE, CROP, SLICE, DESKEW, STAFFLINES, RATIO, SCALE, SYSTEMS, STAGES
+            };
+
+   private:
       Omr* _omr;
       QImage _image;
       double _spatium;
       double _ratio;
+      qint64 _stageTime[int(Stage::STAGES)];    // ms spent in each stage
 
       int cropL, cropR;       // crop values in words (32 bit) units
       int cropT, cropB;       // crop values in pixel units
@@ -234,6 +242,9 @@ class OmrPage {
       const QList<QRect>& slices() const { return _slices;  }
       double spatium() const             { return _spatium; }
       double ratio() const   {return _ratio;}
+      qint64 stageTime(Stage s) const       { return _stageTime[int(s)]; }
+      void addStageTime(Stage s, qint64 ms) { _stageTime[int(s)] += ms; }
+      static const char* stageName(Stage);
       double staffDistance() const;
       double systemDistance() const;
       void readHeader(Score* score);
@@ -138,6 +138,100 @@ double Pattern::match(const QImage* img, int col, int row, double bg_parm) const
 #endif
       }
 
+//---------------------------------------------------------
+//   PatternMatcher
+//---------------------------------------------------------
+
+PatternMatcher::PatternMatcher(const Pattern* p, double bgParm)
+   : _pattern(p), _bgParm(bgParm), _rows(p->h()), _cols(p->w())
+      {
+      if (bgParm < 0.00001)
+            bgParm = 0.00001;
+      if (bgParm > 0.99999)
+            bgParm = 0.99999;
+      double log_bg_black = log(bgParm);
+      double log_bg_white = log(1.0 - bgParm);
+
+      _white.resize(_rows * (_cols + 1));
+      _delta.resize(_rows * _cols);
+      _bound.resize(_rows + 1);
+      std::vector<double> rowBound(_rows);
+      for (int y = 0; y < _rows; ++y) {
+            double* white = &_white[y * (_cols + 1)];
+            double* delta = &_delta[y * _cols];
+            white[0] = 0.0;
+            rowBound[y] = 0.0;
+            for (int x = 0; x < _cols; ++x) {
+                  double bs_scr = p->probability(x, y);
+                  if (bs_scr < 0.00001)
+                        bs_scr = 0.00001;
+                  if (bs_scr > 0.99999)
+                        bs_scr = 0.99999;
+                  double log_black = log(bs_scr) - log_bg_black;
+                  double log_white = log(1.0 - bs_scr) - log_bg_white;
+                  white[x + 1] = white[x] + log_white;
+                  delta[x]     = log_black - log_white;
+                  // pixels outside of the image do not count
+                  rowBound[y] += qMax(0.0, qMax(log_black, log_white));
+                  }
+            }
+      _bound[_rows] = 0.0;
+      for (int y = _rows - 1; y >= 0; --y)
+            _bound[y] = _bound[y + 1] + rowBound[y];
+      }
+
+//---------------------------------------------------------
+//   match
+//    same result as Pattern::match(img, col, row, bgParm);
+//    stops early and returns a value <= threshold as soon
+//    as the remaining rows cannot lift the score above it
+//---------------------------------------------------------
+
+double PatternMatcher::match(const QImage* img, int col, int row, double threshold) const
+      {
+      if (img->format() != QImage::Format_MonoLSB || img->colorCount() != 2
+         || qGray(img->color(0)) < 125 || qGray(img->color(1)) >= 125)
+            return _pattern->match(img, col, row, _bgParm);
+
+      int iw = img->width();
+      int ih = img->height();
+      int xe = qMin(_cols, iw - col);     // columns right of the image are skipped
+      double k = 0.0;
+      for (int y = 0; y < _rows && xe > 0; ++y) {
+            int yy = row + y;
+            if (yy >= ih)
+                  break;
+            const double* white = &_white[y * (_cols + 1)];
+            const double* delta = &_delta[y * _cols];
+            k += white[xe];
+            // QImage::pixel() outside of the image reads as black
+            int xs = col < 0 ? qMin(-col, xe) : 0;
+            for (int x = 0; x < xs; ++x)
+                  k += delta[x];
+            if (yy < 0) {
+                  for (int x = xs; x < xe; ++x)
+                        k += delta[x];
+                  }
+            else if (xs < xe) {
+                  const uchar* line = img->constScanLine(yy);
+                  int p1 = col + xs;            // first image pixel
+                  int p2 = col + xe;            // behind last image pixel
+                  for (int bi = p1 / 8; bi * 8 < p2; ++bi) {
+                        uint b = line[bi];
+                        if (bi * 8 < p1)
+                              b &= 0xff << (p1 - bi * 8);
+                        if (bi * 8 + 8 > p2)
+                              b &= 0xff >> (bi * 8 + 8 - p2);
+                        for (; b; b &= b - 1)
+                              k += delta[bi * 8 + qCountTrailingZeroBits(b) - col];
+                        }
+                  }
+            if (k + _bound[y + 1] <= threshold)
+                  return k + _bound[y + 1];
+            }
+      return k;
+      }
+
 //---------------------------------------------------------
 //   Pattern
 //    create a Pattern from symbol
@@ -59,11 +59,37 @@ class Pattern {
       int w() const       { return cols; /*_image.width();*/ }
       int h() const       { return rows; /*_image.height();*/ }
       bool dot(int x, int y) const;
+      double probability(int x, int y) const { return model[y][x]; }
       SymId id() const      { return _id; }
       void setId(SymId val) { _id = val; }
       const QPoint& base() const { return _base; }
       void setBase(const QPoint& v) { _base = v; }
       };
+
+//---------------------------------------------------------
+//   PatternMatcher
+//    log likelihood match of a Pattern model against a 1 bit
+//    page image (Format_MonoLSB, bit set = black) for a given
+//    background black ratio.
+//    The per pixel log terms are tabled once; a position
+//    is scored as the sum of the white terms of the row
+//    plus the black/white difference for every set bit,
+//    taken a byte at a time from the packed image rows.
+//---------------------------------------------------------
+
+class PatternMatcher {
+      const Pattern* _pattern;
+      double _bgParm;
+      int _rows;
+      int _cols;
+      std::vector<double> _white;      // prefix sums of the white terms, (_cols+1) per row
+      std::vector<double> _delta;      // black term - white term
+      std::vector<double> _bound;      // upper bound for the score of rows y.._rows-1
+
+   public:
+      PatternMatcher(const Pattern*, double bgParm);
+      double match(const QImage* img, int col, int row, double threshold = -std::numeric_limits<double>::max()) const;
+      };
 }
 
 #endif
@@ -23,7 +23,7 @@
 namespace Ms {
 
 
-int Pdf::references;
+QAtomicInt Pdf::references;
 
 //---------------------------------------------------------
 //   numPages
@@ -40,6 +40,7 @@ int Pdf::numPages() const
 
 Pdf::Pdf()
       {
+      _document = 0;
       ++references;
       }
 
@@ -52,6 +53,7 @@ bool Pdf::open(const QString& path)
       _document = Poppler::Document::load(path);
       if (!_document || _document->isLocked()) {
             delete _document;
+            _document = 0;
             return false;
             }
       return true;
@@ -33,7 +33,7 @@ namespace Ms {
 //---------------------------------------------------------
 
 class Pdf {
-      static int references;
+      static QAtomicInt references;
       PDFDoc* _doc;
       QImageOutputDev* imgOut;
       Poppler::Document* _document;
@@ -370,5 +370,54 @@ void EventList::insert(const Event& e)
             }
       append(e);
       }
-}
+//---------------------------------------------------------
+//   EventMap::finalize
+//    sort the events inserted out of order; called by the
+//    writer once the map is complete, so readers on other
+//    threads never modify it
+//---------------------------------------------------------
+
+void EventMap::finalize()
+      {
+      if (_sorted)
+            return;
+      std::stable_sort(_events.begin(), _events.end(),
+         [](const value_type& a, const value_type& b) { return a.first < b.first; });
+      _sorted = true;
+      }
+
+//---------------------------------------------------------
+//   lower_bound
+//   upper_bound
+//---------------------------------------------------------
+
+EventMap::const_iterator EventMap::lower_bound(int tick) const
+      {
+      return std::lower_bound(cbegin(), cend(), tick,
+         [](const value_type& a, int t) { return a.first < t; });
+      }
+
+EventMap::const_iterator EventMap::upper_bound(int tick) const
+      {
+      return std::upper_bound(cbegin(), cend(), tick,
+         [](int t, const value_type& a) { return t < a.first; });
+      }
 
+//---------------------------------------------------------
+//   replaceRange
+//    replace the events from fromTick to toTick inclusive
+//    by the events of m, which must lie in the same range
+//---------------------------------------------------------
+
+void EventMap::replaceRange(int fromTick, int toTick, const EventMap& m)
+      {
+      Q_ASSERT(_sorted && m._sorted);
+      auto i1 = std::lower_bound(_events.begin(), _events.end(), fromTick,
+         [](const value_type& a, int t) { return a.first < t; });
+      auto i2 = std::upper_bound(i1, _events.end(), toTick,
+         [](int t, const value_type& a) { return t < a.first; });
+      i1 = _events.erase(i1, i2);
+      _events.insert(i1, m._events.cbegin(), m._events.cend());
+      }
+
+}
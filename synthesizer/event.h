@@ -13,7 +13,7 @@
 #ifndef __EVENT_H__
 #define __EVENT_H__
 
-#include <map>
+#include <vector>
 
 namespace Ms {
 
@@ -311,7 +311,46 @@ class EventList : public QList<Event> {
       void insertNote(int channel, Note*);
       };
 
-class EventMap : public std::multimap<int, NPlayEvent> {};
+//---------------------------------------------------------
+//   EventMap
+//    events ordered by tick in a contiguous buffer; events
+//    with equal ticks keep their insertion order as in a
+//    std::multimap. insert() appends, finalize() sorts out
+//    of order inserts; the map must be finalized before it
+//    is read.
+//---------------------------------------------------------
+
+class EventMap {
+   public:
+      typedef std::pair<int, NPlayEvent> value_type;
+      typedef std::vector<value_type>::const_iterator const_iterator;
+      typedef const_iterator iterator;
+
+   private:
+      std::vector<value_type> _events;
+      bool _sorted { true };
+
+   public:
+      void insert(const value_type& e) {
+            if (_sorted && !_events.empty() && e.first < _events.back().first)
+                  _sorted = false;
+            _events.push_back(e);
+            }
+      void finalize();
+      void replaceRange(int fromTick, int toTick, const EventMap& events);
+      void reserve(size_t n)                 { _events.reserve(n); }
+      void swap(EventMap& m)                 { _events.swap(m._events); std::swap(_sorted, m._sorted); }
+      void clear()                           { _events.clear(); _sorted = true; }
+      bool empty() const                     { return _events.empty(); }
+      size_t size() const                    { return _events.size(); }
+
+      const_iterator begin() const           { Q_ASSERT(_sorted); return _events.cbegin(); }
+      const_iterator end() const             { Q_ASSERT(_sorted); return _events.cend();   }
+      const_iterator cbegin() const          { Q_ASSERT(_sorted); return _events.cbegin(); }
+      const_iterator cend() const            { Q_ASSERT(_sorted); return _events.cend();   }
+      const_iterator lower_bound(int tick) const;
+      const_iterator upper_bound(int tick) const;
+      };
 
 typedef EventList::iterator iEvent;
 typedef EventList::const_iterator ciEvent;
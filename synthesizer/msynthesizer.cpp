@@ -22,6 +22,34 @@ namespace Ms {
 
 extern QString dataPath;
 
+//---------------------------------------------------------
+//   SynthesizerWorker
+//    renders synthesizers of the current block in
+//    parallel mode; the audio thread only wakes it up and
+//    never waits on a lock
+//---------------------------------------------------------
+
+class SynthesizerWorker : public QThread {
+      MasterSynthesizer* _master;
+      QSemaphore _wakeup;
+      std::atomic<bool> _quit { false };
+
+      virtual void run() override {
+            for (;;) {
+                  _wakeup.acquire();
+                  if (_quit)
+                        break;
+                  while (_master->processJob())
+                        ;
+                  }
+            }
+
+   public:
+      SynthesizerWorker(MasterSynthesizer* m) : _master(m) {}
+      void wakeup() { _wakeup.release(); }
+      void quit()   { _quit = true; _wakeup.release(); wait(); }
+      };
+
 //---------------------------------------------------------
 //   default buildin SynthesizerState
 //    used if synthesizer.xml does not exist or is not
@@ -84,6 +112,9 @@ void MasterSynthesizer::init()
 
 MasterSynthesizer::~MasterSynthesizer()
       {
+      deleteWorkers();
+      for (Bus* b : _bus)
+            delete b;
       for (Synthesizer* s : _synthesizer)
             delete s;
       for (int i = 0; i < MAX_EFFECTS; ++i) {
@@ -103,6 +134,25 @@ void MasterSynthesizer::reset()
             s->reset();
       }
 
+//---------------------------------------------------------
+//   clear
+//    Silence the synthesizers and the effects at once,
+//    without release or reverb tails, so the next
+//    rendering starts as with a new master synthesizer.
+//    Soundfonts and parameters stay.
+//---------------------------------------------------------
+
+void MasterSynthesizer::clear()
+      {
+      reset();
+      for (Synthesizer* s : _synthesizer)
+            s->clear();
+      for (int ab = 0; ab < MAX_EFFECTS; ++ab) {
+            for (Effect* e : _effectList[ab])
+                  e->clear();
+            }
+      }
+
 //---------------------------------------------------------
 //   play
 //---------------------------------------------------------
@@ -197,6 +247,56 @@ Synthesizer* MasterSynthesizer::synthesizer(const QString& name)
 void MasterSynthesizer::registerSynthesizer(Synthesizer* s)
       {
       _synthesizer.push_back(s);
+      _jobs.resize(_synthesizer.size());
+      if (_parallel)
+            createWorkers();
+      }
+
+//---------------------------------------------------------
+//   setParallel
+//    In parallel mode every active synthesizer renders a
+//    block into its own bus, the buses are summed before
+//    the effects. Not to be called while processing.
+//---------------------------------------------------------
+
+void MasterSynthesizer::setParallel(bool val)
+      {
+      _parallel = val;
+      if (_parallel)
+            createWorkers();
+      else
+            deleteWorkers();
+      }
+
+//---------------------------------------------------------
+//   createWorkers
+//    one thread less than synthesizers, the audio thread
+//    renders too
+//---------------------------------------------------------
+
+void MasterSynthesizer::createWorkers()
+      {
+      while (_bus.size() < _synthesizer.size())
+            _bus.push_back(new Bus);
+      size_t n = qMin(_synthesizer.size(), size_t(qMax(QThread::idealThreadCount(), 1))) - 1;
+      while (_workers.size() < n) {
+            SynthesizerWorker* w = new SynthesizerWorker(this);
+            w->start(QThread::TimeCriticalPriority);
+            _workers.push_back(w);
+            }
+      }
+
+//---------------------------------------------------------
+//   deleteWorkers
+//---------------------------------------------------------
+
+void MasterSynthesizer::deleteWorkers()
+      {
+      for (SynthesizerWorker* w : _workers) {
+            w->quit();
+            delete w;
+            }
+      _workers.clear();
       }
 
 //---------------------------------------------------------
@@ -269,10 +369,7 @@ void MasterSynthesizer::process(unsigned n, float* p)
       // avoid overflow
       if (n > MAX_BUFFERSIZE / 2)
             return;
-      for (Synthesizer* s : _synthesizer) {
-            if (s->active())
-                  s->process(n, p, effect1Buffer, effect2Buffer);
-            }
+      processSynthesizers(n, p);
 
       if (_effect[0] && _effect[1]) {
             memset(effect1Buffer, 0, n * sizeof(float) * 2);
@@ -292,6 +389,76 @@ void MasterSynthesizer::process(unsigned n, float* p)
       lock1 = false;
       }
 
+//---------------------------------------------------------
+//   processSynthesizers
+//    add the output of all active synthesizers to p
+//---------------------------------------------------------
+
+void MasterSynthesizer::processSynthesizers(unsigned n, float* p)
+      {
+      int jobs = 0;
+      if (!_workers.empty() && n >= MIN_PARALLEL_FRAMES) {
+            for (unsigned i = 0; i < _synthesizer.size(); ++i) {
+                  if (_synthesizer[i]->active())
+                        _jobs[jobs++] = i;
+                  }
+            }
+      if (jobs < 2) {
+            for (Synthesizer* s : _synthesizer) {
+                  if (s->active())
+                        s->process(n, p, effect1Buffer, effect2Buffer);
+                  }
+            return;
+            }
+
+      // publish the jobs, wake up the workers and take part
+      // in rendering until all jobs are claimed
+      _jobFrames = n;
+      _pendingJobs.store(jobs, std::memory_order_relaxed);
+      _jobState.store(quint64(jobs) << 32, std::memory_order_release);
+      for (int i = 0; i < jobs - 1 && i < int(_workers.size()); ++i)
+            _workers[i]->wakeup();
+      while (processJob())
+            ;
+      // barrier: wait for the jobs still running on workers
+      while (_pendingJobs.load(std::memory_order_acquire))
+            QThread::yieldCurrentThread();
+
+      for (int i = 0; i < jobs; ++i) {
+            const float* b = _bus[_jobs[i]]->buffer;
+            for (unsigned k = 0; k < n * 2; ++k)
+                  p[k] += b[k];
+            }
+      }
+
+//---------------------------------------------------------
+//   processJob
+//    claim and render the next synthesizer of the current
+//    block; return false if there is none left.
+//    Called by the audio thread and the workers.
+//---------------------------------------------------------
+
+bool MasterSynthesizer::processJob()
+      {
+      quint64 state = _jobState.load(std::memory_order_acquire);
+      for (;;) {
+            quint32 next = quint32(state);
+            if (next >= quint32(state >> 32))
+                  return false;
+            if (_jobState.compare_exchange_weak(state, state + 1, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                  int idx  = _jobs[next];
+                  Bus* bus = _bus[idx];
+                  unsigned n = _jobFrames;
+                  memset(bus->buffer,  0, n * 2 * sizeof(float));
+                  memset(bus->effect1, 0, n * 2 * sizeof(float));
+                  memset(bus->effect2, 0, n * 2 * sizeof(float));
+                  _synthesizer[idx]->process(n, bus->buffer, bus->effect1, bus->effect2);
+                  _pendingJobs.fetch_sub(1, std::memory_order_release);
+                  return true;
+                  }
+            }
+      }
+
 //---------------------------------------------------------
 //   indexOfEffect
 //---------------------------------------------------------
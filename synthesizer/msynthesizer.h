@@ -24,6 +24,7 @@ class NPlayEvent;
 class Synthesizer;
 class Effect;
 class Xml;
+class SynthesizerWorker;
 
 //---------------------------------------------------------
 //   MasterSynthesizer
@@ -40,6 +41,20 @@ class MasterSynthesizer : public QObject {
    public:
       static const int MAX_BUFFERSIZE = 8192;
       static const int MAX_EFFECTS = 2;
+      static const unsigned MIN_PARALLEL_FRAMES = 64;  // smaller blocks are rendered serially
+
+      //---------------------------------------------------
+      //   Bus
+      //    private output of one synthesizer in parallel
+      //    mode; the effect sends are not used by the
+      //    master effects and are discarded
+      //---------------------------------------------------
+
+      struct Bus {
+            float buffer[MAX_BUFFERSIZE];
+            float effect1[MAX_BUFFERSIZE];
+            float effect2[MAX_BUFFERSIZE];
+            };
 
    private:
       std::atomic<bool> lock1      { false };
@@ -52,7 +67,20 @@ class MasterSynthesizer : public QObject {
 
       float effect1Buffer[MAX_BUFFERSIZE];
       float effect2Buffer[MAX_BUFFERSIZE];
+
+      // parallel mode
+      bool _parallel { false };
+      std::vector<Bus*> _bus;                   // one per synthesizer
+      std::vector<int> _jobs;                   // indices of the synthesizers to render
+      std::vector<SynthesizerWorker*> _workers;
+      std::atomic<quint64> _jobState { 0 };     // number of jobs << 32 | next job
+      std::atomic<int> _pendingJobs  { 0 };
+      unsigned _jobFrames            { 0 };
+
       int indexOfEffect(int ab, const QString& name);
+      void createWorkers();
+      void deleteWorkers();
+      void processSynthesizers(unsigned, float*);
 
    public slots:
       void sfChanged() { emit soundFontChanged(); }
@@ -73,6 +101,11 @@ class MasterSynthesizer : public QObject {
       void setSampleRate(float val);
 
       void process(unsigned, float*);
+      bool processJob();
+
+      void setParallel(bool val);
+      bool parallel() const            { return _parallel; }
+
       void play(const NPlayEvent&, unsigned);
 
       void setMasterTuning(double val);
@@ -92,6 +125,7 @@ class MasterSynthesizer : public QObject {
       void registerEffect(int ab, Effect*);
 
       void reset();
+      void clear();
       void allSoundsOff(int channel);
       void allNotesOff(int channel);
 
@@ -67,6 +67,7 @@ class Synthesizer {
 
       virtual void allSoundsOff(int /*channel*/) {}
       virtual void allNotesOff(int /*channel*/) {}
+      virtual void clear()           { allSoundsOff(-1); }  // silence at once, as a new synthesizer
 
       virtual SynthesizerGui* gui()  { return _gui; }
       };
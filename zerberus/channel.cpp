@@ -28,12 +28,23 @@ Channel::Channel(Zerberus* ms, int i)
       _msynth     = ms;
       _idx        = i;
       _instrument = 0;
+      reset();
+      }
+
+//---------------------------------------------------------
+//   reset
+//    the controllers as set by the instrument
+//---------------------------------------------------------
+
+void Channel::reset()
+      {
       _gain       = 1.0;
       _midiVolume = 1.0;
       _panLeftGain  = cosf(M_PI_2 * 64.0/126.0);
       _panRightGain = sinf(M_PI_2 * 64.0/126.0);
       memset(ctrl, 0, 128 * sizeof(char));
       ctrl[Ms::CTRL_EXPRESSION] = 127;
+      resetCC();
       }
 
 //---------------------------------------------------------
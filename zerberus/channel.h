@@ -49,6 +49,7 @@ class Channel {
       int idx() const            { return _idx; }
       int getCtrl(int CTRL) const;
       void resetCC();
+      void reset();
       };
 
 
@@ -17,6 +17,7 @@
 #include <QStringList>
 
 #include "libmscore/xml.h"
+#include "mscore/preferences.h"
 #include "audiofile/audiofile.h"
 #include "thirdparty/qzip/qzipreader_p.h"
 
@@ -34,14 +35,80 @@ int ZInstrument::idx;
 Sample::~Sample()
       {
       delete[] _data;
+      delete[] _loopData;
+      }
+
+//---------------------------------------------------------
+//   loadLoop
+//    keep the loop of a streamed sample in memory, the
+//    stream only follows the playback forwards
+//---------------------------------------------------------
+
+bool Sample::loadLoop(int start, int end)
+      {
+      if (!streamed() || _loopData || start < 0 || end <= 0 || end > _frames)
+            return true;
+      int from = qMax(start - 1, _residentFrames);      // interpolation needs one frame before
+      int to   = qMin(end + 3, _frames);                // and two after the loop
+      if (from >= to)
+            return true;
+      AudioFile a;
+      if (!a.open(_path) || !a.seekFrame(from)) {
+            qDebug("Sample::loadLoop: cannot read <%s>: %s", qPrintable(_path), a.error());
+            return false;
+            }
+      short* d = new short[(to - from) * _channel];
+      if (a.read(d, to - from) != to - from) {
+            qDebug("Sample::loadLoop: read failed: %s", a.error());
+            delete[] d;
+            return false;
+            }
+      repeatTail(d, from, to - from);
+      _loopData = d;
+      _loopFrom = from;
+      _loopTo   = to;
+      return true;
+      }
+
+//---------------------------------------------------------
+//   repeatTail
+//    readSample replaces the frames frames-3 and frames-2
+//    with frame frames-4; do the same for the n frames
+//    from frame first in d, read later from the file
+//---------------------------------------------------------
+
+void Sample::repeatTail(short* d, int first, int n) const
+      {
+      if (_frames < 4)
+            return;
+      int from = qMax(first, _frames - 3);
+      int to   = qMin(first + n, _frames - 1);
+      for (int f = from; f < to; ++f) {
+            for (int i = 0; i < _channel; ++i)
+                  d[(f - first) * _channel + i] = _tail[i];
+            }
+      }
+
+//---------------------------------------------------------
+//   memory
+//    bytes of sample data in memory
+//---------------------------------------------------------
+
+size_t Sample::memory() const
+      {
+      return ((_residentFrames + 3) + (_loopTo - _loopFrom)) * _channel * sizeof(short);
       }
 
 //---------------------------------------------------------
 //   readSample
+//    with preferences.zerberusStreaming only the first
+//    preferences.zerberusPreloadFrames frames of a sample
+//    file are read
 //---------------------------------------------------------
 
 Sample* ZInstrument::readSample(const QString& s, MQZipReader* uz)
       {
+      bool stream = !uz && Ms::preferences.zerberusStreaming;
       if (uz) {
             QList<MQZipReader::FileInfo> fi = uz->fileInfoList();
 
@@ -51,7 +118,7 @@ Sample* ZInstrument::readSample(const QString& s, MQZipReader* uz)
                   return 0;
                   }
             }
-      else {
+      else if (!stream) {
             QFile f(s);
             if (!f.open(QIODevice::ReadOnly)) {
                   printf("Sample::read: open <%s> failed\n", qPrintable(s));
@@ -61,31 +128,45 @@ Sample* ZInstrument::readSample(const QString& s, MQZipReader* uz)
             }
 
       AudioFile a;
-      if (!a.open(buf)) {
+      if (stream ? !a.open(s) : !a.open(buf)) {
             printf("open <%s> failed: %s\n", qPrintable(s), a.error());
             return 0;
             }
 
-      int channel = a.channels();
-      int frames  = a.frames();
-      int sr      = a.samplerate();
+      int channel  = a.channels();
+      int frames   = a.frames();
+      int sr       = a.samplerate();
+      if (channel > 2)
+            stream = false;         // a SampleStream holds mono or stereo frames
+      int resident = stream ? qBound(0, Ms::preferences.zerberusPreloadFrames, frames) : frames;
 
-      short* data = new short[(frames + 3) * channel];
+      short* data = new short[(resident + 3) * channel]();     // frames behind the end read as 0, as from a stream
       Sample* sa  = new Sample(channel, data, frames, sr);
       sa->setLoopStart(a.loopStart());
       sa->setLoopEnd(a.loopEnd());
       sa->setLoopMode(a.loopMode());
+      if (resident < frames)
+            sa->setStreamed(QFileInfo(s).absoluteFilePath(), resident);
 
-      if (frames != a.read(data + channel, frames)) {
+      if (resident != a.read(data + channel, resident)) {
             qDebug("Sample read failed: %s\n", a.error());
             delete sa;
-            sa = 0;
+            return 0;
             }
-      for (int i = 0; i < channel; ++i) {
-            data[i]                        = data[channel + i];
-            data[(frames-1) * channel + i] = data[(frames-3) * channel + i];
-            data[(frames-2) * channel + i] = data[(frames-3) * channel + i];
+      if (frames >= 4) {
+            std::vector<short> tail(channel);
+            if (resident > frames - 4)
+                  memcpy(tail.data(), data + (frames - 3) * channel, channel * sizeof(short));
+            else if (!a.seekFrame(frames - 4) || a.read(tail.data(), 1) != 1) {
+                  qDebug("Sample read failed: %s\n", a.error());
+                  delete sa;
+                  return 0;
+                  }
+            sa->setTail(tail.data());
+            sa->repeatTail(sa->data(), 0, resident);
             }
+      for (int i = 0; i < channel; ++i)
+            data[i] = data[channel + i];
       return sa;
       }
 
@@ -15,6 +15,9 @@
 
 //---------------------------------------------------------
 //   Sample
+//    A streamed sample keeps only the first residentFrames
+//    frames (and the loop of the zone) in memory, the rest
+//    is read from path by a SampleStream while playing.
 //---------------------------------------------------------
 
 class Sample {
@@ -26,9 +29,16 @@ class Sample {
       int _loopEnd;
       int _loopMode;
 
+      QString _path;
+      int _residentFrames;
+      short* _loopData { 0 };       // frames _loopFrom - _loopTo
+      int _loopFrom    { 0 };
+      int _loopTo      { 0 };
+      std::vector<short> _tail;     // frame frames-4, repeated in frames-3 and frames-2
+
    public:
       Sample(int ch, short* val, int f, int sr)
-         : _channel(ch), _data(val), _frames(f), _sampleRate(sr) {}
+         : _channel(ch), _data(val), _frames(f), _sampleRate(sr), _residentFrames(f) {}
       ~Sample();
       bool read(const QString&);
       int frames() const     { return _frames;          }
@@ -36,6 +46,18 @@ class Sample {
       int channel() const    { return _channel;         }
       int sampleRate() const { return _sampleRate;      }
 
+      void setStreamed(const QString& path, int residentFrames) { _path = path; _residentFrames = residentFrames; }
+      bool streamed() const                 { return _residentFrames < _frames; }
+      const QString& path() const           { return _path;           }
+      int residentFrames() const            { return _residentFrames; }
+      bool loadLoop(int start, int end);
+      const short* loopData() const         { return _loopData; }
+      void setTail(const short* frame)      { _tail.assign(frame, frame + _channel); }
+      void repeatTail(short* d, int first, int n) const;
+      int loopFrom() const                  { return _loopFrom; }
+      int loopTo() const                    { return _loopTo;   }
+      size_t memory() const;
+
       void setLoopStart (int v) { _loopStart = v; }
       void setLoopEnd (int v)   { _loopEnd = v; }
       void setLoopMode (int v)  { _loopMode = v; }
@@ -274,6 +274,8 @@ void ZInstrument::addRegion(SfzRegion& r)
                   r.loopEnd = z->sample->loopEnd();
             }
       r.setZone(z);
+      if (z->sample && (z->loopMode == LoopMode::CONTINUOUS || z->loopMode == LoopMode::SUSTAIN))
+            z->sample->loadLoop(z->loopStart, z->loopEnd);
       if (z->sample)
             addZone(z);
       }
@@ -0,0 +1,257 @@
+//=============================================================================
+//  Zerberus
+//  Zample player
+//
+//  Copyright (C) 2017 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <algorithm>
+#include <vector>
+
+#include "audiofile/audiofile.h"
+
+#include "stream.h"
+#include "sample.h"
+
+//---------------------------------------------------------
+//   ~SampleStream
+//---------------------------------------------------------
+
+SampleStream::~SampleStream()
+      {
+      delete _file;
+      delete[] _ring;
+      }
+
+//---------------------------------------------------------
+//   start
+//    voice thread; play s from frame
+//---------------------------------------------------------
+
+void SampleStream::start(const Sample* s, int frame, bool background)
+      {
+      if (!_ring)
+            _ring = new short[RING_FRAMES * 2];
+      flushMissing();
+      _head           = s->data();
+      _loop           = s->loopData();
+      _residentFrames = s->residentFrames();
+      _loopFrom       = s->loopFrom();
+      _loopTo         = s->loopTo();
+      _frames         = s->frames();
+      _shift          = s->channel() == 2 ? 1 : 0;
+      _filled         = qMax(frame - 1, _residentFrames);
+      ++_generation;
+
+      _position.store(frame, std::memory_order_relaxed);
+      _background.store(background, std::memory_order_relaxed);
+      _sample.store(s, std::memory_order_release);
+      _state.store((quint64(_generation) << 32) | quint32(_filled), std::memory_order_release);
+      }
+
+//---------------------------------------------------------
+//   stop
+//    voice thread; the file is closed on the next fill
+//---------------------------------------------------------
+
+void SampleStream::stop()
+      {
+      flushMissing();
+      ++_generation;
+      _sample.store(0, std::memory_order_release);
+      _state.store(quint64(_generation) << 32, std::memory_order_release);
+      if (!background())
+            fill();
+      }
+
+//---------------------------------------------------------
+//   update
+//    voice thread; called before each block with the
+//    current play position
+//---------------------------------------------------------
+
+void SampleStream::update(int frame)
+      {
+      flushMissing();
+      _position.store(frame, std::memory_order_relaxed);
+      if (!background())
+            fill();
+      _filled = int(_state.load(std::memory_order_acquire) & 0xffffffff);
+      }
+
+//---------------------------------------------------------
+//   flushMissing
+//---------------------------------------------------------
+
+void SampleStream::flushMissing()
+      {
+      if (_missing) {
+            DiskReader::instance()->underrun(_missing);
+            _missing = 0;
+            }
+      }
+
+//---------------------------------------------------------
+//   fill
+//    read the frames up to one ring length ahead of the
+//    play position; return true if anything was read.
+//    The loop is read through as well, so the ring always
+//    holds the last RING_FRAMES frames before filled.
+//---------------------------------------------------------
+
+bool SampleStream::fill()
+      {
+      quint64 state      = _state.load(std::memory_order_acquire);
+      quint32 generation = state >> 32;
+      int filled         = int(state & 0xffffffff);
+      const Sample* s    = _sample.load(std::memory_order_acquire);
+
+      if (generation != _fileGeneration) {
+            delete _file;
+            _file           = 0;
+            _filePos        = -1;
+            _fileGeneration = generation;
+            if (s) {
+                  _file = new AudioFile;
+                  if (!_file->open(s->path())) {
+                        qDebug("SampleStream: cannot open <%s>", qPrintable(s->path()));
+                        delete _file;
+                        _file = 0;
+                        }
+                  }
+            }
+      if (!s || !_file)
+            return false;
+
+      // the voice reads one frame before and two after its
+      // position, keep those in the ring
+      int target   = qMin(_position.load(std::memory_order_relaxed) + RING_FRAMES - 4, s->frames());
+      int channels = s->channel();
+      bool read    = false;
+      while (filled < target) {
+            int n = qMin(target - filled, CHUNK_FRAMES);
+            n = qMin(n, RING_FRAMES - (filled & (RING_FRAMES - 1)));
+            if (_filePos != filled && !_file->seekFrame(filled))
+                  break;
+            short* chunk = _ring + (filled & (RING_FRAMES - 1)) * channels;
+            n = _file->read(chunk, n);
+            if (n <= 0) {
+                  _filePos = -1;
+                  break;
+                  }
+            s->repeatTail(chunk, filled, n);
+            filled  += n;
+            _filePos = filled;
+            read     = true;
+            DiskReader::instance()->read(n);
+
+            // publish, unless the voice restarted the stream meanwhile
+            quint64 next = (quint64(generation) << 32) | quint32(filled);
+            if (!_state.compare_exchange_strong(state, next, std::memory_order_release, std::memory_order_relaxed))
+                  break;
+            state = next;
+            }
+      return read;
+      }
+
+//---------------------------------------------------------
+//   instance
+//---------------------------------------------------------
+
+DiskReader* DiskReader::instance()
+      {
+      static DiskReader reader;
+      return &reader;
+      }
+
+//---------------------------------------------------------
+//   ~DiskReader
+//---------------------------------------------------------
+
+DiskReader::~DiskReader()
+      {
+      _quit = true;
+      wait();
+      }
+
+//---------------------------------------------------------
+//   add
+//---------------------------------------------------------
+
+void DiskReader::add(SampleStream* s)
+      {
+      QMutexLocker locker(&_mutex);
+      _streams.push_back(s);
+      }
+
+//---------------------------------------------------------
+//   remove
+//    waits until the reader is done with s, but not for
+//    the reading of other streams
+//---------------------------------------------------------
+
+void DiskReader::remove(SampleStream* s)
+      {
+      QMutexLocker locker(&_mutex);
+      _streams.remove(s);
+      while (_current == s)
+            _idle.wait(&_mutex);
+      }
+
+//---------------------------------------------------------
+//   startReading
+//---------------------------------------------------------
+
+void DiskReader::startReading()
+      {
+      if (!isRunning())
+            start(QThread::HighPriority);
+      }
+
+//---------------------------------------------------------
+//   resetStatistics
+//---------------------------------------------------------
+
+void DiskReader::resetStatistics()
+      {
+      _underruns      = 0;
+      _missingSamples = 0;
+      _framesRead     = 0;
+      }
+
+//---------------------------------------------------------
+//   run
+
+//    The file i/o is done without holding the mutex, only
+//    the stream being filled is marked as in use.
+//---------------------------------------------------------
+
+void DiskReader::run()
+      {
+      std::vector<SampleStream*> streams;
+      while (!_quit) {
+            bool busy = false;
+            _mutex.lock();
+            streams.assign(_streams.begin(), _streams.end());
+            for (SampleStream* s : streams) {
+                  // skip the streams removed meanwhile
+                  if (std::find(_streams.begin(), _streams.end(), s) == _streams.end() || !s->background())
+                        continue;
+                  _current = s;
+                  _mutex.unlock();
+                  busy |= s->fill();
+                  _mutex.lock();
+                  _current = 0;
+                  _idle.wakeAll();
+                  }
+            _mutex.unlock();
+            if (!busy)
+                  msleep(2);
+            }
+      }
+
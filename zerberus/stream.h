@@ -0,0 +1,133 @@
+//=============================================================================
+//  Zerberus
+//  Zample player
+//
+//  Copyright (C) 2017 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __ZSTREAM_H__
+#define __ZSTREAM_H__
+
+#include <atomic>
+#include <list>
+
+class Sample;
+class AudioFile;
+
+//---------------------------------------------------------
+//   SampleStream
+//    Ring buffer of a voice playing a streamed sample.
+//    The voice publishes its play position, the disk
+//    reader thread fills the frames ahead of it. Without
+//    background loading (offline rendering) the voice
+//    fills the ring itself before each block.
+//    The head and the loop of the sample are taken from
+//    memory.
+//---------------------------------------------------------
+
+class SampleStream {
+   public:
+      static const int RING_FRAMES  = 16384;
+      static const int CHUNK_FRAMES = 4096;
+
+   private:
+      // shared between voice and reader
+      std::atomic<quint64> _state { 0 };       // generation << 32 | frames read
+      std::atomic<const Sample*> _sample { 0 };
+      std::atomic<int> _position { 0 };         // first frame still needed by the voice
+      std::atomic<bool> _background { false };
+      short* _ring { 0 };
+
+      // voice side
+      quint32 _generation  { 0 };
+      const short* _head   { 0 };
+      const short* _loop   { 0 };
+      int _residentFrames  { 0 };
+      int _loopFrom        { 0 };
+      int _loopTo          { 0 };
+      int _frames          { 0 };
+      int _shift           { 0 };         // log2 of the channel count
+      int _filled          { 0 };
+      int _missing         { 0 };
+
+      // reader side
+      AudioFile* _file     { 0 };
+      quint32 _fileGeneration { 0 };
+      int _filePos         { -1 };
+
+      void flushMissing();
+
+   public:
+      ~SampleStream();
+
+      void start(const Sample*, int frame, bool background);
+      void stop();
+      void update(int frame);
+      bool background() const { return _background.load(std::memory_order_relaxed); }
+      bool fill();
+
+      //---------------------------------------------------
+      //   at
+      //    interleaved sample point i, 0 if it was not
+      //    read in time
+      //---------------------------------------------------
+
+      short at(int i) {
+            int frame = i >> _shift;
+            if (frame < _residentFrames)
+                  return _head[i];
+            if (frame < _loopTo && frame >= _loopFrom)
+                  return _loop[i - (_loopFrom << _shift)];
+            if (frame < _filled && frame >= _filled - RING_FRAMES)
+                  return _ring[((frame & (RING_FRAMES - 1)) << _shift) + (i & ((1 << _shift) - 1))];
+            if (frame < _frames)
+                  ++_missing;
+            return 0;
+            }
+      };
+
+//---------------------------------------------------------
+//   DiskReader
+//    thread refilling the streams of all realtime voices
+//---------------------------------------------------------
+
+class DiskReader : public QThread {
+      QMutex _mutex;
+      QWaitCondition _idle;
+      std::list<SampleStream*> _streams;
+      SampleStream* _current { 0 };       // stream being filled, guarded by _mutex
+      std::atomic<bool> _quit { false };
+
+      std::atomic<int> _underruns         { 0 };
+      std::atomic<qint64> _missingSamples { 0 };
+      std::atomic<qint64> _framesRead     { 0 };
+
+      virtual void run() override;
+
+   public:
+      struct Statistics {
+            int underruns;          // voice blocks which played silence for missing data
+            qint64 missingSamples;
+            qint64 framesRead;
+            };
+
+      ~DiskReader();
+      static DiskReader* instance();
+
+      void add(SampleStream*);
+      void remove(SampleStream*);
+      void startReading();
+
+      void underrun(int missing)    { ++_underruns; _missingSamples += missing; }
+      void read(int frames)         { _framesRead += frames; }
+      Statistics statistics() const { return { _underruns, _missingSamples, _framesRead }; }
+      void resetStatistics();
+      };
+
+#endif
+
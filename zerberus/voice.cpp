@@ -18,6 +18,7 @@
 #include "zerberus.h"
 #include "zone.h"
 #include "sample.h"
+#include "stream.h"
 #include "synthesizer/msynthesizer.h"
 
 float Voice::interpCoeff[INTERP_MAX][4];
@@ -50,6 +51,41 @@ Voice::Voice(Zerberus* z)
       _zerberus = z;
       }
 
+Voice::~Voice()
+      {
+      if (_stream) {
+            DiskReader::instance()->remove(_stream);
+            delete _stream;
+            }
+      }
+
+//---------------------------------------------------------
+//   enableStreaming
+//    create the SampleStream of this voice, called before
+//    the first instrument with streamed samples is used
+//---------------------------------------------------------
+
+void Voice::enableStreaming()
+      {
+      if (_stream)
+            return;
+      _stream = new SampleStream;
+      DiskReader::instance()->add(_stream);
+      }
+
+//---------------------------------------------------------
+//   off
+//---------------------------------------------------------
+
+void Voice::off()
+      {
+      _state = VoiceState::OFF;
+      if (_streaming) {
+            _stream->stop();
+            _streaming = false;
+            }
+      }
+
 //---------------------------------------------------------
 //   stop
 //---------------------------------------------------------
@@ -112,6 +148,10 @@ void Voice::start(Channel* c, int key, int v, const Zone* zone, double durSinceN
       _loopStart = z->loopStart;
       _loopEnd   = z->loopEnd;
       _samplesSinceStart = 0;
+      _streaming  = s->streamed() && _stream;
+      _dataOffset = z->offset * audioChan;
+      if (_streaming)
+            _stream->start(s, z->offset, _zerberus->backgroundLoading());
 
       _offMode  = z->offMode;
       _offBy    = z->offBy;
@@ -325,6 +365,9 @@ void Voice::process(int frames, float* p)
             last_fres = _fres;
             }
 
+      if (_streaming)
+            _stream->update(phase.index() + z->offset);
+
       if (audioChan == 1) {
             while (frames--) {
 
@@ -452,22 +495,31 @@ void Voice::updateLoop()
             phase.setIndex(_loopStart+(idx-_loopEnd-1));
       }
 
+//---------------------------------------------------------
+//   sampleAt
+//---------------------------------------------------------
+
+inline short Voice::sampleAt(int pos)
+      {
+      return _streaming ? _stream->at(pos + _dataOffset) : data[pos];
+      }
+
 short Voice::getData(int pos) {
       if (pos < 0 && !_looping)
             return 0;
 
       if (!_looping)
-            return data[pos];
+            return sampleAt(pos);
 
       int loopEnd = _loopEnd * audioChan;
       int loopStart = _loopStart * audioChan;
 
       if (pos < loopStart)
-            return data[loopEnd + (pos - loopStart) + audioChan];
+            return sampleAt(loopEnd + (pos - loopStart) + audioChan);
       else if (pos > (loopEnd + audioChan - 1))
-            return data[loopStart + (pos - loopEnd) - audioChan];
+            return sampleAt(loopStart + (pos - loopEnd) - audioChan);
       else
-            return data[pos];
+            return sampleAt(pos);
       }
 
 //---------------------------------------------------------
@@ -19,6 +19,7 @@
 class Channel;
 struct Zone;
 class Sample;
+class SampleStream;
 class Zerberus;
 
 enum class LoopMode : char;
@@ -121,6 +122,9 @@ class Voice {
       int audioChan;
 
       short* data;
+      SampleStream* _stream { 0 };  // only for voices of a Zerberus with streamed samples
+      bool _streaming = false;      // data of a streamed sample is read through _stream
+      int _dataOffset;
       int eidx;
       LoopMode _loopMode;
       OffMode _offMode;
@@ -169,6 +173,7 @@ class Voice {
       static float interpCoeff[INTERP_MAX][4];
 
       void updateFilter(float fres);
+      short sampleAt(int pos);
 
       Trigger trigger;
 
@@ -176,6 +181,7 @@ class Voice {
 
    public:
       Voice(Zerberus*);
+      ~Voice();
       Voice* next() const         { return _next; }
       void setNext(Voice* v)      { _next = v; }
 
@@ -196,7 +202,8 @@ class Voice {
       void stop()                 { envelopes[currentEnvelope].step(); envelopes[V1Envelopes::RELEASE].max = envelopes[currentEnvelope].val; currentEnvelope = V1Envelopes::RELEASE; _state = VoiceState::STOP;      }
       void stop(float time);
       void sustained()            { _state = VoiceState::SUSTAINED; }
-      void off()                  { _state = VoiceState::OFF;       }
+      void off();
+      void enableStreaming();
       const char* state() const;
       LoopMode loopMode() const   { return _loopMode; }
       int getSamplesSinceStart()  { return _samplesSinceStart;    }
@@ -20,6 +20,8 @@
 #include "channel.h"
 #include "instrument.h"
 #include "zone.h"
+#include "sample.h"
+#include "stream.h"
 
 #include <stdio.h>
 
@@ -31,9 +33,11 @@ std::list<ZInstrument*> Zerberus::globalInstruments;
 //   createZerberus
 //---------------------------------------------------------
 
-Ms::Synthesizer* createZerberus()
+Ms::Synthesizer* createZerberus(bool backgroundLoading)
       {
-      return new Zerberus();
+      Zerberus* z = new Zerberus();
+      z->setBackgroundLoading(backgroundLoading);
+      return z;
       }
 
 //---------------------------------------------------------
@@ -47,8 +51,11 @@ Zerberus::Zerberus()
             initialized = true;
             Voice::init();
             }
-      for (int i = 0; i < MAX_VOICES; ++i)
-            freeVoices.push(new Voice(this));
+      for (int i = 0; i < MAX_VOICES; ++i) {
+            Voice* v = new Voice(this);
+            voices.push_back(v);
+            freeVoices.push(v);
+            }
       for (int i = 0; i < MAX_CHANNEL; ++i)
             _channel[i] = new Channel(this, i);
       busy = true;      // no sf loaded yet
@@ -78,6 +85,19 @@ Zerberus::~Zerberus()
             delete c;
       }
 
+//---------------------------------------------------------
+//   setBackgroundLoading
+//    a realtime synthesizer must not wait for the disk;
+//    otherwise voices read streamed samples themselves
+//---------------------------------------------------------
+
+void Zerberus::setBackgroundLoading(bool val)
+      {
+      _backgroundLoading = val;
+      if (val)
+            DiskReader::instance()->startReading();
+      }
+
 //---------------------------------------------------------
 //   programChange
 //---------------------------------------------------------
@@ -284,6 +304,35 @@ void Zerberus::allNotesOff(int channel)
       busy = false;
       }
 
+//---------------------------------------------------------
+//   clear
+//    stop all voices without release and give every
+//    channel the first instrument with its controllers,
+//    as after loading
+//---------------------------------------------------------
+
+void Zerberus::clear()
+      {
+      bool wasBusy = busy;
+      busy = true;
+      while (activeVoices) {
+            Voice* v = activeVoices;
+            activeVoices = v->next();
+            v->off();
+            freeVoices.push(v);
+            }
+      for (ZInstrument* i : instruments) {
+            for (Zone* z : i->zones())
+                  z->ccGain = 1.0;
+            }
+      ZInstrument* zi = instruments.empty() ? 0 : instruments.front();
+      for (int i = 0; i < MAX_CHANNEL; ++i) {
+            _channel[i]->setInstrument(zi);
+            _channel[i]->reset();
+            }
+      busy = wasBusy;
+      }
+
 //---------------------------------------------------------
 //   loadSoundFonts
 //---------------------------------------------------------
@@ -396,6 +445,23 @@ ZInstrument* Zerberus::instrument(int n) const
       return 0;
       }
 
+//---------------------------------------------------------
+//   enableStreaming
+//    give all voices a SampleStream if instr has streamed
+//    samples; a Zerberus without them needs no streams
+//---------------------------------------------------------
+
+void Zerberus::enableStreaming(const ZInstrument* instr)
+      {
+      for (const Zone* z : instr->zones()) {
+            if (z->sample && z->sample->streamed()) {
+                  for (Voice* v : voices)
+                        v->enableStreaming();
+                  return;
+                  }
+            }
+      }
+
 //---------------------------------------------------------
 //   loadInstrument
 //    return true on success
@@ -414,6 +480,7 @@ bool Zerberus::loadInstrument(const QString& s)
             }
       for (ZInstrument* instr : globalInstruments) {
             if (QFileInfo(instr->path()).fileName() == fileName) {
+                  enableStreaming(instr);
                   instruments.push_back(instr);
                   instr->setRefCount(instr->refCount() + 1);
                   if (instruments.size() == 1) {
@@ -438,6 +505,7 @@ bool Zerberus::loadInstrument(const QString& s)
 
       try {
             if (instr->load(path)) {
+                  enableStreaming(instr);
                   globalInstruments.push_back(instr);
                   instruments.push_back(instr);
                   instr->setRefCount(1);
@@ -79,14 +79,17 @@ class Zerberus : public Ms::Synthesizer {
 
       int allocatedVoices = 0;
       VoiceFifo freeVoices;
+      std::vector<Voice*> voices;         // all voices, owned by freeVoices
       Voice* activeVoices = 0;
       int _loadProgress = 0;
       bool _loadWasCanceled = false;
+      bool _backgroundLoading = false;    // streamed samples are read by the DiskReader thread
 
       void programChange(int channel, int program);
       void trigger(Channel*, int key, int velo, Trigger, int cc, int ccVal, double durSinceNoteOn);
       void processNoteOff(Channel*, int pitch);
       void processNoteOn(Channel* cp, int key, int velo);
+      void enableStreaming(const ZInstrument*);
 
    public:
       Zerberus();
@@ -104,6 +107,8 @@ class Zerberus : public Ms::Synthesizer {
       void setLoadProgress(int val) { _loadProgress = val; }
       bool loadWasCanceled()        { return _loadWasCanceled; }
       void setLoadWasCanceled(bool status)     { _loadWasCanceled = status; }
+      bool backgroundLoading() const           { return _backgroundLoading; }
+      void setBackgroundLoading(bool val);
 
       virtual void setMasterTuning(double val) { _masterTuning = val;  }
       virtual double masterTuning() const      { return _masterTuning; }
@@ -118,6 +123,7 @@ class Zerberus : public Ms::Synthesizer {
 
       virtual void allSoundsOff(int channel);
       virtual void allNotesOff(int channel);
+      virtual void clear();
 
       virtual bool addSoundFont(const QString&);
       virtual bool removeSoundFont(const QString&);